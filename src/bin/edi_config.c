@@ -37,12 +37,12 @@
    EET_DATA_DESCRIPTOR_ADD_HASH(edd, type, #member, member, eddtype)
 
 #  define EDI_CONFIG_FILE_EPOCH 0x0003
-#  define EDI_CONFIG_FILE_GENERATION 0x000c
+#  define EDI_CONFIG_FILE_GENERATION 0x000f
 #  define EDI_CONFIG_FILE_VERSION \
    ((EDI_CONFIG_FILE_EPOCH << 16) | EDI_CONFIG_FILE_GENERATION)
 
 #  define EDI_PROJECT_CONFIG_FILE_EPOCH 0x0002
-#  define EDI_PROJECT_CONFIG_FILE_GENERATION 0x0005
+#  define EDI_PROJECT_CONFIG_FILE_GENERATION 0x0006
 #  define EDI_PROJECT_CONFIG_FILE_VERSION \
    ((EDI_PROJECT_CONFIG_FILE_EPOCH << 16) | EDI_PROJECT_CONFIG_FILE_GENERATION)
 
@@ -243,6 +243,9 @@ _edi_config_init(void)
    EDI_CONFIG_VAL(D, T, autosave, EET_T_UCHAR);
    EDI_CONFIG_VAL(D, T, trim_whitespace, EET_T_UCHAR);
    EDI_CONFIG_VAL(D, T, show_hidden, EET_T_UCHAR);
+   EDI_CONFIG_VAL(D, T, search_index, EET_T_UCHAR);
+   EDI_CONFIG_VAL(D, T, symbol_index, EET_T_UCHAR);
+   EDI_CONFIG_VAL(D, T, search_results_max, EET_T_INT);
 
    EDI_CONFIG_LIST(D, T, projects, _edi_cfg_proj_edd);
    EDI_CONFIG_LIST(D, T, mime_assocs, _edi_cfg_mime_edd);
@@ -296,6 +299,7 @@ _edi_config_init(void)
    EDI_CONFIG_VAL(D, T, debug_command, EET_T_STRING);
    EDI_CONFIG_VAL(D, T, user_fullname, EET_T_STRING);
    EDI_CONFIG_VAL(D, T, user_email, EET_T_STRING);
+   EDI_CONFIG_VAL(D, T, task_tags, EET_T_STRING);
 
    EDI_CONFIG_LIST(D, T, panels, _edi_proj_cfg_panel_edd);
    EDI_CONFIG_LIST(D, T, windows, _edi_proj_cfg_tab_edd);
@@ -369,6 +373,18 @@ _edi_config_load(void)
    _edi_config->mime_assocs = NULL;
    IFCFGEND;
 
+   IFCFG(0x000d);
+   _edi_config->search_index = EINA_TRUE;
+   IFCFGEND;
+
+   IFCFG(0x000e);
+   _edi_config->search_results_max = 10000;
+   IFCFGEND;
+
+   IFCFG(0x000f);
+   _edi_config->symbol_index = EINA_TRUE;
+   IFCFGEND;
+
    _edi_config->version = EDI_CONFIG_FILE_VERSION;
 
    if (save) _edi_config_save();
@@ -551,6 +567,10 @@ _edi_project_config_load()
    _edi_project_config->gui.alpha = 255;
    IFPCFGEND;
 
+   IFPCFG(0x0006);
+   _edi_project_config->task_tags = eina_stringshare_add("TODO FIXME XXX HACK PERF");
+   IFPCFGEND;
+
    /* limit config values so they are sane */
    EDI_CONFIG_LIMIT(_edi_project_config->font.size, EDI_FONT_MIN, EDI_FONT_MAX);
    EDI_CONFIG_LIMIT(_edi_project_config->gui.width, 150, 10000);
@@ -42,6 +42,9 @@ struct _Edi_Config
    Eina_Bool autosave;
    Eina_Bool trim_whitespace;
    Eina_Bool show_hidden;
+   Eina_Bool search_index;
+   Eina_Bool symbol_index;
+   int search_results_max;
 
    Eina_List *projects;
    Eina_List *mime_assocs;
@@ -99,6 +102,7 @@ struct _Edi_Project_Config
    Eina_Stringshare *debug_command;
    Eina_Stringshare *user_fullname;
    Eina_Stringshare *user_email;
+   Eina_Stringshare *task_tags;
 
    Eina_List *panels;
    Eina_List *windows;
@@ -127,6 +131,7 @@ const char* _edi_config_mime_search(const char *mime);
 
 // Project based configuration handling
 
+const char *_edi_project_config_dir_get(void);
 void _edi_project_config_load(void);
 void _edi_project_config_save(void);
 
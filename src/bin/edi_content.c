@@ -8,8 +8,29 @@
 #include "mainview/edi_mainview.h"
 
 #include "edi_config.h"
+#include "edi_line_index.h"
+#include "edi_theme.h"
 #include "edi_private.h"
 
+// Longer lines are cut when shown in a large file.
+#define EDI_CONTENT_LARGE_LINE_MAX 4096
+
+struct _Edi_Content_Large
+{
+   Edi_Mainview_Item *item;
+   Edi_Line_Index *index;
+   Ecore_Event_Handler *config_handler;
+
+   Evas_Object *widget, *slider, *label;
+   Evas_Object *searchbar, *search, *search_entry;
+
+   unsigned int top, rows; /**< The first line shown, and how many fit */
+   unsigned int prefix; /**< The width of the line numbers shown before the lines */
+   unsigned int mark_line, mark_col, mark_length; /**< The line gone to, or the last match */
+   unsigned int pending; /**< A line gone to before it was found */
+   unsigned int find_length; /**< The length of the text being found */
+};
+
 static Eina_Bool
 _edi_content_diff_config_changed(void *data, int type EINA_UNUSED, void *event EINA_UNUSED)
 {
@@ -83,6 +104,456 @@ edi_content_image_add(Evas_Object *parent, Edi_Mainview_Item *item)
    return vbox;
 }
 
+static void
+_edi_content_large_fill(Edi_Content_Large *large)
+{
+   Elm_Code *code;
+   Elm_Code_Line *line;
+   const char *text;
+   char buf[EDI_CONTENT_LARGE_LINE_MAX + 16];
+   unsigned int lines, number, length, width, row = 0;
+
+   code = elm_code_widget_code_get(large->widget);
+   elm_code_file_clear(code->file);
+
+   lines = edi_line_index_lines_get(large->index);
+   for (width = 1, number = lines; number >= 10; number /= 10)
+     width++;
+   large->prefix = width + 1;
+
+   // Only the lines in view are ever copied out of the file.
+   for (number = large->top; number <= large->top + large->rows; number++)
+     {
+        text = edi_line_index_line_get(large->index, number, &length);
+        if (!text)
+          break;
+
+        if (length > EDI_CONTENT_LARGE_LINE_MAX)
+          {
+             length = EDI_CONTENT_LARGE_LINE_MAX;
+             while (length && (text[length] & 0xc0) == 0x80)
+               length--;
+          }
+
+        snprintf(buf, sizeof(buf), "%*u ", width, number);
+        memcpy(buf + large->prefix, text, length);
+        elm_code_file_line_append(code->file, buf, large->prefix + length, NULL);
+
+        line = elm_code_file_line_get(code->file, ++row);
+        elm_code_line_token_add(line, 0, width - 1, 1, ELM_CODE_TOKEN_TYPE_COMMENT);
+        if (number == large->mark_line && large->mark_length &&
+            large->mark_col + large->mark_length - 1 <= length)
+          elm_code_line_token_add(line, large->prefix + large->mark_col - 1,
+                                  large->prefix + large->mark_col + large->mark_length - 2,
+                                  1, ELM_CODE_TOKEN_TYPE_MATCH);
+        elm_code_widget_line_refresh(large->widget, line);
+     }
+}
+
+static void
+_edi_content_large_top_set(Edi_Content_Large *large, long top)
+{
+   long last;
+
+   last = (long) edi_line_index_lines_get(large->index) - large->rows + 1;
+   if (top > last)
+     top = last;
+   if (top < 1)
+     top = 1;
+
+   large->top = top;
+   elm_slider_value_set(large->slider, top);
+   _edi_content_large_fill(large);
+}
+
+static void
+_edi_content_large_mark(Edi_Content_Large *large, unsigned int number, unsigned int col,
+                        unsigned int length)
+{
+   Elm_Code *code;
+   Elm_Code_Line *line;
+   unsigned int row;
+
+   large->mark_line = number;
+   large->mark_col = col;
+   large->mark_length = length;
+
+   if (number < large->top || number >= large->top + large->rows)
+     _edi_content_large_top_set(large, (long) number - large->rows / 3);
+   else
+     _edi_content_large_fill(large);
+
+   code = elm_code_widget_code_get(large->widget);
+   row = number - large->top + 1;
+   line = elm_code_file_line_get(code->file, row);
+   if (line)
+     elm_code_widget_cursor_position_set(large->widget, row,
+        elm_code_widget_line_text_column_width_to_position(large->widget, line,
+                                                           large->prefix + col - 1));
+
+   edi_content_statusbar_position_set(large->item->pos, number, col);
+}
+
+static void
+_edi_content_large_label_update(Edi_Content_Large *large)
+{
+   char text[128];
+
+   if (edi_line_index_done_get(large->index))
+     snprintf(text, sizeof(text), _("Read only, %u lines"), edi_line_index_lines_get(large->index));
+   else
+     snprintf(text, sizeof(text), _("Read only, indexing %u lines"), edi_line_index_lines_get(large->index));
+
+   elm_object_text_set(large->label, text);
+}
+
+static void
+_edi_content_large_index_cb(void *data, Edi_Line_Index *index)
+{
+   Edi_Content_Large *large = data;
+   Elm_Code *code;
+   unsigned int lines;
+
+   lines = edi_line_index_lines_get(index);
+   elm_slider_min_max_set(large->slider, 1, lines > 1 ? lines : 2);
+   _edi_content_large_label_update(large);
+
+   if (large->pending && (large->pending <= lines || edi_line_index_done_get(index)))
+     {
+        edi_content_large_goto(large, large->pending);
+        return;
+     }
+
+   code = elm_code_widget_code_get(large->widget);
+   if (elm_code_file_lines_get(code->file) <= large->rows)
+     _edi_content_large_fill(large);
+}
+
+static void
+_edi_content_large_slider_changed_cb(void *data, Evas_Object *obj, void *event_info EINA_UNUSED)
+{
+   Edi_Content_Large *large = data;
+
+   _edi_content_large_top_set(large, (long) (elm_slider_value_get(obj) + 0.5));
+}
+
+static void
+_edi_content_large_resize_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED,
+                             void *event_info EINA_UNUSED)
+{
+   Edi_Content_Large *large = data;
+   unsigned int rows;
+
+   rows = elm_code_widget_lines_visible_get(large->widget);
+   if (rows < 1)
+     rows = 1;
+   if (rows == large->rows)
+     return;
+
+   large->rows = rows;
+   _edi_content_large_top_set(large, large->top);
+}
+
+static void
+_edi_content_large_wheel_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED,
+                            void *event_info)
+{
+   Edi_Content_Large *large = data;
+   Evas_Event_Mouse_Wheel *ev = event_info;
+
+   if (ev->direction)
+     return;
+
+   _edi_content_large_top_set(large, (long) large->top + ev->z * 3);
+}
+
+static void
+_edi_content_large_key_down_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED,
+                               void *event_info)
+{
+   Edi_Content_Large *large = data;
+   Evas_Event_Key_Down *ev = event_info;
+   Eina_Bool ctrl;
+
+   ctrl = evas_key_modifier_is_set(ev->modifiers, "Control");
+
+   if (ctrl && !strcmp(ev->key, "f"))
+     edi_content_large_search(large);
+   else if (ctrl && !strcmp(ev->key, "g"))
+     edi_mainview_goto_popup_show();
+   else if (ctrl && !strcmp(ev->key, "Home"))
+     _edi_content_large_top_set(large, 1);
+   else if (ctrl && !strcmp(ev->key, "End"))
+     _edi_content_large_top_set(large, edi_line_index_lines_get(large->index));
+   else if (!strcmp(ev->key, "Prior"))
+     _edi_content_large_top_set(large, (long) large->top - large->rows);
+   else if (!strcmp(ev->key, "Next"))
+     _edi_content_large_top_set(large, (long) large->top + large->rows);
+}
+
+static void
+_edi_content_large_cursor_cb(void *data, Evas_Object *obj, void *event_info EINA_UNUSED)
+{
+   Edi_Content_Large *large = data;
+   Elm_Code *code;
+   Elm_Code_Line *line;
+   unsigned int row, col, pos;
+
+   elm_code_widget_cursor_position_get(obj, &row, &col);
+   code = elm_code_widget_code_get(obj);
+   line = elm_code_file_line_get(code->file, row);
+   if (!line)
+     return;
+
+   pos = elm_code_widget_line_text_position_for_column_get(obj, line, col);
+   edi_content_statusbar_position_set(large->item->pos, large->top + row - 1,
+                                      pos >= large->prefix ? pos - large->prefix + 1 : 1);
+}
+
+static void
+_edi_content_large_found_cb(void *data, Edi_Line_Index *index EINA_UNUSED, Eina_Bool found,
+                            unsigned int line, unsigned int col)
+{
+   Edi_Content_Large *large = data;
+
+   if (found)
+     _edi_content_large_mark(large, line, col, large->find_length);
+   else
+     elm_object_text_set(large->label, _("No match found"));
+}
+
+static void
+_edi_content_large_find(Edi_Content_Large *large)
+{
+   char *text;
+   unsigned int line, col;
+
+   text = elm_entry_markup_to_utf8(elm_object_text_get(large->search_entry));
+   if (!text || !*text)
+     {
+        free(text);
+        return;
+     }
+
+   // The file is looked through on a thread, a find still running is let finish.
+   line = large->mark_line ? large->mark_line : large->top;
+   col = large->mark_line ? large->mark_col + 1 : 1;
+   if (edi_line_index_find_async(large->index, text, line, col, _edi_content_large_found_cb, large))
+     large->find_length = strlen(text);
+
+   free(text);
+}
+
+static void
+_edi_content_large_search_hide(Edi_Content_Large *large)
+{
+   elm_box_unpack(large->searchbar, large->search);
+   evas_object_hide(large->search);
+   elm_object_focus_set(large->widget, EINA_TRUE);
+}
+
+static void
+_edi_content_large_search_clicked_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+   _edi_content_large_find(data);
+}
+
+static void
+_edi_content_large_search_key_up_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED,
+                                    void *event_info)
+{
+   Evas_Event_Key_Up *ev = event_info;
+
+   if (!strcmp(ev->key, "KP_Enter") || !strcmp(ev->key, "Return"))
+     _edi_content_large_find(data);
+   else if (!strcmp(ev->key, "Escape"))
+     _edi_content_large_search_hide(data);
+}
+
+static void
+_edi_content_large_search_add(Edi_Content_Large *large)
+{
+   Evas_Object *box, *lbl, *entry, *btn;
+
+   large->search = box = elm_box_add(large->searchbar);
+   elm_box_horizontal_set(box, EINA_TRUE);
+   elm_box_padding_set(box, 5, 0);
+   evas_object_size_hint_align_set(box, EVAS_HINT_FILL, EVAS_HINT_FILL);
+   evas_object_size_hint_weight_set(box, EVAS_HINT_EXPAND, 0.0);
+
+   lbl = elm_label_add(box);
+   elm_object_text_set(lbl, _("Search term"));
+   evas_object_show(lbl);
+   elm_box_pack_end(box, lbl);
+
+   large->search_entry = entry = elm_entry_add(box);
+   elm_entry_scrollable_set(entry, EINA_TRUE);
+   elm_entry_single_line_set(entry, EINA_TRUE);
+   evas_object_size_hint_align_set(entry, EVAS_HINT_FILL, 0.5);
+   evas_object_size_hint_weight_set(entry, EVAS_HINT_EXPAND, 0.0);
+   evas_object_event_callback_add(entry, EVAS_CALLBACK_KEY_UP, _edi_content_large_search_key_up_cb, large);
+   evas_object_show(entry);
+   elm_box_pack_end(box, entry);
+
+   btn = elm_button_add(box);
+   elm_object_text_set(btn, _("Search"));
+   evas_object_smart_callback_add(btn, "clicked", _edi_content_large_search_clicked_cb, large);
+   evas_object_show(btn);
+   elm_box_pack_end(box, btn);
+}
+
+static Eina_Bool
+_edi_content_large_config_changed(void *data, int type EINA_UNUSED, void *event EINA_UNUSED)
+{
+   Edi_Content_Large *large = data;
+
+   elm_code_widget_font_set(large->widget, _edi_project_config->font.name, _edi_project_config->font.size);
+   edi_theme_elm_code_alpha_set(large->widget);
+   edi_theme_elm_code_set(large->widget, _edi_project_config->gui.theme);
+   elm_code_widget_tabstop_set(large->widget, _edi_project_config->gui.tabstop);
+
+   return ECORE_CALLBACK_RENEW;
+}
+
+static void
+_edi_content_large_del_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED,
+                          void *event_info EINA_UNUSED)
+{
+   Edi_Content_Large *large = data;
+
+   ecore_event_handler_del(large->config_handler);
+   edi_line_index_free(large->index);
+   free(large);
+}
+
+void
+edi_content_large_goto(Edi_Content_Large *large, unsigned int line)
+{
+   unsigned int lines;
+
+   if (!line)
+     return;
+
+   lines = edi_line_index_lines_get(large->index);
+   if (line > lines)
+     {
+        // Go there once the index gets that far.
+        if (!edi_line_index_done_get(large->index))
+          {
+             large->pending = line;
+             return;
+          }
+        line = lines;
+     }
+
+   large->pending = 0;
+   _edi_content_large_mark(large, line, 1, 0);
+   elm_object_focus_set(large->widget, EINA_TRUE);
+}
+
+void
+edi_content_large_search(Edi_Content_Large *large)
+{
+   if (!evas_object_visible_get(large->search))
+     {
+        evas_object_show(large->search);
+        elm_box_pack_end(large->searchbar, large->search);
+     }
+
+   elm_object_focus_set(large->search_entry, EINA_TRUE);
+}
+
+Evas_Object *
+edi_content_large_add(Evas_Object *parent, Edi_Mainview_Item *item)
+{
+   Edi_Content_Large *large;
+   Edi_Line_Index *index;
+   Evas_Object *vbox, *box, *statusbar, *widget, *slider, *label;
+   Evas *e;
+   Elm_Code *code;
+
+   large = calloc(1, sizeof(Edi_Content_Large));
+   index = edi_line_index_new(item->path, _edi_content_large_index_cb, large);
+   if (!index)
+     {
+        ERR("Could not map %s", item->path);
+        free(large);
+        return NULL;
+     }
+   large->item = item;
+   large->index = index;
+   large->top = large->rows = 1;
+
+   vbox = elm_box_add(parent);
+   evas_object_size_hint_weight_set(vbox, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
+   evas_object_size_hint_align_set(vbox, EVAS_HINT_FILL, EVAS_HINT_FILL);
+   evas_object_show(vbox);
+
+   large->searchbar = elm_box_add(vbox);
+   evas_object_size_hint_weight_set(large->searchbar, EVAS_HINT_EXPAND, 0.0);
+   evas_object_size_hint_align_set(large->searchbar, EVAS_HINT_FILL, 0.0);
+   elm_box_pack_end(vbox, large->searchbar);
+   evas_object_show(large->searchbar);
+   _edi_content_large_search_add(large);
+
+   box = elm_box_add(vbox);
+   elm_box_horizontal_set(box, EINA_TRUE);
+   evas_object_size_hint_weight_set(box, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
+   evas_object_size_hint_align_set(box, EVAS_HINT_FILL, EVAS_HINT_FILL);
+   elm_box_pack_end(vbox, box);
+   evas_object_show(box);
+
+   statusbar = elm_box_add(vbox);
+   evas_object_size_hint_weight_set(statusbar, EVAS_HINT_EXPAND, 0.0);
+   evas_object_size_hint_align_set(statusbar, EVAS_HINT_FILL, 0.0);
+   elm_box_pack_end(vbox, statusbar);
+   evas_object_show(statusbar);
+
+   // The widget only ever holds the lines in view, the slider scrolls the file.
+   code = elm_code_create();
+   large->widget = widget = elm_code_widget_add(box, code);
+   elm_code_widget_editable_set(widget, EINA_FALSE);
+   elm_code_widget_line_numbers_set(widget, EINA_FALSE);
+   _edi_content_large_config_changed(large, 0, NULL);
+   evas_object_size_hint_weight_set(widget, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
+   evas_object_size_hint_align_set(widget, EVAS_HINT_FILL, EVAS_HINT_FILL);
+   evas_object_event_callback_add(widget, EVAS_CALLBACK_RESIZE, _edi_content_large_resize_cb, large);
+   evas_object_event_callback_add(widget, EVAS_CALLBACK_MOUSE_WHEEL, _edi_content_large_wheel_cb, large);
+   evas_object_event_callback_add(widget, EVAS_CALLBACK_KEY_DOWN, _edi_content_large_key_down_cb, large);
+   evas_object_smart_callback_add(widget, "cursor,changed", _edi_content_large_cursor_cb, large);
+   evas_object_show(widget);
+   elm_box_pack_end(box, widget);
+
+   large->slider = slider = elm_slider_add(box);
+   elm_slider_horizontal_set(slider, EINA_FALSE);
+   elm_slider_inverted_set(slider, EINA_TRUE);
+   elm_slider_indicator_show_set(slider, EINA_FALSE);
+   elm_slider_min_max_set(slider, 1, 2);
+   elm_slider_value_set(slider, 1);
+   evas_object_size_hint_weight_set(slider, 0.0, EVAS_HINT_EXPAND);
+   evas_object_size_hint_align_set(slider, 0.5, EVAS_HINT_FILL);
+   evas_object_smart_callback_add(slider, "changed", _edi_content_large_slider_changed_cb, large);
+   evas_object_show(slider);
+   elm_box_pack_end(box, slider);
+
+   edi_content_statusbar_add(statusbar, item);
+   large->label = label = elm_label_add(statusbar);
+   evas_object_show(label);
+   elm_box_pack_end(statusbar, label);
+   _edi_content_large_label_update(large);
+
+   e = evas_object_evas_get(widget);
+   (void)!evas_object_key_grab(widget, "f", evas_key_modifier_mask_get(e, "Control"), 0, 1);
+   (void)!evas_object_key_grab(widget, "g", evas_key_modifier_mask_get(e, "Control"), 0, 1);
+
+   evas_object_data_set(item->view, "large", large);
+   large->config_handler = ecore_event_handler_add(EDI_EVENT_CONFIG_CHANGED,
+                                                   _edi_content_large_config_changed, large);
+   evas_object_event_callback_add(item->view, EVAS_CALLBACK_DEL, _edi_content_large_del_cb, large);
+
+   return vbox;
+}
+
 void
 edi_content_statusbar_position_set(Evas_Object *position, unsigned int line, unsigned int pos)
 {
@@ -13,6 +13,12 @@ extern "C" {
  * @brief These routines are used for managing various content.
  */
 
+/**
+ * @typedef Edi_Content_Large
+ * A read-only view of a text file too large to be loaded whole.
+ */
+typedef struct _Edi_Content_Large Edi_Content_Large;
+
 /**
  * @brief Managing the creation of alternative content within EDI.
  * @defgroup Content
@@ -47,6 +53,38 @@ Evas_Object *edi_content_image_add(Evas_Object *parent, Edi_Mainview_Item *item)
  */
 Evas_Object *edi_content_diff_add(Evas_Object *parent, Edi_Mainview_Item *item);
 
+/**
+ * Create an object for viewing a large text file.
+ * The file is mapped rather than loaded, and only the lines in view are read.
+ *
+ * @param parent the panel into which the viewer will be loaded.
+ * @param item the item describing the file to be viewed.
+ *
+ * @return an Evas_Object containing the viewer.
+ *
+ * @ingroup Content
+ */
+Evas_Object *edi_content_large_add(Evas_Object *parent, Edi_Mainview_Item *item);
+
+/**
+ * Show a line of a large file, once it has been found if the file is still being indexed.
+ *
+ * @param large the viewer of the file.
+ * @param line the line number to show.
+ *
+ * @ingroup Content
+ */
+void edi_content_large_goto(Edi_Content_Large *large, unsigned int line);
+
+/**
+ * Show the search bar of a large file.
+ *
+ * @param large the viewer of the file.
+ *
+ * @ingroup Content
+ */
+void edi_content_large_search(Edi_Content_Large *large);
+
 /**
  * Add a statusbar to the panel for displaying statistics about loaded content.
  *
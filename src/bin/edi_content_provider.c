@@ -12,12 +12,16 @@
 
 #include "edi_private.h"
 
+// Text files larger than this are shown from an index of their lines rather than loaded.
+#define EDI_CONTENT_PROVIDER_LARGE_SIZE (32 * 1024 * 1024)
+
 static Edi_Content_Provider _edi_content_provider_registry[] =
 {
    {"text", "text-x-generic", EINA_TRUE, EINA_TRUE, edi_editor_add},
    {"code", "text-x-csrc", EINA_TRUE, EINA_TRUE, edi_editor_add},
    {"image", "image-x-generic", EINA_FALSE, EINA_FALSE, edi_content_image_add},
    {"diff", "text-x-source", EINA_TRUE, EINA_FALSE, edi_content_diff_add},
+   {"large", "text-x-generic", EINA_TRUE, EINA_FALSE, edi_content_large_add},
 
    {NULL, NULL, EINA_FALSE, EINA_FALSE, NULL}
 };
@@ -55,6 +59,17 @@ Edi_Content_Provider *edi_content_provider_for_mime_get(const char *mime)
    return edi_content_provider_for_id_get(id);
 }
 
+Edi_Content_Provider *edi_content_provider_for_file_get(const char *mime, unsigned long long size)
+{
+   Edi_Content_Provider *provider;
+
+   provider = edi_content_provider_for_mime_get(mime);
+   if (!provider || !provider->is_text || size <= EDI_CONTENT_PROVIDER_LARGE_SIZE)
+     return provider;
+
+   return edi_content_provider_for_id_get("large");
+}
+
 Edi_Content_Provider *edi_content_provider_for_id_get(const char *id)
 {
    Edi_Content_Provider *provider;
@@ -46,6 +46,19 @@ typedef struct _Edi_Content_Provider
  */
 Edi_Content_Provider *edi_content_provider_for_mime_get(const char *mime);
 
+/**
+ * Look up a content provider for a file, based on its mime type and size.
+ * Text files too large to be loaded whole are given a read-only viewer.
+ *
+ * @param mime the mime type of the file
+ * @param size the size of the file in bytes
+ *
+ * @return an Edi_Content_Provider if one is registered or NULL otherwise
+ *
+ * @ingroup Lookup
+ */
+Edi_Content_Provider *edi_content_provider_for_file_get(const char *mime, unsigned long long size);
+
 /**
  * Look up a content provider based on a provider id.
  * This is useful for overriding mime-type based lookup.
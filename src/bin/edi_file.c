@@ -1,127 +1,337 @@
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
 #include "Edi.h"
 #include "edi_file.h"
+#include "edi_ignore.h"
+#include "edi_search.h"
 #include "edi_config.h"
 #include "edi_private.h"
 
 Eina_Bool
 edi_file_path_hidden(const char *path)
 {
-   Edi_Build_Provider *provider;
+   return edi_ignore_path_ignored(path, EINA_FILE_UNKNOWN);
+}
+
+// The most segments handed to the kernel by a single write.
+#define EDI_FILE_REPLACE_IOV_MAX 512
+
+struct _Edi_File_Replace
+{
+   char *directory;
+   char *search, *replace;
+   size_t search_length, replace_length;
+   Eina_Bool dry_run;
+   Eina_Hash *skip;
+
+   Ecore_Thread *thread;
+   int refs;
+   Eina_Bool cancelled;
+
+   Edi_File_Replace_Cb file_cb;
+   Edi_File_Replace_Done_Cb done_cb;
+   void *data;
+};
+
+typedef struct
+{
+   Edi_File_Replace *replace;
+   char *path;
+   unsigned int line, count;
+} Edi_File_Replace_Result;
 
-   provider = edi_build_provider_for_project_get();
-   if (provider && provider->file_hidden_is(path))
-     return EINA_TRUE;
+static Eina_Bool
+_edi_file_writev(int fd, struct iovec *iov, int count)
+{
+   ssize_t written;
+
+   while (count)
+     {
+        written = writev(fd, iov, count);
+        if (written < 0)
+          {
+             if (errno == EINTR) continue;
+             return EINA_FALSE;
+          }
 
-   if (ecore_file_file_get(path)[0] == '.')
-     return EINA_TRUE;
+        // Skip what was written, the last segment may only be written in part.
+        while (count && (size_t) written >= iov->iov_len)
+          {
+             written -= iov->iov_len;
+             iov++;
+             count--;
+          }
+        if (count)
+          {
+             iov->iov_base = (char *) iov->iov_base + written;
+             iov->iov_len -= written;
+          }
+     }
 
-   return EINA_FALSE;
+   return EINA_TRUE;
 }
 
-void
-edi_file_text_replace(const char *path, const char *search, const char *replace)
+/*
+ * Write the file with every match replaced next to the original, then move
+ * it over the original so the file is never seen half written. The parts of
+ * the mapped file that do not change are written straight from the map.
+ */
+static Eina_Bool
+_edi_file_text_replace_write(const char *path, const char *map, size_t length,
+                             const char *found, const Edi_File_Replace *replace)
 {
-   char *map, *found;
-   FILE *tempfile;
-   Eina_File *f;
-   char *tempfiledir, *tempfilepath;
-   unsigned long long len, idx;
-   unsigned int slen;
+   struct iovec iov[EDI_FILE_REPLACE_IOV_MAX];
+   struct stat st;
+   const char *start = map, *end = map + length;
+   char *target, *tempfilepath;
+   Eina_Bool ok = EINA_TRUE;
+   int fd, count = 0;
 
-   tempfiledir = edi_path_append(_edi_config_dir_get(), ".tmp");
+   // Replace what a link points to, not the link.
+   target = realpath(path, NULL);
+   if (!target || stat(target, &st))
+     {
+        free(target);
+        return EINA_FALSE;
+     }
 
-   ecore_file_mkdir(tempfiledir);
+   tempfilepath = malloc(strlen(target) + 16);
+   sprintf(tempfilepath, "%s.edi-XXXXXX", target);
+   fd = mkstemp(tempfilepath);
+   if (fd < 0)
+     {
+        free(tempfilepath);
+        free(target);
+        return EINA_FALSE;
+     }
 
-   f = eina_file_open(path, EINA_FALSE);
-   if (!f) return;
+   for (; found; found = edi_search_find(start, end - start, replace->search, replace->search_length))
+     {
+        iov[count].iov_base = (void *) start;
+        iov[count++].iov_len = found - start;
+        iov[count].iov_base = replace->replace;
+        iov[count++].iov_len = replace->replace_length;
+        start = found + replace->search_length;
 
-   map = eina_file_map_all(f, EINA_FILE_POPULATE);
-   if (!map)
+        if (count == EDI_FILE_REPLACE_IOV_MAX)
+          {
+             ok = _edi_file_writev(fd, iov, count);
+             count = 0;
+             if (!ok) break;
+          }
+     }
+
+   if (ok)
      {
-        eina_file_close(f);
-        return;
+        iov[count].iov_base = (void *) start;
+        iov[count++].iov_len = end - start;
+        ok = _edi_file_writev(fd, iov, count);
      }
 
-   len = eina_file_size_get(f);
-   if (!len)
+   if (ok)
+     ok = !fchmod(fd, st.st_mode & 07777);
+   if (close(fd))
+     ok = EINA_FALSE;
+   if (ok)
+     ok = !rename(tempfilepath, target);
+   if (!ok)
+     unlink(tempfilepath);
+
+   free(tempfilepath);
+   free(target);
+
+   return ok;
+}
+
+// Replace, or only count, the matches in a file. Returns -1 if the file could not be written.
+static int
+_edi_file_text_replace(const char *path, const Edi_File_Replace *replace, unsigned int *line)
+{
+   const char elf_header[4] = {0x7f, 'E', 'L', 'F'};
+   const char *map, *found, *end, *lf;
+   Eina_File *f;
+   size_t length;
+   int count = 0;
+
+   f = eina_file_open(path, EINA_FALSE);
+   if (!f) return 0;
+
+   length = eina_file_size_get(f);
+   map = length ? eina_file_map_all(f, EINA_FILE_SEQUENTIAL) : NULL;
+   if (!map)
      {
         eina_file_close(f);
-        return;
+        return 0;
      }
 
-   tempfilepath = edi_path_append(tempfiledir, ecore_file_file_get(path));
+   end = map + length;
+   found = edi_search_find(map, length, replace->search, replace->search_length);
 
-   tempfile = fopen(tempfilepath, "wb");
-   if (!tempfile) goto done;
+   // Never rewrite binaries, big files must also look like text.
+   if (!found || (length >= 4 && !memcmp(map, elf_header, sizeof(elf_header))) ||
+       (length > 1 * 1024 * 1024 && strncmp(edi_mime_type_get(path), "text/", 5)))
+     goto done;
 
-   idx = 0;
+   *line = 1;
+   for (lf = map; (lf = memchr(lf, '\n', found - lf)); lf++)
+     (*line)++;
 
-   found = strstr(&map[idx], search);
-   if (!found)
+   if (!replace->dry_run &&
+       !_edi_file_text_replace_write(path, map, length, found, replace))
      {
-        fclose(tempfile);
-        unlink(tempfilepath);
+        count = -1;
         goto done;
      }
 
-   slen = strlen(search);
-
-   while (idx < len)
+   for (; found; found = edi_search_find(found, end - found, replace->search, replace->search_length))
      {
-         if (!found || &map[idx] < found)
-           {
-              fprintf(tempfile, "%c", map[idx]);
-              idx++;
-           }
-         else
-           {
-              fprintf(tempfile, "%s", replace);
-              idx += slen;
-              found = strstr(&map[idx], search);
-           }
+        count++;
+        found += replace->search_length;
      }
 
-   fclose(tempfile);
-   ecore_file_mv(tempfilepath, path);
-   free(tempfilepath);
 done:
-   eina_file_map_free(f, map);
+   eina_file_map_free(f, (void *) map);
    eina_file_close(f);
-   free(tempfiledir);
+
+   return count;
+}
+
+int
+edi_file_text_replace(const char *path, const char *search, const char *replace)
+{
+   Edi_File_Replace data;
+   unsigned int line;
+
+   if (!search || !search[0] || !replace) return 0;
+
+   memset(&data, 0, sizeof(Edi_File_Replace));
+   data.search = (char *) search;
+   data.search_length = strlen(search);
+   data.replace = (char *) replace;
+   data.replace_length = strlen(replace);
+
+   return _edi_file_text_replace(path, &data, &line);
+}
+
+static void
+_edi_file_text_replace_unref(Edi_File_Replace *replace)
+{
+   if (__atomic_sub_fetch(&replace->refs, 1, __ATOMIC_ACQ_REL))
+     return;
+
+   if (replace->done_cb)
+     replace->done_cb(replace->data, replace->cancelled);
+
+   if (replace->skip)
+     eina_hash_free(replace->skip);
+   free(replace->directory);
+   free(replace->search);
+   free(replace->replace);
+   free(replace);
+}
+
+static void
+_edi_file_text_replace_result_cb(void *data)
+{
+   Edi_File_Replace_Result *result = data;
+   Edi_File_Replace *replace = result->replace;
+
+   if (!replace->cancelled)
+     replace->file_cb(replace->data, result->path, result->line, result->count);
+
+   free(result->path);
+   free(result);
+   _edi_file_text_replace_unref(replace);
 }
 
 static void
-_edi_file_text_replace_all(const char *directory, const char *search, const char *replace)
+_edi_file_text_replace_file_cb(void *data, const char *path)
 {
-   char *path, *file;
-   Eina_List *files;
+   Edi_File_Replace *replace = data;
+   Edi_File_Replace_Result *result;
+   unsigned int line = 0;
+   int count;
+
+   if (__atomic_load_n(&replace->cancelled, __ATOMIC_RELAXED)) return;
+   if (replace->skip && eina_hash_find(replace->skip, path)) return;
 
-   files = ecore_file_ls(directory);
+   count = _edi_file_text_replace(path, replace, &line);
+   if (!count) return;
 
-   EINA_LIST_FREE(files, file)
+   if (count < 0)
      {
-        path = edi_path_append(directory, file);
-        if (!edi_file_path_hidden(path))
-          {
-             if (ecore_file_is_dir(path))
-               {
-                  _edi_file_text_replace_all(path, search, replace);
-               }
-             else
-               {
-                  edi_file_text_replace(path, search, replace);
-               }
-          }
-        free(path);
-        free(file);
+        ERR("Could not replace the text in %s", path);
+        return;
      }
 
-   if (files)
-     eina_list_free(files);
+   result = malloc(sizeof(Edi_File_Replace_Result));
+   result->replace = replace;
+   result->path = strdup(path);
+   result->line = line;
+   result->count = count;
+
+   __atomic_add_fetch(&replace->refs, 1, __ATOMIC_ACQ_REL);
+   ecore_main_loop_thread_safe_call_async(_edi_file_text_replace_result_cb, result);
+}
+
+static void
+_edi_file_text_replace_run_cb(void *data, Ecore_Thread *thread)
+{
+   Edi_File_Replace *replace = data;
+
+   edi_search_project_run(replace->directory, thread, _edi_file_text_replace_file_cb, replace);
+}
+
+static void
+_edi_file_text_replace_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_File_Replace *replace = data;
+
+   replace->thread = NULL;
+   _edi_file_text_replace_unref(replace);
+}
+
+Edi_File_Replace *
+edi_file_text_replace_all(const char *search, const char *replace, Eina_Bool dry_run,
+                          Eina_Hash *skip, Edi_File_Replace_Cb file_cb,
+                          Edi_File_Replace_Done_Cb done_cb, const void *data)
+{
+   Edi_File_Replace *job;
+
+   if (!search || !search[0] || !replace || !edi_project_get())
+     {
+        if (skip) eina_hash_free(skip);
+        return NULL;
+     }
+
+   job = calloc(1, sizeof(Edi_File_Replace));
+   job->directory = strdup(edi_project_get());
+   job->search = strdup(search);
+   job->search_length = strlen(search);
+   job->replace = strdup(replace);
+   job->replace_length = strlen(replace);
+   job->dry_run = dry_run;
+   job->skip = skip;
+   job->file_cb = file_cb;
+   job->done_cb = done_cb;
+   job->data = (void *) data;
+   job->refs = 1;
+
+   job->thread = ecore_thread_run(_edi_file_text_replace_run_cb, _edi_file_text_replace_end_cb,
+                                  _edi_file_text_replace_end_cb, job);
+
+   return job;
 }
 
 void
-edi_file_text_replace_all(const char *search, const char *replace)
+edi_file_text_replace_cancel(Edi_File_Replace *replace)
 {
-   _edi_file_text_replace_all(edi_project_get(), search, replace);
+   if (!replace) return;
+
+   __atomic_store_n(&replace->cancelled, EINA_TRUE, __ATOMIC_RELAXED);
+   if (replace->thread)
+     ecore_thread_cancel(replace->thread);
 }
@@ -12,6 +12,26 @@ extern "C" {
  * @brief These routines used for managing Edi file actions.
  */
 
+/**
+ * @typedef Edi_File_Replace
+ * A replace of text running over the whole project.
+ */
+typedef struct _Edi_File_Replace Edi_File_Replace;
+
+/**
+ * @typedef Edi_File_Replace_Cb
+ * A function called for each file with occurences to replace, with the
+ * line of the first occurence and how many there are.
+ */
+typedef void (*Edi_File_Replace_Cb)(void *data, const char *path, unsigned int line, unsigned int count);
+
+/**
+ * @typedef Edi_File_Replace_Done_Cb
+ * A function called once a replace went through the whole project, or
+ * stopped after it was cancelled.
+ */
+typedef void (*Edi_File_Replace_Done_Cb)(void *data, Eina_Bool cancelled);
+
 /**
  * @brief UI management functions.
  * @defgroup UI
@@ -32,25 +52,50 @@ extern "C" {
 Eina_Bool edi_file_path_hidden(const char *path);
 
 /**
- * Replace all occurences of text within whole project.
+ * Replace all occurences of text within given file. The file is rewritten
+ * next to the original and moved over it once complete.
  *
+ * @param path The path of the file to replace all occurences of the text.
  * @param search The text to be replaced.
  * @param replace The text that will replace.
  *
+ * @return The number of occurences replaced, or -1 if the file could not be written.
+ *
  * @ingroup Lookup
  */
-void edi_file_text_replace_all(const char *search, const char *replace);
+int edi_file_text_replace(const char *path, const char *search, const char *replace);
 
 /**
- * Replace all occurences of text within given file.
+ * Replace all occurences of text within whole project. The files are
+ * scanned and rewritten by a pool of threads, the callbacks are called
+ * on the main loop. Once the replace is cancelled only @p done_cb is.
  *
- * @param path The path of the file to replace all occurences of the text.
  * @param search The text to be replaced.
  * @param replace The text that will replace.
+ * @param dry_run Only count the occurences, without changing any file.
+ * @param skip A hash of the paths to leave alone, such as the files open
+ *             in an editor, may be NULL. It is freed with the replace.
+ * @param file_cb The function called for each file with an occurence.
+ * @param done_cb The function called last, may be NULL.
+ * @param data User data passed to the callbacks.
+ *
+ * @return The running replace, or NULL if there is nothing to replace.
+ *
+ * @ingroup Lookup
+ */
+Edi_File_Replace *edi_file_text_replace_all(const char *search, const char *replace, Eina_Bool dry_run,
+                                            Eina_Hash *skip, Edi_File_Replace_Cb file_cb,
+                                            Edi_File_Replace_Done_Cb done_cb, const void *data);
+
+/**
+ * Stop a replace started by edi_file_text_replace_all(). The files already
+ * rewritten are kept.
+ *
+ * @param replace The running replace.
  *
  * @ingroup Lookup
  */
-void edi_file_text_replace(const char *path, const char *search, const char *replace);
+void edi_file_text_replace_cancel(Edi_File_Replace *replace);
 
 /**
  * @}
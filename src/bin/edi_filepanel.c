@@ -14,6 +14,7 @@
 
 #include "edi_filepanel.h"
 #include "edi_file.h"
+#include "edi_ignore.h"
 #include "edi_theme.h"
 #include "edi_config.h"
 #include "edi_content_provider.h"
@@ -807,7 +808,8 @@ _ls_filter_cb(void *data EINA_UNUSED, Eio_File *handler EINA_UNUSED,
    if (_edi_config->show_hidden)
      return EINA_TRUE;
 
-   return info->path[info->name_start] != '.';
+   // Ignored directories are dropped here, on the listing thread.
+   return !edi_ignore_path_ignored(info->path, info->type);
 }
 
 static int
@@ -0,0 +1,620 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sys/stat.h>
+
+#include <Eina.h>
+#include <Ecore.h>
+#include <Ecore_File.h>
+
+#include "Edi.h"
+
+#include "edi_ignore.h"
+
+// How long the rules of a directory are trusted before its ignore files are checked again.
+#define EDI_IGNORE_CHECK_DELAY 2.0
+
+typedef struct
+{
+   char *pattern;
+   Eina_Bool negate : 1;
+   Eina_Bool dir_only : 1;
+   Eina_Bool anchored : 1;
+} Edi_Ignore_Rule;
+
+typedef struct
+{
+   Edi_Ignore_Rule *rules;
+   unsigned int count, size;
+} Edi_Ignore_Rules;
+
+typedef struct _Edi_Ignore_Dir Edi_Ignore_Dir;
+
+/*
+ * The rules found in one directory of the project and whether the directory
+ * itself is ignored. The decision is recalculated when the generation changes,
+ * which happens whenever the rules of any directory are reloaded.
+ */
+struct _Edi_Ignore_Dir
+{
+   Edi_Ignore_Dir *parent;
+   char *path;
+   size_t length;
+
+   Edi_Ignore_Rules rules;
+   struct {
+      long long mtime;
+      off_t size;
+   } stamps[3];
+   double checked;
+
+   unsigned int generation;
+   Eina_Bool ignored;
+};
+
+// Loaded in this order, so the rules of later files take precedence.
+static const char *_edi_ignore_files[] = {
+   ".git/info/exclude", ".gitignore", ".ignore"
+};
+
+static Eina_Lock _ignore_lock;
+static Eina_Hash *_ignore_dirs = NULL;
+static char *_ignore_root = NULL;
+static size_t _ignore_root_length = 0;
+static Edi_Ignore_Rules _ignore_builtin;
+static Edi_Build_Provider *_ignore_provider = NULL;
+static unsigned int _ignore_generation = 1;
+
+static Eina_Bool
+_edi_ignore_class(const char **pattern, char c, Eina_Bool *matched)
+{
+   const char *p = *pattern + 1;
+   unsigned char lo, hi;
+   Eina_Bool negate, first = EINA_TRUE, found = EINA_FALSE;
+
+   negate = (*p == '!' || *p == '^');
+   if (negate) p++;
+
+   while (*p && (first || *p != ']'))
+     {
+        if (*p == '\\' && p[1]) p++;
+        lo = hi = *p++;
+
+        if (*p == '-' && p[1] && p[1] != ']')
+          {
+             p++;
+             if (*p == '\\' && p[1]) p++;
+             hi = *p++;
+          }
+
+        if ((unsigned char) c >= lo && (unsigned char) c <= hi)
+          found = EINA_TRUE;
+        first = EINA_FALSE;
+     }
+
+   // An unterminated class is not a class at all.
+   if (!*p) return EINA_FALSE;
+
+   *pattern = p + 1;
+   *matched = (found != negate);
+   return EINA_TRUE;
+}
+
+/*
+ * Match a path against a gitignore style glob. "*", "?" and classes never
+ * match a "/", a "**" surrounded by slashes matches any number of directories
+ * and a trailing "**" matches everything inside a directory.
+ */
+static Eina_Bool
+_edi_ignore_glob(const char *p, const char *t)
+{
+   Eina_Bool matched;
+
+   while (*p)
+     {
+        switch (*p)
+          {
+           case '*':
+             if (p[1] == '*' && (p[2] == '/' || !p[2]))
+               {
+                  p += 2;
+                  if (!*p) return EINA_TRUE;
+
+                  p++;
+                  while (EINA_TRUE)
+                    {
+                       if (_edi_ignore_glob(p, t)) return EINA_TRUE;
+                       t = strchr(t, '/');
+                       if (!t) return EINA_FALSE;
+                       t++;
+                    }
+               }
+
+             while (*p == '*') p++;
+             while (EINA_TRUE)
+               {
+                  if (_edi_ignore_glob(p, t)) return EINA_TRUE;
+                  if (!*t || *t == '/') return EINA_FALSE;
+                  t++;
+               }
+           case '?':
+             if (!*t || *t == '/') return EINA_FALSE;
+             p++;
+             t++;
+             break;
+           case '[':
+             if (!*t || *t == '/') return EINA_FALSE;
+             if (_edi_ignore_class(&p, *t, &matched))
+               {
+                  if (!matched) return EINA_FALSE;
+                  t++;
+                  break;
+               }
+             if (*t != '[') return EINA_FALSE;
+             p++;
+             t++;
+             break;
+           case '\\':
+             if (p[1]) p++;
+             /* fall through */
+           default:
+             if (*p != *t) return EINA_FALSE;
+             p++;
+             t++;
+          }
+     }
+
+   return !*t;
+}
+
+static Eina_Bool
+_edi_ignore_rule_parse(Edi_Ignore_Rule *rule, const char *line, size_t length)
+{
+   // Trailing spaces are dropped unless they are escaped.
+   while (length && (line[length - 1] == '\r' ||
+          (line[length - 1] == ' ' && !(length > 1 && line[length - 2] == '\\'))))
+     length--;
+
+   if (!length || line[0] == '#')
+     return EINA_FALSE;
+
+   memset(rule, 0, sizeof(Edi_Ignore_Rule));
+   if (line[0] == '!')
+     {
+        rule->negate = EINA_TRUE;
+        line++;
+        length--;
+     }
+   else if (line[0] == '\\' && length > 1 && (line[1] == '!' || line[1] == '#'))
+     {
+        line++;
+        length--;
+     }
+
+   if (length && line[length - 1] == '/')
+     {
+        rule->dir_only = EINA_TRUE;
+        length--;
+     }
+
+   // A pattern with a slash is relative to the directory of its ignore file.
+   rule->anchored = !!memchr(line, '/', length);
+   if (length && line[0] == '/')
+     {
+        line++;
+        length--;
+     }
+
+   if (!length)
+     return EINA_FALSE;
+
+   rule->pattern = strndup(line, length);
+   return EINA_TRUE;
+}
+
+static void
+_edi_ignore_rules_add(Edi_Ignore_Rules *rules, const char *line, size_t length)
+{
+   Edi_Ignore_Rule rule;
+
+   if (!_edi_ignore_rule_parse(&rule, line, length))
+     return;
+
+   if (rules->count == rules->size)
+     {
+        rules->size = rules->size ? rules->size * 2 : 8;
+        rules->rules = realloc(rules->rules, rules->size * sizeof(Edi_Ignore_Rule));
+     }
+   rules->rules[rules->count++] = rule;
+}
+
+static void
+_edi_ignore_rules_clear(Edi_Ignore_Rules *rules)
+{
+   unsigned int i;
+
+   for (i = 0; i < rules->count; i++)
+     free(rules->rules[i].pattern);
+   free(rules->rules);
+   memset(rules, 0, sizeof(Edi_Ignore_Rules));
+}
+
+static void
+_edi_ignore_rules_load(Edi_Ignore_Rules *rules, const char *path)
+{
+   Eina_File *f;
+   const char *map, *line, *end, *eol;
+
+   f = eina_file_open(path, EINA_FALSE);
+   if (!f) return;
+
+   map = eina_file_map_all(f, EINA_FILE_SEQUENTIAL);
+   if (map)
+     {
+        end = map + eina_file_size_get(f);
+        for (line = map; line < end; line = eol + 1)
+          {
+             eol = memchr(line, '\n', end - line);
+             if (!eol) eol = end;
+
+             _edi_ignore_rules_add(rules, line, eol - line);
+          }
+        eina_file_map_free(f, (void *) map);
+     }
+   eina_file_close(f);
+}
+
+/*
+ * Check a path against a set of rules, the last rule that matches decides.
+ * Returns 1 if the path is ignored, 0 if it is included again and -1 if no
+ * rule matched.
+ */
+static int
+_edi_ignore_rules_match(const Edi_Ignore_Rules *rules, const char *relative,
+                        const char *name, Eina_Bool is_dir)
+{
+   const Edi_Ignore_Rule *rule;
+   unsigned int i;
+
+   for (i = rules->count; i > 0; i--)
+     {
+        rule = &rules->rules[i - 1];
+        if (rule->dir_only && !is_dir)
+          continue;
+
+        if (_edi_ignore_glob(rule->pattern, rule->anchored ? relative : name))
+          return rule->negate ? 0 : 1;
+     }
+
+   return -1;
+}
+
+// The rules of deeper directories take precedence, the built in rules come last.
+static Eina_Bool
+_edi_ignore_match(const Edi_Ignore_Dir *dir, const char *path, Eina_Bool is_dir)
+{
+   const Edi_Ignore_Dir *d;
+   const char *name;
+   int result;
+
+   name = strrchr(path, '/');
+   name = name ? name + 1 : path;
+
+   for (d = dir; d; d = d->parent)
+     {
+        result = _edi_ignore_rules_match(&d->rules, path + d->length + 1, name, is_dir);
+        if (result >= 0)
+          return result;
+     }
+
+   if (!dir)
+     return _edi_ignore_rules_match(&_ignore_builtin, name, name, is_dir) > 0;
+
+   return _edi_ignore_rules_match(&_ignore_builtin, path + _ignore_root_length + 1,
+                                  name, is_dir) > 0;
+}
+
+static void
+_edi_ignore_dir_free(void *data)
+{
+   Edi_Ignore_Dir *dir = data;
+
+   _edi_ignore_rules_clear(&dir->rules);
+   free(dir->path);
+   free(dir);
+}
+
+static void
+_edi_ignore_dir_load(Edi_Ignore_Dir *dir, double now)
+{
+   struct stat st;
+   char path[PATH_MAX];
+   long long mtime;
+   unsigned int i;
+   Eina_Bool changed = EINA_FALSE;
+
+   dir->checked = now;
+   for (i = 0; i < EINA_C_ARRAY_LENGTH(_edi_ignore_files); i++)
+     {
+        // Only the project root has a repository to read excludes from.
+        if (i == 0 && dir->parent)
+          continue;
+
+        snprintf(path, sizeof(path), "%s/%s", dir->path, _edi_ignore_files[i]);
+        if (stat(path, &st))
+          memset(&st, 0, sizeof(st));
+
+        mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        if (dir->stamps[i].mtime != mtime || dir->stamps[i].size != st.st_size)
+          changed = EINA_TRUE;
+        dir->stamps[i].mtime = mtime;
+        dir->stamps[i].size = st.st_size;
+     }
+
+   if (!changed)
+     return;
+
+   _edi_ignore_rules_clear(&dir->rules);
+   for (i = 0; i < EINA_C_ARRAY_LENGTH(_edi_ignore_files); i++)
+     {
+        if (!dir->stamps[i].mtime)
+          continue;
+
+        snprintf(path, sizeof(path), "%s/%s", dir->path, _edi_ignore_files[i]);
+        _edi_ignore_rules_load(&dir->rules, path);
+     }
+
+   _ignore_generation++;
+}
+
+/*
+ * Build output that patterns cannot describe, such as meson build directories
+ * which are found by their build.ninja. Only asked about directories.
+ */
+static Eina_Bool
+_edi_ignore_provider_hidden(const char *path)
+{
+   if (!_ignore_provider || !_ignore_provider->file_hidden_is)
+     return EINA_FALSE;
+
+   return _ignore_provider->file_hidden_is(path);
+}
+
+// Refresh the rules of a directory and its parents, then its own decision.
+static void
+_edi_ignore_dir_update(Edi_Ignore_Dir *dir, double now)
+{
+   if (dir->parent)
+     _edi_ignore_dir_update(dir->parent, now);
+
+   if (now - dir->checked > EDI_IGNORE_CHECK_DELAY)
+     _edi_ignore_dir_load(dir, now);
+
+   if (dir->generation == _ignore_generation)
+     return;
+
+   dir->generation = _ignore_generation;
+   dir->ignored = dir->parent &&
+      (dir->parent->ignored || _edi_ignore_match(dir->parent, dir->path, EINA_TRUE) ||
+       _edi_ignore_provider_hidden(dir->path));
+}
+
+static Edi_Ignore_Dir *
+_edi_ignore_dir_get(const char *path, size_t length)
+{
+   Edi_Ignore_Dir *dir;
+   char key[PATH_MAX];
+   const char *slash;
+
+   if (length < _ignore_root_length || length >= sizeof(key))
+     return NULL;
+
+   memcpy(key, path, length);
+   key[length] = '\0';
+
+   dir = eina_hash_find(_ignore_dirs, key);
+   if (dir) return dir;
+
+   if (length > _ignore_root_length)
+     {
+        slash = strrchr(key, '/');
+
+        dir = calloc(1, sizeof(Edi_Ignore_Dir));
+        dir->parent = _edi_ignore_dir_get(key, slash - key);
+        if (!dir->parent)
+          {
+             free(dir);
+             return NULL;
+          }
+     }
+   else
+     dir = calloc(1, sizeof(Edi_Ignore_Dir));
+
+   dir->path = strdup(key);
+   dir->length = length;
+   dir->checked = -EDI_IGNORE_CHECK_DELAY;
+   eina_hash_add(_ignore_dirs, key, dir);
+
+   return dir;
+}
+
+static void
+_edi_ignore_builtin_load(void)
+{
+   const char * const *pattern;
+
+   _edi_ignore_rules_clear(&_ignore_builtin);
+   _edi_ignore_rules_add(&_ignore_builtin, ".*", 2);
+
+   _ignore_provider = edi_build_provider_for_project_get();
+   if (!_ignore_provider || !_ignore_provider->ignore_patterns)
+     return;
+
+   for (pattern = _ignore_provider->ignore_patterns; *pattern; pattern++)
+     _edi_ignore_rules_add(&_ignore_builtin, *pattern, strlen(*pattern));
+}
+
+// Start again if the project has changed since the rules were cached.
+static void
+_edi_ignore_root_check(void)
+{
+   const char *root = edi_project_get();
+
+   if (!root)
+     {
+        if (!_ignore_root) return;
+     }
+   else if (_ignore_root && !strcmp(root, _ignore_root))
+     return;
+
+   eina_hash_free_buckets(_ignore_dirs);
+   free(_ignore_root);
+   _ignore_root = root ? strdup(root) : NULL;
+   _ignore_root_length = root ? strlen(root) : 0;
+   _ignore_generation++;
+
+   _edi_ignore_builtin_load();
+}
+
+static Eina_Bool
+_edi_ignore_path_ignored(const char *path, Eina_Bool is_dir)
+{
+   Edi_Ignore_Dir *dir = NULL;
+   const char *slash;
+   Eina_Bool ignored;
+
+   eina_lock_take(&_ignore_lock);
+   _edi_ignore_root_check();
+
+   if (_ignore_root && !strncmp(path, _ignore_root, _ignore_root_length))
+     {
+        // The project itself is never ignored.
+        if (!path[_ignore_root_length])
+          {
+             eina_lock_release(&_ignore_lock);
+             return EINA_FALSE;
+          }
+
+        slash = strrchr(path, '/');
+        if (path[_ignore_root_length] == '/')
+          dir = _edi_ignore_dir_get(path, slash - path);
+     }
+
+   if (dir)
+     {
+        _edi_ignore_dir_update(dir, ecore_time_get());
+        ignored = dir->ignored || _edi_ignore_match(dir, path, is_dir) ||
+           (is_dir && _edi_ignore_provider_hidden(path));
+     }
+   else
+     ignored = _edi_ignore_match(NULL, path, is_dir);
+   eina_lock_release(&_ignore_lock);
+
+   return ignored;
+}
+
+void
+edi_ignore_init(void)
+{
+   eina_lock_new(&_ignore_lock);
+   _ignore_dirs = eina_hash_string_superfast_new(_edi_ignore_dir_free);
+}
+
+void
+edi_ignore_shutdown(void)
+{
+   eina_hash_free(_ignore_dirs);
+   _ignore_dirs = NULL;
+   _edi_ignore_rules_clear(&_ignore_builtin);
+   free(_ignore_root);
+   _ignore_root = NULL;
+   _ignore_provider = NULL;
+   eina_lock_free(&_ignore_lock);
+}
+
+Eina_Bool
+edi_ignore_path_ignored(const char *path, Eina_File_Type type)
+{
+   if (type == EINA_FILE_UNKNOWN)
+     return _edi_ignore_path_ignored(path, ecore_file_is_dir(path));
+
+   return _edi_ignore_path_ignored(path, type == EINA_FILE_DIR);
+}
+
+static void
+_edi_ignore_walk(const char *directory, Ecore_Thread *thread, Edi_Ignore_File_Cb file_cb,
+                 Edi_Ignore_File_Cb dir_cb, const void *data)
+{
+   Eina_List *dirs;
+   char *dir;
+
+   if (_edi_ignore_path_ignored(directory, EINA_TRUE))
+     return;
+
+   dirs = eina_list_append(NULL, strdup(directory));
+
+   EINA_LIST_FREE(dirs, dir)
+     {
+        Eina_File_Direct_Info *info;
+        Eina_Iterator *it;
+        Eina_File_Type type;
+        struct stat st;
+
+        if (dir_cb)
+          dir_cb((void *) data, dir);
+
+        it = eina_file_direct_ls(dir);
+        EINA_ITERATOR_FOREACH(it, info)
+          {
+             type = info->type;
+
+             // Links to directories are not followed, so the walk cannot loop.
+             if (type == EINA_FILE_UNKNOWN || type == EINA_FILE_LNK)
+               {
+                  if (stat(info->path, &st))
+                    continue;
+
+                  if (S_ISREG(st.st_mode))
+                    type = EINA_FILE_REG;
+                  else if (S_ISDIR(st.st_mode) && type == EINA_FILE_UNKNOWN)
+                    type = EINA_FILE_DIR;
+               }
+
+             if (type != EINA_FILE_REG && type != EINA_FILE_DIR)
+               continue;
+
+             if (_edi_ignore_path_ignored(info->path, type == EINA_FILE_DIR))
+               continue;
+
+             if (type == EINA_FILE_DIR)
+               dirs = eina_list_append(dirs, strdup(info->path));
+             else if (file_cb)
+               file_cb((void *) data, info->path);
+
+             if (thread && ecore_thread_check(thread)) break;
+          }
+        eina_iterator_free(it);
+        free(dir);
+
+        if (thread && ecore_thread_check(thread)) break;
+     }
+
+   // Cleanup in case of interuption
+   EINA_LIST_FREE(dirs, dir)
+     free(dir);
+}
+
+void
+edi_ignore_walk(const char *directory, Ecore_Thread *thread,
+                Edi_Ignore_File_Cb file_cb, const void *data)
+{
+   _edi_ignore_walk(directory, thread, file_cb, NULL, data);
+}
+
+void
+edi_ignore_directories_walk(const char *directory, Ecore_Thread *thread,
+                            Edi_Ignore_File_Cb dir_cb, const void *data)
+{
+   _edi_ignore_walk(directory, thread, NULL, dir_cb, data);
+}
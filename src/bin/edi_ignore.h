@@ -0,0 +1,102 @@
+#ifndef EDI_IGNORE_H_
+# define EDI_IGNORE_H_
+
+#include <Elementary.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief These routines decide which files of a project are hidden or ignored.
+ */
+
+/**
+ * @typedef Edi_Ignore_File_Cb
+ * A function called on the walking thread for every file that is not ignored.
+ */
+typedef void (*Edi_Ignore_File_Cb)(void *data, const char *path);
+
+/**
+ * @brief Ignore rule functions.
+ * @defgroup Ignore
+ *
+ * @{
+ *
+ * The rules of the .gitignore and .ignore files of the project, the hidden
+ * file rule and the patterns of the build provider, all answered by a single
+ * matcher. The build provider is also asked about each directory, to find
+ * build output no pattern describes. Rules are loaded once per directory and the decision for each
+ * directory is cached, so a directory that is ignored is never read.
+ * These functions can be called from several threads at once.
+ *
+ */
+
+/**
+ * Prepare the rule cache. Must be called before any other ignore function.
+ *
+ * @ingroup Ignore
+ */
+void edi_ignore_init(void);
+
+/**
+ * Release the rule cache.
+ *
+ * @ingroup Ignore
+ */
+void edi_ignore_shutdown(void);
+
+/**
+ * Check if a path is hidden or ignored, either itself or because one of its
+ * parents is.
+ *
+ * @param path The absolute path to check.
+ * @param type The type of the file, or EINA_FILE_UNKNOWN to look it up.
+ *
+ * @return Whether the path is ignored.
+ *
+ * @ingroup Ignore
+ */
+Eina_Bool edi_ignore_path_ignored(const char *path, Eina_File_Type type);
+
+/**
+ * Walk a directory tree and report every regular file that is not ignored.
+ * Ignored directories are pruned before they are read. This call blocks until
+ * the walk is complete or @p thread is cancelled.
+ *
+ * @param directory The directory to walk.
+ * @param thread The thread running the walk, checked for cancellation,
+ *               may be NULL.
+ * @param file_cb The function called for each file.
+ * @param data User data passed to @p file_cb.
+ *
+ * @ingroup Ignore
+ */
+void edi_ignore_walk(const char *directory, Ecore_Thread *thread,
+                     Edi_Ignore_File_Cb file_cb, const void *data);
+
+/**
+ * Walk a directory tree like edi_ignore_walk() and report every directory
+ * that is not ignored, @p directory included, instead of the files.
+ *
+ * @param directory The directory to walk.
+ * @param thread The thread running the walk, checked for cancellation,
+ *               may be NULL.
+ * @param dir_cb The function called for each directory.
+ * @param data User data passed to @p dir_cb.
+ *
+ * @ingroup Ignore
+ */
+void edi_ignore_directories_walk(const char *directory, Ecore_Thread *thread,
+                                 Edi_Ignore_File_Cb dir_cb, const void *data);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDI_IGNORE_H_ */
@@ -0,0 +1,102 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <Eina.h>
+#include <Eet.h>
+#include <Ecore_File.h>
+
+#include "edi_index_file.h"
+
+#include "edi_private.h"
+
+static char *
+_edi_index_file_tmp_get(const char *filename)
+{
+   char *tmp;
+
+   tmp = malloc(strlen(filename) + 5);
+   sprintf(tmp, "%s.tmp", filename);
+
+   return tmp;
+}
+
+Eet_File *
+edi_index_file_open(const char *filename, int version, const char *directory)
+{
+   Eet_File *ef;
+   int *read_version, size;
+   char *dir;
+   Eina_Bool ok;
+
+   ef = eet_open(filename, EET_FILE_MODE_READ);
+   if (!ef) return NULL;
+
+   read_version = eet_read(ef, "version", &size);
+   dir = eet_read(ef, "directory", NULL);
+
+   // The config dir is named after the project, make sure it is the same one.
+   ok = read_version && size == sizeof(int) && *read_version == version &&
+        dir && !strcmp(dir, directory);
+   free(read_version);
+   free(dir);
+
+   if (!ok)
+     {
+        eet_close(ef);
+        return NULL;
+     }
+
+   return ef;
+}
+
+Eet_File *
+edi_index_file_write_begin(const char *filename, int version, const char *directory)
+{
+   Eet_File *ef;
+   char *tmp, *dir;
+
+   dir = ecore_file_dir_get(filename);
+   ecore_file_mkpath(dir);
+   free(dir);
+
+   tmp = _edi_index_file_tmp_get(filename);
+   ef = eet_open(tmp, EET_FILE_MODE_WRITE);
+   if (!ef)
+     {
+        WRN("Could not write index %s", tmp);
+        free(tmp);
+        return NULL;
+     }
+   free(tmp);
+
+   if (!eet_write(ef, "version", &version, sizeof(int), EET_COMPRESSION_NONE) ||
+       !eet_write(ef, "directory", directory, strlen(directory) + 1, EET_COMPRESSION_NONE))
+     {
+        edi_index_file_write_end(ef, filename, EINA_FALSE);
+        return NULL;
+     }
+
+   return ef;
+}
+
+Eina_Bool
+edi_index_file_write_end(Eet_File *ef, const char *filename, Eina_Bool ok)
+{
+   char *tmp;
+
+   if (eet_close(ef) != EET_ERROR_NONE)
+     ok = EINA_FALSE;
+
+   tmp = _edi_index_file_tmp_get(filename);
+   if (ok)
+     ok = ecore_file_mv(tmp, filename);
+   else
+     ecore_file_unlink(tmp);
+
+   if (!ok)
+     WRN("Could not write index %s", filename);
+
+   free(tmp);
+   return ok;
+}
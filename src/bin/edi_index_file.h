@@ -0,0 +1,75 @@
+#ifndef EDI_INDEX_FILE_H_
+# define EDI_INDEX_FILE_H_
+
+#include <Eina.h>
+#include <Eet.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief These routines read and write the files indexes of a project are kept in.
+ */
+
+/**
+ * @brief Index file functions.
+ * @defgroup Index_File
+ *
+ * @{
+ *
+ * An index file starts with the version of its format and the project it
+ * was built for, as the config dir it is kept in is only named after the
+ * project. It is written to a temporary file first, which replaces it once
+ * complete, so an index is never left half written.
+ *
+ */
+
+/**
+ * Open an index file to read the rest of its table from.
+ *
+ * @param filename the path of the index file.
+ * @param version the version of the format expected.
+ * @param directory the project directory it should have been built for.
+ * @return the file open, or NULL if it is missing, of another version or
+ *         of another project.
+ *
+ * @ingroup Index_File
+ */
+Eet_File *edi_index_file_open(const char *filename, int version, const char *directory);
+
+/**
+ * Start writing an index file, creating the directory it goes in if needed.
+ *
+ * @param filename the path of the index file to replace.
+ * @param version the version of the format written.
+ * @param directory the project directory the index was built for.
+ * @return the file to write the table to, or NULL if it could not be created.
+ *
+ * @ingroup Index_File
+ */
+Eet_File *edi_index_file_write_begin(const char *filename, int version, const char *directory);
+
+/**
+ * Finish writing an index file, replacing the previous one if all of the
+ * table could be written.
+ *
+ * @param ef the file returned by edi_index_file_write_begin().
+ * @param filename the path of the index file to replace.
+ * @param ok whether all of the table could be written.
+ * @return whether the index file was replaced.
+ *
+ * @ingroup Index_File
+ */
+Eina_Bool edi_index_file_write_end(Eet_File *ef, const char *filename, Eina_Bool ok);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDI_INDEX_FILE_H_ */
@@ -0,0 +1,442 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <Eina.h>
+
+#include "edi_lexer.h"
+
+#include "edi_private.h"
+
+// The most comments and strings a language can have.
+#define EDI_LEXER_SPANS 4
+
+// What a byte may start, looked up in a table of each language.
+typedef enum
+{
+   EDI_LEXER_CLASS_OTHER = 0,
+   EDI_LEXER_CLASS_SPACE,
+   EDI_LEXER_CLASS_WORD,
+   EDI_LEXER_CLASS_DIGIT,
+   EDI_LEXER_CLASS_DELIMITER /**< The first byte of a comment, string or preprocessor line */
+} Edi_Lexer_Class;
+
+// A comment or string, from where it opens to where it closes.
+typedef struct
+{
+   const char *open, *close;
+   Elm_Code_Token_Type type;
+   Eina_Bool escapes; /**< A backslash escapes the byte after it */
+   Eina_Bool lines; /**< It goes on over lines until closed, or ends with the line */
+} Edi_Lexer_Span;
+
+struct _Edi_Lexer
+{
+   const char *name;
+   const char *mimes[5];
+   const char *files[4]; /**< The extensions, or the names, of its files */
+   const char *line_comment;
+   Eina_Bool comment_word; /**< Line comments have to start a word */
+   const char *preprocessor; /**< What starts the preprocessor lines */
+   Edi_Lexer_Span spans[EDI_LEXER_SPANS]; /**< Those with the longest opening first */
+   const char **keywords, **types; /**< Sorted, and NULL terminated */
+
+   unsigned int keyword_count, type_count;
+   unsigned char classes[256]; /**< Edi_Lexer_Class of each byte, filled once first used */
+   Eina_Bool ready;
+};
+
+static const char *_edi_lexer_c_keywords[] =
+{
+   "auto", "break", "case", "const", "continue", "default", "do", "else",
+   "enum", "extern", "for", "goto", "if", "inline", "register", "restrict",
+   "return", "sizeof", "static", "struct", "switch", "typedef", "union",
+   "volatile", "while", NULL
+};
+
+static const char *_edi_lexer_c_types[] =
+{
+   "bool", "char", "double", "float", "int", "long", "short", "signed",
+   "size_t", "ssize_t", "unsigned", "void", NULL
+};
+
+static const char *_edi_lexer_python_keywords[] =
+{
+   "False", "None", "True", "and", "as", "assert", "async", "await", "break",
+   "class", "continue", "def", "del", "elif", "else", "except", "finally",
+   "for", "from", "global", "if", "import", "in", "is", "lambda", "nonlocal",
+   "not", "or", "pass", "raise", "return", "try", "while", "with", "yield",
+   NULL
+};
+
+static const char *_edi_lexer_python_types[] =
+{
+   "bool", "bytes", "dict", "float", "int", "list", "object", "set", "str",
+   "tuple", NULL
+};
+
+static const char *_edi_lexer_rust_keywords[] =
+{
+   "as", "async", "await", "break", "const", "continue", "crate", "dyn",
+   "else", "enum", "extern", "false", "fn", "for", "if", "impl", "in", "let",
+   "loop", "match", "mod", "move", "mut", "pub", "ref", "return", "self",
+   "static", "struct", "super", "trait", "true", "type", "unsafe", "use",
+   "where", "while", NULL
+};
+
+static const char *_edi_lexer_rust_types[] =
+{
+   "Option", "Result", "Self", "String", "Vec", "bool", "char", "f32", "f64",
+   "i128", "i16", "i32", "i64", "i8", "isize", "str", "u128", "u16", "u32",
+   "u64", "u8", "usize", NULL
+};
+
+static const char *_edi_lexer_go_keywords[] =
+{
+   "break", "case", "chan", "const", "continue", "default", "defer", "else",
+   "fallthrough", "false", "for", "func", "go", "goto", "if", "import",
+   "interface", "iota", "map", "nil", "package", "range", "return", "select",
+   "struct", "switch", "true", "type", "var", NULL
+};
+
+static const char *_edi_lexer_go_types[] =
+{
+   "bool", "byte", "complex128", "complex64", "error", "float32", "float64",
+   "int", "int16", "int32", "int64", "int8", "rune", "string", "uint",
+   "uint16", "uint32", "uint64", "uint8", "uintptr", NULL
+};
+
+static const char *_edi_lexer_meson_keywords[] =
+{
+   "and", "break", "continue", "elif", "else", "endforeach", "endif",
+   "false", "foreach", "if", "in", "not", "or", "true", NULL
+};
+
+static const char *_edi_lexer_shell_keywords[] =
+{
+   "case", "do", "done", "elif", "else", "esac", "export", "fi", "for",
+   "function", "if", "in", "local", "read", "return", "select", "shift",
+   "then", "until", "while", NULL
+};
+
+static Edi_Lexer _edi_lexers[] =
+{
+   {
+      "c", { "text/x-csrc", "text/x-chdr", NULL }, { ".c", ".h", NULL },
+      "//", EINA_FALSE, "#",
+      {
+         { "/*", "*/", ELM_CODE_TOKEN_TYPE_COMMENT, EINA_FALSE, EINA_TRUE },
+         { "\"", "\"", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_FALSE },
+         { "'", "'", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_FALSE },
+      },
+      _edi_lexer_c_keywords, _edi_lexer_c_types, 0, 0, { 0 }, EINA_FALSE
+   },
+   {
+      "python", { "text/x-python", "text/x-python3", NULL }, { ".py", NULL },
+      "#", EINA_FALSE, NULL,
+      {
+         { "\"\"\"", "\"\"\"", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_TRUE },
+         { "'''", "'''", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_TRUE },
+         { "\"", "\"", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_FALSE },
+         { "'", "'", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_FALSE },
+      },
+      _edi_lexer_python_keywords, _edi_lexer_python_types, 0, 0, { 0 }, EINA_FALSE
+   },
+   {
+      "rust", { "text/rust", "text/x-rust", NULL }, { ".rs", NULL },
+      "//", EINA_FALSE, NULL,
+      {
+         { "/*", "*/", ELM_CODE_TOKEN_TYPE_COMMENT, EINA_FALSE, EINA_TRUE },
+         { "\"", "\"", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_TRUE },
+      },
+      _edi_lexer_rust_keywords, _edi_lexer_rust_types, 0, 0, { 0 }, EINA_FALSE
+   },
+   {
+      "go", { "text/x-go", NULL }, { ".go", NULL },
+      "//", EINA_FALSE, NULL,
+      {
+         { "/*", "*/", ELM_CODE_TOKEN_TYPE_COMMENT, EINA_FALSE, EINA_TRUE },
+         { "`", "`", ELM_CODE_TOKEN_TYPE_STRING, EINA_FALSE, EINA_TRUE },
+         { "\"", "\"", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_FALSE },
+         { "'", "'", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_FALSE },
+      },
+      _edi_lexer_go_keywords, _edi_lexer_go_types, 0, 0, { 0 }, EINA_FALSE
+   },
+   {
+      "meson", { NULL }, { "meson.build", "meson_options.txt", "meson.options", NULL },
+      "#", EINA_FALSE, NULL,
+      {
+         { "'''", "'''", ELM_CODE_TOKEN_TYPE_STRING, EINA_FALSE, EINA_TRUE },
+         { "'", "'", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_FALSE },
+      },
+      _edi_lexer_meson_keywords, NULL, 0, 0, { 0 }, EINA_FALSE
+   },
+   {
+      "shell", { "application/x-shellscript", "text/x-sh", NULL }, { ".sh", ".bash", NULL },
+      "#", EINA_TRUE, NULL,
+      {
+         { "\"", "\"", ELM_CODE_TOKEN_TYPE_STRING, EINA_TRUE, EINA_TRUE },
+         { "'", "'", ELM_CODE_TOKEN_TYPE_STRING, EINA_FALSE, EINA_TRUE },
+      },
+      _edi_lexer_shell_keywords, NULL, 0, 0, { 0 }, EINA_FALSE
+   },
+
+   { NULL, { NULL }, { NULL }, NULL, EINA_FALSE, NULL, { { NULL, NULL, 0, EINA_FALSE, EINA_FALSE } },
+     NULL, NULL, 0, 0, { 0 }, EINA_FALSE }
+};
+
+static unsigned int
+_edi_lexer_words_count(const char **words)
+{
+   unsigned int count = 0;
+
+   while (words && words[count])
+     count++;
+
+   return count;
+}
+
+static void
+_edi_lexer_delimiter_set(Edi_Lexer *lexer, const char *delimiter)
+{
+   if (delimiter && *delimiter)
+     lexer->classes[(unsigned char) delimiter[0]] = EDI_LEXER_CLASS_DELIMITER;
+}
+
+static void
+_edi_lexer_ready(Edi_Lexer *lexer)
+{
+   unsigned int i;
+
+   for (i = 0; i < 256; i++)
+     {
+        if (i == ' ' || i == '\t' || i == '\r')
+          lexer->classes[i] = EDI_LEXER_CLASS_SPACE;
+        else if (i >= '0' && i <= '9')
+          lexer->classes[i] = EDI_LEXER_CLASS_DIGIT;
+        // The bytes of UTF-8 sequences are taken as letters.
+        else if ((i >= 'a' && i <= 'z') || (i >= 'A' && i <= 'Z') || i == '_' || i >= 0x80)
+          lexer->classes[i] = EDI_LEXER_CLASS_WORD;
+        else
+          lexer->classes[i] = EDI_LEXER_CLASS_OTHER;
+     }
+
+   _edi_lexer_delimiter_set(lexer, lexer->line_comment);
+   _edi_lexer_delimiter_set(lexer, lexer->preprocessor);
+   for (i = 0; i < EDI_LEXER_SPANS; i++)
+     _edi_lexer_delimiter_set(lexer, lexer->spans[i].open);
+
+   lexer->keyword_count = _edi_lexer_words_count(lexer->keywords);
+   lexer->type_count = _edi_lexer_words_count(lexer->types);
+   lexer->ready = EINA_TRUE;
+}
+
+const Edi_Lexer *
+edi_lexer_get(const char *mime, const char *path)
+{
+   Edi_Lexer *lexer;
+   const char *name = NULL;
+   unsigned int i;
+
+   if (path)
+     {
+        name = strrchr(path, '/');
+        name = name ? name + 1 : path;
+     }
+
+   for (lexer = _edi_lexers; lexer->name; lexer++)
+     {
+        for (i = 0; mime && lexer->mimes[i]; i++)
+          if (!strcasecmp(mime, lexer->mimes[i]))
+            goto found;
+
+        for (i = 0; name && lexer->files[i]; i++)
+          {
+             if (lexer->files[i][0] == '.' ? eina_str_has_extension(name, lexer->files[i]) :
+                                             !strcmp(name, lexer->files[i]))
+               goto found;
+          }
+     }
+
+   return NULL;
+
+found:
+   if (!lexer->ready)
+     _edi_lexer_ready(lexer);
+
+   return lexer;
+}
+
+const char *
+edi_lexer_name_get(const Edi_Lexer *lexer)
+{
+   return lexer->name;
+}
+
+static Eina_Bool
+_edi_lexer_word_find(const char **words, unsigned int count, const char *word, unsigned int length)
+{
+   unsigned int low = 0, high = count, middle;
+   int cmp;
+
+   while (low < high)
+     {
+        middle = (low + high) / 2;
+        cmp = strncmp(words[middle], word, length);
+        if (!cmp)
+          cmp = (unsigned char) words[middle][length];
+        if (!cmp)
+          return EINA_TRUE;
+
+        if (cmp < 0)
+          low = middle + 1;
+        else
+          high = middle;
+     }
+
+   return EINA_FALSE;
+}
+
+static Eina_Bool
+_edi_lexer_prefix_is(const char *text, unsigned int length, unsigned int offset, const char *prefix)
+{
+   size_t prefix_length;
+
+   if (!prefix)
+     return EINA_FALSE;
+
+   prefix_length = strlen(prefix);
+   return offset + prefix_length <= length && !memcmp(text + offset, prefix, prefix_length);
+}
+
+// The offset after the end of a span, or 0 if it does not end on the line.
+static unsigned int
+_edi_lexer_span_end(const Edi_Lexer_Span *span, const char *text, unsigned int length,
+                    unsigned int offset)
+{
+   size_t close_length = strlen(span->close);
+
+   for (; offset + close_length <= length; offset++)
+     {
+        if (span->escapes && text[offset] == '\\')
+          offset++;
+        else if (text[offset] == span->close[0] && !memcmp(text + offset, span->close, close_length))
+          return offset + close_length;
+     }
+
+   return 0;
+}
+
+Edi_Lexer_State
+edi_lexer_line_lex(const Edi_Lexer *lexer, Edi_Lexer_State state,
+                   const char *text, unsigned int length,
+                   Edi_Lexer_Token_Cb cb, const void *data)
+{
+   const Edi_Lexer_Span *span;
+   unsigned int offset = 0, end, next, i;
+   Eina_Bool line_start = EINA_TRUE;
+
+   // A comment or string going on from the line before.
+   if (state && state <= EDI_LEXER_SPANS)
+     {
+        span = &lexer->spans[state - 1];
+        end = _edi_lexer_span_end(span, text, length, 0);
+        if (!end)
+          {
+             if (length)
+               cb((void *) data, 0, length - 1, span->type);
+             return state;
+          }
+
+        cb((void *) data, 0, end - 1, span->type);
+        offset = end;
+        line_start = EINA_FALSE;
+     }
+
+   while (offset < length)
+     {
+        switch (lexer->classes[(unsigned char) text[offset]])
+          {
+           case EDI_LEXER_CLASS_SPACE:
+             offset++;
+             continue;
+
+           case EDI_LEXER_CLASS_WORD:
+             for (end = offset + 1; end < length; end++)
+               {
+                  if (lexer->classes[(unsigned char) text[end]] != EDI_LEXER_CLASS_WORD &&
+                      lexer->classes[(unsigned char) text[end]] != EDI_LEXER_CLASS_DIGIT)
+                    break;
+               }
+
+             if (_edi_lexer_word_find(lexer->keywords, lexer->keyword_count, text + offset, end - offset))
+               cb((void *) data, offset, end - 1, ELM_CODE_TOKEN_TYPE_KEYWORD);
+             else if (_edi_lexer_word_find(lexer->types, lexer->type_count, text + offset, end - offset))
+               cb((void *) data, offset, end - 1, ELM_CODE_TOKEN_TYPE_TYPE);
+             else
+               {
+                  for (next = end; next < length && lexer->classes[(unsigned char) text[next]] == EDI_LEXER_CLASS_SPACE; next++);
+                  if (next < length && text[next] == '(')
+                    cb((void *) data, offset, end - 1, ELM_CODE_TOKEN_TYPE_FUNCTION);
+               }
+             offset = end;
+             break;
+
+           case EDI_LEXER_CLASS_DIGIT:
+             for (end = offset + 1; end < length; end++)
+               {
+                  if (lexer->classes[(unsigned char) text[end]] != EDI_LEXER_CLASS_WORD &&
+                      lexer->classes[(unsigned char) text[end]] != EDI_LEXER_CLASS_DIGIT &&
+                      text[end] != '.')
+                    break;
+               }
+
+             cb((void *) data, offset, end - 1, ELM_CODE_TOKEN_TYPE_NUMBER);
+             offset = end;
+             break;
+
+           case EDI_LEXER_CLASS_DELIMITER:
+             if (line_start && _edi_lexer_prefix_is(text, length, offset, lexer->preprocessor))
+               {
+                  cb((void *) data, offset, length - 1, ELM_CODE_TOKEN_TYPE_PREPROCESSOR);
+                  return 0;
+               }
+             if (_edi_lexer_prefix_is(text, length, offset, lexer->line_comment) &&
+                 (!lexer->comment_word || !offset ||
+                  lexer->classes[(unsigned char) text[offset - 1]] == EDI_LEXER_CLASS_SPACE))
+               {
+                  cb((void *) data, offset, length - 1, ELM_CODE_TOKEN_TYPE_COMMENT);
+                  return 0;
+               }
+
+             for (i = 0; i < EDI_LEXER_SPANS && lexer->spans[i].open; i++)
+               {
+                  span = &lexer->spans[i];
+                  if (!_edi_lexer_prefix_is(text, length, offset, span->open))
+                    continue;
+
+                  end = _edi_lexer_span_end(span, text, length, offset + strlen(span->open));
+                  if (!end)
+                    {
+                       cb((void *) data, offset, length - 1, span->type);
+                       return span->lines ? i + 1 : 0;
+                    }
+
+                  cb((void *) data, offset, end - 1, span->type);
+                  offset = end;
+                  break;
+               }
+             if (i == EDI_LEXER_SPANS || !lexer->spans[i].open)
+               offset++;
+             break;
+
+           default:
+             offset++;
+             break;
+          }
+
+        line_start = EINA_FALSE;
+     }
+
+   return 0;
+}
@@ -0,0 +1,97 @@
+#ifndef EDI_LEXER_H_
+# define EDI_LEXER_H_
+
+#include <Elementary.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief These routines split the lines of source files into highlighted tokens.
+ */
+
+/**
+ * @typedef Edi_Lexer
+ * The tables a language is lexed with.
+ */
+typedef struct _Edi_Lexer Edi_Lexer;
+
+/**
+ * @typedef Edi_Lexer_State
+ * What a line ends inside of, a comment or string that goes on to the next
+ * line, 0 if nothing. A line is lexed starting in the state the line before
+ * it ended in.
+ */
+typedef unsigned char Edi_Lexer_State;
+
+/**
+ * @typedef Edi_Lexer_Token_Cb
+ * Called for each token found in a line, in order.
+ */
+typedef void (*Edi_Lexer_Token_Cb)(void *data, unsigned int start, unsigned int end,
+                                   Elm_Code_Token_Type type);
+
+/**
+ * @brief Lexer functions.
+ * @defgroup Lexer
+ *
+ * @{
+ *
+ * A lexer for the languages without a parser of their own, driven by a few
+ * small tables for each language so a line is lexed in a single pass.
+ *
+ */
+
+/**
+ * Get the lexer for a file.
+ *
+ * @param mime The mime type of the file, may be NULL.
+ * @param path The path of the file, for the files known by their name.
+ *
+ * @return the lexer, or NULL if the language of the file has none.
+ *
+ * @ingroup Lexer
+ */
+const Edi_Lexer *edi_lexer_get(const char *mime, const char *path);
+
+/**
+ * Get the name of the language of a lexer.
+ *
+ * @param lexer The lexer.
+ *
+ * @return the name, like "python".
+ *
+ * @ingroup Lexer
+ */
+const char *edi_lexer_name_get(const Edi_Lexer *lexer);
+
+/**
+ * Lex a line.
+ *
+ * @param lexer The lexer of the language.
+ * @param state The state the line before ended in, 0 for the first line.
+ * @param text The text of the line, without its newline.
+ * @param length The length of the text.
+ * @param cb Called with each token, the start and end are the offsets of
+ *        their first and last bytes.
+ * @param data Passed to the callback.
+ *
+ * @return the state the line ends in.
+ *
+ * @ingroup Lexer
+ */
+Edi_Lexer_State edi_lexer_line_lex(const Edi_Lexer *lexer, Edi_Lexer_State state,
+                                   const char *text, unsigned int length,
+                                   Edi_Lexer_Token_Cb cb, const void *data);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDI_LEXER_H_ */
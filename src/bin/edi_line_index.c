@@ -0,0 +1,359 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <Eina.h>
+#include <Ecore.h>
+
+#include "edi_line_index.h"
+#include "edi_search.h"
+
+#include "edi_private.h"
+
+// Lines between the starts kept, the others are found from the one before.
+#define EDI_LINE_INDEX_STEP 64
+// Starts found on the thread before they are given to the index.
+#define EDI_LINE_INDEX_BATCH 4096
+// How often the main loop is told about the lines found meanwhile.
+#define EDI_LINE_INDEX_NOTIFY_DELAY 0.25
+
+struct _Edi_Line_Index
+{
+   Eina_File *file;
+   const char *map;
+   size_t size;
+
+   Eina_Lock lock; /**< Held to change or read what the thread found */
+   Eina_Inarray *starts; /**< Where the first line, and every EDI_LINE_INDEX_STEP after it, start */
+   unsigned int lines;
+   size_t end; /**< Where the lines found end */
+   Eina_Bool done;
+
+   Ecore_Thread *thread;
+   Ecore_Timer *timer;
+   unsigned int notified; /**< The lines found when the callback was last called */
+   Edi_Line_Index_Cb cb;
+   void *data;
+
+   Ecore_Thread *find_thread;
+   Edi_Line_Index_Find_Cb find_cb;
+   void *find_data;
+};
+
+typedef struct _Edi_Line_Index_Find
+{
+   Edi_Line_Index *index;
+   char *text;
+   unsigned int line, col;
+   Eina_Bool found;
+} Edi_Line_Index_Find;
+
+static void
+_edi_line_index_publish(Edi_Line_Index *index, const size_t *starts, unsigned int count,
+                        unsigned int lines, size_t end, Eina_Bool done)
+{
+   unsigned int i;
+
+   eina_lock_take(&index->lock);
+   for (i = 0; i < count; i++)
+     eina_inarray_push(index->starts, &starts[i]);
+   index->lines = lines;
+   index->end = end;
+   index->done = done;
+   eina_lock_release(&index->lock);
+}
+
+static void
+_edi_line_index_scan_cb(void *data, Ecore_Thread *thread)
+{
+   Edi_Line_Index *index = data;
+   size_t starts[EDI_LINE_INDEX_BATCH];
+   const char *newline;
+   unsigned int count = 0, lines = 0;
+   size_t offset = 0;
+
+   while (offset < index->size)
+     {
+        if (!(lines % EDI_LINE_INDEX_STEP))
+          {
+             if (count == EDI_LINE_INDEX_BATCH)
+               {
+                  _edi_line_index_publish(index, starts, count, lines, offset, EINA_FALSE);
+                  count = 0;
+
+                  if (ecore_thread_check(thread))
+                    return;
+               }
+             starts[count++] = offset;
+          }
+
+        newline = memchr(index->map + offset, '\n', index->size - offset);
+        offset = newline ? (size_t) (newline - index->map) + 1 : index->size;
+        lines++;
+     }
+
+   _edi_line_index_publish(index, starts, count, lines, offset, EINA_TRUE);
+}
+
+static void
+_edi_line_index_notify(Edi_Line_Index *index)
+{
+   unsigned int lines;
+
+   eina_lock_take(&index->lock);
+   lines = index->lines;
+   eina_lock_release(&index->lock);
+
+   if (lines == index->notified && index->thread)
+     return;
+
+   index->notified = lines;
+   if (index->cb)
+     index->cb(index->data, index);
+}
+
+static Eina_Bool
+_edi_line_index_timer_cb(void *data)
+{
+   _edi_line_index_notify(data);
+
+   return ECORE_CALLBACK_RENEW;
+}
+
+static void
+_edi_line_index_scan_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Line_Index *index = data;
+
+   index->thread = NULL;
+   if (index->timer)
+     ecore_timer_del(index->timer);
+   index->timer = NULL;
+
+   _edi_line_index_notify(index);
+}
+
+Edi_Line_Index *
+edi_line_index_new(const char *path, Edi_Line_Index_Cb cb, const void *data)
+{
+   Edi_Line_Index *index;
+   Eina_File *file;
+
+   file = eina_file_open(path, EINA_FALSE);
+   if (!file)
+     return NULL;
+
+   index = calloc(1, sizeof(Edi_Line_Index));
+   index->file = file;
+   index->size = eina_file_size_get(file);
+   index->cb = cb;
+   index->data = (void *) data;
+   eina_lock_new(&index->lock);
+   index->starts = eina_inarray_new(sizeof(size_t), EDI_LINE_INDEX_BATCH);
+
+   if (!index->size)
+     {
+        index->done = EINA_TRUE;
+        return index;
+     }
+
+   index->map = eina_file_map_all(file, EINA_FILE_SEQUENTIAL);
+   if (!index->map)
+     {
+        edi_line_index_free(index);
+        return NULL;
+     }
+
+   index->timer = ecore_timer_add(EDI_LINE_INDEX_NOTIFY_DELAY, _edi_line_index_timer_cb, index);
+   index->thread = ecore_thread_run(_edi_line_index_scan_cb, _edi_line_index_scan_end_cb,
+                                    _edi_line_index_scan_end_cb, index);
+
+   return index;
+}
+
+void
+edi_line_index_free(Edi_Line_Index *index)
+{
+   index->cb = NULL;
+   if (index->thread)
+     {
+        ecore_thread_cancel(index->thread);
+        while ((ecore_thread_wait(index->thread, 0.1)) != EINA_TRUE);
+     }
+   index->find_cb = NULL;
+   if (index->find_thread)
+     {
+        ecore_thread_cancel(index->find_thread);
+        while ((ecore_thread_wait(index->find_thread, 0.1)) != EINA_TRUE);
+     }
+   if (index->timer)
+     ecore_timer_del(index->timer);
+
+   if (index->map)
+     eina_file_map_free(index->file, (void *) index->map);
+   eina_file_close(index->file);
+
+   eina_inarray_free(index->starts);
+   eina_lock_free(&index->lock);
+   free(index);
+}
+
+unsigned int
+edi_line_index_lines_get(Edi_Line_Index *index)
+{
+   unsigned int lines;
+
+   eina_lock_take(&index->lock);
+   lines = index->lines;
+   eina_lock_release(&index->lock);
+
+   return lines;
+}
+
+Eina_Bool
+edi_line_index_done_get(Edi_Line_Index *index)
+{
+   Eina_Bool done;
+
+   eina_lock_take(&index->lock);
+   done = index->done;
+   eina_lock_release(&index->lock);
+
+   return done;
+}
+
+const char *
+edi_line_index_line_get(Edi_Line_Index *index, unsigned int number, unsigned int *length)
+{
+   const char *text, *newline, *end;
+   unsigned int skip;
+
+   if (!number)
+     return NULL;
+
+   eina_lock_take(&index->lock);
+   if (number > index->lines)
+     {
+        eina_lock_release(&index->lock);
+        return NULL;
+     }
+   text = index->map + *(size_t *) eina_inarray_nth(index->starts, (number - 1) / EDI_LINE_INDEX_STEP);
+   eina_lock_release(&index->lock);
+
+   end = index->map + index->size;
+   for (skip = (number - 1) % EDI_LINE_INDEX_STEP; skip; skip--)
+     text = (const char *) memchr(text, '\n', end - text) + 1;
+
+   newline = memchr(text, '\n', end - text);
+   if (newline)
+     end = newline;
+   if (end > text && *(end - 1) == '\r')
+     end--;
+
+   *length = end - text;
+   return text;
+}
+
+Eina_Bool
+edi_line_index_find(Edi_Line_Index *index, const char *text,
+                    unsigned int *line, unsigned int *col)
+{
+   const char *start, *found, *newline;
+   unsigned int length, low, high, middle, number;
+   size_t from, end, offset;
+
+   start = edi_line_index_line_get(index, *line, &length);
+   if (!start || !*text)
+     return EINA_FALSE;
+
+   from = start - index->map + (*col > length + 1 ? length : (*col ? *col - 1 : 0));
+
+   eina_lock_take(&index->lock);
+   end = index->end;
+   eina_lock_release(&index->lock);
+
+   found = edi_search_find(index->map + from, end - from, text, strlen(text));
+   if (!found)
+     return EINA_FALSE;
+
+   // The line of the match, counted from the last start kept before it.
+   offset = found - index->map;
+   eina_lock_take(&index->lock);
+   low = 0;
+   high = eina_inarray_count(index->starts);
+   while (high - low > 1)
+     {
+        middle = (low + high) / 2;
+        if (*(size_t *) eina_inarray_nth(index->starts, middle) <= offset)
+          low = middle;
+        else
+          high = middle;
+     }
+   start = index->map + *(size_t *) eina_inarray_nth(index->starts, low);
+   eina_lock_release(&index->lock);
+
+   number = low * EDI_LINE_INDEX_STEP + 1;
+   while ((newline = memchr(start, '\n', found - start)))
+     {
+        start = newline + 1;
+        number++;
+     }
+
+   *line = number;
+   *col = found - start + 1;
+   return EINA_TRUE;
+}
+
+static void
+_edi_line_index_find_cb(void *data, Ecore_Thread *thread)
+{
+   Edi_Line_Index_Find *find = data;
+   unsigned int line, col;
+
+   line = find->line;
+   col = find->col;
+   find->found = edi_line_index_find(find->index, find->text, &find->line, &find->col);
+   if (find->found || (line == 1 && col == 1) || ecore_thread_check(thread))
+     return;
+
+   find->line = find->col = 1;
+   find->found = edi_line_index_find(find->index, find->text, &find->line, &find->col);
+}
+
+static void
+_edi_line_index_find_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Line_Index_Find *find = data;
+   Edi_Line_Index *index = find->index;
+
+   index->find_thread = NULL;
+   if (index->find_cb)
+     index->find_cb(index->find_data, index, find->found, find->line, find->col);
+
+   free(find->text);
+   free(find);
+}
+
+Eina_Bool
+edi_line_index_find_async(Edi_Line_Index *index, const char *text,
+                          unsigned int line, unsigned int col,
+                          Edi_Line_Index_Find_Cb cb, const void *data)
+{
+   Edi_Line_Index_Find *find;
+
+   if (!*text || index->find_thread)
+     return EINA_FALSE;
+
+   find = calloc(1, sizeof(Edi_Line_Index_Find));
+   find->index = index;
+   find->text = strdup(text);
+   find->line = line;
+   find->col = col;
+
+   index->find_cb = cb;
+   index->find_data = (void *) data;
+   index->find_thread = ecore_thread_run(_edi_line_index_find_cb, _edi_line_index_find_end_cb,
+                                         _edi_line_index_find_end_cb, find);
+
+   return EINA_TRUE;
+}
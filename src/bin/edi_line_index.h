@@ -0,0 +1,145 @@
+#ifndef EDI_LINE_INDEX_H_
+# define EDI_LINE_INDEX_H_
+
+#include <Elementary.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief These routines find the lines of files too large to be loaded whole.
+ */
+
+/**
+ * @typedef Edi_Line_Index
+ * A file mapped in memory, and where its lines start.
+ */
+typedef struct _Edi_Line_Index Edi_Line_Index;
+
+/**
+ * @typedef Edi_Line_Index_Cb
+ * Called on the main loop as more lines of a file are found, and once all are.
+ */
+typedef void (*Edi_Line_Index_Cb)(void *data, Edi_Line_Index *index);
+
+/**
+ * @typedef Edi_Line_Index_Find_Cb
+ * Called on the main loop with where a find in the background matched.
+ */
+typedef void (*Edi_Line_Index_Find_Cb)(void *data, Edi_Line_Index *index, Eina_Bool found,
+                                       unsigned int line, unsigned int col);
+
+/**
+ * @brief Line index functions.
+ * @defgroup Line_Index
+ *
+ * @{
+ *
+ * The file is mapped rather than read, and its newlines are looked for on
+ * a thread. Only the start of every few lines is kept, the others are
+ * found from there when they are needed.
+ *
+ */
+
+/**
+ * Map a file and start finding its lines in the background.
+ *
+ * @param path The path of the file.
+ * @param cb Called as lines are found, may be NULL.
+ * @param data Passed to the callback.
+ *
+ * @return the index, or NULL if the file could not be mapped.
+ *
+ * @ingroup Line_Index
+ */
+Edi_Line_Index *edi_line_index_new(const char *path, Edi_Line_Index_Cb cb, const void *data);
+
+/**
+ * Stop finding lines and unmap the file.
+ *
+ * @param index The index to free.
+ *
+ * @ingroup Line_Index
+ */
+void edi_line_index_free(Edi_Line_Index *index);
+
+/**
+ * Get how many lines have been found.
+ *
+ * @param index The index of the file.
+ *
+ * @return the number of lines found so far.
+ *
+ * @ingroup Line_Index
+ */
+unsigned int edi_line_index_lines_get(Edi_Line_Index *index);
+
+/**
+ * Get whether all the lines of a file have been found.
+ *
+ * @param index The index of the file.
+ *
+ * @return EINA_TRUE once the whole file has been looked at.
+ *
+ * @ingroup Line_Index
+ */
+Eina_Bool edi_line_index_done_get(Edi_Line_Index *index);
+
+/**
+ * Get the text of a line, as it is in the mapped file.
+ *
+ * @param index The index of the file.
+ * @param number The number of the line, from 1.
+ * @param length Set to the length of the line, without its line ending.
+ *
+ * @return the text, not nul terminated, or NULL if the line was not found yet.
+ *
+ * @ingroup Line_Index
+ */
+const char *edi_line_index_line_get(Edi_Line_Index *index, unsigned int number, unsigned int *length);
+
+/**
+ * Find text in a file, in the lines found so far.
+ *
+ * @param index The index of the file.
+ * @param text The text to look for.
+ * @param line The line to start looking from, set to the line of the match.
+ * @param col The byte of the line to start from, from 1, set to where the match starts.
+ *
+ * @return EINA_TRUE if the text was found.
+ *
+ * @ingroup Line_Index
+ */
+Eina_Bool edi_line_index_find(Edi_Line_Index *index, const char *text,
+                              unsigned int *line, unsigned int *col);
+
+/**
+ * Find text in a file on a thread, looking again from the start of the file
+ * if it is not found after the position given.
+ *
+ * @param index The index of the file.
+ * @param text The text to look for.
+ * @param line The line to start looking from.
+ * @param col The byte of the line to start from, from 1.
+ * @param cb Called once the text is found, or not.
+ * @param data Passed to the callback.
+ *
+ * @return EINA_FALSE if there is nothing to look for or a find is still running.
+ *
+ * @ingroup Line_Index
+ */
+Eina_Bool edi_line_index_find_async(Edi_Line_Index *index, const char *text,
+                                    unsigned int line, unsigned int col,
+                                    Edi_Line_Index_Find_Cb cb, const void *data);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDI_LINE_INDEX_H_ */
@@ -15,12 +15,16 @@
 #include "edi_theme.h"
 #include "edi_filepanel.h"
 #include "edi_file.h"
+#include "edi_ignore.h"
 #include "edi_process.h"
 #include "edi_logpanel.h"
 #include "edi_consolepanel.h"
 #include "edi_searchpanel.h"
+#include "edi_search_index.h"
+#include "edi_symbol_index.h"
 #include "edi_debugpanel.h"
 #include "edi_content_provider.h"
+#include "language/edi_language_provider.h"
 #include "mainview/edi_mainview.h"
 #include "screens/edi_screens.h"
 #include "screens/edi_file_screens.h"
@@ -1698,6 +1702,7 @@ edi_open(const char *inputpath)
 
    _edi_open_tabs();
    edi_scm_init();
+   edi_symbol_index_init();
    _edi_icon_update();
 
    evas_object_smart_callback_add(win, "delete,request", _win_delete_cb, NULL);
@@ -1825,6 +1830,7 @@ elm_main(int argc EINA_UNUSED, char **argv EINA_UNUSED)
      goto config_error;
 
    edi_init();
+   edi_ignore_init();
    if (!_edi_log_init())
      goto end;
 
@@ -1879,6 +1885,10 @@ elm_main(int argc EINA_UNUSED, char **argv EINA_UNUSED)
    elm_run();
 
  end:
+   edi_language_provider_shutdown();
+   edi_search_index_shutdown();
+   edi_symbol_index_shutdown();
+   edi_ignore_shutdown();
    _edi_log_shutdown();
    elm_shutdown();
    edi_scm_shutdown();
@@ -40,7 +40,7 @@ extern int _edi_log_dom;
 
 extern int EDI_EVENT_TAB_CHANGED;
 extern int EDI_EVENT_FILE_CHANGED;
-extern int EDI_EVENT_FILE_SAVED;
+extern int EDI_EVENT_FILE_SAVED; /**< The event is the stringshared path of the file saved */
 
 #define EDI_CONTENT_SAVE_TIMEOUT 1
 
@@ -0,0 +1,1400 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <ctype.h>
+
+#include <Eina.h>
+
+#include "edi_regex.h"
+
+// Limits keeping the size of a compiled pattern, and of its DFA, bounded.
+#define EDI_REGEX_INSTS_MAX 20000
+#define EDI_REGEX_REPEAT_MAX 1000
+#define EDI_REGEX_DEPTH_MAX 500
+#define EDI_REGEX_STATES_MAX 2048
+
+// A symbol fed to the automaton just before a line break or the end of text.
+#define EDI_REGEX_EOL 256
+
+typedef enum
+{
+   EDI_REGEX_NODE_EMPTY,
+   EDI_REGEX_NODE_CLASS,
+   EDI_REGEX_NODE_BOL,
+   EDI_REGEX_NODE_EOL,
+   EDI_REGEX_NODE_CONCAT,
+   EDI_REGEX_NODE_ALTERNATE,
+   EDI_REGEX_NODE_REPEAT
+} Edi_Regex_Node_Type;
+
+typedef struct _Edi_Regex_Node Edi_Regex_Node;
+
+struct _Edi_Regex_Node
+{
+   Edi_Regex_Node_Type type;
+
+   // A class matches one byte from the set, or any non ASCII character if utf8 is set.
+   unsigned char set[32];
+   Eina_Bool utf8;
+
+   Edi_Regex_Node *left, *right;
+   int min, max;
+};
+
+typedef struct
+{
+   const char *p;
+   const char *error;
+   Eina_List *nodes;
+   int depth;
+} Edi_Regex_Parser;
+
+typedef enum
+{
+   EDI_REGEX_OP_CLASS,
+   EDI_REGEX_OP_SPLIT,
+   EDI_REGEX_OP_JUMP,
+   EDI_REGEX_OP_BOL,
+   EDI_REGEX_OP_EOL,
+   EDI_REGEX_OP_MATCH
+} Edi_Regex_Op;
+
+typedef struct
+{
+   Edi_Regex_Op op;
+   unsigned int x, y;
+   unsigned char set[32];
+} Edi_Regex_Inst;
+
+/*
+ * A DFA state is a set of program instructions, its transitions are filled
+ * in as they are first taken. Sets are keyed by their size then their sorted
+ * instructions.
+ */
+typedef struct
+{
+   unsigned int *insts;
+   Eina_Bool match;
+   int next[EDI_REGEX_EOL + 1];
+} Edi_Regex_State;
+
+typedef struct
+{
+   Edi_Regex_State **states;
+   unsigned int count, size;
+   Eina_Hash *hash;
+   int start[2];
+} Edi_Regex_Dfa;
+
+// An instruction reached by a match starting at start.
+typedef struct
+{
+   unsigned int pc;
+   size_t start;
+} Edi_Regex_Thread;
+
+// Each thread matching works with its own cache, so no lock is taken per byte.
+typedef struct
+{
+   Edi_Regex_Dfa search, anchored;
+   unsigned int *stack, *marks, *set;
+   unsigned int generation;
+   Edi_Regex_Thread *threads;
+} Edi_Regex_Cache;
+
+struct _Edi_Regex
+{
+   Edi_Regex_Inst *insts;
+   unsigned int count;
+   char *literal;
+
+   Eina_Spinlock lock;
+   Eina_List *caches;
+};
+
+static void
+_edi_regex_set_add(unsigned char *set, unsigned int c)
+{
+   set[c >> 3] |= 1 << (c & 7);
+}
+
+static Eina_Bool
+_edi_regex_set_has(const unsigned char *set, unsigned int c)
+{
+   return !!(set[c >> 3] & (1 << (c & 7)));
+}
+
+static void
+_edi_regex_set_add_range(unsigned char *set, unsigned int first, unsigned int last)
+{
+   unsigned int c;
+
+   for (c = first; c <= last; c++)
+     _edi_regex_set_add(set, c);
+}
+
+// Matches never span lines, so no class can match a line break.
+static void
+_edi_regex_set_remove_breaks(unsigned char *set)
+{
+   set['\n' >> 3] &= ~(1 << ('\n' & 7));
+   set['\r' >> 3] &= ~(1 << ('\r' & 7));
+}
+
+static Eina_Bool
+_edi_regex_set_add_named(unsigned char *set, char name)
+{
+   unsigned char named[32];
+   unsigned int c;
+
+   memset(named, 0, sizeof(named));
+   switch (tolower(name))
+     {
+      case 'd':
+        _edi_regex_set_add_range(named, '0', '9');
+        break;
+      case 'w':
+        _edi_regex_set_add_range(named, '0', '9');
+        _edi_regex_set_add_range(named, 'a', 'z');
+        _edi_regex_set_add_range(named, 'A', 'Z');
+        _edi_regex_set_add(named, '_');
+        break;
+      case 's':
+        _edi_regex_set_add(named, ' ');
+        _edi_regex_set_add_range(named, '\t', '\r');
+        break;
+      default:
+        return EINA_FALSE;
+     }
+
+   for (c = 0; c < 256; c++)
+     if (_edi_regex_set_has(named, c) == !!islower(name))
+       _edi_regex_set_add(set, c);
+
+   return EINA_TRUE;
+}
+
+// Keep only the ASCII characters missing from the set, anything else is matched as UTF-8.
+static void
+_edi_regex_set_negate(unsigned char *set)
+{
+   unsigned int i;
+
+   for (i = 0; i < 16; i++)
+     set[i] = ~set[i];
+   memset(set + 16, 0, 16);
+}
+
+static Edi_Regex_Node *
+_edi_regex_node_new(Edi_Regex_Parser *parser, Edi_Regex_Node_Type type)
+{
+   Edi_Regex_Node *node;
+
+   node = calloc(1, sizeof(Edi_Regex_Node));
+   node->type = type;
+   parser->nodes = eina_list_append(parser->nodes, node);
+
+   return node;
+}
+
+static Edi_Regex_Node *
+_edi_regex_error(Edi_Regex_Parser *parser, const char *error)
+{
+   if (!parser->error)
+     parser->error = error;
+
+   return NULL;
+}
+
+static Eina_Bool
+_edi_regex_parse_hex(Edi_Regex_Parser *parser, unsigned int *c)
+{
+   if (!isxdigit(parser->p[0]) || !isxdigit(parser->p[1]))
+     return EINA_FALSE;
+
+   sscanf(parser->p, "%2x", c);
+   parser->p += 2;
+
+   return EINA_TRUE;
+}
+
+/*
+ * Parse an escaped character, adding it to the set. The negated named classes
+ * set utf8, they match any non ASCII character as well.
+ */
+static Eina_Bool
+_edi_regex_parse_escape(Edi_Regex_Parser *parser, unsigned char *set, Eina_Bool *utf8)
+{
+   unsigned int c;
+   char e;
+
+   e = *parser->p;
+   if (!e)
+     return !!_edi_regex_error(parser, "Trailing backslash");
+   parser->p++;
+
+   if (_edi_regex_set_add_named(set, e))
+     {
+        *utf8 = !!isupper(e);
+        return EINA_TRUE;
+     }
+
+   switch (e)
+     {
+      case 't': c = '\t'; break;
+      case 'n': c = '\n'; break;
+      case 'r': c = '\r'; break;
+      case 'f': c = '\f'; break;
+      case 'v': c = '\v'; break;
+      case 'x':
+        if (!_edi_regex_parse_hex(parser, &c))
+          return !!_edi_regex_error(parser, "Invalid hexadecimal escape");
+        break;
+      default:
+        if (isalnum(e))
+          return !!_edi_regex_error(parser, "Unsupported escape");
+        c = (unsigned char) e;
+     }
+
+   _edi_regex_set_add(set, c);
+   return EINA_TRUE;
+}
+
+static Edi_Regex_Node *
+_edi_regex_parse_class(Edi_Regex_Parser *parser)
+{
+   Edi_Regex_Node *node;
+   Eina_Bool negate = EINA_FALSE, first = EINA_TRUE;
+   Eina_Bool utf8 = EINA_FALSE, bytes = EINA_FALSE;
+
+   node = _edi_regex_node_new(parser, EDI_REGEX_NODE_CLASS);
+
+   if (*parser->p == '^')
+     {
+        negate = EINA_TRUE;
+        parser->p++;
+     }
+
+   while (*parser->p != ']' || first)
+     {
+        unsigned char single[32];
+        unsigned int c, last, count = 0;
+        Eina_Bool named = EINA_FALSE;
+
+        first = EINA_FALSE;
+        if (!*parser->p)
+          return _edi_regex_error(parser, "Missing ]");
+
+        memset(single, 0, sizeof(single));
+        if (*parser->p == '\\')
+          {
+             parser->p++;
+             if (!_edi_regex_parse_escape(parser, single, &named))
+               return NULL;
+          }
+        else
+          _edi_regex_set_add(single, (unsigned char) *parser->p++);
+
+        for (c = 0; c < 256; c++)
+          if (_edi_regex_set_has(single, c))
+            {
+               count++;
+               last = c;
+            }
+
+        // A range, unless the escape was a named class or the '-' closes the class.
+        if (count == 1 && parser->p[0] == '-' && parser->p[1] && parser->p[1] != ']')
+          {
+             c = last;
+             parser->p++;
+             memset(single, 0, sizeof(single));
+             if (*parser->p == '\\')
+               {
+                  parser->p++;
+                  if (!_edi_regex_parse_escape(parser, single, &named))
+                    return NULL;
+               }
+             else
+               _edi_regex_set_add(single, (unsigned char) *parser->p++);
+
+             for (last = 0; last < 256 && !_edi_regex_set_has(single, last); last++)
+               ;
+             if (last < c)
+               return _edi_regex_error(parser, "Invalid range");
+
+             _edi_regex_set_add_range(node->set, c, last);
+             bytes |= last >= 0x80;
+             continue;
+          }
+
+        if (named)
+          utf8 = EINA_TRUE;
+        else
+          bytes |= last >= 0x80;
+
+        for (c = 0; c < 32; c++)
+          node->set[c] |= single[c];
+     }
+   parser->p++;
+
+   /*
+    * A negated class matches whole UTF-8 characters, it could only leave out
+    * single bytes of the non ASCII ones listed so they are not accepted.
+    */
+   if (negate && bytes)
+     return _edi_regex_error(parser, "Negated classes can only list ASCII characters");
+
+   // Unless \D, \S or \W already cover them, any non ASCII character is not in the class.
+   if (negate)
+     {
+        _edi_regex_set_negate(node->set);
+        node->utf8 = !utf8;
+     }
+
+   return node;
+}
+
+static Edi_Regex_Node *_edi_regex_parse_alternate(Edi_Regex_Parser *parser);
+
+static Edi_Regex_Node *
+_edi_regex_parse_atom(Edi_Regex_Parser *parser)
+{
+   Edi_Regex_Node *node;
+   char c;
+
+   c = *parser->p++;
+   switch (c)
+     {
+      case '(':
+        if (parser->p[0] == '?' && parser->p[1] == ':')
+          parser->p += 2;
+        else if (parser->p[0] == '?')
+          return _edi_regex_error(parser, "Unsupported group");
+
+        if (++parser->depth > EDI_REGEX_DEPTH_MAX)
+          return _edi_regex_error(parser, "Pattern too complex");
+
+        node = _edi_regex_parse_alternate(parser);
+        if (!node) return NULL;
+
+        if (*parser->p != ')')
+          return _edi_regex_error(parser, "Missing )");
+        parser->p++;
+        parser->depth--;
+        return node;
+      case '*':
+      case '+':
+      case '?':
+        return _edi_regex_error(parser, "Nothing to repeat");
+      case '[':
+        return _edi_regex_parse_class(parser);
+      case '.':
+        node = _edi_regex_node_new(parser, EDI_REGEX_NODE_CLASS);
+        _edi_regex_set_add(node->set, '\n');
+        _edi_regex_set_add(node->set, '\r');
+        _edi_regex_set_negate(node->set);
+        node->utf8 = EINA_TRUE;
+        return node;
+      case '^':
+        return _edi_regex_node_new(parser, EDI_REGEX_NODE_BOL);
+      case '$':
+        return _edi_regex_node_new(parser, EDI_REGEX_NODE_EOL);
+      case '\\':
+        node = _edi_regex_node_new(parser, EDI_REGEX_NODE_CLASS);
+        if (!_edi_regex_parse_escape(parser, node->set, &node->utf8))
+          return NULL;
+
+        if (node->utf8)
+          memset(node->set + 16, 0, 16);
+        return node;
+      default:
+        node = _edi_regex_node_new(parser, EDI_REGEX_NODE_CLASS);
+        _edi_regex_set_add(node->set, (unsigned char) c);
+        return node;
+     }
+}
+
+// Parse a {m}, {m,} or {m,n} count, anything else is a literal '{'.
+static Eina_Bool
+_edi_regex_parse_count(Edi_Regex_Parser *parser, int *min, int *max)
+{
+   const char *p = parser->p + 1;
+   char *end;
+
+   if (!isdigit(*p)) return EINA_FALSE;
+
+   *min = strtol(p, &end, 10);
+   p = end;
+   *max = *min;
+   if (*p == ',')
+     {
+        p++;
+        if (isdigit(*p))
+          {
+             *max = strtol(p, &end, 10);
+             p = end;
+          }
+        else
+          *max = -1;
+     }
+
+   if (*p != '}') return EINA_FALSE;
+
+   parser->p = p + 1;
+   return EINA_TRUE;
+}
+
+static Edi_Regex_Node *
+_edi_regex_parse_repeat(Edi_Regex_Parser *parser)
+{
+   Edi_Regex_Node *atom, *node;
+   int min, max;
+
+   atom = _edi_regex_parse_atom(parser);
+   if (!atom) return NULL;
+
+   while (1)
+     {
+        char c = *parser->p;
+
+        if (c == '*')
+          {
+             min = 0;
+             max = -1;
+             parser->p++;
+          }
+        else if (c == '+')
+          {
+             min = 1;
+             max = -1;
+             parser->p++;
+          }
+        else if (c == '?')
+          {
+             min = 0;
+             max = 1;
+             parser->p++;
+          }
+        else if (c != '{' || !_edi_regex_parse_count(parser, &min, &max))
+          break;
+
+        if (min > EDI_REGEX_REPEAT_MAX || max > EDI_REGEX_REPEAT_MAX)
+          return _edi_regex_error(parser, "Repeat count too large");
+        if (max != -1 && max < min)
+          return _edi_regex_error(parser, "Invalid repeat count");
+
+        // Lazy repeats find the same lines, a DFA has no preference.
+        if (*parser->p == '?')
+          parser->p++;
+
+        node = _edi_regex_node_new(parser, EDI_REGEX_NODE_REPEAT);
+        node->left = atom;
+        node->min = min;
+        node->max = max;
+        atom = node;
+     }
+
+   return atom;
+}
+
+static Edi_Regex_Node *
+_edi_regex_parse_concat(Edi_Regex_Parser *parser)
+{
+   Edi_Regex_Node *node, *concat, *atom;
+
+   node = _edi_regex_node_new(parser, EDI_REGEX_NODE_EMPTY);
+   while (*parser->p && *parser->p != '|' && *parser->p != ')')
+     {
+        atom = _edi_regex_parse_repeat(parser);
+        if (!atom) return NULL;
+
+        concat = _edi_regex_node_new(parser, EDI_REGEX_NODE_CONCAT);
+        concat->left = node;
+        concat->right = atom;
+        node = concat;
+     }
+
+   return node;
+}
+
+static Edi_Regex_Node *
+_edi_regex_parse_alternate(Edi_Regex_Parser *parser)
+{
+   Edi_Regex_Node *node, *alternate, *right;
+
+   node = _edi_regex_parse_concat(parser);
+   if (!node) return NULL;
+
+   while (*parser->p == '|')
+     {
+        parser->p++;
+        right = _edi_regex_parse_concat(parser);
+        if (!right) return NULL;
+
+        alternate = _edi_regex_node_new(parser, EDI_REGEX_NODE_ALTERNATE);
+        alternate->left = node;
+        alternate->right = right;
+        node = alternate;
+     }
+
+   return node;
+}
+
+static int
+_edi_regex_emit(Edi_Regex *regex, Edi_Regex_Op op)
+{
+   Edi_Regex_Inst *inst;
+
+   if (regex->count >= EDI_REGEX_INSTS_MAX)
+     return -1;
+
+   if (!(regex->count & (regex->count - 1)) || !regex->count)
+     {
+        Edi_Regex_Inst *insts;
+
+        insts = realloc(regex->insts, (regex->count ? regex->count * 2 : 16) * sizeof(Edi_Regex_Inst));
+        if (!insts) return -1;
+        regex->insts = insts;
+     }
+
+   inst = &regex->insts[regex->count];
+   memset(inst, 0, sizeof(Edi_Regex_Inst));
+   inst->op = op;
+   inst->x = regex->count + 1;
+
+   return regex->count++;
+}
+
+/*
+ * Compile a node so that it falls through to the next instruction emitted.
+ * Instructions can move as the program grows, so they are patched by index.
+ */
+static Eina_Bool
+_edi_regex_compile(Edi_Regex *regex, const Edi_Regex_Node *node)
+{
+   int split, jump, loop, i;
+   int *splits;
+
+   switch (node->type)
+     {
+      case EDI_REGEX_NODE_EMPTY:
+        return EINA_TRUE;
+      case EDI_REGEX_NODE_BOL:
+        return _edi_regex_emit(regex, EDI_REGEX_OP_BOL) >= 0;
+      case EDI_REGEX_NODE_EOL:
+        return _edi_regex_emit(regex, EDI_REGEX_OP_EOL) >= 0;
+      case EDI_REGEX_NODE_CLASS:
+        if (!node->utf8)
+          {
+             i = _edi_regex_emit(regex, EDI_REGEX_OP_CLASS);
+             if (i < 0) return EINA_FALSE;
+             memcpy(regex->insts[i].set, node->set, sizeof(node->set));
+             _edi_regex_set_remove_breaks(regex->insts[i].set);
+             return EINA_TRUE;
+          }
+
+        // An ASCII byte from the set, or a lead byte and its continuation bytes.
+        if ((split = _edi_regex_emit(regex, EDI_REGEX_OP_SPLIT)) < 0) return EINA_FALSE;
+        if ((i = _edi_regex_emit(regex, EDI_REGEX_OP_CLASS)) < 0) return EINA_FALSE;
+        memcpy(regex->insts[i].set, node->set, sizeof(node->set));
+        _edi_regex_set_remove_breaks(regex->insts[i].set);
+        if ((jump = _edi_regex_emit(regex, EDI_REGEX_OP_JUMP)) < 0) return EINA_FALSE;
+        regex->insts[split].y = regex->count;
+        if ((i = _edi_regex_emit(regex, EDI_REGEX_OP_CLASS)) < 0) return EINA_FALSE;
+        _edi_regex_set_add_range(regex->insts[i].set, 0xc0, 0xf7);
+        if ((loop = _edi_regex_emit(regex, EDI_REGEX_OP_SPLIT)) < 0) return EINA_FALSE;
+        if ((i = _edi_regex_emit(regex, EDI_REGEX_OP_CLASS)) < 0) return EINA_FALSE;
+        _edi_regex_set_add_range(regex->insts[i].set, 0x80, 0xbf);
+        if ((i = _edi_regex_emit(regex, EDI_REGEX_OP_JUMP)) < 0) return EINA_FALSE;
+        regex->insts[i].x = loop;
+        regex->insts[loop].y = regex->count;
+        regex->insts[jump].x = regex->count;
+        return EINA_TRUE;
+      case EDI_REGEX_NODE_CONCAT:
+        return _edi_regex_compile(regex, node->left) &&
+               _edi_regex_compile(regex, node->right);
+      case EDI_REGEX_NODE_ALTERNATE:
+        if ((split = _edi_regex_emit(regex, EDI_REGEX_OP_SPLIT)) < 0) return EINA_FALSE;
+        if (!_edi_regex_compile(regex, node->left)) return EINA_FALSE;
+        if ((jump = _edi_regex_emit(regex, EDI_REGEX_OP_JUMP)) < 0) return EINA_FALSE;
+        regex->insts[split].y = regex->count;
+        if (!_edi_regex_compile(regex, node->right)) return EINA_FALSE;
+        regex->insts[jump].x = regex->count;
+        return EINA_TRUE;
+      case EDI_REGEX_NODE_REPEAT:
+        for (i = 0; i < node->min; i++)
+          if (!_edi_regex_compile(regex, node->left)) return EINA_FALSE;
+
+        if (node->max == -1)
+          {
+             if ((loop = _edi_regex_emit(regex, EDI_REGEX_OP_SPLIT)) < 0) return EINA_FALSE;
+             if (!_edi_regex_compile(regex, node->left)) return EINA_FALSE;
+             if ((jump = _edi_regex_emit(regex, EDI_REGEX_OP_JUMP)) < 0) return EINA_FALSE;
+             regex->insts[jump].x = loop;
+             regex->insts[loop].y = regex->count;
+             return EINA_TRUE;
+          }
+
+        if (node->max == node->min)
+          return EINA_TRUE;
+
+        // Each optional copy can skip straight past the last one.
+        splits = malloc((node->max - node->min) * sizeof(int));
+        for (i = 0; i < node->max - node->min; i++)
+          {
+             if ((splits[i] = _edi_regex_emit(regex, EDI_REGEX_OP_SPLIT)) < 0 ||
+                 !_edi_regex_compile(regex, node->left))
+               {
+                  free(splits);
+                  return EINA_FALSE;
+               }
+          }
+        for (i = 0; i < node->max - node->min; i++)
+          regex->insts[splits[i]].y = regex->count;
+        free(splits);
+        return EINA_TRUE;
+     }
+
+   return EINA_FALSE;
+}
+
+/*
+ * The strings known to be in any match of a node. The prefix and suffix are
+ * the strings every match starts and ends with, they are joined across a
+ * concatenation to find longer required strings.
+ */
+typedef struct
+{
+   char *exact;    // The string matched by the node, NULL if not a single string.
+   char *prefix;
+   char *suffix;
+   char *required; // The longest string found in every match of the node.
+} Edi_Regex_Literal;
+
+static char *
+_edi_regex_literal_concat(const char *s1, const char *s2)
+{
+   char *s;
+
+   s = malloc(strlen(s1) + strlen(s2) + 1);
+   strcpy(s, s1);
+   strcat(s, s2);
+
+   return s;
+}
+
+static char *
+_edi_regex_literal_longest(char *s1, char *s2)
+{
+   if (strlen(s2) > strlen(s1))
+     {
+        free(s1);
+        return s2;
+     }
+
+   free(s2);
+   return s1;
+}
+
+static char *
+_edi_regex_literal_same(const char *s1, const char *s2)
+{
+   return strdup(!strcmp(s1, s2) ? s1 : "");
+}
+
+static void
+_edi_regex_literal_free(Edi_Regex_Literal *literal)
+{
+   free(literal->exact);
+   free(literal->prefix);
+   free(literal->suffix);
+   free(literal->required);
+}
+
+static void
+_edi_regex_literal_exact_set(Edi_Regex_Literal *literal, char *exact)
+{
+   literal->exact = exact;
+   literal->prefix = strdup(exact);
+   literal->suffix = strdup(exact);
+   literal->required = strdup(exact);
+}
+
+static void
+_edi_regex_literal_get(const Edi_Regex_Node *node, Edi_Regex_Literal *literal)
+{
+   Edi_Regex_Literal left, right;
+   unsigned int c, count = 0, last = 0;
+   char *exact;
+   int i;
+
+   memset(literal, 0, sizeof(Edi_Regex_Literal));
+   switch (node->type)
+     {
+      case EDI_REGEX_NODE_EMPTY:
+      case EDI_REGEX_NODE_BOL:
+      case EDI_REGEX_NODE_EOL:
+        _edi_regex_literal_exact_set(literal, strdup(""));
+        return;
+      case EDI_REGEX_NODE_CLASS:
+        for (c = 1; c < 256; c++)
+          if (_edi_regex_set_has(node->set, c))
+            {
+               count++;
+               last = c;
+            }
+
+        if (count == 1 && !node->utf8 && !_edi_regex_set_has(node->set, 0) &&
+            last != '\n' && last != '\r')
+          {
+             exact = calloc(2, 1);
+             exact[0] = last;
+             _edi_regex_literal_exact_set(literal, exact);
+             return;
+          }
+        break;
+      case EDI_REGEX_NODE_CONCAT:
+        _edi_regex_literal_get(node->left, &left);
+        _edi_regex_literal_get(node->right, &right);
+
+        if (left.exact && right.exact)
+          _edi_regex_literal_exact_set(literal, _edi_regex_literal_concat(left.exact, right.exact));
+        else
+          {
+             literal->prefix = left.exact ? _edi_regex_literal_concat(left.exact, right.prefix) :
+                                            strdup(left.prefix);
+             literal->suffix = right.exact ? _edi_regex_literal_concat(left.suffix, right.exact) :
+                                             strdup(right.suffix);
+             literal->required = _edi_regex_literal_concat(left.suffix, right.prefix);
+             literal->required = _edi_regex_literal_longest(literal->required, strdup(left.required));
+             literal->required = _edi_regex_literal_longest(literal->required, strdup(right.required));
+             literal->required = _edi_regex_literal_longest(literal->required, strdup(literal->prefix));
+             literal->required = _edi_regex_literal_longest(literal->required, strdup(literal->suffix));
+          }
+        _edi_regex_literal_free(&left);
+        _edi_regex_literal_free(&right);
+        return;
+      case EDI_REGEX_NODE_ALTERNATE:
+        _edi_regex_literal_get(node->left, &left);
+        _edi_regex_literal_get(node->right, &right);
+
+        if (left.exact && right.exact && !strcmp(left.exact, right.exact))
+          _edi_regex_literal_exact_set(literal, strdup(left.exact));
+        else
+          {
+             literal->prefix = _edi_regex_literal_same(left.prefix, right.prefix);
+             literal->suffix = _edi_regex_literal_same(left.suffix, right.suffix);
+             literal->required = _edi_regex_literal_same(left.required, right.required);
+          }
+        _edi_regex_literal_free(&left);
+        _edi_regex_literal_free(&right);
+        return;
+      case EDI_REGEX_NODE_REPEAT:
+        _edi_regex_literal_get(node->left, &left);
+
+        if (node->min == node->max && left.exact)
+          {
+             exact = malloc(strlen(left.exact) * node->min + 1);
+             exact[0] = '\0';
+             for (i = 0; i < node->min; i++)
+               strcat(exact, left.exact);
+             _edi_regex_literal_exact_set(literal, exact);
+          }
+        else if (node->min > 0)
+          {
+             literal->prefix = strdup(left.prefix);
+             literal->suffix = strdup(left.suffix);
+             literal->required = strdup(left.required);
+          }
+        _edi_regex_literal_free(&left);
+        if (literal->required)
+          return;
+        break;
+     }
+
+   literal->prefix = strdup("");
+   literal->suffix = strdup("");
+   literal->required = strdup("");
+}
+
+static unsigned int
+_edi_regex_key_length(const void *key)
+{
+   return (((const unsigned int *) key)[0] + 2) * sizeof(unsigned int);
+}
+
+static int
+_edi_regex_key_cmp(const void *key1, int key1_length, const void *key2, int key2_length)
+{
+   if (key1_length != key2_length)
+     return key1_length - key2_length;
+
+   return memcmp(key1, key2, key1_length);
+}
+
+static int
+_edi_regex_key_hash(const void *key, int key_length)
+{
+   return eina_hash_superfast(key, key_length);
+}
+
+static void
+_edi_regex_dfa_init(Edi_Regex_Dfa *dfa)
+{
+   dfa->hash = eina_hash_new(EINA_KEY_LENGTH(_edi_regex_key_length), EINA_KEY_CMP(_edi_regex_key_cmp),
+                             EINA_KEY_HASH(_edi_regex_key_hash), NULL, 8);
+   dfa->start[0] = dfa->start[1] = -1;
+}
+
+static void
+_edi_regex_dfa_flush(Edi_Regex_Dfa *dfa)
+{
+   unsigned int i;
+
+   eina_hash_free_buckets(dfa->hash);
+   for (i = 0; i < dfa->count; i++)
+     {
+        free(dfa->states[i]->insts);
+        free(dfa->states[i]);
+     }
+   dfa->count = 0;
+   dfa->start[0] = dfa->start[1] = -1;
+}
+
+static void
+_edi_regex_dfa_shutdown(Edi_Regex_Dfa *dfa)
+{
+   _edi_regex_dfa_flush(dfa);
+   eina_hash_free(dfa->hash);
+   free(dfa->states);
+}
+
+static Edi_Regex_Cache *
+_edi_regex_cache_get(Edi_Regex *regex)
+{
+   Edi_Regex_Cache *cache;
+
+   eina_spinlock_take(&regex->lock);
+   cache = eina_list_data_get(regex->caches);
+   regex->caches = eina_list_remove_list(regex->caches, regex->caches);
+   eina_spinlock_release(&regex->lock);
+
+   if (cache) return cache;
+
+   cache = calloc(1, sizeof(Edi_Regex_Cache));
+   cache->stack = malloc((regex->count * 2 + 1) * sizeof(unsigned int));
+   cache->marks = calloc(regex->count, sizeof(unsigned int));
+   cache->set = malloc((regex->count + 2) * sizeof(unsigned int));
+   cache->threads = malloc(regex->count * 2 * sizeof(Edi_Regex_Thread));
+   _edi_regex_dfa_init(&cache->search);
+   _edi_regex_dfa_init(&cache->anchored);
+
+   return cache;
+}
+
+static void
+_edi_regex_cache_release(Edi_Regex *regex, Edi_Regex_Cache *cache)
+{
+   eina_spinlock_take(&regex->lock);
+   regex->caches = eina_list_prepend(regex->caches, cache);
+   eina_spinlock_release(&regex->lock);
+}
+
+static void
+_edi_regex_cache_free(Edi_Regex_Cache *cache)
+{
+   _edi_regex_dfa_shutdown(&cache->search);
+   _edi_regex_dfa_shutdown(&cache->anchored);
+   free(cache->stack);
+   free(cache->marks);
+   free(cache->set);
+   free(cache->threads);
+   free(cache);
+}
+
+static void
+_edi_regex_marks_clear(const Edi_Regex *regex, Edi_Regex_Cache *cache)
+{
+   if (++cache->generation) return;
+
+   // The marks wrapped around, forget them all.
+   memset(cache->marks, 0, regex->count * sizeof(unsigned int));
+   cache->generation = 1;
+}
+
+static void
+_edi_regex_set_begin(const Edi_Regex *regex, Edi_Regex_Cache *cache, Eina_Bool bol)
+{
+   cache->set[0] = 0;
+   cache->set[1] = bol;
+   _edi_regex_marks_clear(regex, cache);
+}
+
+/*
+ * Add an instruction and everything reachable from it without reading a byte.
+ * The line anchors are followed if the position is known to be at the start,
+ * or the end, of a line.
+ */
+static void
+_edi_regex_closure_add(const Edi_Regex *regex, Edi_Regex_Cache *cache,
+                       unsigned int pc, Eina_Bool eol)
+{
+   Eina_Bool bol = cache->set[1];
+
+   unsigned int top = 0;
+
+   cache->stack[top++] = pc;
+   while (top)
+     {
+        const Edi_Regex_Inst *inst;
+
+        pc = cache->stack[--top];
+        if (cache->marks[pc] == cache->generation)
+          continue;
+        cache->marks[pc] = cache->generation;
+
+        inst = &regex->insts[pc];
+        switch (inst->op)
+          {
+           case EDI_REGEX_OP_JUMP:
+             cache->stack[top++] = inst->x;
+             break;
+           case EDI_REGEX_OP_SPLIT:
+             cache->stack[top++] = inst->y;
+             cache->stack[top++] = inst->x;
+             break;
+           case EDI_REGEX_OP_BOL:
+             if (bol)
+               cache->stack[top++] = inst->x;
+             break;
+           case EDI_REGEX_OP_EOL:
+             if (eol)
+               cache->stack[top++] = inst->x;
+             else
+               cache->set[2 + cache->set[0]++] = pc;
+             break;
+           default:
+             cache->set[2 + cache->set[0]++] = pc;
+          }
+     }
+}
+
+static int
+_edi_regex_uint_cmp(const void *a, const void *b)
+{
+   unsigned int i1 = *(const unsigned int *) a, i2 = *(const unsigned int *) b;
+
+   return (i1 > i2) - (i1 < i2);
+}
+
+// Find or add the state for the set just built. Sets *flushed if the cache was full.
+static int
+_edi_regex_state_get(const Edi_Regex *regex, Edi_Regex_Cache *cache, Edi_Regex_Dfa *dfa,
+                     Eina_Bool *flushed)
+{
+   Edi_Regex_State *state;
+   unsigned int i, count = cache->set[0];
+   uintptr_t found;
+
+   qsort(cache->set + 2, count, sizeof(unsigned int), _edi_regex_uint_cmp);
+
+   found = (uintptr_t) eina_hash_find(dfa->hash, cache->set);
+   if (found)
+     return found - 1;
+
+   if (dfa->count >= EDI_REGEX_STATES_MAX)
+     {
+        _edi_regex_dfa_flush(dfa);
+        *flushed = EINA_TRUE;
+     }
+
+   if (dfa->count == dfa->size)
+     {
+        dfa->size = dfa->size ? dfa->size * 2 : 16;
+        dfa->states = realloc(dfa->states, dfa->size * sizeof(Edi_Regex_State *));
+     }
+
+   state = malloc(sizeof(Edi_Regex_State));
+   state->insts = malloc((count + 2) * sizeof(unsigned int));
+   memcpy(state->insts, cache->set, (count + 2) * sizeof(unsigned int));
+   memset(state->next, 0xff, sizeof(state->next));
+   state->match = EINA_FALSE;
+   for (i = 2; i < count + 2; i++)
+     if (regex->insts[state->insts[i]].op == EDI_REGEX_OP_MATCH)
+       state->match = EINA_TRUE;
+
+   dfa->states[dfa->count] = state;
+   eina_hash_direct_add(dfa->hash, state->insts, (void *) (uintptr_t) (dfa->count + 1));
+
+   return dfa->count++;
+}
+
+static int
+_edi_regex_start_get(const Edi_Regex *regex, Edi_Regex_Cache *cache, Edi_Regex_Dfa *dfa,
+                     Eina_Bool bol)
+{
+   Eina_Bool flushed = EINA_FALSE;
+   int state;
+
+   if (dfa->start[bol] >= 0)
+     return dfa->start[bol];
+
+   _edi_regex_set_begin(regex, cache, bol);
+   _edi_regex_closure_add(regex, cache, 0, EINA_FALSE);
+   state = _edi_regex_state_get(regex, cache, dfa, &flushed);
+   dfa->start[bol] = state;
+
+   return state;
+}
+
+static inline int
+_edi_regex_next(const Edi_Regex *regex, Edi_Regex_Cache *cache, Edi_Regex_Dfa *dfa,
+                int state, unsigned int symbol)
+{
+   Edi_Regex_State *from = dfa->states[state];
+   Eina_Bool flushed = EINA_FALSE, eol;
+   unsigned int i;
+   int next;
+
+   if (from->next[symbol] >= 0)
+     return from->next[symbol];
+
+   // The end of line symbol does not move, the start of line is unchanged.
+   eol = symbol == EDI_REGEX_EOL;
+   _edi_regex_set_begin(regex, cache, eol ? from->insts[1] : symbol == '\n');
+   for (i = 2; i < from->insts[0] + 2; i++)
+     {
+        const Edi_Regex_Inst *inst = &regex->insts[from->insts[i]];
+
+        if (inst->op == EDI_REGEX_OP_CLASS && !eol && _edi_regex_set_has(inst->set, symbol))
+          _edi_regex_closure_add(regex, cache, inst->x, EINA_FALSE);
+        else if (inst->op == EDI_REGEX_OP_EOL && eol)
+          _edi_regex_closure_add(regex, cache, inst->x, EINA_TRUE);
+        else if (inst->op == EDI_REGEX_OP_MATCH && eol)
+          _edi_regex_closure_add(regex, cache, from->insts[i], EINA_TRUE);
+     }
+
+   // Searching, a match can start at any position.
+   if (dfa == &cache->search)
+     _edi_regex_closure_add(regex, cache, 0, eol);
+
+   next = _edi_regex_state_get(regex, cache, dfa, &flushed);
+   if (!flushed)
+     from->next[symbol] = next;
+
+   return next;
+}
+
+Edi_Regex *
+edi_regex_new(const char *pattern, const char **error)
+{
+   Edi_Regex_Parser parser;
+   Edi_Regex_Literal literal;
+   Edi_Regex_Node *root, *node;
+   Edi_Regex *regex;
+
+   memset(&parser, 0, sizeof(parser));
+   parser.p = pattern;
+
+   root = _edi_regex_parse_alternate(&parser);
+   if (root && *parser.p)
+     root = _edi_regex_error(&parser, "Unmatched )");
+
+   regex = NULL;
+   if (root)
+     {
+        regex = calloc(1, sizeof(Edi_Regex));
+        if (!_edi_regex_compile(regex, root) ||
+            _edi_regex_emit(regex, EDI_REGEX_OP_MATCH) < 0)
+          {
+             free(regex->insts);
+             free(regex);
+             regex = NULL;
+             _edi_regex_error(&parser, "Pattern too complex");
+          }
+     }
+
+   if (regex)
+     {
+        _edi_regex_literal_get(root, &literal);
+        regex->literal = literal.required;
+        literal.required = NULL;
+        _edi_regex_literal_free(&literal);
+        eina_spinlock_new(&regex->lock);
+     }
+
+   EINA_LIST_FREE(parser.nodes, node)
+     free(node);
+
+   if (!regex && error)
+     *error = parser.error;
+
+   return regex;
+}
+
+void
+edi_regex_free(Edi_Regex *regex)
+{
+   Edi_Regex_Cache *cache;
+
+   if (!regex) return;
+
+   EINA_LIST_FREE(regex->caches, cache)
+     _edi_regex_cache_free(cache);
+   eina_spinlock_free(&regex->lock);
+   free(regex->literal);
+   free(regex->insts);
+   free(regex);
+}
+
+const char *
+edi_regex_literal_get(const Edi_Regex *regex)
+{
+   return regex->literal;
+}
+
+static const char *
+_edi_regex_search(const Edi_Regex *regex, Edi_Regex_Cache *cache,
+                  const char *text, size_t length, Eina_Bool bol)
+{
+   Edi_Regex_Dfa *dfa = &cache->search;
+   size_t i;
+   int state;
+
+   state = _edi_regex_start_get(regex, cache, dfa, bol);
+   if (dfa->states[state]->match)
+     return text;
+
+   for (i = 0; i < length; i++)
+     {
+        unsigned char c = text[i];
+
+        if (c == '\n' || c == '\r')
+          {
+             state = _edi_regex_next(regex, cache, dfa, state, EDI_REGEX_EOL);
+             if (dfa->states[state]->match)
+               return text + i;
+          }
+
+        state = _edi_regex_next(regex, cache, dfa, state, c);
+        if (dfa->states[state]->match)
+          return text + i + 1;
+     }
+
+   state = _edi_regex_next(regex, cache, dfa, state, EDI_REGEX_EOL);
+   if (dfa->states[state]->match)
+     return text + length;
+
+   return NULL;
+}
+
+// The end of the longest match starting at start, or -1.
+static long
+_edi_regex_longest(const Edi_Regex *regex, Edi_Regex_Cache *cache,
+                   const char *text, size_t length, size_t start)
+{
+   Edi_Regex_Dfa *dfa = &cache->anchored;
+   long last = -1;
+   size_t i;
+   int state;
+
+   state = _edi_regex_start_get(regex, cache, dfa, !start || text[start - 1] == '\n');
+   if (dfa->states[state]->match)
+     last = start;
+
+   for (i = start; i <= length; i++)
+     {
+        unsigned char c = i < length ? text[i] : '\n';
+
+        if (!dfa->states[state]->insts[0])
+          break;
+
+        if (c == '\n' || c == '\r')
+          {
+             state = _edi_regex_next(regex, cache, dfa, state, EDI_REGEX_EOL);
+             if (dfa->states[state]->match)
+               last = i;
+          }
+
+        // Matches never span lines, the end of the text is one more line break.
+        if (i == length || c == '\n' || c == '\r')
+          break;
+
+        state = _edi_regex_next(regex, cache, dfa, state, c);
+        if (dfa->states[state]->match)
+          last = i + 1;
+     }
+
+   return last;
+}
+
+/*
+ * Add a thread and every instruction it reaches without reading a byte. Threads
+ * are added in the order they started, an instruction already reached by an
+ * earlier match is not added again.
+ */
+static void
+_edi_regex_thread_add(const Edi_Regex *regex, Edi_Regex_Cache *cache, Edi_Regex_Thread *list,
+                      unsigned int *count, unsigned int pc, size_t start,
+                      Eina_Bool bol, Eina_Bool eol)
+{
+   unsigned int top = 0;
+
+   cache->stack[top++] = pc;
+   while (top)
+     {
+        const Edi_Regex_Inst *inst;
+
+        pc = cache->stack[--top];
+        if (cache->marks[pc] == cache->generation)
+          continue;
+        cache->marks[pc] = cache->generation;
+
+        inst = &regex->insts[pc];
+        switch (inst->op)
+          {
+           case EDI_REGEX_OP_JUMP:
+             cache->stack[top++] = inst->x;
+             break;
+           case EDI_REGEX_OP_SPLIT:
+             cache->stack[top++] = inst->y;
+             cache->stack[top++] = inst->x;
+             break;
+           case EDI_REGEX_OP_BOL:
+             if (bol)
+               cache->stack[top++] = inst->x;
+             break;
+           case EDI_REGEX_OP_EOL:
+             if (eol)
+               cache->stack[top++] = inst->x;
+             break;
+           default:
+             list[*count].pc = pc;
+             list[*count].start = start;
+             (*count)++;
+          }
+     }
+}
+
+/*
+ * Where the leftmost non empty match in a line starts, or -1. A DFA state
+ * cannot tell where its matches started, so the automaton is run here with
+ * each instruction tagged by the earliest start reaching it. This reads the
+ * text once, and stops once no earlier match can be found.
+ */
+static long
+_edi_regex_leftmost(const Edi_Regex *regex, Edi_Regex_Cache *cache,
+                    const char *text, size_t length, size_t offset)
+{
+   Edi_Regex_Thread *current = cache->threads, *next = cache->threads + regex->count, *swap;
+   unsigned int count = 0, next_count, i;
+   Eina_Bool bol, eol;
+   long best = -1;
+   size_t pos;
+
+   for (pos = offset; pos <= length; pos++)
+     {
+        bol = !pos || text[pos - 1] == '\n';
+        eol = pos == length || text[pos] == '\n' || text[pos] == '\r';
+
+        // The threads were added before this position was known to start or end a line.
+        _edi_regex_marks_clear(regex, cache);
+        next_count = 0;
+        for (i = 0; i < count; i++)
+          _edi_regex_thread_add(regex, cache, next, &next_count, current[i].pc,
+                                current[i].start, bol, eol);
+        if (best < 0)
+          _edi_regex_thread_add(regex, cache, next, &next_count, 0, pos, bol, eol);
+
+        swap = current;
+        current = next;
+        next = swap;
+        count = next_count;
+
+        if (!count)
+          break;
+
+        _edi_regex_marks_clear(regex, cache);
+        next_count = 0;
+        for (i = 0; i < count; i++)
+          {
+             const Edi_Regex_Inst *inst = &regex->insts[current[i].pc];
+
+             // Later threads started later, they cannot find an earlier match.
+             if (inst->op == EDI_REGEX_OP_MATCH && current[i].start < pos)
+               {
+                  best = current[i].start;
+                  break;
+               }
+
+             if (inst->op == EDI_REGEX_OP_CLASS && !eol &&
+                 _edi_regex_set_has(inst->set, (unsigned char) text[pos]))
+               {
+                  if (cache->marks[inst->x] == cache->generation)
+                    continue;
+                  cache->marks[inst->x] = cache->generation;
+                  next[next_count].pc = inst->x;
+                  next[next_count].start = current[i].start;
+                  next_count++;
+               }
+          }
+
+        if (eol)
+          break;
+
+        swap = current;
+        current = next;
+        next = swap;
+        count = next_count;
+     }
+
+   return best;
+}
+
+const char *
+edi_regex_search(Edi_Regex *regex, const char *text, size_t length)
+{
+   Edi_Regex_Cache *cache;
+   const char *found;
+
+   cache = _edi_regex_cache_get(regex);
+   found = _edi_regex_search(regex, cache, text, length, EINA_TRUE);
+   _edi_regex_cache_release(regex, cache);
+
+   return found;
+}
+
+Eina_Bool
+edi_regex_match(Edi_Regex *regex, const char *text, size_t length,
+                size_t offset, size_t *start, size_t *end)
+{
+   Edi_Regex_Cache *cache;
+   Eina_Bool found = EINA_FALSE;
+   long first, last;
+
+   if (offset > length) return EINA_FALSE;
+
+   cache = _edi_regex_cache_get(regex);
+
+   // Most lines do not match at all, which a single pass tells.
+   if (_edi_regex_search(regex, cache, text + offset, length - offset,
+                         !offset || text[offset - 1] == '\n'))
+     {
+        first = _edi_regex_leftmost(regex, cache, text, length, offset);
+        if (first >= 0)
+          {
+             last = _edi_regex_longest(regex, cache, text, length, first);
+             if (last > first)
+               {
+                  *start = first;
+                  *end = last;
+                  found = EINA_TRUE;
+               }
+          }
+     }
+
+   _edi_regex_cache_release(regex, cache);
+
+   return found;
+}
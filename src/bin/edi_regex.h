@@ -0,0 +1,116 @@
+#ifndef EDI_REGEX_H_
+# define EDI_REGEX_H_
+
+#include <Eina.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief These routines are used for matching regular expressions.
+ */
+
+/**
+ * @typedef Edi_Regex
+ * A compiled regular expression.
+ */
+typedef struct _Edi_Regex Edi_Regex;
+
+/**
+ * @brief Regular expression functions.
+ * @defgroup Regex
+ *
+ * @{
+ *
+ * A regular expression engine that never backtracks. Patterns are compiled
+ * to an automaton that is turned into a DFA lazily, one state at a time, as
+ * the text is read. Matching is linear in the length of the text.
+ *
+ * The syntax supports literals, ".", character classes with ranges and
+ * negation, the \\d \\w \\s classes and their negations, groups, "|", the
+ * "*", "+", "?" and "{m,n}" repeats and the "^" and "$" line anchors.
+ * A match never spans a line break. "." and negated classes match a whole
+ * UTF-8 character, other classes work on single bytes. Negated classes can
+ * only list ASCII characters.
+ *
+ */
+
+/**
+ * Compile a regular expression.
+ *
+ * @param pattern The pattern to compile.
+ * @param error Set to a description of the problem if the pattern is invalid,
+ *              may be NULL.
+ *
+ * @return The compiled expression, or NULL if the pattern is invalid.
+ *
+ * @ingroup Regex
+ */
+Edi_Regex *edi_regex_new(const char *pattern, const char **error);
+
+/**
+ * Free a compiled regular expression.
+ *
+ * @param regex The expression to free.
+ *
+ * @ingroup Regex
+ */
+void edi_regex_free(Edi_Regex *regex);
+
+/**
+ * Get a string that is part of every match of the expression. Text that does
+ * not contain it can be skipped with a literal search.
+ *
+ * @param regex The compiled expression.
+ *
+ * @return The required string, or an empty string if there is none.
+ *
+ * @ingroup Regex
+ */
+const char *edi_regex_literal_get(const Edi_Regex *regex);
+
+/**
+ * Find where the first match in a block of text ends. This reads each byte
+ * once and is the fastest way to know if, and on which line, text matches.
+ * The text must start at the beginning of a line.
+ * This can be called from several threads at once.
+ *
+ * @param regex The compiled expression.
+ * @param text The text to search.
+ * @param length The length of @p text.
+ *
+ * @return A pointer just past the end of the first match to end, or NULL.
+ *
+ * @ingroup Regex
+ */
+const char *edi_regex_search(Edi_Regex *regex, const char *text, size_t length);
+
+/**
+ * Find the leftmost, longest, non empty match in a line of text.
+ * This can be called from several threads at once.
+ *
+ * @param regex The compiled expression.
+ * @param text The line of text.
+ * @param length The length of @p text.
+ * @param offset Where in @p text to start looking for a match.
+ * @param start Set to the offset of the match.
+ * @param end Set to the offset just past the end of the match.
+ *
+ * @return Whether a match was found.
+ *
+ * @ingroup Regex
+ */
+Eina_Bool edi_regex_match(Edi_Regex *regex, const char *text, size_t length,
+                          size_t offset, size_t *start, size_t *end);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDI_REGEX_H_ */
@@ -0,0 +1,665 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <Eina.h>
+#include <Ecore.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+# define EDI_SEARCH_SIMD 1
+# include <immintrin.h>
+#endif
+
+#include "edi_search.h"
+#include "edi_ignore.h"
+
+#include "edi_private.h"
+
+#define EDI_SEARCH_QUEUE_SIZE 64
+
+typedef struct _Edi_Search_Pool Edi_Search_Pool;
+
+/*
+ * An Aho-Corasick automaton for a set of patterns, stored as a dense DFA so
+ * every byte of the text costs a single table lookup however many patterns
+ * there are. State 0 is the root.
+ */
+struct _Edi_Search_Patterns
+{
+   unsigned int *next;
+   unsigned int *match;
+   unsigned int count;
+   size_t length_max;
+};
+
+/*
+ * Each scanner owns a queue of paths. The walker feeds the queues round-robin,
+ * the owner takes the newest path (the walker is likely still in that
+ * directory) and idle scanners steal the oldest path from their neighbours.
+ */
+typedef struct
+{
+   Eina_Spinlock lock;
+   char **paths;
+   unsigned int head, tail;
+   unsigned int size;
+} Edi_Search_Queue;
+
+typedef struct
+{
+   Edi_Search_Pool *pool;
+   Edi_Search_Queue queue;
+   Eina_Thread thread;
+   unsigned int id;
+   Eina_Bool started;
+} Edi_Search_Worker;
+
+struct _Edi_Search_Pool
+{
+   Edi_Search_Worker *workers;
+   unsigned int count, next;
+
+   Eina_Lock lock;
+   Eina_Condition cond;
+   unsigned int pending, sleeping, running;
+   Eina_Bool done, cancel;
+
+   Edi_Search_File_Cb file_cb;
+   void *data;
+};
+
+static Eina_Bool
+_edi_search_file_ignore(const char *filename)
+{
+   if ((eina_str_has_extension(filename, ".png")   ||
+        eina_str_has_extension(filename, ".PNG")   ||
+        eina_str_has_extension(filename, ".jpg")   ||
+        eina_str_has_extension(filename, ".jpeg")  ||
+        eina_str_has_extension(filename, ".JPG")   ||
+        eina_str_has_extension(filename, ".JPEG")  ||
+        eina_str_has_extension(filename, ".bmp")   ||
+        eina_str_has_extension(filename, ".dds")   ||
+        eina_str_has_extension(filename, ".tgv")   ||
+        eina_str_has_extension(filename, ".eet")   ||
+        eina_str_has_extension(filename, ".edj")   ||
+        eina_str_has_extension(filename, ".gz")    ||
+        eina_str_has_extension(filename, ".bz2")   ||
+        eina_str_has_extension(filename, ".xz")    ||
+        eina_str_has_extension(filename, ".lzma")  ||
+        eina_str_has_extension(filename, ".core")  ||
+        eina_str_has_extension(filename, ".zip")
+       ))
+     return EINA_TRUE;
+
+   return EINA_FALSE;
+}
+
+Eina_Bool
+edi_search_path_ignored(const char *directory, const char *path)
+{
+   size_t length;
+
+   length = strlen(directory);
+   if (strncmp(path, directory, length) || path[length] != '/')
+     return EINA_TRUE;
+
+   if (_edi_search_file_ignore(path))
+     return EINA_TRUE;
+
+   return edi_ignore_path_ignored(path, EINA_FILE_REG);
+}
+
+typedef const char *(*Edi_Search_Find_Cb)(const char *haystack, size_t length,
+                                          const char *needle, size_t needle_length);
+
+static Edi_Search_Find_Cb _edi_search_find_func = NULL;
+
+static const char *
+_edi_search_find_scalar(const char *haystack, size_t length,
+                        const char *needle, size_t needle_length)
+{
+   const char *search = haystack;
+   const char *last = haystack + length - needle_length;
+   const char *lookup;
+
+   while (search <= last)
+     {
+        lookup = memchr(search, *needle, last - search + 1);
+        if (!lookup)
+          return NULL;
+        if (!memcmp(lookup + 1, needle + 1, needle_length - 1))
+          return lookup;
+
+        search = lookup + 1;
+     }
+
+   return NULL;
+}
+
+#ifdef EDI_SEARCH_SIMD
+/*
+ * Compare a block of candidate first bytes and the block of matching last
+ * bytes against the needle at once, only the positions where both agree are
+ * verified with memcmp. This avoids the flood of false positives memchr has
+ * on common leading characters.
+ */
+static const char *
+_edi_search_find_sse2(const char *haystack, size_t length,
+                      const char *needle, size_t needle_length)
+{
+   const __m128i first = _mm_set1_epi8(needle[0]);
+   const __m128i last = _mm_set1_epi8(needle[needle_length - 1]);
+   size_t i;
+
+   for (i = 0; i + needle_length - 1 + 16 <= length; i += 16)
+     {
+        const __m128i block_first = _mm_loadu_si128((const __m128i *) (haystack + i));
+        const __m128i block_last = _mm_loadu_si128((const __m128i *) (haystack + i + needle_length - 1));
+        unsigned int mask;
+
+        mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                               _mm_cmpeq_epi8(last, block_last)));
+        while (mask)
+          {
+             unsigned int bit = __builtin_ctz(mask);
+
+             if (!memcmp(haystack + i + bit + 1, needle + 1, needle_length - 2))
+               return haystack + i + bit;
+
+             mask &= mask - 1;
+          }
+     }
+
+   if (i + needle_length > length)
+     return NULL;
+
+   return _edi_search_find_scalar(haystack + i, length - i, needle, needle_length);
+}
+
+__attribute__((target("avx2")))
+static const char *
+_edi_search_find_avx2(const char *haystack, size_t length,
+                      const char *needle, size_t needle_length)
+{
+   const __m256i first = _mm256_set1_epi8(needle[0]);
+   const __m256i last = _mm256_set1_epi8(needle[needle_length - 1]);
+   size_t i;
+
+   for (i = 0; i + needle_length - 1 + 32 <= length; i += 32)
+     {
+        const __m256i block_first = _mm256_loadu_si256((const __m256i *) (haystack + i));
+        const __m256i block_last = _mm256_loadu_si256((const __m256i *) (haystack + i + needle_length - 1));
+        unsigned int mask;
+
+        mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                                                     _mm256_cmpeq_epi8(last, block_last)));
+        while (mask)
+          {
+             unsigned int bit = __builtin_ctz(mask);
+
+             if (!memcmp(haystack + i + bit + 1, needle + 1, needle_length - 2))
+               return haystack + i + bit;
+
+             mask &= mask - 1;
+          }
+     }
+
+   if (i + needle_length > length)
+     return NULL;
+
+   return _edi_search_find_sse2(haystack + i, length - i, needle, needle_length);
+}
+#endif
+
+static Edi_Search_Find_Cb
+_edi_search_find_func_get(void)
+{
+   if (_edi_search_find_func)
+     return _edi_search_find_func;
+
+#ifdef EDI_SEARCH_SIMD
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+     _edi_search_find_func = _edi_search_find_avx2;
+   else
+     _edi_search_find_func = _edi_search_find_sse2;
+#else
+   _edi_search_find_func = _edi_search_find_scalar;
+#endif
+
+   return _edi_search_find_func;
+}
+
+const char *
+edi_search_find(const char *haystack, size_t length,
+                const char *needle, size_t needle_length)
+{
+   if (!needle_length || needle_length > length)
+     return NULL;
+
+   if (needle_length == 1)
+     return memchr(haystack, *needle, length);
+
+   return _edi_search_find_func_get()(haystack, length, needle, needle_length);
+}
+
+Edi_Search_Patterns *
+edi_search_patterns_new(Eina_List *patterns)
+{
+   Edi_Search_Patterns *automaton;
+   unsigned int *fail, *queue;
+   unsigned int size = 1, head = 0, tail = 0, state, c;
+   const char *pattern;
+   Eina_List *l;
+
+   EINA_LIST_FOREACH(patterns, l, pattern)
+     size += strlen(pattern);
+
+   automaton = calloc(1, sizeof(Edi_Search_Patterns));
+   if (!automaton) return NULL;
+
+   automaton->next = calloc(size * 256, sizeof(unsigned int));
+   automaton->match = calloc(size, sizeof(unsigned int));
+   automaton->count = 1;
+   if (!automaton->next || !automaton->match)
+     {
+        edi_search_patterns_free(automaton);
+        return NULL;
+     }
+
+   // Build the trie of all the patterns, an edge to state 0 meaning no edge.
+   EINA_LIST_FOREACH(patterns, l, pattern)
+     {
+        size_t i, length = strlen(pattern);
+
+        if (!length) continue;
+
+        state = 0;
+        for (i = 0; i < length; i++)
+          {
+             unsigned int *next = &automaton->next[state * 256 + (unsigned char) pattern[i]];
+
+             if (!*next)
+               *next = automaton->count++;
+             state = *next;
+          }
+
+        automaton->match[state] = length;
+        if (length > automaton->length_max)
+          automaton->length_max = length;
+     }
+
+   if (automaton->count == 1)
+     {
+        edi_search_patterns_free(automaton);
+        return NULL;
+     }
+
+   // Turn the trie into a DFA breadth first, missing edges take the edge
+   // of the longest suffix that is also in the trie.
+   fail = calloc(automaton->count, sizeof(unsigned int));
+   queue = malloc(automaton->count * sizeof(unsigned int));
+
+   for (c = 0; c < 256; c++)
+     if (automaton->next[c])
+       queue[tail++] = automaton->next[c];
+
+   while (head < tail)
+     {
+        state = queue[head++];
+        if (!automaton->match[state])
+          automaton->match[state] = automaton->match[fail[state]];
+
+        for (c = 0; c < 256; c++)
+          {
+             unsigned int *next = &automaton->next[state * 256 + c];
+             unsigned int fallback = automaton->next[fail[state] * 256 + c];
+
+             if (*next)
+               {
+                  fail[*next] = fallback;
+                  queue[tail++] = *next;
+               }
+             else
+               *next = fallback;
+          }
+     }
+
+   free(queue);
+   free(fail);
+
+   return automaton;
+}
+
+void
+edi_search_patterns_free(Edi_Search_Patterns *patterns)
+{
+   if (!patterns) return;
+
+   free(patterns->next);
+   free(patterns->match);
+   free(patterns);
+}
+
+size_t
+edi_search_patterns_length_max(const Edi_Search_Patterns *patterns)
+{
+   return patterns->length_max;
+}
+
+const char *
+edi_search_patterns_find(const Edi_Search_Patterns *patterns,
+                         const char *haystack, size_t length)
+{
+   const unsigned int *next = patterns->next;
+   unsigned int state = 0;
+   size_t i;
+
+   for (i = 0; i < length; i++)
+     {
+        state = next[state * 256 + (unsigned char) haystack[i]];
+        if (patterns->match[state])
+          return haystack + i + 1 - patterns->match[state];
+     }
+
+   return NULL;
+}
+
+static void
+_edi_search_queue_init(Edi_Search_Queue *queue)
+{
+   eina_spinlock_new(&queue->lock);
+   queue->size = EDI_SEARCH_QUEUE_SIZE;
+   queue->paths = malloc(sizeof(char *) * queue->size);
+   queue->head = queue->tail = 0;
+}
+
+static void
+_edi_search_queue_shutdown(Edi_Search_Queue *queue)
+{
+   while (queue->head != queue->tail)
+     free(queue->paths[queue->head++ & (queue->size - 1)]);
+
+   free(queue->paths);
+   queue->paths = NULL;
+   eina_spinlock_free(&queue->lock);
+}
+
+static void
+_edi_search_queue_push(Edi_Search_Queue *queue, char *path)
+{
+   eina_spinlock_take(&queue->lock);
+   if (queue->tail - queue->head == queue->size)
+     {
+        char **paths;
+        unsigned int i, count = queue->tail - queue->head;
+
+        paths = malloc(sizeof(char *) * queue->size * 2);
+        for (i = 0; i < count; i++)
+          paths[i] = queue->paths[(queue->head + i) & (queue->size - 1)];
+
+        free(queue->paths);
+        queue->paths = paths;
+        queue->head = 0;
+        queue->tail = count;
+        queue->size *= 2;
+     }
+
+   queue->paths[queue->tail++ & (queue->size - 1)] = path;
+   eina_spinlock_release(&queue->lock);
+}
+
+static char *
+_edi_search_queue_pop(Edi_Search_Queue *queue)
+{
+   char *path = NULL;
+
+   eina_spinlock_take(&queue->lock);
+   if (queue->head != queue->tail)
+     path = queue->paths[--queue->tail & (queue->size - 1)];
+   eina_spinlock_release(&queue->lock);
+
+   return path;
+}
+
+static char *
+_edi_search_queue_steal(Edi_Search_Queue *queue)
+{
+   char *path = NULL;
+
+   eina_spinlock_take(&queue->lock);
+   if (queue->head != queue->tail)
+     path = queue->paths[queue->head++ & (queue->size - 1)];
+   eina_spinlock_release(&queue->lock);
+
+   return path;
+}
+
+static char *
+_edi_search_worker_next(Edi_Search_Worker *worker)
+{
+   Edi_Search_Pool *pool = worker->pool;
+   char *path;
+   unsigned int i;
+
+   path = _edi_search_queue_pop(&worker->queue);
+   if (path) return path;
+
+   for (i = 1; i < pool->count; i++)
+     {
+        path = _edi_search_queue_steal(&pool->workers[(worker->id + i) % pool->count].queue);
+        if (path) return path;
+     }
+
+   return NULL;
+}
+
+static void *
+_edi_search_worker_main(void *data, Eina_Thread thread EINA_UNUSED)
+{
+   Edi_Search_Worker *worker = data;
+   Edi_Search_Pool *pool = worker->pool;
+   char *path;
+
+   while (1)
+     {
+        path = _edi_search_worker_next(worker);
+        if (path)
+          {
+             eina_lock_take(&pool->lock);
+             pool->pending--;
+             eina_lock_release(&pool->lock);
+
+             if (!pool->cancel)
+               pool->file_cb(pool->data, path);
+             free(path);
+             continue;
+          }
+
+        eina_lock_take(&pool->lock);
+        // Another scanner may hold a path it has not accounted for yet,
+        // only sleep when there is really nothing queued.
+        while (!pool->pending && !pool->done && !pool->cancel)
+          {
+             pool->sleeping++;
+             eina_condition_wait(&pool->cond);
+             pool->sleeping--;
+          }
+
+        if (pool->cancel || (!pool->pending && pool->done))
+          {
+             eina_lock_release(&pool->lock);
+             break;
+          }
+        eina_lock_release(&pool->lock);
+     }
+
+   eina_lock_take(&pool->lock);
+   pool->running--;
+   eina_condition_broadcast(&pool->cond);
+   eina_lock_release(&pool->lock);
+
+   return NULL;
+}
+
+static Edi_Search_Pool *
+_edi_search_pool_new(Edi_Search_File_Cb file_cb, const void *data)
+{
+   Edi_Search_Pool *pool;
+   unsigned int i;
+   int cores;
+
+   pool = calloc(1, sizeof(Edi_Search_Pool));
+   if (!pool) return NULL;
+
+   cores = eina_cpu_count();
+   pool->count = cores > 0 ? cores : 1;
+   pool->workers = calloc(pool->count, sizeof(Edi_Search_Worker));
+   pool->file_cb = file_cb;
+   pool->data = (void *) data;
+
+   eina_lock_new(&pool->lock);
+   eina_condition_new(&pool->cond, &pool->lock);
+
+   // Every queue must exist before the first scanner starts stealing.
+   for (i = 0; i < pool->count; i++)
+     {
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+        _edi_search_queue_init(&pool->workers[i].queue);
+     }
+
+   for (i = 0; i < pool->count; i++)
+     {
+        Edi_Search_Worker *worker = &pool->workers[i];
+
+        eina_lock_take(&pool->lock);
+        worker->started = eina_thread_create(&worker->thread, EINA_THREAD_BACKGROUND, -1,
+                                             _edi_search_worker_main, worker);
+        if (worker->started)
+          pool->running++;
+        else
+          ERR("Could not start search thread %d", i);
+        eina_lock_release(&pool->lock);
+     }
+
+   return pool;
+}
+
+static void
+_edi_search_pool_push(Edi_Search_Pool *pool, const char *path)
+{
+   // Without any scanner, fall back to scanning on the walker thread.
+   if (!pool->running)
+     {
+        pool->file_cb(pool->data, path);
+        return;
+     }
+
+   // Account for the path before publishing it, a scanner may take it at once.
+   eina_lock_take(&pool->lock);
+   pool->pending++;
+   eina_lock_release(&pool->lock);
+
+   _edi_search_queue_push(&pool->workers[pool->next++ % pool->count].queue, strdup(path));
+
+   eina_lock_take(&pool->lock);
+   if (pool->sleeping)
+     eina_condition_signal(&pool->cond);
+   eina_lock_release(&pool->lock);
+}
+
+static void
+_edi_search_pool_cancel(Edi_Search_Pool *pool)
+{
+   eina_lock_take(&pool->lock);
+   pool->cancel = EINA_TRUE;
+   eina_condition_broadcast(&pool->cond);
+   eina_lock_release(&pool->lock);
+}
+
+static void
+_edi_search_pool_free(Edi_Search_Pool *pool, Ecore_Thread *thread)
+{
+   unsigned int i;
+
+   eina_lock_take(&pool->lock);
+   pool->done = EINA_TRUE;
+   eina_condition_broadcast(&pool->cond);
+
+   // Wait for the scanners to drain the queues, still honouring cancellation.
+   while (pool->running)
+     {
+        eina_condition_timedwait(&pool->cond, 0.1);
+        if (!pool->cancel && ecore_thread_check(thread))
+          {
+             pool->cancel = EINA_TRUE;
+             eina_condition_broadcast(&pool->cond);
+          }
+     }
+   eina_lock_release(&pool->lock);
+
+   for (i = 0; i < pool->count; i++)
+     {
+        if (pool->workers[i].started)
+          eina_thread_join(pool->workers[i].thread);
+        _edi_search_queue_shutdown(&pool->workers[i].queue);
+     }
+
+   eina_condition_free(&pool->cond);
+   eina_lock_free(&pool->lock);
+   free(pool->workers);
+   free(pool);
+}
+
+static void
+_edi_search_project_file_cb(void *data, const char *path)
+{
+   Edi_Search_Pool *pool = data;
+
+   if (_edi_search_file_ignore(path))
+     return;
+
+   _edi_search_pool_push(pool, path);
+}
+
+void
+edi_search_project_run(const char *directory, Ecore_Thread *thread,
+                       Edi_Search_File_Cb file_cb, const void *data)
+{
+   Edi_Search_Pool *pool;
+
+   pool = _edi_search_pool_new(file_cb, data);
+   if (!pool) return;
+
+   edi_ignore_walk(directory, thread, _edi_search_project_file_cb, pool);
+
+   if (ecore_thread_check(thread))
+     _edi_search_pool_cancel(pool);
+
+   _edi_search_pool_free(pool, thread);
+}
+
+void
+edi_search_files_run(Eina_List *paths, Ecore_Thread *thread,
+                     Edi_Search_File_Cb file_cb, const void *data)
+{
+   Edi_Search_Pool *pool;
+   const char *path;
+   Eina_List *l;
+
+   pool = _edi_search_pool_new(file_cb, data);
+   if (!pool) return;
+
+   EINA_LIST_FOREACH(paths, l, path)
+     {
+        _edi_search_pool_push(pool, path);
+
+        if (ecore_thread_check(thread)) break;
+     }
+
+   if (ecore_thread_check(thread))
+     _edi_search_pool_cancel(pool);
+
+   _edi_search_pool_free(pool, thread);
+}
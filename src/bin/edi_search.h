@@ -0,0 +1,154 @@
+#ifndef EDI_SEARCH_H_
+# define EDI_SEARCH_H_
+
+#include <Elementary.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief These routines are used for searching the files of a project.
+ */
+
+/**
+ * @typedef Edi_Search_File_Cb
+ * A function called on a scanner thread for every file the walker finds.
+ */
+typedef void (*Edi_Search_File_Cb)(void *data, const char *path);
+
+/**
+ * @typedef Edi_Search_Patterns
+ * A set of strings compiled to be searched for all at once.
+ */
+typedef struct _Edi_Search_Patterns Edi_Search_Patterns;
+
+/**
+ * @brief Project search functions.
+ * @defgroup Search
+ *
+ * @{
+ *
+ * Walking the project tree and scanning its files in parallel.
+ *
+ */
+
+/**
+ * Walk the project tree and scan every file that is not hidden or ignored.
+ * A single walker feeds the files to a work-stealing pool of scanner threads
+ * sized to the number of cores. This call blocks until every file has been
+ * scanned or the search has been cancelled.
+ *
+ * @param directory The directory to walk.
+ * @param thread The thread running the search, checked for cancellation.
+ * @param file_cb The function that will scan each file.
+ * @param data User data passed to @p file_cb.
+ *
+ * @ingroup Search
+ */
+void edi_search_project_run(const char *directory, Ecore_Thread *thread,
+                            Edi_Search_File_Cb file_cb, const void *data);
+
+/**
+ * Scan a list of files with the same pool of scanner threads used by
+ * edi_search_project_run(). This call blocks until every file has been
+ * scanned or the search has been cancelled.
+ *
+ * @param paths A list of absolute paths to scan.
+ * @param thread The thread running the search, checked for cancellation.
+ * @param file_cb The function that will scan each file.
+ * @param data User data passed to @p file_cb.
+ *
+ * @ingroup Search
+ */
+void edi_search_files_run(Eina_List *paths, Ecore_Thread *thread,
+                          Edi_Search_File_Cb file_cb, const void *data);
+
+/**
+ * Check if a file would be skipped when walking a directory, either because
+ * of its type or because it, or one of its parents, is hidden.
+ *
+ * @param directory The directory being walked.
+ * @param path The absolute path of the file to check.
+ *
+ * @return Whether the file should be skipped. Files outside @p directory
+ *         are always skipped.
+ *
+ * @ingroup Search
+ */
+Eina_Bool edi_search_path_ignored(const char *directory, const char *path);
+
+/**
+ * Find the first occurrence of a string within a block of memory.
+ * Candidates are filtered on their first and last byte with the widest
+ * vector instructions the CPU supports (SSE2 or AVX2), picked at runtime.
+ *
+ * @param haystack The memory to search.
+ * @param length The length of @p haystack.
+ * @param needle The string to look for.
+ * @param needle_length The length of @p needle.
+ *
+ * @return A pointer to the first match within @p haystack or NULL if not found.
+ *
+ * @ingroup Search
+ */
+const char *edi_search_find(const char *haystack, size_t length,
+                            const char *needle, size_t needle_length);
+
+/**
+ * Compile a set of strings into an Aho-Corasick automaton, so they can all
+ * be searched for in a single pass over the text.
+ *
+ * @param patterns A list of strings, empty strings are ignored.
+ *
+ * @return The compiled patterns, or NULL if there is nothing to search for.
+ *
+ * @ingroup Search
+ */
+Edi_Search_Patterns *edi_search_patterns_new(Eina_List *patterns);
+
+/**
+ * Free a set of patterns compiled by edi_search_patterns_new().
+ *
+ * @param patterns The patterns to free.
+ *
+ * @ingroup Search
+ */
+void edi_search_patterns_free(Edi_Search_Patterns *patterns);
+
+/**
+ * Get the length of the longest string in a set of patterns.
+ *
+ * @param patterns The compiled patterns.
+ *
+ * @return The length of the longest pattern.
+ *
+ * @ingroup Search
+ */
+size_t edi_search_patterns_length_max(const Edi_Search_Patterns *patterns);
+
+/**
+ * Find the first occurrence of any of a set of strings within a block of memory.
+ *
+ * @param patterns The compiled patterns to look for.
+ * @param haystack The memory to search.
+ * @param length The length of @p haystack.
+ *
+ * @return A pointer to the start of the first match to end within
+ *         @p haystack or NULL if not found.
+ *
+ * @ingroup Search
+ */
+const char *edi_search_patterns_find(const Edi_Search_Patterns *patterns,
+                                     const char *haystack, size_t length);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDI_SEARCH_H_ */
@@ -0,0 +1,1218 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sys/stat.h>
+
+#include <Eina.h>
+#include <Eet.h>
+#include <Ecore.h>
+#include <Ecore_File.h>
+#include <Eio.h>
+
+#include "edi_search_index.h"
+#include "edi_search.h"
+#include "edi_index_file.h"
+#include "edi_ignore.h"
+#include "edi_config.h"
+
+#include "edi_private.h"
+
+#define EDI_SEARCH_INDEX_NAME "search.idx"
+#define EDI_SEARCH_INDEX_VERSION 1
+
+// Larger files are not indexed, they are always searched.
+#define EDI_SEARCH_INDEX_FILE_MAX (4 * 1024 * 1024)
+// How many changed files are kept in memory before the table is rewritten.
+#define EDI_SEARCH_INDEX_DELTA_MAX 1024
+#define EDI_SEARCH_INDEX_UPDATE_DELAY 0.5
+
+#define EDI_SEARCH_INDEX_FILE_UNINDEXED 1
+#define EDI_SEARCH_INDEX_FILE_REMOVED   2
+
+/*
+ * The table maps every trigram found in the project to the list of files
+ * containing it. File ids in a list are ascending and stored as varint
+ * encoded deltas, which keeps the table compact on disk and in memory.
+ */
+typedef struct
+{
+   unsigned int trigram;
+   unsigned int offset, length;
+} Edi_Search_Index_Entry;
+
+typedef struct
+{
+   unsigned int path;
+   unsigned int flags;
+   long long mtime, size;
+} Edi_Search_Index_File;
+
+typedef struct
+{
+   Edi_Search_Index_File *files;
+   unsigned int file_count;
+   char *paths;
+   unsigned int paths_size;
+   Edi_Search_Index_Entry *entries;
+   unsigned int entry_count;
+   unsigned char *postings;
+   unsigned int postings_size;
+} Edi_Search_Index_Table;
+
+// A file that changed since the table was written.
+typedef struct
+{
+   unsigned int *trigrams;
+   unsigned int count;
+   long long mtime, size;
+   Eina_Bool unindexed;
+} Edi_Search_Index_Delta;
+
+typedef struct
+{
+   char *directory;
+   char *filename;
+
+   Edi_Search_Index_Table table;
+   Eina_Hash *ids;
+   Eina_Hash *delta;
+   unsigned int removed;
+   Eina_Bool ready, stale;
+
+   Ecore_Thread *thread;
+   Ecore_Timer *timer;
+   Eina_List *pending;
+   Eina_List *handlers;
+   Eina_Hash *monitors; /**< Every directory of the project, watched from the main loop */
+   Eina_List *directories; /**< Directories found by the open thread, to be watched */
+} Edi_Search_Index;
+
+typedef struct
+{
+   unsigned char *data;
+   unsigned int length, size;
+   unsigned int last;
+} Edi_Search_Index_Posting;
+
+typedef struct
+{
+   Eina_Lock lock;
+   Eina_Hash *postings;
+   Eina_Inarray *files;
+   Eina_Binbuf *paths;
+   Eina_Bool failed; /**< Some file could not be added, the table would miss matches */
+} Edi_Search_Index_Builder;
+
+typedef struct
+{
+   Edi_Search_Index *index;
+   Edi_Search_Index_Builder *builder;
+   unsigned char *seen;
+} Edi_Search_Index_Walk;
+
+// Directories are queued with a trailing '/' when they are deleted.
+typedef struct
+{
+   Edi_Search_Index *index;
+   Eina_List *paths;
+   Eina_List *directories;
+} Edi_Search_Index_Update;
+
+static Edi_Search_Index *_index = NULL;
+static Eina_Lock _index_lock;
+static Eina_Bool _index_lock_ready = EINA_FALSE;
+
+static int
+_edi_search_index_trigram_cmp(const void *a, const void *b)
+{
+   unsigned int t1 = *(const unsigned int *) a, t2 = *(const unsigned int *) b;
+
+   return (t1 > t2) - (t1 < t2);
+}
+
+static unsigned int
+_edi_search_index_trigrams_get(const unsigned char *text, size_t length, unsigned int *trigrams)
+{
+   size_t i, count;
+
+   if (length < 3) return 0;
+
+   for (i = 0; i < length - 2; i++)
+     trigrams[i] = (text[i] << 16) | (text[i + 1] << 8) | text[i + 2];
+
+   qsort(trigrams, length - 2, sizeof(unsigned int), _edi_search_index_trigram_cmp);
+   for (i = 1, count = 1; i < length - 2; i++)
+     if (trigrams[i] != trigrams[count - 1])
+       trigrams[count++] = trigrams[i];
+
+   return count;
+}
+
+static unsigned int *
+_edi_search_index_file_trigrams_get(const char *path, unsigned int *count, Eina_Bool *unindexed)
+{
+   Eina_File *file;
+   unsigned char *map;
+   unsigned int *trigrams = NULL;
+   size_t length;
+
+   *count = 0;
+   *unindexed = EINA_FALSE;
+
+   file = eina_file_open(path, EINA_FALSE);
+   if (!file) return NULL;
+
+   length = eina_file_size_get(file);
+   if (length > EDI_SEARCH_INDEX_FILE_MAX)
+     {
+        *unindexed = EINA_TRUE;
+        eina_file_close(file);
+        return NULL;
+     }
+
+   // Too short to contain any trigram, so it can not match any indexed query.
+   if (length < 3)
+     {
+        eina_file_close(file);
+        return NULL;
+     }
+
+   map = eina_file_map_all(file, EINA_FILE_SEQUENTIAL);
+   if (map)
+     trigrams = malloc((length - 2) * sizeof(unsigned int));
+
+   if (trigrams)
+     *count = _edi_search_index_trigrams_get(map, length, trigrams);
+   else
+     *unindexed = EINA_TRUE;
+
+   if (map)
+     eina_file_map_free(file, map);
+   eina_file_close(file);
+
+   return trigrams;
+}
+
+static Eina_Bool
+_edi_search_index_trigrams_contain(const unsigned int *trigrams, unsigned int count,
+                                   const unsigned int *query, unsigned int query_count)
+{
+   unsigned int i;
+
+   for (i = 0; i < query_count; i++)
+     if (!bsearch(&query[i], trigrams, count, sizeof(unsigned int), _edi_search_index_trigram_cmp))
+       return EINA_FALSE;
+
+   return EINA_TRUE;
+}
+
+static Eina_Bool
+_edi_search_index_posting_append(Edi_Search_Index_Posting *posting, unsigned int id)
+{
+   unsigned int value;
+
+   if (posting->length + 5 > posting->size)
+     {
+        unsigned char *data;
+        unsigned int size;
+
+        size = posting->size ? posting->size * 2 : 8;
+        data = realloc(posting->data, size);
+        if (!data) return EINA_FALSE;
+
+        posting->data = data;
+        posting->size = size;
+     }
+
+   value = id - posting->last;
+   while (value >= 0x80)
+     {
+        posting->data[posting->length++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+     }
+   posting->data[posting->length++] = value;
+   posting->last = id;
+
+   return EINA_TRUE;
+}
+
+static unsigned int
+_edi_search_index_posting_decode(const unsigned char *data, unsigned int length, unsigned int *ids)
+{
+   unsigned int i = 0, count = 0, id = 0;
+
+   while (i < length)
+     {
+        unsigned int value = 0, shift = 0;
+
+        while (i < length && data[i] & 0x80)
+          {
+             value |= (data[i++] & 0x7f) << shift;
+             shift += 7;
+          }
+        if (i < length)
+          value |= data[i++] << shift;
+
+        id += value;
+        ids[count++] = id;
+     }
+
+   return count;
+}
+
+static unsigned int
+_edi_search_index_ids_intersect(unsigned int *ids, unsigned int count,
+                                const unsigned int *other, unsigned int other_count)
+{
+   unsigned int i = 0, j = 0, n = 0;
+
+   while (i < count && j < other_count)
+     {
+        if (ids[i] < other[j])
+          i++;
+        else if (ids[i] > other[j])
+          j++;
+        else
+          {
+             ids[n++] = ids[i++];
+             j++;
+          }
+     }
+
+   return n;
+}
+
+static void
+_edi_search_index_posting_free(void *data)
+{
+   Edi_Search_Index_Posting *posting = data;
+
+   free(posting->data);
+   free(posting);
+}
+
+static void
+_edi_search_index_delta_free(void *data)
+{
+   Edi_Search_Index_Delta *delta = data;
+
+   free(delta->trigrams);
+   free(delta);
+}
+
+static void
+_edi_search_index_table_free(Edi_Search_Index_Table *table)
+{
+   free(table->files);
+   free(table->paths);
+   free(table->entries);
+   free(table->postings);
+   memset(table, 0, sizeof(Edi_Search_Index_Table));
+}
+
+static void
+_edi_search_index_builder_init(Edi_Search_Index_Builder *builder)
+{
+   eina_lock_new(&builder->lock);
+   builder->postings = eina_hash_int32_new(_edi_search_index_posting_free);
+   builder->files = eina_inarray_new(sizeof(Edi_Search_Index_File), 256);
+   builder->paths = eina_binbuf_new();
+}
+
+static void
+_edi_search_index_builder_shutdown(Edi_Search_Index_Builder *builder)
+{
+   eina_hash_free(builder->postings);
+   eina_inarray_free(builder->files);
+   eina_binbuf_free(builder->paths);
+   eina_lock_free(&builder->lock);
+}
+
+static Edi_Search_Index_Posting *
+_edi_search_index_builder_posting_get(Edi_Search_Index_Builder *builder, unsigned int trigram)
+{
+   Edi_Search_Index_Posting *posting;
+
+   posting = eina_hash_find(builder->postings, &trigram);
+   if (posting) return posting;
+
+   posting = calloc(1, sizeof(Edi_Search_Index_Posting));
+   if (posting)
+     eina_hash_add(builder->postings, &trigram, posting);
+
+   return posting;
+}
+
+static void
+_edi_search_index_builder_posting_append(Edi_Search_Index_Builder *builder, unsigned int trigram,
+                                         unsigned int id)
+{
+   Edi_Search_Index_Posting *posting;
+
+   posting = _edi_search_index_builder_posting_get(builder, trigram);
+   if (!posting || !_edi_search_index_posting_append(posting, id))
+     builder->failed = EINA_TRUE;
+}
+
+// Files must be added in the order of their ids, keeping every posting list sorted.
+static unsigned int
+_edi_search_index_builder_file_add(Edi_Search_Index_Builder *builder, const char *path,
+                                   long long mtime, long long size, unsigned int flags,
+                                   const unsigned int *trigrams, unsigned int count)
+{
+   Edi_Search_Index_File file;
+   unsigned int i, id;
+
+   id = eina_inarray_count(builder->files);
+
+   file.path = eina_binbuf_length_get(builder->paths);
+   file.flags = flags;
+   file.mtime = mtime;
+   file.size = size;
+   eina_inarray_push(builder->files, &file);
+   eina_binbuf_append_length(builder->paths, (const unsigned char *) path, strlen(path) + 1);
+
+   for (i = 0; i < count; i++)
+     _edi_search_index_builder_posting_append(builder, trigrams[i], id);
+
+   return id;
+}
+
+typedef struct
+{
+   unsigned int trigram;
+   Edi_Search_Index_Posting *posting;
+} Edi_Search_Index_Builder_Entry;
+
+static Eina_Bool
+_edi_search_index_builder_entry_collect(const Eina_Hash *hash EINA_UNUSED, const void *key,
+                                        void *data, void *fdata)
+{
+   Edi_Search_Index_Builder_Entry **entry = fdata;
+
+   (*entry)->trigram = *(const unsigned int *) key;
+   (*entry)->posting = data;
+   (*entry)++;
+
+   return EINA_TRUE;
+}
+
+static void
+_edi_search_index_builder_finish(Edi_Search_Index_Builder *builder, Edi_Search_Index_Table *table)
+{
+   Edi_Search_Index_Builder_Entry *entries, *entry;
+   unsigned int i, offset = 0;
+
+   memset(table, 0, sizeof(Edi_Search_Index_Table));
+
+   table->file_count = eina_inarray_count(builder->files);
+   if (table->file_count)
+     {
+        table->files = malloc(table->file_count * sizeof(Edi_Search_Index_File));
+        memcpy(table->files, eina_inarray_nth(builder->files, 0),
+               table->file_count * sizeof(Edi_Search_Index_File));
+     }
+
+   table->paths_size = eina_binbuf_length_get(builder->paths);
+   table->paths = (char *) eina_binbuf_string_steal(builder->paths);
+
+   table->entry_count = eina_hash_population(builder->postings);
+   if (!table->entry_count) return;
+
+   entries = entry = malloc(table->entry_count * sizeof(Edi_Search_Index_Builder_Entry));
+   eina_hash_foreach(builder->postings, _edi_search_index_builder_entry_collect, &entry);
+   qsort(entries, table->entry_count, sizeof(Edi_Search_Index_Builder_Entry),
+         _edi_search_index_trigram_cmp);
+
+   for (i = 0; i < table->entry_count; i++)
+     table->postings_size += entries[i].posting->length;
+
+   table->entries = malloc(table->entry_count * sizeof(Edi_Search_Index_Entry));
+   table->postings = malloc(table->postings_size ? table->postings_size : 1);
+   for (i = 0; i < table->entry_count; i++)
+     {
+        Edi_Search_Index_Posting *posting = entries[i].posting;
+
+        table->entries[i].trigram = entries[i].trigram;
+        table->entries[i].offset = offset;
+        table->entries[i].length = posting->length;
+        if (posting->length)
+          memcpy(table->postings + offset, posting->data, posting->length);
+        offset += posting->length;
+     }
+
+   free(entries);
+}
+
+static Eina_Bool
+_edi_search_index_table_write(Edi_Search_Index_Table *table, const char *filename,
+                              const char *directory)
+{
+   Eet_File *ef;
+   Eina_Bool ok;
+
+   ef = edi_index_file_write_begin(filename, EDI_SEARCH_INDEX_VERSION, directory);
+   if (!ef)
+     return EINA_FALSE;
+
+   ok = (!table->file_count ||
+         (eet_write(ef, "files", table->files, table->file_count * sizeof(Edi_Search_Index_File),
+                    EET_COMPRESSION_VERYFAST) &&
+          eet_write(ef, "paths", table->paths, table->paths_size, EET_COMPRESSION_VERYFAST))) &&
+        (!table->entry_count ||
+         (eet_write(ef, "trigrams", table->entries, table->entry_count * sizeof(Edi_Search_Index_Entry),
+                    EET_COMPRESSION_VERYFAST) &&
+          eet_write(ef, "postings", table->postings, table->postings_size, EET_COMPRESSION_VERYFAST)));
+
+   return edi_index_file_write_end(ef, filename, ok);
+}
+
+static Eina_Bool
+_edi_search_index_table_read(Edi_Search_Index_Table *table, const char *filename,
+                             const char *directory)
+{
+   Eet_File *ef;
+   int size;
+   unsigned int i;
+   Eina_Bool ok = EINA_TRUE;
+
+   memset(table, 0, sizeof(Edi_Search_Index_Table));
+
+   ef = edi_index_file_open(filename, EDI_SEARCH_INDEX_VERSION, directory);
+   if (!ef) return EINA_FALSE;
+
+   table->files = eet_read(ef, "files", &size);
+   table->file_count = size / sizeof(Edi_Search_Index_File);
+   table->paths = eet_read(ef, "paths", &size);
+   table->paths_size = size;
+   table->entries = eet_read(ef, "trigrams", &size);
+   table->entry_count = size / sizeof(Edi_Search_Index_Entry);
+   table->postings = eet_read(ef, "postings", &size);
+   table->postings_size = size;
+   eet_close(ef);
+
+   // Validate every offset so a damaged file is rebuilt rather than trusted.
+   if (table->file_count && (!table->paths || table->paths[table->paths_size - 1]))
+     ok = EINA_FALSE;
+   for (i = 0; ok && i < table->file_count; i++)
+     if (table->files[i].path >= table->paths_size)
+       ok = EINA_FALSE;
+   for (i = 0; ok && i < table->entry_count; i++)
+     if (table->entries[i].offset > table->postings_size ||
+         table->entries[i].length > table->postings_size - table->entries[i].offset ||
+         (i && table->entries[i].trigram <= table->entries[i - 1].trigram))
+       ok = EINA_FALSE;
+
+   if (!ok)
+     {
+        WRN("Ignoring damaged search index %s", filename);
+        _edi_search_index_table_free(table);
+     }
+
+   return ok;
+}
+
+// Replace the table, dropping the changes it now includes. Called with the lock held.
+static void
+_edi_search_index_table_set(Edi_Search_Index *index, Edi_Search_Index_Table *table)
+{
+   unsigned int i;
+
+   eina_hash_free_buckets(index->ids);
+   eina_hash_free_buckets(index->delta);
+   _edi_search_index_table_free(&index->table);
+
+   index->table = *table;
+   index->removed = 0;
+
+   for (i = 0; i < table->file_count; i++)
+     eina_hash_direct_add(index->ids, table->paths + table->files[i].path,
+                          (void *) (uintptr_t) (i + 1));
+}
+
+static void
+_edi_search_index_stale_set(Edi_Search_Index *index)
+{
+   ERR("Search index of %s is out of date, searching every file", index->directory);
+
+   eina_lock_take(&_index_lock);
+   index->ready = EINA_FALSE;
+   index->stale = EINA_TRUE;
+   eina_lock_release(&_index_lock);
+}
+
+/*
+ * Write the table again with the changed files merged in. Only the index
+ * thread changes the index and searches only read it, so it is read here
+ * without the lock, which is only taken to swap the tables.
+ */
+static void
+_edi_search_index_compact(Edi_Search_Index *index)
+{
+   Edi_Search_Index_Builder builder;
+   Edi_Search_Index_Table table;
+   Eina_Hash_Tuple *tuple;
+   Eina_Iterator *it;
+   unsigned int *map, *ids = NULL;
+   unsigned int i, j, count, size = 0;
+
+   _edi_search_index_builder_init(&builder);
+
+   map = malloc((index->table.file_count + 1) * sizeof(unsigned int));
+   for (i = 0; i < index->table.file_count; i++)
+     {
+        Edi_Search_Index_File *file = &index->table.files[i];
+
+        if (file->flags & EDI_SEARCH_INDEX_FILE_REMOVED)
+          map[i] = UINT_MAX;
+        else
+          map[i] = _edi_search_index_builder_file_add(&builder, index->table.paths + file->path,
+                                                      file->mtime, file->size, file->flags, NULL, 0);
+     }
+
+   for (i = 0; i < index->table.entry_count; i++)
+     {
+        Edi_Search_Index_Entry *entry = &index->table.entries[i];
+
+        if (entry->length > size)
+          {
+             unsigned int *grown;
+
+             grown = realloc(ids, entry->length * sizeof(unsigned int));
+             if (!grown)
+               {
+                  builder.failed = EINA_TRUE;
+                  break;
+               }
+             ids = grown;
+             size = entry->length;
+          }
+
+        count = _edi_search_index_posting_decode(index->table.postings + entry->offset,
+                                                 entry->length, ids);
+        for (j = 0; j < count; j++)
+          {
+             if (ids[j] >= index->table.file_count || map[ids[j]] == UINT_MAX)
+               continue;
+
+             _edi_search_index_builder_posting_append(&builder, entry->trigram, map[ids[j]]);
+          }
+     }
+   free(ids);
+   free(map);
+
+   it = eina_hash_iterator_tuple_new(index->delta);
+   EINA_ITERATOR_FOREACH(it, tuple)
+     {
+        Edi_Search_Index_Delta *delta = tuple->data;
+
+        _edi_search_index_builder_file_add(&builder, tuple->key, delta->mtime, delta->size,
+                                           delta->unindexed ? EDI_SEARCH_INDEX_FILE_UNINDEXED : 0,
+                                           delta->trigrams, delta->count);
+     }
+   eina_iterator_free(it);
+
+   if (builder.failed)
+     {
+        _edi_search_index_builder_shutdown(&builder);
+        _edi_search_index_stale_set(index);
+        return;
+     }
+
+   _edi_search_index_builder_finish(&builder, &table);
+   _edi_search_index_builder_shutdown(&builder);
+
+   eina_lock_take(&_index_lock);
+   _edi_search_index_table_set(index, &table);
+   eina_lock_release(&_index_lock);
+
+   _edi_search_index_table_write(&index->table, index->filename, index->directory);
+}
+
+static void
+_edi_search_index_file_update(Edi_Search_Index *index, const char *path, unsigned char *seen)
+{
+   Edi_Search_Index_Delta *delta;
+   struct stat st;
+   const char *relative;
+   unsigned int id;
+   Eina_Bool exists;
+
+   // Paths come from the walker or the event handlers, both skip ignored files.
+   exists = !stat(path, &st) && S_ISREG(st.st_mode);
+   relative = path + strlen(index->directory) + 1;
+
+   eina_lock_take(&_index_lock);
+   id = (uintptr_t) eina_hash_find(index->ids, relative);
+   if (id)
+     {
+        Edi_Search_Index_File *file = &index->table.files[id - 1];
+
+        if (seen) seen[id - 1] = 1;
+
+        if (!(file->flags & EDI_SEARCH_INDEX_FILE_REMOVED))
+          {
+             if (exists && file->mtime == st.st_mtime && file->size == st.st_size)
+               {
+                  eina_lock_release(&_index_lock);
+                  return;
+               }
+
+             file->flags |= EDI_SEARCH_INDEX_FILE_REMOVED;
+             index->removed++;
+          }
+     }
+
+   delta = eina_hash_find(index->delta, relative);
+   if (delta && exists && delta->mtime == st.st_mtime && delta->size == st.st_size)
+     {
+        eina_lock_release(&_index_lock);
+        return;
+     }
+   if (!exists)
+     eina_hash_del_by_key(index->delta, relative);
+   eina_lock_release(&_index_lock);
+
+   if (!exists) return;
+
+   // Read the file without holding the lock, searches can carry on meanwhile.
+   delta = calloc(1, sizeof(Edi_Search_Index_Delta));
+   delta->mtime = st.st_mtime;
+   delta->size = st.st_size;
+   delta->trigrams = _edi_search_index_file_trigrams_get(path, &delta->count, &delta->unindexed);
+
+   eina_lock_take(&_index_lock);
+   delta = eina_hash_set(index->delta, relative, delta);
+   eina_lock_release(&_index_lock);
+
+   if (delta)
+     _edi_search_index_delta_free(delta);
+}
+
+static void
+_edi_search_index_build_file_cb(void *data, const char *path)
+{
+   Edi_Search_Index_Walk *walk = data;
+   unsigned int *trigrams, count;
+   struct stat st;
+   Eina_Bool unindexed;
+
+   // Stat before reading so a file changing meanwhile is found stale later.
+   if (stat(path, &st)) return;
+
+   trigrams = _edi_search_index_file_trigrams_get(path, &count, &unindexed);
+
+   eina_lock_take(&walk->builder->lock);
+   _edi_search_index_builder_file_add(walk->builder, path + strlen(walk->index->directory) + 1,
+                                      st.st_mtime, st.st_size,
+                                      unindexed ? EDI_SEARCH_INDEX_FILE_UNINDEXED : 0,
+                                      trigrams, count);
+   eina_lock_release(&walk->builder->lock);
+
+   free(trigrams);
+}
+
+static void
+_edi_search_index_refresh_file_cb(void *data, const char *path)
+{
+   Edi_Search_Index_Walk *walk = data;
+
+   _edi_search_index_file_update(walk->index, path, walk->seen);
+}
+
+static void
+_edi_search_index_directory_cb(void *data, const char *path)
+{
+   Eina_List **directories = data;
+
+   *directories = eina_list_append(*directories, eina_stringshare_add(path));
+}
+
+// Forget the files below a directory that was deleted, path ends with a '/'.
+static void
+_edi_search_index_directory_remove(Edi_Search_Index *index, const char *path)
+{
+   Eina_Iterator *it;
+   Eina_List *keys = NULL;
+   const char *relative, *key;
+   unsigned int i;
+   size_t length;
+
+   relative = path + strlen(index->directory) + 1;
+   length = strlen(relative);
+
+   eina_lock_take(&_index_lock);
+   for (i = 0; i < index->table.file_count; i++)
+     {
+        Edi_Search_Index_File *file = &index->table.files[i];
+
+        if (file->flags & EDI_SEARCH_INDEX_FILE_REMOVED ||
+            strncmp(index->table.paths + file->path, relative, length))
+          continue;
+
+        file->flags |= EDI_SEARCH_INDEX_FILE_REMOVED;
+        index->removed++;
+     }
+
+   it = eina_hash_iterator_key_new(index->delta);
+   EINA_ITERATOR_FOREACH(it, key)
+     if (!strncmp(key, relative, length))
+       keys = eina_list_append(keys, key);
+   eina_iterator_free(it);
+
+   EINA_LIST_FREE(keys, key)
+     eina_hash_del_by_key(index->delta, key);
+   eina_lock_release(&_index_lock);
+}
+
+static void
+_edi_search_index_build(Edi_Search_Index *index, Ecore_Thread *thread)
+{
+   Edi_Search_Index_Builder builder;
+   Edi_Search_Index_Table table;
+   Edi_Search_Index_Walk walk = { index, &builder, NULL };
+
+   INF("Building search index for %s", index->directory);
+
+   _edi_search_index_builder_init(&builder);
+   edi_search_project_run(index->directory, thread, _edi_search_index_build_file_cb, &walk);
+
+   if (builder.failed)
+     _edi_search_index_stale_set(index);
+   else if (!ecore_thread_check(thread))
+     {
+        _edi_search_index_builder_finish(&builder, &table);
+
+        eina_lock_take(&_index_lock);
+        _edi_search_index_table_set(index, &table);
+        eina_lock_release(&_index_lock);
+
+        _edi_search_index_table_write(&index->table, index->filename, index->directory);
+     }
+
+   _edi_search_index_builder_shutdown(&builder);
+}
+
+static void
+_edi_search_index_refresh(Edi_Search_Index *index, Ecore_Thread *thread)
+{
+   Edi_Search_Index_Walk walk = { index, NULL, NULL };
+   unsigned int i;
+
+   walk.seen = calloc(index->table.file_count + 1, sizeof(unsigned char));
+   edi_search_project_run(index->directory, thread, _edi_search_index_refresh_file_cb, &walk);
+
+   // Anything the walker did not find was deleted while we were not looking.
+   eina_lock_take(&_index_lock);
+   for (i = 0; !ecore_thread_check(thread) && i < index->table.file_count; i++)
+     {
+        Edi_Search_Index_File *file = &index->table.files[i];
+
+        if (walk.seen[i] || file->flags & EDI_SEARCH_INDEX_FILE_REMOVED)
+          continue;
+
+        file->flags |= EDI_SEARCH_INDEX_FILE_REMOVED;
+        index->removed++;
+     }
+   eina_lock_release(&_index_lock);
+
+   free(walk.seen);
+}
+
+static void
+_edi_search_index_open_cb(void *data, Ecore_Thread *thread)
+{
+   Edi_Search_Index *index = data;
+   Edi_Search_Index_Table table;
+
+   if (_edi_search_index_table_read(&table, index->filename, index->directory))
+     {
+        eina_lock_take(&_index_lock);
+        _edi_search_index_table_set(index, &table);
+        eina_lock_release(&_index_lock);
+
+        _edi_search_index_refresh(index, thread);
+     }
+   else
+     _edi_search_index_build(index, thread);
+
+   if (ecore_thread_check(thread)) return;
+
+   // Files changed outside of the editor are only seen if their directory is watched.
+   edi_ignore_directories_walk(index->directory, thread, _edi_search_index_directory_cb,
+                               &index->directories);
+
+   if (index->removed || eina_hash_population(index->delta))
+     _edi_search_index_compact(index);
+
+   eina_lock_take(&_index_lock);
+   index->ready = !index->stale;
+   eina_lock_release(&_index_lock);
+
+   INF("Search index ready with %d files", index->table.file_count);
+}
+
+static Eina_Bool _edi_search_index_update_timer_cb(void *data);
+
+static void
+_edi_search_index_thread_end(Edi_Search_Index *index)
+{
+   index->thread = NULL;
+
+   if (index->pending && !index->timer)
+     index->timer = ecore_timer_add(EDI_SEARCH_INDEX_UPDATE_DELAY,
+                                    _edi_search_index_update_timer_cb, index);
+}
+
+static void
+_edi_search_index_monitors_add(Edi_Search_Index *index, Eina_List **directories)
+{
+   const char *directory;
+   Eio_Monitor *monitor;
+
+   EINA_LIST_FREE(*directories, directory)
+     {
+        if (!eina_hash_find(index->monitors, directory))
+          {
+             monitor = eio_monitor_add(directory);
+             if (monitor)
+               eina_hash_add(index->monitors, directory, monitor);
+          }
+        eina_stringshare_del(directory);
+     }
+}
+
+static void
+_edi_search_index_monitors_del(Edi_Search_Index *index, const char *directory)
+{
+   Eina_Iterator *it;
+   Eina_List *keys = NULL;
+   const char *key;
+   size_t length;
+
+   length = strlen(directory);
+   it = eina_hash_iterator_key_new(index->monitors);
+   EINA_ITERATOR_FOREACH(it, key)
+     if (!strncmp(key, directory, length) && (!key[length] || key[length] == '/'))
+       keys = eina_list_append(keys, key);
+   eina_iterator_free(it);
+
+   EINA_LIST_FREE(keys, key)
+     eina_hash_del_by_key(index->monitors, key);
+}
+
+static void
+_edi_search_index_open_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Search_Index *index = data;
+
+   _edi_search_index_monitors_add(index, &index->directories);
+   _edi_search_index_thread_end(index);
+}
+
+static void
+_edi_search_index_update_cb(void *data, Ecore_Thread *thread)
+{
+   Edi_Search_Index_Update *update = data;
+   Edi_Search_Index *index = update->index;
+   Edi_Search_Index_Walk walk = { index, NULL, NULL };
+   const char *path;
+   Eina_List *l;
+
+   EINA_LIST_FOREACH(update->paths, l, path)
+     {
+        if (path[strlen(path) - 1] == '/')
+          _edi_search_index_directory_remove(index, path);
+        else if (ecore_file_is_dir(path))
+          {
+             // A new directory, its files are indexed and it is watched as well.
+             edi_search_project_run(path, thread, _edi_search_index_refresh_file_cb, &walk);
+             edi_ignore_directories_walk(path, thread, _edi_search_index_directory_cb,
+                                         &update->directories);
+          }
+        else
+          _edi_search_index_file_update(index, path, NULL);
+
+        if (ecore_thread_check(thread)) return;
+     }
+
+   if (eina_hash_population(index->delta) > EDI_SEARCH_INDEX_DELTA_MAX ||
+       index->removed > index->table.file_count / 4 + EDI_SEARCH_INDEX_DELTA_MAX)
+     _edi_search_index_compact(index);
+}
+
+static void
+_edi_search_index_update_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Search_Index_Update *update = data;
+   const char *path;
+
+   _edi_search_index_monitors_add(update->index, &update->directories);
+   _edi_search_index_thread_end(update->index);
+
+   EINA_LIST_FREE(update->paths, path)
+     eina_stringshare_del(path);
+   free(update);
+}
+
+static Eina_Bool
+_edi_search_index_update_timer_cb(void *data)
+{
+   Edi_Search_Index *index = data;
+   Edi_Search_Index_Update *update;
+
+   // Changes arriving while the index is busy are picked up once it is done.
+   if (index->thread)
+     return ECORE_CALLBACK_RENEW;
+
+   index->timer = NULL;
+
+   update = calloc(1, sizeof(Edi_Search_Index_Update));
+   update->index = index;
+   update->paths = index->pending;
+   index->pending = NULL;
+
+   index->thread = ecore_thread_run(_edi_search_index_update_cb, _edi_search_index_update_end_cb,
+                                    _edi_search_index_update_end_cb, update);
+
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static Eina_Bool
+_edi_search_index_file_changed_cb(void *data EINA_UNUSED, int type, void *event)
+{
+   const char *path;
+   size_t length;
+
+   if (!_index) return ECORE_CALLBACK_PASS_ON;
+
+   if (type == EDI_EVENT_FILE_SAVED)
+     path = event;
+   else
+     path = ((Eio_Monitor_Event *) event)->filename;
+
+   if (type == EIO_MONITOR_DIRECTORY_CREATED || type == EIO_MONITOR_DIRECTORY_DELETED)
+     {
+        length = strlen(_index->directory);
+        if (strncmp(path, _index->directory, length) || path[length] != '/' ||
+            edi_ignore_path_ignored(path, EINA_FILE_DIR))
+          return ECORE_CALLBACK_PASS_ON;
+
+        if (type == EIO_MONITOR_DIRECTORY_DELETED)
+          {
+             _edi_search_index_monitors_del(_index, path);
+             _index->pending = eina_list_append(_index->pending,
+                                                eina_stringshare_printf("%s/", path));
+          }
+        else
+          _index->pending = eina_list_append(_index->pending, eina_stringshare_add(path));
+     }
+   else if (edi_search_path_ignored(_index->directory, path))
+     return ECORE_CALLBACK_PASS_ON;
+   else
+     _index->pending = eina_list_append(_index->pending, eina_stringshare_add(path));
+
+   if (!_index->timer)
+     _index->timer = ecore_timer_add(EDI_SEARCH_INDEX_UPDATE_DELAY,
+                                     _edi_search_index_update_timer_cb, _index);
+
+   return ECORE_CALLBACK_PASS_ON;
+}
+
+void
+edi_search_index_init(void)
+{
+   Edi_Search_Index *index;
+
+   if (_index || !_edi_config->search_index || !edi_project_get())
+     return;
+
+   if (!_index_lock_ready)
+     {
+        eina_lock_new(&_index_lock);
+        _index_lock_ready = EINA_TRUE;
+     }
+
+   index = calloc(1, sizeof(Edi_Search_Index));
+   index->directory = strdup(edi_project_get());
+   index->filename = edi_path_append(_edi_project_config_dir_get(), EDI_SEARCH_INDEX_NAME);
+   index->ids = eina_hash_string_superfast_new(NULL);
+   index->delta = eina_hash_string_superfast_new(_edi_search_index_delta_free);
+
+   // Every directory of the project is watched once the open thread has found them.
+   index->monitors = eina_hash_string_superfast_new(EINA_FREE_CB(eio_monitor_del));
+   index->handlers = eina_list_append(index->handlers,
+      ecore_event_handler_add(EIO_MONITOR_FILE_CREATED, _edi_search_index_file_changed_cb, NULL));
+   index->handlers = eina_list_append(index->handlers,
+      ecore_event_handler_add(EIO_MONITOR_FILE_MODIFIED, _edi_search_index_file_changed_cb, NULL));
+   index->handlers = eina_list_append(index->handlers,
+      ecore_event_handler_add(EIO_MONITOR_FILE_DELETED, _edi_search_index_file_changed_cb, NULL));
+   index->handlers = eina_list_append(index->handlers,
+      ecore_event_handler_add(EIO_MONITOR_DIRECTORY_CREATED, _edi_search_index_file_changed_cb, NULL));
+   index->handlers = eina_list_append(index->handlers,
+      ecore_event_handler_add(EIO_MONITOR_DIRECTORY_DELETED, _edi_search_index_file_changed_cb, NULL));
+   index->handlers = eina_list_append(index->handlers,
+      ecore_event_handler_add(EDI_EVENT_FILE_SAVED, _edi_search_index_file_changed_cb, NULL));
+
+   eina_lock_take(&_index_lock);
+   _index = index;
+   eina_lock_release(&_index_lock);
+
+   index->thread = ecore_thread_run(_edi_search_index_open_cb, _edi_search_index_open_end_cb,
+                                    _edi_search_index_open_end_cb, index);
+}
+
+void
+edi_search_index_shutdown(void)
+{
+   Edi_Search_Index *index = _index;
+   Ecore_Event_Handler *handler;
+   const char *path;
+
+   if (!index) return;
+
+   EINA_LIST_FREE(index->handlers, handler)
+     ecore_event_handler_del(handler);
+   if (index->timer)
+     ecore_timer_del(index->timer);
+   index->timer = NULL;
+   EINA_LIST_FREE(index->pending, path)
+     eina_stringshare_del(path);
+
+   if (index->thread)
+     {
+        ecore_thread_cancel(index->thread);
+        while ((ecore_thread_wait(index->thread, 0.1)) != EINA_TRUE);
+     }
+
+   // Any change not written yet is found again by the refresh on next open.
+   eina_lock_take(&_index_lock);
+   _index = NULL;
+   eina_lock_release(&_index_lock);
+
+   eina_hash_free(index->monitors);
+   EINA_LIST_FREE(index->directories, path)
+     eina_stringshare_del(path);
+   eina_hash_free(index->ids);
+   eina_hash_free(index->delta);
+   _edi_search_index_table_free(&index->table);
+   free(index->directory);
+   free(index->filename);
+   free(index);
+}
+
+static int
+_edi_search_index_query_cmp(const void *a, const void *b)
+{
+   const Edi_Search_Index_Entry *e1 = *(const Edi_Search_Index_Entry **) a;
+   const Edi_Search_Index_Entry *e2 = *(const Edi_Search_Index_Entry **) b;
+
+   return (e1->length > e2->length) - (e1->length < e2->length);
+}
+
+static unsigned int
+_edi_search_index_table_query(Edi_Search_Index_Table *table, const unsigned int *trigrams,
+                              unsigned int count, unsigned int **ids)
+{
+   const Edi_Search_Index_Entry **entries;
+   unsigned int *other, i, found;
+
+   *ids = NULL;
+   entries = malloc(count * sizeof(Edi_Search_Index_Entry *));
+   for (i = 0; i < count; i++)
+     {
+        entries[i] = bsearch(&trigrams[i], table->entries, table->entry_count,
+                             sizeof(Edi_Search_Index_Entry), _edi_search_index_trigram_cmp);
+        if (!entries[i])
+          {
+             free(entries);
+             return 0;
+          }
+     }
+
+   // Start from the rarest trigram so the intersection only shrinks from there.
+   qsort(entries, count, sizeof(Edi_Search_Index_Entry *), _edi_search_index_query_cmp);
+
+   *ids = malloc((entries[0]->length + 1) * sizeof(unsigned int));
+   found = _edi_search_index_posting_decode(table->postings + entries[0]->offset,
+                                            entries[0]->length, *ids);
+
+   other = malloc((entries[count - 1]->length + 1) * sizeof(unsigned int));
+   for (i = 1; found && i < count; i++)
+     {
+        unsigned int other_count;
+
+        other_count = _edi_search_index_posting_decode(table->postings + entries[i]->offset,
+                                                       entries[i]->length, other);
+        found = _edi_search_index_ids_intersect(*ids, found, other, other_count);
+     }
+   free(other);
+   free(entries);
+
+   return found;
+}
+
+Eina_Bool
+edi_search_index_candidates_get(const char *term, Eina_List **paths)
+{
+   Edi_Search_Index *index;
+   Edi_Search_Index_Table *table;
+   Eina_Hash_Tuple *tuple;
+   Eina_Iterator *it;
+   unsigned int *trigrams, *ids, count, found, i;
+   size_t length;
+
+   *paths = NULL;
+
+   length = strlen(term);
+   if (!_index_lock_ready || length < 3)
+     return EINA_FALSE;
+
+   eina_lock_take(&_index_lock);
+   index = _index;
+   if (!index || !index->ready)
+     {
+        eina_lock_release(&_index_lock);
+        return EINA_FALSE;
+     }
+
+   table = &index->table;
+   trigrams = malloc((length - 2) * sizeof(unsigned int));
+   count = _edi_search_index_trigrams_get((const unsigned char *) term, length, trigrams);
+
+   found = _edi_search_index_table_query(table, trigrams, count, &ids);
+   for (i = 0; i < found; i++)
+     {
+        if (ids[i] >= table->file_count ||
+            table->files[ids[i]].flags & EDI_SEARCH_INDEX_FILE_REMOVED)
+          continue;
+
+        *paths = eina_list_append(*paths, edi_path_append(index->directory,
+                                                          table->paths + table->files[ids[i]].path));
+     }
+   free(ids);
+
+   for (i = 0; i < table->file_count; i++)
+     {
+        if (table->files[i].flags == EDI_SEARCH_INDEX_FILE_UNINDEXED)
+          *paths = eina_list_append(*paths, edi_path_append(index->directory,
+                                                            table->paths + table->files[i].path));
+     }
+
+   it = eina_hash_iterator_tuple_new(index->delta);
+   EINA_ITERATOR_FOREACH(it, tuple)
+     {
+        Edi_Search_Index_Delta *delta = tuple->data;
+
+        if (delta->unindexed ||
+            _edi_search_index_trigrams_contain(delta->trigrams, delta->count, trigrams, count))
+          *paths = eina_list_append(*paths, edi_path_append(index->directory, tuple->key));
+     }
+   eina_iterator_free(it);
+
+   eina_lock_release(&_index_lock);
+   free(trigrams);
+
+   return EINA_TRUE;
+}
@@ -0,0 +1,66 @@
+#ifndef EDI_SEARCH_INDEX_H_
+# define EDI_SEARCH_INDEX_H_
+
+#include <Elementary.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief These routines manage the trigram index used to speed up project search.
+ */
+
+/**
+ * @brief Search index functions.
+ * @defgroup Search_Index
+ *
+ * @{
+ *
+ * A trigram index of the project files, stored in the project config
+ * directory and kept current from file monitor and save events.
+ *
+ */
+
+/**
+ * Load the index of the current project, building or refreshing it in the
+ * background. Does nothing if the index is disabled in the settings.
+ *
+ * @ingroup Search_Index
+ */
+void edi_search_index_init(void);
+
+/**
+ * Stop maintaining the index and release it.
+ *
+ * @ingroup Search_Index
+ */
+void edi_search_index_shutdown(void);
+
+/**
+ * Get the files that may contain a search term. Only files containing every
+ * trigram of the term are returned, they still need to be searched to
+ * confirm a match. This can be called from any thread.
+ *
+ * @param term The term that will be searched for.
+ * @param paths Set to a list of absolute paths that should be freed
+ *              by the caller.
+ *
+ * @return EINA_FALSE if the index can not answer the query, either because
+ *         it is not ready yet or because the term is too short, in which case
+ *         all files should be searched.
+ *
+ * @ingroup Search_Index
+ */
+Eina_Bool edi_search_index_candidates_get(const char *term, Eina_List **paths);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDI_SEARCH_INDEX_H_ */
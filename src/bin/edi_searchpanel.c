@@ -9,19 +9,192 @@
 
 #include <string.h>
 #include "edi_file.h"
+#include "edi_regex.h"
+#include "edi_search.h"
+#include "edi_search_index.h"
 #include "edi_searchpanel.h"
 #include "edi_theme.h"
 #include "edi_config.h"
 #include "mainview/edi_mainview.h"
+#include "editor/edi_editor.h"
 
 #include "edi_private.h"
 
 static Evas_Object *_info_widget, *_tasks_widget;
 static Elm_Code *_elm_code, *_tasks_code;
 
-static Ecore_Thread *_search_thread = NULL;
-static Eina_Bool _searching = EINA_FALSE;
-static char *_search_text = NULL;
+// The number of results that can wait for the main loop and the time spent adding them each frame.
+#define EDI_SEARCHPANEL_QUEUE_SIZE 4096
+#define EDI_SEARCHPANEL_FRAME_BUDGET 0.004
+
+// Files larger than two blocks are searched in blocks of this size at least, in parallel.
+#define EDI_SEARCHPANEL_CHUNK_SIZE (1024 * 1024)
+#define EDI_SEARCHPANEL_CHUNK_SIZE_MAX (64 * 1024 * 1024)
+// Files larger than this are only searched if their first bytes look like text.
+#define EDI_SEARCHPANEL_TEXT_CHECK_SIZE (1024 * 1024)
+#define EDI_SEARCHPANEL_TEXT_CHECK_LENGTH 2048
+
+// The hits a scanner queues at once, and the lines shown before files start collapsed.
+#define EDI_SEARCHPANEL_BATCH_SIZE 256
+#define EDI_SEARCHPANEL_LINES_MAX 1000
+
+// The bytes of a matching line kept before its match, and in all.
+#define EDI_SEARCHPANEL_SNIPPET_BEFORE 40
+#define EDI_SEARCHPANEL_SNIPPET_LENGTH 160
+
+// How long typing must pause before a search as you type starts, and the shortest term searched.
+#define EDI_SEARCHPANEL_TYPING_DELAY 0.2
+#define EDI_SEARCHPANEL_TYPING_LENGTH_MIN 2
+
+/*
+ * A search and what it found. The scanner threads only look at the run they
+ * were started for, so a run that is replaced winds down in the background
+ * while the next one starts. Runs are only referenced from the main loop.
+ */
+typedef struct {
+   Elm_Code *logger;
+   unsigned int generation;
+   int refs;
+
+   char *text;
+   Edi_Regex *regex;
+   Edi_Search_Patterns *patterns;
+   Eina_List *tags;
+   Eina_List *paths;
+   Eina_Hash *buffers;
+   time_t started;
+
+   Ecore_Thread *thread;
+   unsigned int count, max;
+   Eina_Bool stopped, capped, cancelled;
+   Eina_Bool running, done, typed;
+} Search_Run;
+
+/*
+ * A block of a large file, cut after a line break so it starts a line. Its
+ * matching lines are numbered from the start of the block, and moved down
+ * by the line breaks of the blocks before it once they are shown.
+ */
+typedef struct {
+   const char *start, *end;
+   Eina_List *lines;
+   unsigned int breaks;
+   Eina_Bool done;
+} Search_Chunk;
+
+typedef struct {
+   Eina_File_Line line;
+   const char *match;
+   size_t match_length;
+} Search_Chunk_Line;
+
+typedef struct {
+   Search_Run *run;
+   Search_Chunk *chunks;
+   unsigned int count, next;
+
+   Eina_Lock lock;
+   Eina_Condition cond;
+} Search_Chunks;
+
+/*
+ * The text of a file open in an editor, searched instead of the file. Runs
+ * share the copy until the editor is changed again.
+ */
+typedef struct {
+   char *text;
+   size_t length;
+
+   int refs;
+   Edi_Editor *editor;
+   unsigned int serial;
+} Search_Buffer;
+
+/*
+ * A replace over the project, listing the files it changes, or would change
+ * for a preview. A replace that is no longer shown carries on unless it is
+ * a preview, but stops listing its files.
+ */
+typedef struct {
+   Edi_File_Replace *replace;
+   unsigned int files, count;
+   Eina_Bool dry_run, shown;
+} Search_Replace;
+
+static Search_Run *_search_run = NULL, *_tasks_run = NULL;
+static Search_Replace *_search_replace = NULL;
+static Eina_Hash *_search_buffers = NULL;
+static Ecore_Timer *_search_typing_timer = NULL;
+static char *_search_typing_text = NULL;
+
+// A matching line, the offset is where the line starts in the file.
+typedef struct {
+   unsigned long long offset;
+   unsigned int line, column, length;
+   unsigned int text, text_length; // The part of the line shown, within the text of its result.
+} Search_Hit;
+
+// Hits of a single file, queued for the main loop together.
+typedef struct {
+   Elm_Code *logger;
+   unsigned int generation;
+   Eina_Stringshare *path;
+   Search_Hit *hits;
+   unsigned int count;
+   char *text;
+} Search_Result;
+
+typedef struct {
+   Eina_Stringshare *path;
+   Elm_Code_Line *header;
+   unsigned int first, last, count;
+   unsigned int shown;
+   Eina_Bool expanded;
+} Search_File;
+
+/*
+ * Everything shown in a panel, one array per field of the hits. Paths are
+ * interned once and hits refer to their file by its index. Only the lines
+ * of expanded files exist in the panel, the others are shown from the part
+ * of their line kept with the hit when the file is expanded. Each line
+ * points back to its hit, or file.
+ */
+typedef struct {
+   Search_File *files;
+   Eina_Hash *ids;
+   unsigned int file_count, file_size;
+
+   unsigned int *file, *line, *column, *length, *next;
+   unsigned int *snippet, *snippet_length;
+   unsigned long long *offset;
+   unsigned int count, size;
+   Eina_Strbuf *snippets;
+
+   unsigned int shown;
+} Search_Store;
+
+static Search_Store _search_store, _tasks_store;
+
+/*
+ * A bounded queue of results, filled by the scanner threads without locking
+ * and drained by the main loop once per frame. Each slot has a sequence
+ * number telling whether it is ready to be written or read.
+ */
+typedef struct {
+   unsigned int sequence;
+   Search_Result result;
+} Search_Result_Slot;
+
+static Search_Result_Slot _results_queue[EDI_SEARCHPANEL_QUEUE_SIZE];
+static unsigned int _results_head = 0, _results_tail = 0;
+static Ecore_Animator *_results_animator = NULL;
+
+// Scanners finding the queue full sleep on the condition until the main loop makes room.
+static Eina_Lock _results_lock;
+static Eina_Condition _results_cond;
+static unsigned int _results_waiting = 0;
+
+static void _edi_searchpanel_find_more(void);
 
 static Eina_Bool
 _edi_searchpanel_config_changed_cb(void *data EINA_UNUSED, int type EINA_UNUSED, void *event EINA_UNUSED)
@@ -33,69 +206,332 @@ _edi_searchpanel_config_changed_cb(void *data EINA_UNUSED, int type EINA_UNUSED,
    return ECORE_CALLBACK_RENEW;
 }
 
+static Search_Store *
+_edi_searchpanel_store_get(Elm_Code *code)
+{
+   return code == _tasks_code ? &_tasks_store : &_search_store;
+}
+
 static void
-_edi_searchpanel_line_clicked_cb(void *data EINA_UNUSED, const Efl_Event *event)
+_edi_searchpanel_store_clear(Search_Store *store)
 {
-   Elm_Code_Line *line;
-   const char *content;
-   unsigned int length;
-   int numlen;
-   char *path, *filename_end;
-   char *line_start, *line_end, *numstr;
+   unsigned int i;
+
+   for (i = 0; i < store->file_count; i++)
+     eina_stringshare_del(store->files[i].path);
+   free(store->files);
+   if (store->ids)
+     eina_hash_free(store->ids);
+
+   free(store->file);
+   free(store->line);
+   free(store->column);
+   free(store->length);
+   free(store->next);
+   free(store->snippet);
+   free(store->snippet_length);
+   free(store->offset);
+   if (store->snippets)
+     eina_strbuf_free(store->snippets);
+
+   memset(store, 0, sizeof(Search_Store));
+}
 
-   line = (Elm_Code_Line *) event->info;
-   filename_end = line_start = NULL;
+// Intern a path, returns the index of its file.
+static unsigned int
+_edi_searchpanel_store_file_get(Search_Store *store, Eina_Stringshare *path)
+{
+   Search_File *file;
+   uintptr_t id;
 
-   path = strdup(line->data);
-   if (!path) return;
+   if (!store->ids)
+     store->ids = eina_hash_stringshared_new(NULL);
 
-   content = elm_code_line_text_get(line, &length);
-   if (!content)
-     return;
+   id = (uintptr_t) eina_hash_find(store->ids, path);
+   if (id) return id - 1;
 
-   filename_end = strchr(content, ':');
-   if (!filename_end)
-     return;
+   if (store->file_count == store->file_size)
+     {
+        store->file_size = store->file_size ? store->file_size * 2 : 64;
+        store->files = realloc(store->files, store->file_size * sizeof(Search_File));
+     }
 
-   line_start = filename_end + 1;
-   line_end = strchr(line_start, ' ');
-   if (!line_end)
-     return;
+   file = &store->files[store->file_count];
+   memset(file, 0, sizeof(Search_File));
+   file->path = eina_stringshare_ref(path);
+   eina_hash_add(store->ids, file->path, (void *) (uintptr_t) (store->file_count + 1));
+
+   return store->file_count++;
+}
+
+// Add a hit after the others of its file, with the part of its line in text, returns its index.
+static unsigned int
+_edi_searchpanel_store_hit_add(Search_Store *store, unsigned int id, const Search_Hit *hit,
+                               const char *text)
+{
+   Search_File *file = &store->files[id];
+   unsigned int index;
+
+   if (store->count == store->size)
+     {
+        store->size = store->size ? store->size * 2 : 1024;
+        store->file = realloc(store->file, store->size * sizeof(unsigned int));
+        store->line = realloc(store->line, store->size * sizeof(unsigned int));
+        store->column = realloc(store->column, store->size * sizeof(unsigned int));
+        store->length = realloc(store->length, store->size * sizeof(unsigned int));
+        store->next = realloc(store->next, store->size * sizeof(unsigned int));
+        store->snippet = realloc(store->snippet, store->size * sizeof(unsigned int));
+        store->snippet_length = realloc(store->snippet_length, store->size * sizeof(unsigned int));
+        store->offset = realloc(store->offset, store->size * sizeof(unsigned long long));
+     }
 
-   numlen = line_end - line_start;
-   numstr = malloc((numlen + 1) * sizeof(char));
-   strncpy(numstr, line_start, numlen);
-   numstr[numlen] = '\0';
+   index = store->count++;
+   store->file[index] = id;
+   store->line[index] = hit->line;
+   store->column[index] = hit->column;
+   store->length[index] = hit->length;
+   store->offset[index] = hit->offset;
+
+   if (!store->snippets)
+     store->snippets = eina_strbuf_new();
+   store->snippet[index] = eina_strbuf_length_get(store->snippets);
+   store->snippet_length[index] = text ? hit->text_length : 0;
+   if (text)
+     eina_strbuf_append_length(store->snippets, text + hit->text, hit->text_length);
+
+   if (file->count)
+     store->next[file->last] = index;
+   else
+     file->first = index;
+   file->last = index;
+   file->count++;
+
+   return index;
+}
+
+// Lines of a panel point to a hit, or to the file they head, by index.
+static void *
+_edi_searchpanel_line_data(unsigned int index, Eina_Bool header)
+{
+   return (void *) (uintptr_t) ((((uintptr_t) index << 1) | header) + 1);
+}
 
-   edi_mainview_open_path(path);
-   edi_mainview_goto(atoi(numstr));
+static Eina_Bool
+_edi_searchpanel_line_header(const Elm_Code_Line *line, unsigned int *index)
+{
+   uintptr_t data = (uintptr_t) line->data - 1;
 
-   free(numstr);
+   *index = data >> 1;
+   return data & 1;
 }
 
-static char *
-edi_searchpanel_line_render(const Eina_File_Line *line, const char *path, size_t *length)
+// A file mapped, or the text of its editor, to read the lines of its hits back.
+typedef struct {
+   Eina_File *f;
+   const char *map;
+   size_t length;
+} Search_Source;
+
+static Eina_Bool
+_edi_searchpanel_source_open(Search_Source *source, const char *path, Eina_Hash *buffers)
 {
-   Eina_Strbuf *buf = eina_strbuf_new();
-   char *r;
-   const char *text = line->start;
-   const char *end = line->end;
+   Search_Buffer *buffer = NULL;
 
-   while (text < end)
+   memset(source, 0, sizeof(Search_Source));
+   if (buffers)
+     buffer = eina_hash_find(buffers, path);
+   if (buffer)
      {
-        if (*text != ' ' && *text != '\t')
-          break;
-        text++;
+        source->map = buffer->text;
+        source->length = buffer->length;
+        return EINA_TRUE;
+     }
+
+   source->f = eina_file_open(path, EINA_FALSE);
+   if (!source->f) return EINA_FALSE;
+
+   source->length = eina_file_size_get(source->f);
+   source->map = eina_file_map_all(source->f, EINA_FILE_RANDOM);
+   if (!source->map)
+     {
+        eina_file_close(source->f);
+        return EINA_FALSE;
      }
 
-   eina_strbuf_append_printf(buf, "%s:%d ->\t", ecore_file_file_get(path), line->index);
-   eina_strbuf_append_length(buf, text, end - text - 1);
+   return EINA_TRUE;
+}
+
+static void
+_edi_searchpanel_source_close(Search_Source *source)
+{
+   if (!source->f) return;
+
+   eina_file_map_free(source->f, (void *) source->map);
+   eina_file_close(source->f);
+}
+
+// The line starting at offset, without its line break.
+static const char *
+_edi_searchpanel_source_line_get(const Search_Source *source, unsigned long long offset,
+                                 unsigned int *length)
+{
+   const char *start, *end;
+
+   *length = 0;
+   if (offset >= source->length) return NULL;
+
+   start = source->map + offset;
+   for (end = start; end < source->map + source->length && *end != '\n' && *end != '\r'; end++);
+
+   *length = end - start;
+   return start;
+}
+
+static const char *
+_edi_searchpanel_path_relative(const char *path)
+{
+   const char *project;
+   size_t length;
+
+   project = edi_project_get();
+   length = project ? strlen(project) : 0;
+   if (length && !strncmp(path, project, length) && path[length] == '/')
+     return path + length + 1;
+
+   return path;
+}
+
+/*
+ * The part of a line shown for its match, without leading blanks and cut
+ * between characters so long lines are not kept whole.
+ */
+static const char *
+_edi_searchpanel_snippet_get(const char *start, const char *end, const char *match,
+                             unsigned int *length)
+{
+   const char *from, *to;
+
+   while (start < match && (*start == ' ' || *start == '\t'))
+     start++;
+
+   from = start;
+   if (match - start > EDI_SEARCHPANEL_SNIPPET_BEFORE)
+     from = match - EDI_SEARCHPANEL_SNIPPET_BEFORE;
+   while (from < match && (*from & 0xC0) == 0x80)
+     from++;
+
+   to = end;
+   if (end - from > EDI_SEARCHPANEL_SNIPPET_LENGTH)
+     to = from + EDI_SEARCHPANEL_SNIPPET_LENGTH;
+   while (to < end && (*to & 0xC0) == 0x80)
+     to--;
+
+   *length = to - from;
+   return from;
+}
+
+// The editor counts columns in characters, not bytes.
+static unsigned int
+_edi_searchpanel_column_get(const char *line, const char *match)
+{
+   unsigned int column = 1;
+
+   for (; line < match; line++)
+     if ((*line & 0xC0) != 0x80)
+       column++;
+
+   return column;
+}
+
+static void
+_edi_searchpanel_file_header_update(Search_File *file)
+{
+   char text[PATH_MAX + 32];
+
+   snprintf(text, sizeof(text), "%s %s (%u)", file->expanded ? "-" : "+",
+            _edi_searchpanel_path_relative(file->path), file->count);
+   elm_code_line_text_set(file->header, text, strlen(text));
+}
+
+// Show a hit below the lines of its file that are already shown.
+static void
+_edi_searchpanel_hit_show(Elm_Code *code, Search_Store *store, Search_File *file,
+                          unsigned int index)
+{
+   Eina_Strbuf *buf;
+
+   buf = eina_strbuf_new();
+   eina_strbuf_append_printf(buf, "  %u:\t", store->line[index]);
+   if (store->snippet_length[index])
+     eina_strbuf_append_length(buf, eina_strbuf_string_get(store->snippets) + store->snippet[index],
+                               store->snippet_length[index]);
 
-   *length = eina_strbuf_length_get(buf);
-   r = eina_strbuf_string_steal(buf);
+   elm_code_file_line_insert(code->file, file->header->number + file->shown + 1,
+                             eina_strbuf_string_get(buf), eina_strbuf_length_get(buf),
+                             _edi_searchpanel_line_data(index, EINA_FALSE));
    eina_strbuf_free(buf);
 
-   return r;
+   file->shown++;
+   store->shown++;
+}
+
+// Show or hide the hits of a file, as they were found even if the file changed since.
+static void
+_edi_searchpanel_file_toggle(Elm_Code *code, Search_Store *store, unsigned int id)
+{
+   Search_File *file = &store->files[id];
+   unsigned int i, index;
+
+   if (file->expanded)
+     {
+        for (; file->shown; file->shown--, store->shown--)
+          elm_code_file_line_remove(code->file, file->header->number + 1);
+        file->expanded = EINA_FALSE;
+     }
+   else
+     {
+        file->expanded = EINA_TRUE;
+        index = file->first;
+        for (i = 0; i < file->count && i < EDI_SEARCHPANEL_LINES_MAX; i++)
+          {
+             _edi_searchpanel_hit_show(code, store, file, index);
+             index = store->next[index];
+          }
+     }
+
+   _edi_searchpanel_file_header_update(file);
+}
+
+static void
+_edi_searchpanel_line_clicked_cb(void *data, const Efl_Event *event)
+{
+   Elm_Code *code = data;
+   Elm_Code_Line *line;
+   Search_Store *store;
+   Search_Run *run;
+   unsigned int index;
+
+   line = (Elm_Code_Line *) event->info;
+   store = _edi_searchpanel_store_get(code);
+   run = code == _tasks_code ? _tasks_run : _search_run;
+
+   // Only the lines telling how a search went point to nothing.
+   if (!line->data)
+     {
+        if (run && run == _search_run && !run->running &&
+            __atomic_load_n(&run->capped, __ATOMIC_ACQUIRE))
+          _edi_searchpanel_find_more();
+        return;
+     }
+
+   if (_edi_searchpanel_line_header(line, &index))
+     {
+        _edi_searchpanel_file_toggle(code, store, index);
+        return;
+     }
+
+   edi_mainview_open_path(store->files[store->file[index]].path);
+   edi_mainview_goto_position(store->line[index], store->column[index]);
 }
 
 typedef struct _Eina_Iterator_Search Eina_Iterator_Search;
@@ -109,111 +545,137 @@ struct _Eina_Iterator_Search
    const char *end;
 
    Eina_Stringshare *term;
+   const Edi_Search_Patterns *patterns;
+   Edi_Regex *regex;
 
    Eina_File_Line current;
+   const char *match;
+   size_t match_length;
 
    int boundary;
 };
 
 // Return the starting of the last line found and update the count
 static inline const char *
-edi_count_line(const char *start, unsigned int length, const char *line, unsigned int *count)
+edi_count_line(const char *start, size_t length, const char *line, unsigned int *count)
 {
-   const char *cr;
+   const char *end = start + length;
    const char *lf;
-   const char *end;
-
-   if (!length) return line;
-
-   lf = memchr(start, '\r', length);
-   cr = memchr(start, '\n', length);
-
-   if (!cr && !lf) return start;
-
-   end = lf + 1;
-   (*count)++;
 
-   // \r\n
-   if (lf && cr == lf + 1)
+   // Most files have no \r at all, only look for \n then.
+   if (!memchr(start, '\r', length))
      {
-        end = cr;
+        while ((lf = memchr(start, '\n', end - start)))
+          {
+             (*count)++;
+             start = line = lf + 1;
+          }
+        return line;
      }
-   // \n
-   else if (cr)
+
+   for (; start < end; start++)
      {
-        end = cr;
+        // \n and \r alone end a line, \r\n is counted on its \n.
+        if (*start == '\r' && start + 1 < end && start[1] == '\n')
+          continue;
+        if (*start != '\n' && *start != '\r')
+          continue;
+
+        (*count)++;
+        line = start + 1;
      }
-   // \r
-   else if (lf)
+
+   return line;
+}
+
+static inline const char *
+edi_end_of_line(const char *start, const char *end)
+{
+   for (; start < end; start++)
      {
-        end = lf;
+        if (*start == '\n')
+          return start + 1;
+        if (*start == '\r')
+          return start + 1 < end && start[1] == '\n' ? start + 2 : start + 1;
      }
 
-   length = length - (end - start);
-   if (length == 0) return start;
-
-   return edi_count_line(end + 1, length - 1, end, count);
+   return end;
 }
 
-static inline const char *
-edi_end_of_line(const char *start, int boundary, const char *end)
+// Find the first line matching the regular expression, start must be the start of a line.
+static const char *
+edi_search_regex(const Eina_Iterator_Search *it, const char *start, const char *end,
+                 size_t *length)
 {
-   const char *cr;
-   const char *lf;
-   unsigned long long chunk;
+   const char *literal, *found, *line, *line_end;
+   size_t literal_length, match_start, match_end;
+
+   literal = edi_regex_literal_get(it->regex);
+   literal_length = strlen(literal);
 
    while (start < end)
      {
-        chunk = start + boundary < end ? boundary : end - start;
-        lf = memchr(start, '\r', chunk);
-        cr = memchr(start, '\n', chunk);
-
-        // \r\n
-        if (lf && cr == lf + 1)
-          return cr + 1;
-        // \n
-        if (cr)
-          return cr + 1;
-        // \r
-        if (lf)
-          return lf + 1;
+        // Only the lines with the required literal, if any, can match.
+        if (literal_length)
+          found = edi_search_find(start, end - start, literal, literal_length);
+        else
+          found = edi_regex_search(it->regex, start, end - start);
+        if (!found) return NULL;
 
-        start += chunk;
-        boundary = 4096;
+        for (line = found; line > start && line[-1] != '\n' && line[-1] != '\r'; line--);
+        for (line_end = found; line_end < end && *line_end != '\n' && *line_end != '\r'; line_end++);
+
+        if (edi_regex_match(it->regex, line, line_end - line, 0, &match_start, &match_end))
+          {
+             *length = match_end - match_start;
+             return line + match_start;
+          }
+
+        start = line_end;
+        if (start < end && *start == '\r') start++;
+        if (start < end && *start == '\n') start++;
      }
 
-   return end;
+   return NULL;
 }
 
 static inline const char *
 edi_search_term(const char *start, const char *end, int boundary,
-                Eina_Stringshare *term, Eina_File_Line *line)
+                Eina_Iterator_Search *it, Eina_File_Line *line)
 {
+   const char *match = NULL;
    char end_of_block = 0;
+   size_t length = 0;
+
+   if (it->regex)
+     {
+        // The match is found in one pass, the loop below only counts the lines.
+        match = edi_search_regex(it, start, end, &it->match_length);
+        if (!match) return end;
+     }
+   else if (it->patterns)
+     length = edi_search_patterns_length_max(it->patterns);
+   else
+     length = eina_stringshare_strlen(it->term);
 
    while (start < end)
      {
         const char *lookup;
         const char *count;
-        unsigned long long chunk, cchunk;
-        const char *search = start;
+        unsigned long long chunk, window;
 
-        cchunk = chunk = start + boundary < end ? boundary : end - start;
-        do
-          {
-             lookup = memchr(search, *term, cchunk);
-
-             // Did we found the right word or not ?
-             if (!lookup)
-               break;
-             else if (!memcmp(lookup, term, eina_stringshare_strlen(term)))
-               break;
+        chunk = start + boundary < end ? boundary : end - start;
 
-             // We didn't, start looking from where we are at
-             cchunk -= lookup - search;
-             search = lookup + 1;
-          }
-        while (cchunk > 0);
+        // Look for a match starting in this chunk, it may end past the chunk.
+        window = chunk + length - 1;
+        if (window > (unsigned long long) (end - start))
+          window = end - start;
+        if (it->regex)
+          lookup = match < start + chunk ? match : NULL;
+        else if (it->patterns)
+          lookup = edi_search_patterns_find(it->patterns, start, window);
+        else
+          lookup = edi_search_find(start, window, it->term, length);
 
         // If not found, we want to count starting from the end all the
         // line in this chunk.
@@ -224,7 +686,7 @@ edi_search_term(const char *start, const char *end, int boundary,
         // Here we post adjust the counter as we may have double counted a line
         // if \r\n is exactly at the boundary of a chunk. This also only happen
         // when we haven't found what we are looking for yet.
-        if (end_of_block == '\r' && *start == '\n')
+        if (end_of_block == '\r' && *start == '\n' && count > start)
           line->index--;
 
         if (lookup) return lookup;
@@ -241,35 +703,28 @@ static Eina_Bool
 edi_search_file_iterator_next(Eina_Iterator_Search *it, void **data)
 {
    const char *lookup;
-   int line_boundary;
 
    if (it->end == it->current.end) return EINA_FALSE;
 
-   // We are starting counting at the end of the line, so we will forget
-   // to account for the line where we found the term we were looking for,
-   // manually adjust for it.
+   // The search starts on the line after the last one found, the count of
+   // line breaks before the match gives how far below it the match is.
    // This also work to adjust for the first line as we start at zero
    it->current.index++;
+   if (it->current.end)
+     it->current.start = it->current.end;
 
-   // Account for first iteration when end == NULL
-   lookup = edi_search_term(it->current.end ? it->current.end : it->current.start,
-                            it->end, it->boundary, it->term, &it->current);
+   lookup = edi_search_term(it->current.start, it->end, it->boundary, it, &it->current);
 
    if (lookup == it->end) return EINA_FALSE;
 
-   line_boundary = (uintptr_t) lookup & 0x3FF;
-   if (!line_boundary) line_boundary = 4096;
-
-   it->current.end = edi_end_of_line(lookup, line_boundary, it->end);
-   // We need to adjust the end position of the line for '\r\n',
-   // in case it is on a cluster boundary.
-   if (*it->current.end == '\r')
-     {
-        if (it->current.end + 1 < it->end &&
-            *(it->current.end + 1) == '\n')
-          it->current.end += 1;
-     }
+   // The patterns do not tell which one matched, so neither how long it is.
+   it->match = lookup;
+   if (it->patterns)
+     it->match_length = 0;
+   else if (!it->regex)
+     it->match_length = eina_stringshare_strlen(it->term);
 
+   it->current.end = edi_end_of_line(lookup, it->end);
    it->current.length = it->current.end - it->current.start;
 
    it->boundary = (uintptr_t) it->current.end & 0x3FF;
@@ -288,50 +743,40 @@ edi_search_file_iterator_container(Eina_Iterator_Search *it)
 static void
 edi_search_file_iterator_free(Eina_Iterator_Search *it)
 {
-   eina_file_map_free(it->fp, (void*) it->map);
-   eina_file_close(it->fp);
+   if (it->fp)
+     {
+        eina_file_map_free(it->fp, (void*) it->map);
+        eina_file_close(it->fp);
+     }
 
+   eina_stringshare_del(it->term);
    EINA_MAGIC_SET(&it->iterator, 0);
    free(it);
 }
 
+// Iterate the matching lines of a block of text, start must be the start of a line.
 static Eina_Iterator *
-edi_search_file(Eina_File *file, const char *term)
+edi_search_text(const char *start, const char *end, const char *term,
+                const Edi_Search_Patterns *patterns, Edi_Regex *regex)
 {
    Eina_Iterator_Search *it;
-   size_t length;
-   const char elf_header[4] = {0x7f, 'E', 'L', 'F'};
-
-   if (!file || !term || strlen(term) == 0) return NULL;
-
-   length = eina_file_size_get(file);
 
-   if (!length) return NULL;
+   if (start >= end) return NULL;
+   if (!patterns && !regex && (!term || strlen(term) == 0)) return NULL;
 
    it = calloc(1, sizeof (Eina_Iterator_Search));
    if (!it) return NULL;
 
    EINA_MAGIC_SET(&it->iterator, EINA_MAGIC_ITERATOR);
 
-   it->map = eina_file_map_all(file, EINA_FILE_SEQUENTIAL);
-   if (!it->map)
-     {
-        free(it);
-        return NULL;
-     }
-
-   if (length >= 4 && !memcmp(it->map, elf_header, sizeof(elf_header)))
-     {
-        free(it);
-        return NULL;
-     }
-
-   it->fp = eina_file_dup(it->fp);
-   it->current.start = it->map;
+   it->map = start;
+   it->current.start = start;
    it->current.end = NULL;
    it->current.index = 0;
-   it->end = it->map + length;
+   it->end = end;
    it->term = eina_stringshare_add(term);
+   it->patterns = patterns;
+   it->regex = regex;
    it->boundary = 4096;
 
    it->iterator.version = EINA_ITERATOR_VERSION;
@@ -342,231 +787,1397 @@ edi_search_file(Eina_File *file, const char *term)
    return &it->iterator;
 }
 
-typedef struct {
-   char *text;
-   size_t length;
-} Async_Item;
-
-typedef struct {
-   Elm_Code *logger;
-   Eina_File *f;
+// Where the match is within the last line returned by a search iterator, and its offset in the text.
+static const char *
+edi_search_match_get(Eina_Iterator *iterator, size_t *length, unsigned long long *offset)
+{
+   Eina_Iterator_Search *it = (Eina_Iterator_Search *) iterator;
 
-   Eina_Inarray texts;
-} Async_Log;
+   *length = it->match_length;
+   *offset = it->current.start - it->map;
+   return it->match;
+}
 
+static Eina_Bool
+edi_search_binary(const char *map, size_t length)
+{
+   const char elf_header[4] = {0x7f, 'E', 'L', 'F'};
 
-static Eina_Spinlock logs_lock;
-static unsigned int logs_count = 0;
-static Eina_Trash *logs = NULL;
+   return length >= 4 && !memcmp(map, elf_header, sizeof(elf_header));
+}
 
-static void
-main_loop_line_append_async(void *data)
+// Iterate the lines matching either a term, a set of patterns or a regular expression.
+static Eina_Iterator *
+edi_search_file(Eina_File *file, const char *term, const Edi_Search_Patterns *patterns,
+                Edi_Regex *regex)
 {
-   Async_Log *log = data;
-   Async_Item *item;
+   Eina_Iterator_Search *it;
+   Eina_Iterator *iterator;
+   const char *map;
+   size_t length;
 
-   while ((item = eina_inarray_pop(&log->texts)))
-     {
-        elm_code_file_line_append(log->logger->file, item->text, item->length,
-                                  strdup(eina_file_filename_get(log->f)));
-        free(item->text);
-        item->text = NULL;
-     }
+   if (!file) return NULL;
+
+   length = eina_file_size_get(file);
+
+   if (!length) return NULL;
 
-   eina_file_close(log->f);
-   log->f = NULL;
-   log->logger = NULL;
-   // We are keeping the texts array as it won't be touched by Eina_Trash
+   map = eina_file_map_all(file, EINA_FILE_SEQUENTIAL);
+   if (!map) return NULL;
 
-   eina_spinlock_take(&logs_lock);
-   if (logs_count < 8)
+   if (edi_search_binary(map, length))
      {
-        logs_count++;
-        eina_trash_push(&logs, log);
-        log = NULL;
+        eina_file_map_free(file, (void*) map);
+        return NULL;
      }
-   eina_spinlock_release(&logs_lock);
 
-   if (log)
+   iterator = edi_search_text(map, map + length, term, patterns, regex);
+   if (!iterator)
      {
-        eina_inarray_flush(&log->texts);
-        free(log);
+        eina_file_map_free(file, (void*) map);
+        return NULL;
      }
+
+   it = (Eina_Iterator_Search *) iterator;
+   it->fp = eina_file_dup(file);
+
+   return iterator;
 }
 
-void
-_edi_searchpanel_search_project_file(const char *path, const char *search_term, Elm_Code *logger)
+static void
+_edi_searchpanel_results_init(void)
 {
-   Eina_Iterator *it;
-   Eina_File_Line *l;
-   Async_Log *log;
-   Eina_File *f;
+   static Eina_Bool ready = EINA_FALSE;
+   unsigned int i;
 
-   f = eina_file_open(path, EINA_FALSE);
-   if (!f) return ;
+   if (ready) return;
 
-   // If the file looks big, check if it is a text file first.
-   if (eina_file_size_get(f) > 1 * 1024 * 1024 &&
-       strncmp(edi_mime_type_get(path), "text/", 5))
-     {
-        eina_file_close(f);
-        return ;
-     }
+   for (i = 0; i < EDI_SEARCHPANEL_QUEUE_SIZE; i++)
+     _results_queue[i].sequence = i;
+   eina_lock_new(&_results_lock);
+   eina_condition_new(&_results_cond, &_results_lock);
+   ready = EINA_TRUE;
+}
 
-   eina_spinlock_take(&logs_lock);
-   log = eina_trash_pop(&logs);
-   if (log) logs_count--;
-   eina_spinlock_release(&logs_lock);
+// Wake the scanners waiting for room in the queue, or for their run to be cancelled.
+static void
+_edi_searchpanel_results_wake(void)
+{
+   eina_lock_take(&_results_lock);
+   if (_results_waiting)
+     eina_condition_broadcast(&_results_cond);
+   eina_lock_release(&_results_lock);
+}
+
+// Called from any scanner thread.
+static Eina_Bool
+_edi_searchpanel_results_push(const Search_Result *result)
+{
+   Search_Result_Slot *slot;
+   unsigned int tail;
+   int diff;
 
-   if (!log)
+   tail = __atomic_load_n(&_results_tail, __ATOMIC_RELAXED);
+   while (1)
      {
-        log = calloc(1, sizeof (Async_Log));
-        eina_inarray_step_set(&log->texts, sizeof (log->texts),
-                              sizeof (Async_Item), 4);
+        slot = &_results_queue[tail & (EDI_SEARCHPANEL_QUEUE_SIZE - 1)];
+        diff = (int) (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - tail);
+
+        if (diff < 0)
+          return EINA_FALSE;
+        if (diff > 0)
+          tail = __atomic_load_n(&_results_tail, __ATOMIC_RELAXED);
+        else if (__atomic_compare_exchange_n(&_results_tail, &tail, tail + 1, EINA_TRUE,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+          break;
      }
 
-   log->f = eina_file_dup(f);
-   log->logger = logger;
+   slot->result = *result;
+   __atomic_store_n(&slot->sequence, tail + 1, __ATOMIC_RELEASE);
 
-   it = edi_search_file(f, search_term);
-   EINA_ITERATOR_FOREACH(it, l)
-     {
-        Async_Item *item = eina_inarray_grow(&log->texts, 1);
+   return EINA_TRUE;
+}
 
-        item->text = edi_searchpanel_line_render(l, path, &item->length);
-     }
-   eina_iterator_free(it);
+// Only called from the main loop.
+static Eina_Bool
+_edi_searchpanel_results_pop(Search_Result *result)
+{
+   Search_Result_Slot *slot;
 
-   if (eina_inarray_count(&log->texts) == 0)
-     {
-        eina_inarray_flush(&log->texts);
-        eina_file_close(log->f);
-        free(log);
-        log = NULL;
-     }
+   slot = &_results_queue[_results_head & (EDI_SEARCHPANEL_QUEUE_SIZE - 1)];
+   if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != _results_head + 1)
+     return EINA_FALSE;
 
-   if (log) ecore_main_loop_thread_safe_call_async(main_loop_line_append_async, log);
+   *result = slot->result;
+   __atomic_store_n(&slot->sequence, _results_head + EDI_SEARCHPANEL_QUEUE_SIZE, __ATOMIC_RELEASE);
+   _results_head++;
 
-   eina_file_close(f);
+   return EINA_TRUE;
 }
 
-Eina_Bool
-_file_ignore(const char *filename)
-{
-   if ((eina_str_has_extension(filename, ".png")   ||
-        eina_str_has_extension(filename, ".PNG")   ||
-        eina_str_has_extension(filename, ".jpg")   ||
-        eina_str_has_extension(filename, ".jpeg")  ||
-        eina_str_has_extension(filename, ".JPG")   ||
-        eina_str_has_extension(filename, ".JPEG")  ||
-        eina_str_has_extension(filename, ".bmp")   ||
-        eina_str_has_extension(filename, ".dds")   ||
-        eina_str_has_extension(filename, ".tgv")   ||
-        eina_str_has_extension(filename, ".eet")   ||
-        eina_str_has_extension(filename, ".edj")   ||
-        eina_str_has_extension(filename, ".gz")    ||
-        eina_str_has_extension(filename, ".bz2")   ||
-        eina_str_has_extension(filename, ".xz")    ||
-        eina_str_has_extension(filename, ".lzma")  ||
-        eina_str_has_extension(filename, ".core")  ||
-        eina_str_has_extension(filename, ".zip")
-       ))
-     return EINA_TRUE;
-
-   return EINA_FALSE;
+static Search_Run *
+_edi_searchpanel_run_new(Elm_Code *logger, unsigned int max)
+{
+   static unsigned int generation = 0;
+   Search_Run *run;
+
+   run = calloc(1, sizeof(Search_Run));
+   run->logger = logger;
+   run->generation = ++generation;
+   run->max = max;
+   run->refs = 1;
+   run->started = time(NULL);
+
+   return run;
 }
 
-void
-_edi_searchpanel_search_project(const char *directory, const char *search_term, Elm_Code *logger)
+static void
+_edi_searchpanel_run_unref(Search_Run *run)
 {
-   Eina_List *dirs;
-   char *dir;
+   const char *tag;
+   char *path;
+
+   if (!run || --run->refs) return;
+
+   free(run->text);
+   if (run->regex)
+     edi_regex_free(run->regex);
+   if (run->patterns)
+     edi_search_patterns_free(run->patterns);
+   EINA_LIST_FREE(run->tags, tag)
+     eina_stringshare_del(tag);
+   EINA_LIST_FREE(run->paths, path)
+     free(path);
+   if (run->buffers)
+     eina_hash_free(run->buffers);
+   free(run);
+}
 
-   dirs = eina_list_append(NULL, strdup(directory));
+static void
+_edi_searchpanel_buffer_free(void *data)
+{
+   Search_Buffer *buffer = data;
 
-   EINA_LIST_FREE(dirs, dir)
-     {
-        Eina_File_Direct_Info *info;
-        Eina_Iterator *it;
+   if (--buffer->refs) return ;
 
-        it = eina_file_stat_ls(dir);
-        EINA_ITERATOR_FOREACH(it, info)
-          {
-             if (_file_ignore(info->path + info->name_start))
-               continue ;
+   free(buffer->text);
+   free(buffer);
+}
 
-             if (edi_file_path_hidden(info->path))
-               continue ;
+// The items with a file loaded in an editor, once for each file.
+static Eina_List *
+_edi_searchpanel_editors_get(void)
+{
+   Edi_Mainview_Panel *panel;
+   Edi_Mainview_Item *item, *other;
+   Eina_List *l, *ll, *items = NULL;
+   int i;
 
-             switch (info->type)
+   for (i = 0; i < edi_mainview_panel_count(); i++)
+     {
+        panel = edi_mainview_panel_by_index(i);
+        EINA_LIST_FOREACH(panel->items, l, item)
+          {
+             if (!item->loaded || !item->view ||
+                 !evas_object_data_get(item->view, "editor"))
+               continue;
+
+             EINA_LIST_FOREACH(items, ll, other)
+               if (!strcmp(other->path, item->path))
+                 break;
+             if (!ll)
+               items = eina_list_append(items, item);
+          }
+     }
+
+   return items;
+}
+
+// Copy the text of every file loaded in an editor, it may not be saved yet.
+static Eina_Hash *
+_edi_searchpanel_buffers_get(void)
+{
+   Edi_Mainview_Item *item;
+   Edi_Editor *editor;
+   Search_Buffer *buffer;
+   Elm_Code_Line *line;
+   Eina_Strbuf *text;
+   Eina_Hash *buffers = NULL, *copies;
+   Eina_List *items, *l;
+   const char *content;
+   unsigned int length;
+
+   // Unchanged editors show the file, and copies of the others are kept until they change.
+   copies = eina_hash_string_superfast_new(_edi_searchpanel_buffer_free);
+   items = _edi_searchpanel_editors_get();
+   EINA_LIST_FREE(items, item)
+     {
+        editor = (Edi_Editor *) evas_object_data_get(item->view, "editor");
+        if (!editor->modified)
+          continue;
+
+        buffer = _search_buffers ? eina_hash_find(_search_buffers, item->path) : NULL;
+        if (buffer && buffer->editor == editor && buffer->serial == editor->edit_serial)
+          {
+             buffer->refs += 2;
+             eina_hash_add(copies, item->path, buffer);
+             if (!buffers)
+               buffers = eina_hash_string_superfast_new(_edi_searchpanel_buffer_free);
+             eina_hash_add(buffers, item->path, buffer);
+             continue;
+          }
+
+        text = eina_strbuf_new();
+        EINA_LIST_FOREACH(elm_code_widget_code_get(editor->entry)->file->lines, l, line)
+          {
+             content = elm_code_line_text_get(line, &length);
+             if (content)
+               eina_strbuf_append_length(text, content, length);
+             eina_strbuf_append_char(text, '\n');
+          }
+
+        buffer = malloc(sizeof(Search_Buffer));
+        buffer->length = eina_strbuf_length_get(text);
+        buffer->text = eina_strbuf_string_steal(text);
+        eina_strbuf_free(text);
+        buffer->editor = editor;
+        buffer->serial = editor->edit_serial;
+        buffer->refs = 2;
+        eina_hash_add(copies, item->path, buffer);
+
+        if (!buffers)
+          buffers = eina_hash_string_superfast_new(_edi_searchpanel_buffer_free);
+        eina_hash_add(buffers, item->path, buffer);
+     }
+
+   if (_search_buffers)
+     eina_hash_free(_search_buffers);
+   _search_buffers = copies;
+
+   return buffers;
+}
+
+// Ask a run to stop without waiting for it, its threads notice and return on their own.
+static void
+_edi_searchpanel_run_cancel(Search_Run *run)
+{
+   if (!run) return;
+
+   __atomic_store_n(&run->cancelled, EINA_TRUE, __ATOMIC_RELEASE);
+   __atomic_store_n(&run->stopped, EINA_TRUE, __ATOMIC_RELEASE);
+   if (run->thread)
+     ecore_thread_cancel(run->thread);
+
+   _edi_searchpanel_results_wake();
+}
+
+static void
+_edi_searchpanel_result_free(Search_Result *result)
+{
+   eina_stringshare_del(result->path);
+   free(result->hits);
+   free(result->text);
+}
+
+/*
+ * Store the hits of a result and show them under the header of their file.
+ * Files are expanded until enough lines are shown, the files after that
+ * only show how many hits they have.
+ */
+static void
+_edi_searchpanel_result_append(Search_Result *result)
+{
+   Search_Store *store;
+   Search_File *file;
+   Search_Hit *hit;
+   Elm_Code *code = result->logger;
+   unsigned int i, id, index;
+
+   // Whatever a replaced run still queued is dropped.
+   if ((!_search_run || _search_run->generation != result->generation) &&
+       (!_tasks_run || _tasks_run->generation != result->generation))
+     {
+        _edi_searchpanel_result_free(result);
+        return;
+     }
+
+   store = _edi_searchpanel_store_get(code);
+   id = _edi_searchpanel_store_file_get(store, result->path);
+   file = &store->files[id];
+
+   if (!file->header)
+     {
+        file->expanded = store->shown < EDI_SEARCHPANEL_LINES_MAX;
+        elm_code_file_line_append(code->file, "", 0, _edi_searchpanel_line_data(id, EINA_TRUE));
+        file->header = elm_code_file_line_get(code->file, elm_code_file_lines_get(code->file));
+     }
+
+   for (i = 0; i < result->count; i++)
+     {
+        hit = &result->hits[i];
+        index = _edi_searchpanel_store_hit_add(store, id, hit, result->text);
+
+        if (file->expanded && file->shown < EDI_SEARCHPANEL_LINES_MAX)
+          _edi_searchpanel_hit_show(code, store, file, index);
+     }
+
+   _edi_searchpanel_file_header_update(file);
+   _edi_searchpanel_result_free(result);
+}
+
+static void
+_edi_searchpanel_code_clear(Elm_Code *code)
+{
+   elm_code_file_clear(code->file);
+   _edi_searchpanel_store_clear(_edi_searchpanel_store_get(code));
+}
+
+static void
+_edi_searchpanel_results_more_append(Search_Run *run)
+{
+   char text[256];
+
+   snprintf(text, sizeof(text), _("Stopped after %d results, click here to show more."),
+            run->max);
+   elm_code_file_line_append(run->logger->file, text, strlen(text), NULL);
+}
+
+// Once a run is over and all it found is shown, tell if it stopped early.
+static Eina_Bool
+_edi_searchpanel_run_drained(Search_Run *run)
+{
+   if (!run || run->done) return EINA_TRUE;
+   if (run->running) return EINA_FALSE;
+
+   run->done = EINA_TRUE;
+   if (__atomic_load_n(&run->capped, __ATOMIC_ACQUIRE))
+     _edi_searchpanel_results_more_append(run);
+
+   return EINA_TRUE;
+}
+
+static Eina_Bool
+_edi_searchpanel_results_drain_cb(void *data EINA_UNUSED)
+{
+   Search_Result result;
+   Eina_Bool search_done, tasks_done;
+   double start;
+
+   start = ecore_time_get();
+   while (ecore_time_get() - start < EDI_SEARCHPANEL_FRAME_BUDGET)
+     {
+        if (!_edi_searchpanel_results_pop(&result))
+          {
+             _edi_searchpanel_results_wake();
+
+             search_done = _edi_searchpanel_run_drained(_search_run);
+             tasks_done = _edi_searchpanel_run_drained(_tasks_run);
+             if (!search_done || !tasks_done)
+               return ECORE_CALLBACK_RENEW;
+
+             _results_animator = NULL;
+             return ECORE_CALLBACK_CANCEL;
+          }
+
+        _edi_searchpanel_result_append(&result);
+     }
+
+   _edi_searchpanel_results_wake();
+
+   return ECORE_CALLBACK_RENEW;
+}
+
+// The hits of a file found by a scanner, queued every few hits and once the file is done.
+typedef struct {
+   Search_Run *run;
+   Eina_Stringshare *path;
+   Search_Hit *hits;
+   unsigned int count;
+   Eina_Strbuf *text;
+} Search_Batch;
+
+static void
+_edi_searchpanel_batch_init(Search_Batch *batch, Search_Run *run, Eina_Stringshare *path)
+{
+   memset(batch, 0, sizeof(Search_Batch));
+   batch->run = run;
+   batch->path = path;
+}
+
+/*
+ * Queue the hits of a batch for the main loop, waiting for room if the main
+ * loop is behind. Called from any scanner thread, the hits are dropped if
+ * the run is cancelled meanwhile.
+ */
+static void
+_edi_searchpanel_batch_flush(Search_Batch *batch)
+{
+   Search_Result result;
+   Search_Run *run = batch->run;
+
+   if (!batch->count) return ;
+
+   result.logger = run->logger;
+   result.generation = run->generation;
+   result.path = eina_stringshare_ref(batch->path);
+   result.hits = batch->hits;
+   result.count = batch->count;
+   result.text = eina_strbuf_string_steal(batch->text);
+   eina_strbuf_free(batch->text);
+
+   batch->hits = NULL;
+   batch->text = NULL;
+   batch->count = 0;
+
+   if (_edi_searchpanel_results_push(&result))
+     return ;
+
+   // The main loop is behind, it wakes us once it took some results.
+   eina_lock_take(&_results_lock);
+   while (!_edi_searchpanel_results_push(&result))
+     {
+        if (__atomic_load_n(&run->cancelled, __ATOMIC_ACQUIRE))
+          {
+             eina_lock_release(&_results_lock);
+             _edi_searchpanel_result_free(&result);
+             return ;
+          }
+
+        _results_waiting++;
+        eina_condition_wait(&_results_cond);
+        _results_waiting--;
+     }
+   eina_lock_release(&_results_lock);
+}
+
+// The patterns do not tell which tag matched, the longest one found there did.
+static unsigned int
+_edi_searchpanel_tag_length(const Search_Run *run, const char *match, const char *end)
+{
+   const char *tag;
+   Eina_List *l;
+   size_t length, longest = 0;
+
+   EINA_LIST_FOREACH(run->tags, l, tag)
+     {
+        length = eina_stringshare_strlen(tag);
+        if (length > longest && length <= (size_t) (end - match) && !memcmp(match, tag, length))
+          longest = length;
+     }
+
+   return longest;
+}
+
+/*
+ * Add a matching line to a batch. Called from any scanner thread, returns
+ * EINA_FALSE once the run is stopped or reached its limit.
+ */
+static Eina_Bool
+_edi_searchpanel_batch_add(Search_Batch *batch, const Eina_File_Line *line, const char *match,
+                           size_t match_length, unsigned long long offset)
+{
+   Search_Run *run = batch->run;
+   Search_Hit *hit;
+   const char *end, *text;
+   unsigned int count, length;
+
+   count = __atomic_add_fetch(&run->count, 1, __ATOMIC_RELAXED);
+   if (run->max && count > run->max)
+     {
+        __atomic_store_n(&run->capped, EINA_TRUE, __ATOMIC_RELEASE);
+        __atomic_store_n(&run->stopped, EINA_TRUE, __ATOMIC_RELEASE);
+     }
+
+   if (__atomic_load_n(&run->stopped, __ATOMIC_ACQUIRE))
+     return EINA_FALSE;
+
+   if (!batch->hits)
+     {
+        batch->hits = malloc(EDI_SEARCHPANEL_BATCH_SIZE * sizeof(Search_Hit));
+        batch->text = eina_strbuf_new();
+     }
+
+   // Drop the line break, narrowing reads the whole line back from the file.
+   end = line->end;
+   while (end > line->start && (end[-1] == '\n' || end[-1] == '\r'))
+     end--;
+
+   hit = &batch->hits[batch->count++];
+   hit->offset = offset;
+   hit->line = line->index;
+   hit->column = _edi_searchpanel_column_get(line->start, match);
+   hit->length = match_length;
+   if (run->patterns)
+     hit->length = _edi_searchpanel_tag_length(run, match, end);
+
+   text = _edi_searchpanel_snippet_get(line->start, end, match, &length);
+   hit->text = eina_strbuf_length_get(batch->text);
+   hit->text_length = length;
+   eina_strbuf_append_length(batch->text, text, length);
+
+   if (batch->count == EDI_SEARCHPANEL_BATCH_SIZE)
+     _edi_searchpanel_batch_flush(batch);
+
+   return EINA_TRUE;
+}
+
+// Threads helping with the blocks of large files, shared so the scanners do not oversubscribe the cores.
+static int _search_chunk_threads = 0;
+
+static unsigned int
+_edi_searchpanel_chunks_split(Search_Chunks *chunks, const char *map, size_t length)
+{
+   const char *start, *end, *lf;
+   unsigned int count = 0;
+   size_t size;
+   int cores;
+
+   cores = eina_cpu_count();
+   size = length / (cores > 0 ? cores : 1);
+   if (size < EDI_SEARCHPANEL_CHUNK_SIZE)
+     size = EDI_SEARCHPANEL_CHUNK_SIZE;
+   if (size > EDI_SEARCHPANEL_CHUNK_SIZE_MAX)
+     size = EDI_SEARCHPANEL_CHUNK_SIZE_MAX;
+
+   // Every block but the last one is at least size long.
+   chunks->chunks = calloc(length / size + 1, sizeof(Search_Chunk));
+   if (!chunks->chunks) return 0;
+
+   for (start = map; start < map + length; start = end)
+     {
+        if ((size_t) (map + length - start) <= size)
+          end = map + length;
+        else
+          {
+             // A \n always ends a line, so a block never splits a \r\n.
+             lf = memchr(start + size - 1, '\n', map + length - (start + size - 1));
+             end = lf ? lf + 1 : map + length;
+          }
+
+        chunks->chunks[count].start = start;
+        chunks->chunks[count].end = end;
+        count++;
+     }
+
+   return count;
+}
+
+static void
+_edi_searchpanel_chunk_search(Search_Run *run, Search_Chunk *chunk)
+{
+   Search_Chunk_Line *line;
+   Eina_Iterator *it;
+   Eina_File_Line *l;
+   unsigned long long offset;
+   unsigned int count = 0;
+
+   edi_count_line(chunk->start, chunk->end - chunk->start, chunk->start, &chunk->breaks);
+
+   it = edi_search_text(chunk->start, chunk->end, run->text, run->patterns, run->regex);
+   if (!it) return ;
+
+   EINA_ITERATOR_FOREACH(it, l)
+     {
+        if (__atomic_load_n(&run->stopped, __ATOMIC_ACQUIRE))
+          break;
+        // One more line than the run shows is enough to know it is capped.
+        if (run->max && count++ > run->max)
+          break;
+
+        line = malloc(sizeof(Search_Chunk_Line));
+        if (!line) break;
+
+        line->line = *l;
+        line->match = edi_search_match_get(it, &line->match_length, &offset);
+        chunk->lines = eina_list_append(chunk->lines, line);
+     }
+   eina_iterator_free(it);
+}
+
+// Search the next block nobody took yet, returns EINA_FALSE when none is left.
+static Eina_Bool
+_edi_searchpanel_chunks_work(Search_Chunks *chunks)
+{
+   Search_Chunk *chunk;
+   unsigned int i;
+
+   i = __atomic_fetch_add(&chunks->next, 1, __ATOMIC_RELAXED);
+   if (i >= chunks->count) return EINA_FALSE;
+
+   chunk = &chunks->chunks[i];
+   _edi_searchpanel_chunk_search(chunks->run, chunk);
+
+   eina_lock_take(&chunks->lock);
+   __atomic_store_n(&chunk->done, EINA_TRUE, __ATOMIC_RELEASE);
+   eina_condition_broadcast(&chunks->cond);
+   eina_lock_release(&chunks->lock);
+
+   return EINA_TRUE;
+}
+
+static void *
+_edi_searchpanel_chunks_worker(void *data, Eina_Thread thread EINA_UNUSED)
+{
+   Search_Chunks *chunks = data;
+
+   while (_edi_searchpanel_chunks_work(chunks));
+
+   return NULL;
+}
+
+/*
+ * Search a large file in blocks spread over spare threads, the calling
+ * scanner helps with them. The results are queued in file order as each
+ * block is done, numbered exactly as a search of the whole file would.
+ */
+static void
+_edi_searchpanel_search_chunks(Search_Run *run, Eina_Stringshare *path, const char *map, size_t length)
+{
+   Search_Chunks chunks;
+   Search_Chunk *chunk;
+   Search_Chunk_Line *l;
+   Search_Batch batch;
+   Eina_Thread *threads;
+   unsigned int i, base = 0, started = 0;
+   Eina_Bool stopped = EINA_FALSE;
+   int cores;
+
+   _edi_searchpanel_batch_init(&batch, run, path);
+
+   memset(&chunks, 0, sizeof(Search_Chunks));
+   chunks.run = run;
+   chunks.count = _edi_searchpanel_chunks_split(&chunks, map, length);
+   if (!chunks.count) return ;
+
+   eina_lock_new(&chunks.lock);
+   eina_condition_new(&chunks.cond, &chunks.lock);
+
+   cores = eina_cpu_count();
+   threads = calloc(chunks.count, sizeof(Eina_Thread));
+   for (i = 1; threads && i < chunks.count; i++)
+     {
+        if (__atomic_add_fetch(&_search_chunk_threads, 1, __ATOMIC_RELAXED) >= cores)
+          {
+             __atomic_sub_fetch(&_search_chunk_threads, 1, __ATOMIC_RELAXED);
+             break;
+          }
+        if (!eina_thread_create(&threads[started], EINA_THREAD_BACKGROUND, -1,
+                                _edi_searchpanel_chunks_worker, &chunks))
+          {
+             __atomic_sub_fetch(&_search_chunk_threads, 1, __ATOMIC_RELAXED);
+             break;
+          }
+        started++;
+     }
+
+   for (i = 0; i < chunks.count; i++)
+     {
+        chunk = &chunks.chunks[i];
+
+        while (!__atomic_load_n(&chunk->done, __ATOMIC_ACQUIRE) &&
+               _edi_searchpanel_chunks_work(&chunks));
+
+        eina_lock_take(&chunks.lock);
+        while (!chunk->done)
+          eina_condition_wait(&chunks.cond);
+        eina_lock_release(&chunks.lock);
+
+        EINA_LIST_FREE(chunk->lines, l)
+          {
+             if (!stopped)
                {
-                case EINA_FILE_REG:
-                  {
-                     _edi_searchpanel_search_project_file(info->path, search_term, logger);
-                     break;
-                  }
-                case EINA_FILE_DIR:
-                  {
-                     dirs = eina_list_append(dirs, strdup(info->path));
-                     break;
-                  }
-                default:
-                   // Ignore all other type
-                   break;
+                  l->line.index += base;
+                  stopped = !_edi_searchpanel_batch_add(&batch, &l->line, l->match, l->match_length,
+                                                        l->line.start - map);
                }
+             free(l);
+          }
+        base += chunk->breaks;
+     }
+   _edi_searchpanel_batch_flush(&batch);
+
+   for (i = 0; i < started; i++)
+     {
+        eina_thread_join(threads[i]);
+        __atomic_sub_fetch(&_search_chunk_threads, 1, __ATOMIC_RELAXED);
+     }
+   free(threads);
+
+   eina_condition_free(&chunks.cond);
+   eina_lock_free(&chunks.lock);
+   free(chunks.chunks);
+}
+
+// A file with a nul in its first bytes is not text, as edi_mime_type_get() does without efreet.
+static Eina_Bool
+_edi_searchpanel_text_is(Eina_File *f)
+{
+   const char *map;
+   size_t length;
+   Eina_Bool text;
+
+   length = eina_file_size_get(f);
+   if (length > EDI_SEARCHPANEL_TEXT_CHECK_LENGTH)
+     length = EDI_SEARCHPANEL_TEXT_CHECK_LENGTH;
+
+   map = eina_file_map_new(f, EINA_FILE_POPULATE, 0, length);
+   if (!map) return EINA_FALSE;
+
+   text = !memchr(map, '\0', length);
+   eina_file_map_free(f, (void *) map);
+
+   return text;
+}
+
+static void
+_edi_searchpanel_search_file_cb(void *data, const char *path)
+{
+   Search_Run *run = data;
+   Search_Buffer *buffer = NULL;
+   Eina_Stringshare *shared;
+   Search_Batch batch;
+   Eina_Iterator *it;
+   Eina_File_Line *l;
+   Eina_File *f;
+   const char *match;
+   char *map;
+   unsigned long long offset;
+   size_t length, size;
+
+   // Files open in an editor are searched as they are shown, without reading the disk.
+   if (run->buffers)
+     buffer = eina_hash_find(run->buffers, path);
+
+   if (buffer)
+     f = eina_file_virtualize(path, buffer->text, buffer->length, EINA_FALSE);
+   else
+     f = eina_file_open(path, EINA_FALSE);
+   if (!f) return ;
+
+   // If the file looks big, check if it is a text file first, efreet is not safe on these threads.
+   if (!buffer && eina_file_size_get(f) > EDI_SEARCHPANEL_TEXT_CHECK_SIZE &&
+       !_edi_searchpanel_text_is(f))
+     {
+        eina_file_close(f);
+        return ;
+     }
+
+   if (__atomic_load_n(&run->stopped, __ATOMIC_ACQUIRE))
+     {
+        eina_file_close(f);
+        return ;
+     }
+
+   shared = eina_stringshare_add(path);
+
+   size = eina_file_size_get(f);
+   if (size > EDI_SEARCHPANEL_CHUNK_SIZE * 2)
+     {
+        map = eina_file_map_all(f, EINA_FILE_WILLNEED);
+        if (map && !edi_search_binary(map, size))
+          _edi_searchpanel_search_chunks(run, shared, map, size);
+        if (map)
+          eina_file_map_free(f, map);
+     }
+   else
+     {
+        _edi_searchpanel_batch_init(&batch, run, shared);
 
-             if (ecore_thread_check(_search_thread)) break;
+        it = edi_search_file(f, run->text, run->patterns, run->regex);
+        EINA_ITERATOR_FOREACH(it, l)
+          {
+             match = edi_search_match_get(it, &length, &offset);
+             if (!_edi_searchpanel_batch_add(&batch, l, match, length, offset))
+               break;
           }
         eina_iterator_free(it);
 
-        if (ecore_thread_check(_search_thread)) break;
-        free(dir);
+        _edi_searchpanel_batch_flush(&batch);
      }
 
-   // Cleanup in case of interuption
-   EINA_LIST_FREE(dirs, dir)
-     free(dir);
+   eina_stringshare_del(shared);
+   eina_file_close(f);
+}
+
+// The index only knows the files on disk, open files may match in the editor alone.
+static Eina_List *
+_edi_searchpanel_buffers_append(Search_Run *run, const char *directory, Eina_List *paths)
+{
+   Eina_Iterator *it;
+   Eina_Hash *found;
+   Eina_List *l;
+   const char *path;
+
+   if (!run->buffers) return paths;
+
+   found = eina_hash_string_superfast_new(NULL);
+   EINA_LIST_FOREACH(paths, l, path)
+     eina_hash_add(found, path, path);
+
+   it = eina_hash_iterator_key_new(run->buffers);
+   EINA_ITERATOR_FOREACH(it, path)
+     {
+        if (eina_hash_find(found, path) || edi_search_path_ignored(directory, path))
+          continue;
+
+        paths = eina_list_append(paths, strdup(path));
+     }
+   eina_iterator_free(it);
+   eina_hash_free(found);
+
+   return paths;
 }
 
 static void
-_search_end_cb(void *data EINA_UNUSED, Ecore_Thread *thread EINA_UNUSED)
+_edi_searchpanel_search_project(Search_Run *run, Ecore_Thread *thread,
+                                const char *directory)
 {
-   _search_thread = NULL;
-   _searching = EINA_FALSE;
+   const char *literal;
+   Eina_List *paths;
+   char *path;
+
+   // A narrowed search only checks the files the previous one found.
+   if (run->paths)
+     {
+        edi_search_files_run(run->paths, thread, _edi_searchpanel_search_file_cb, run);
+        return;
+     }
+
+   // Files without the term, or the literal the expression requires, can not match.
+   literal = run->regex ? edi_regex_literal_get(run->regex) : run->text;
+   if (!strcmp(directory, edi_project_get()) &&
+       edi_search_index_candidates_get(literal, &paths))
+     {
+        paths = _edi_searchpanel_buffers_append(run, directory, paths);
+        edi_search_files_run(paths, thread, _edi_searchpanel_search_file_cb, run);
+
+        EINA_LIST_FREE(paths, path)
+          free(path);
+        return;
+     }
+
+   edi_search_project_run(directory, thread, _edi_searchpanel_search_file_cb, run);
 }
 
 static void
-_search_begin_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+_edi_searchpanel_search_project_patterns(Search_Run *run, Ecore_Thread *thread,
+                                         const char *directory)
 {
-   const char *path = data;
+   Eina_List *paths = NULL, *candidates, *l;
+   Eina_Hash *found;
+   Eina_Bool indexed = EINA_TRUE;
+   const char *term;
+   char *path;
+
+   // The index answers one term at a time, verify the union of the candidates.
+   found = eina_hash_string_superfast_new(NULL);
+   EINA_LIST_FOREACH(run->tags, l, term)
+     {
+        if (!edi_search_index_candidates_get(term, &candidates))
+          {
+             indexed = EINA_FALSE;
+             break;
+          }
+
+        EINA_LIST_FREE(candidates, path)
+          {
+             if (eina_hash_find(found, path))
+               {
+                  free(path);
+                  continue;
+               }
+
+             eina_hash_add(found, path, path);
+             paths = eina_list_append(paths, path);
+          }
+     }
+   eina_hash_free(found);
+
+   if (indexed)
+     {
+        paths = _edi_searchpanel_buffers_append(run, directory, paths);
+        edi_search_files_run(paths, thread, _edi_searchpanel_search_file_cb, run);
+     }
 
-   _edi_searchpanel_search_project(path, _search_text, _elm_code);
+   EINA_LIST_FREE(paths, path)
+     free(path);
+
+   if (!indexed)
+     edi_search_project_run(directory, thread, _edi_searchpanel_search_file_cb, run);
 }
 
-void
-edi_searchpanel_find(const char *text)
+static void
+_search_begin_cb(void *data, Ecore_Thread *thread)
 {
-   const char *path;
+   Search_Run *run = data;
 
-   if (!text || strlen(text) == 0) return;
+   // All the task tags are found in a single pass over each file.
+   if (run->patterns)
+     _edi_searchpanel_search_project_patterns(run, thread, edi_project_get());
+   else
+     _edi_searchpanel_search_project(run, thread, edi_project_get());
+}
+
+static void
+_search_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Search_Run *run = data;
+
+   run->thread = NULL;
+   run->running = EINA_FALSE;
+   _edi_searchpanel_run_unref(run);
+}
+
+static void
+_edi_searchpanel_run_start(Search_Run *run)
+{
+   if (!run->buffers)
+     run->buffers = _edi_searchpanel_buffers_get();
+   run->running = EINA_TRUE;
+   run->refs++;
+   run->thread = ecore_thread_feedback_run(_search_begin_cb, NULL,
+                                           _search_end_cb, _search_end_cb,
+                                           run, EINA_FALSE);
+
+   if (!_results_animator)
+     _results_animator = ecore_animator_add(_edi_searchpanel_results_drain_cb, NULL);
+}
+
+static void
+_edi_searchpanel_replace_line_append(Search_Replace *replace, const char *path,
+                                     unsigned int line, unsigned int count)
+{
+   Search_Store *store = &_search_store;
+   Eina_Stringshare *shared;
+   Search_Hit hit;
+   unsigned int id, index;
+   char text[PATH_MAX + 64];
+
+   // Kept as a hit, so clicking the file goes to the first occurence.
+   shared = eina_stringshare_add(path);
+   id = _edi_searchpanel_store_file_get(store, shared);
+   eina_stringshare_del(shared);
+
+   memset(&hit, 0, sizeof(Search_Hit));
+   hit.line = line;
+   hit.column = 1;
+   index = _edi_searchpanel_store_hit_add(store, id, &hit, NULL);
+
+   if (replace->dry_run)
+     snprintf(text, sizeof(text), _("%s:%u  %u to replace"), _edi_searchpanel_path_relative(path), line, count);
+   else
+     snprintf(text, sizeof(text), _("%s:%u  %u replaced"), _edi_searchpanel_path_relative(path), line, count);
+   elm_code_file_line_append(_elm_code->file, text, strlen(text),
+                             _edi_searchpanel_line_data(index, EINA_FALSE));
+
+   replace->files++;
+   replace->count += count;
+}
+
+static void
+_edi_searchpanel_replace_file_cb(void *data, const char *path, unsigned int line, unsigned int count)
+{
+   Search_Replace *replace = data;
+
+   if (replace->shown)
+     _edi_searchpanel_replace_line_append(replace, path, line, count);
+}
+
+static void
+_edi_searchpanel_replace_done_cb(void *data, Eina_Bool cancelled)
+{
+   Search_Replace *replace = data;
+   char text[256];
+
+   if (replace->shown && !cancelled)
+     {
+        if (replace->dry_run)
+          snprintf(text, sizeof(text), _("%u occurences to replace in %u files."),
+                   replace->count, replace->files);
+        else
+          snprintf(text, sizeof(text), _("Replaced %u occurences in %u files."),
+                   replace->count, replace->files);
+        elm_code_file_line_append(_elm_code->file, text, strlen(text), NULL);
+     }
+
+   if (_search_replace == replace)
+     _search_replace = NULL;
+   free(replace);
+}
+
+static void
+_edi_searchpanel_replace_detach(void)
+{
+   if (!_search_replace) return;
+
+   _search_replace->shown = EINA_FALSE;
+   if (_search_replace->dry_run)
+     edi_file_text_replace_cancel(_search_replace->replace);
+   _search_replace = NULL;
+}
+
+/*
+ * Replace the matches of a line through the widget, so each can be undone,
+ * the last first so the columns of the others do not move.
+ */
+static void
+_edi_searchpanel_line_replace(Edi_Editor *editor, Elm_Code_Line *line, Eina_Inarray *offsets,
+                              size_t search_length, const char *text)
+{
+   unsigned int *offset, start, end;
+
+   EINA_INARRAY_REVERSE_FOREACH(offsets, offset)
+     {
+        start = elm_code_widget_line_text_column_width_to_position(editor->entry, line, *offset);
+        end = elm_code_widget_line_text_column_width_to_position(editor->entry, line,
+                                                                  *offset + search_length) - 1;
+
+        elm_code_widget_cursor_position_set(editor->entry, line->number, start);
+        elm_code_widget_selection_start(editor->entry, line->number, start);
+        elm_code_widget_selection_end(editor->entry, line->number, end);
+        elm_code_widget_selection_delete(editor->entry);
+        if (text[0])
+          elm_code_widget_text_at_cursor_insert(editor->entry, text);
+     }
+}
+
+/*
+ * Files open in an editor are changed there, line by line, and left for
+ * the user to save, so what was not saved yet is kept and nothing has to be
+ * reloaded. Returns their paths, for the replace on disk to skip them.
+ */
+static Eina_Hash *
+_edi_searchpanel_buffers_replace(Search_Replace *replace, const char *search, const char *text)
+{
+   Edi_Mainview_Item *item;
+   Edi_Editor *editor;
+   Elm_Code_Line *line;
+   Eina_Inarray *offsets;
+   Eina_Hash *skip;
+   Eina_List *items, *l;
+   const char *content, *start, *found;
+   unsigned int length, first, count, offset;
+   size_t search_length;
+
+   search_length = strlen(search);
+   skip = eina_hash_string_superfast_new(NULL);
+   offsets = eina_inarray_new(sizeof(unsigned int), 16);
+
+   items = _edi_searchpanel_editors_get();
+   EINA_LIST_FREE(items, item)
+     {
+        eina_hash_add(skip, item->path, skip);
+        editor = (Edi_Editor *) evas_object_data_get(item->view, "editor");
+
+        first = count = 0;
+        EINA_LIST_FOREACH(elm_code_widget_code_get(editor->entry)->file->lines, l, line)
+          {
+             content = elm_code_line_text_get(line, &length);
+             if (!content) continue;
+
+             found = edi_search_find(content, length, search, search_length);
+             if (!found) continue;
+             if (!first) first = line->number;
+
+             eina_inarray_flush(offsets);
+             for (start = content; found;
+                  found = edi_search_find(start, content + length - start, search, search_length))
+               {
+                  offset = found - content;
+                  eina_inarray_push(offsets, &offset);
+                  start = found + search_length;
+                  count++;
+               }
+
+             if (!replace->dry_run)
+               _edi_searchpanel_line_replace(editor, line, offsets, search_length, text);
+          }
+
+        if (!count) continue;
+
+        if (!replace->dry_run)
+          {
+             edi_editor_modified_set(editor);
+             ecore_event_add(EDI_EVENT_FILE_CHANGED, NULL, NULL, NULL);
+          }
+        _edi_searchpanel_replace_line_append(replace, item->path, first, count);
+     }
 
-   if (_searching)
+   eina_inarray_free(offsets);
+   return skip;
+}
+
+// Show the results of run in the panel from now on, the previous run is left to wind down.
+static void
+_edi_searchpanel_search_replace(Search_Run *run)
+{
+   _edi_searchpanel_run_cancel(_search_run);
+   _edi_searchpanel_run_unref(_search_run);
+   _search_run = run;
+   _edi_searchpanel_replace_detach();
+
+   _edi_searchpanel_code_clear(_elm_code);
+}
+
+static void
+_edi_searchpanel_search_start(const char *text, Edi_Regex *regex, unsigned int max)
+{
+   Search_Run *run;
+
+   run = _edi_searchpanel_run_new(_elm_code, max);
+   run->text = strdup(text);
+   run->regex = regex;
+
+   _edi_searchpanel_search_replace(run);
+   _edi_searchpanel_run_start(run);
+}
+
+// Run the current search again, showing more results.
+static void
+_edi_searchpanel_find_more(void)
+{
+   Edi_Regex *regex = NULL;
+
+   if (_search_run->regex)
+     regex = edi_regex_new(_search_run->text, NULL);
+
+   _edi_searchpanel_search_start(_search_run->text, regex,
+                                 _search_run->max + _edi_config->search_results_max);
+}
+
+// Whether the text of a file open in an editor changed between two runs.
+static Eina_Bool
+_edi_searchpanel_buffer_changed(const Search_Run *run, const Search_Run *previous, const char *path)
+{
+   Search_Buffer *buffer = NULL, *before = NULL;
+
+   if (run->buffers)
+     buffer = eina_hash_find(run->buffers, path);
+   if (previous->buffers)
+     before = eina_hash_find(previous->buffers, path);
+
+   return buffer != before;
+}
+
+/*
+ * A term that contains the term of a finished search can only match lines
+ * that search found. They are read back and checked again, or if the term
+ * starts with blanks, that are not shown, only their files are searched.
+ * Files changed since, on disk or in an editor, are searched again too,
+ * their lines moved.
+ */
+static Eina_Bool
+_edi_searchpanel_search_narrow(const char *text)
+{
+   Search_Run *run, *previous = _search_run;
+   Search_Store *store = &_search_store;
+   Search_Result *kept;
+   Search_Source source;
+   Search_File *file;
+   Search_Hit *hit;
+   Eina_Strbuf *buf;
+   Eina_List *results = NULL;
+   const char *content, *found, *snippet;
+   unsigned int i, j, index, length, snippet_length;
+   size_t text_length;
+
+   if (!previous || previous->regex || !previous->done ||
+       __atomic_load_n(&previous->capped, __ATOMIC_ACQUIRE) || !strstr(text, previous->text))
+     return EINA_FALSE;
+
+   run = _edi_searchpanel_run_new(_elm_code, previous->max);
+   run->text = strdup(text);
+   run->typed = EINA_TRUE;
+   run->buffers = _edi_searchpanel_buffers_get();
+
+   if (text[0] == ' ' || text[0] == '\t')
+     {
+        for (i = 0; i < store->file_count; i++)
+          run->paths = eina_list_append(run->paths, strdup(store->files[i].path));
+
+        _edi_searchpanel_search_replace(run);
+        if (run->paths)
+          _edi_searchpanel_run_start(run);
+        else
+          run->done = EINA_TRUE;
+        return EINA_TRUE;
+     }
+
+   text_length = strlen(text);
+   for (i = 0; i < store->file_count; i++)
+     {
+        file = &store->files[i];
+        if (_edi_searchpanel_buffer_changed(run, previous, file->path))
+          {
+             run->paths = eina_list_append(run->paths, strdup(file->path));
+             continue;
+          }
+        if (!_edi_searchpanel_source_open(&source, file->path, run->buffers))
+          continue;
+        if (source.f && eina_file_mtime_get(source.f) >= previous->started)
+          {
+             _edi_searchpanel_source_close(&source);
+             run->paths = eina_list_append(run->paths, strdup(file->path));
+             continue;
+          }
+
+        kept = NULL;
+        buf = NULL;
+        index = file->first;
+        for (j = 0; j < file->count; j++, index = store->next[index])
+          {
+             content = _edi_searchpanel_source_line_get(&source, store->offset[index], &length);
+             found = content ? edi_search_find(content, length, text, text_length) : NULL;
+             if (!found)
+               continue;
+
+             if (!kept)
+               {
+                  kept = calloc(1, sizeof(Search_Result));
+                  kept->path = eina_stringshare_ref(file->path);
+                  kept->hits = malloc(file->count * sizeof(Search_Hit));
+                  buf = eina_strbuf_new();
+               }
+
+             hit = &kept->hits[kept->count++];
+             hit->offset = store->offset[index];
+             hit->line = store->line[index];
+             hit->column = _edi_searchpanel_column_get(content, found);
+             hit->length = text_length;
+             snippet = _edi_searchpanel_snippet_get(content, content + length, found, &snippet_length);
+             hit->text = eina_strbuf_length_get(buf);
+             hit->text_length = snippet_length;
+             eina_strbuf_append_length(buf, snippet, snippet_length);
+          }
+        _edi_searchpanel_source_close(&source);
+
+        if (!kept)
+          continue;
+
+        kept->text = eina_strbuf_string_steal(buf);
+        eina_strbuf_free(buf);
+        results = eina_list_append(results, kept);
+     }
+
+   _edi_searchpanel_search_replace(run);
+   EINA_LIST_FREE(results, kept)
+     {
+        kept->logger = _elm_code;
+        kept->generation = run->generation;
+        run->count += kept->count;
+        _edi_searchpanel_result_append(kept);
+        free(kept);
+     }
+
+   if (run->paths)
+     _edi_searchpanel_run_start(run);
+   else
+     run->done = EINA_TRUE;
+
+   return EINA_TRUE;
+}
+
+static void
+_edi_searchpanel_typing_cancel(void)
+{
+   if (_search_typing_timer)
+     ecore_timer_del(_search_typing_timer);
+   _search_typing_timer = NULL;
+
+   free(_search_typing_text);
+   _search_typing_text = NULL;
+}
+
+static Eina_Bool
+_edi_searchpanel_typing_timer_cb(void *data EINA_UNUSED)
+{
+   char *text;
+
+   text = _search_typing_text;
+   _search_typing_text = NULL;
+   _search_typing_timer = NULL;
+
+   if (!_search_run || _search_run->regex || strcmp(_search_run->text, text))
      {
-        ecore_thread_cancel(_search_thread);
-        while ((ecore_thread_wait(_search_thread, 0.1)) != EINA_TRUE);
+        if (!_edi_searchpanel_search_narrow(text))
+          {
+             _edi_searchpanel_search_start(text, NULL, _edi_config->search_results_max);
+             _search_run->typed = EINA_TRUE;
+          }
      }
 
-   if (_search_text) free(_search_text);
-   _search_text = strdup(text);
+   free(text);
+   return ECORE_CALLBACK_CANCEL;
+}
 
-   path = edi_project_get();
+void
+edi_searchpanel_find(const char *text)
+{
+   if (!text || strlen(text) == 0) return;
 
-   elm_code_file_clear(_elm_code->file);
+   _edi_searchpanel_typing_cancel();
 
-   _searching = EINA_TRUE;
-   _search_thread = ecore_thread_feedback_run(_search_begin_cb, NULL,
-                                              _search_end_cb, _search_end_cb,
-                                              path, EINA_FALSE);
+   // Already searched for while it was typed.
+   if (_search_run && _search_run->typed && !_search_run->regex &&
+       !strcmp(_search_run->text, text))
+     return;
+
+   _edi_searchpanel_search_start(text, NULL, _edi_config->search_results_max);
+}
+
+void
+edi_searchpanel_find_incremental(const char *text)
+{
+   _edi_searchpanel_typing_cancel();
+
+   if (!text || strlen(text) < EDI_SEARCHPANEL_TYPING_LENGTH_MIN) return;
+
+   _search_typing_text = strdup(text);
+   _search_typing_timer = ecore_timer_add(EDI_SEARCHPANEL_TYPING_DELAY,
+                                          _edi_searchpanel_typing_timer_cb, NULL);
+}
+
+Eina_Bool
+edi_searchpanel_find_regex(const char *pattern, const char **error)
+{
+   Edi_Regex *regex;
+
+   if (!pattern || strlen(pattern) == 0) return EINA_FALSE;
+
+   regex = edi_regex_new(pattern, error);
+   if (!regex) return EINA_FALSE;
+
+   _edi_searchpanel_typing_cancel();
+   _edi_searchpanel_search_start(pattern, regex, _edi_config->search_results_max);
+   return EINA_TRUE;
+}
+
+void
+edi_searchpanel_replace(const char *search, const char *replace, Eina_Bool dry_run)
+{
+   Search_Replace *job;
+   Eina_Hash *skip;
+
+   if (!search || !search[0] || !replace) return;
+
+   _edi_searchpanel_typing_cancel();
+   _edi_searchpanel_search_replace(NULL);
+
+   job = calloc(1, sizeof(Search_Replace));
+   job->dry_run = dry_run;
+   job->shown = EINA_TRUE;
+
+   skip = _edi_searchpanel_buffers_replace(job, search, replace);
+   job->replace = edi_file_text_replace_all(search, replace, dry_run, skip,
+                                            _edi_searchpanel_replace_file_cb,
+                                            _edi_searchpanel_replace_done_cb, job);
+   if (!job->replace)
+     {
+        free(job);
+        return;
+     }
+
+   _search_replace = job;
 }
 
 void
@@ -587,19 +2198,21 @@ edi_searchpanel_add(Evas_Object *parent)
    edi_theme_elm_code_set(widget, _edi_project_config->gui.theme);
    elm_code_widget_font_set(widget, _edi_project_config->font.name, _edi_project_config->font.size);
    elm_code_widget_gravity_set(widget, 0.0, 1.0);
-   efl_event_callback_add(widget, EFL_UI_CODE_WIDGET_EVENT_LINE_CLICKED, _edi_searchpanel_line_clicked_cb, NULL);
+   efl_event_callback_add(widget, EFL_UI_CODE_WIDGET_EVENT_LINE_CLICKED, _edi_searchpanel_line_clicked_cb, code);
    evas_object_size_hint_weight_set(widget, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
    evas_object_size_hint_align_set(widget, EVAS_HINT_FILL, EVAS_HINT_FILL);
    evas_object_show(widget);
 
    _elm_code = code;
    _info_widget = widget;
-   eina_spinlock_new(&logs_lock);
+   _edi_searchpanel_results_init();
 
    elm_object_content_set(frame, widget);
    elm_box_pack_end(parent, frame);
 
    ecore_event_handler_add(EDI_EVENT_CONFIG_CHANGED, _edi_searchpanel_config_changed_cb, NULL);
+
+   edi_search_index_init();
 }
 
 static void
@@ -624,36 +2237,48 @@ _edi_taskspanel_config_changed_cb(void *data EINA_UNUSED, int type EINA_UNUSED,
 
 #define _edi_taskspanel_line_clicked_cb _edi_searchpanel_line_clicked_cb
 
-static void
-_tasks_begin_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+// Split the configured tags on spaces and commas.
+static Eina_List *
+_edi_taskspanel_tags_get(void)
 {
-   const char *path = data;
+   Eina_List *tags = NULL;
+   const char *start, *end;
+
+   start = _edi_project_config->task_tags;
+   if (!start) return NULL;
 
-   _edi_searchpanel_search_project(path, "TODO", _tasks_code);
-   if (ecore_thread_check(_search_thread)) return;
-   _edi_searchpanel_search_project(path, "FIXME", _tasks_code);
-   if (ecore_thread_check(_search_thread)) return;
+   while (*start)
+     {
+        end = start + strcspn(start, " ,");
+        if (end > start)
+          tags = eina_list_append(tags, eina_stringshare_add_length(start, end - start));
+
+        start = *end ? end + 1 : end;
+     }
+
+   return tags;
 }
 
 void
 edi_taskspanel_find(void)
 {
-   const char *path;
-   if (_searching) return;
-
-   elm_code_file_clear(_tasks_code->file);
+   Search_Run *run;
 
-   path = edi_project_get();
+   if (_tasks_run && _tasks_run->running) return;
 
-   if (_searching)
+   run = _edi_searchpanel_run_new(_tasks_code, 0);
+   run->tags = _edi_taskspanel_tags_get();
+   run->patterns = edi_search_patterns_new(run->tags);
+   if (!run->patterns)
      {
-        ecore_thread_cancel(_search_thread);
-        while ((ecore_thread_wait(_search_thread, 0.1)) != EINA_TRUE);
+        _edi_searchpanel_run_unref(run);
+        return;
      }
 
-   _search_thread = ecore_thread_feedback_run(_tasks_begin_cb, NULL,
-                                             _search_end_cb, _search_end_cb,
-                                             path, EINA_FALSE);
+   _edi_searchpanel_run_unref(_tasks_run);
+   _tasks_run = run;
+   _edi_searchpanel_code_clear(_tasks_code);
+   _edi_searchpanel_run_start(run);
 }
 
 void
@@ -675,13 +2300,14 @@ edi_taskspanel_add(Evas_Object *parent)
    elm_code_widget_font_set(widget, _edi_project_config->font.name, _edi_project_config->font.size);
    elm_code_widget_gravity_set(widget, 0.0, 1.0);
    efl_event_callback_add(widget, &ELM_CODE_EVENT_LINE_LOAD_DONE, _edi_taskspanel_line_cb, NULL);
-   efl_event_callback_add(widget, EFL_UI_CODE_WIDGET_EVENT_LINE_CLICKED, _edi_taskspanel_line_clicked_cb, NULL);
+   efl_event_callback_add(widget, EFL_UI_CODE_WIDGET_EVENT_LINE_CLICKED, _edi_taskspanel_line_clicked_cb, code);
    evas_object_size_hint_weight_set(widget, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
    evas_object_size_hint_align_set(widget, EVAS_HINT_FILL, EVAS_HINT_FILL);
    evas_object_show(widget);
 
    _tasks_code = code;
    _tasks_widget = widget;
+   _edi_searchpanel_results_init();
 
    elm_object_content_set(frame, widget);
    elm_box_pack_end(parent, frame);
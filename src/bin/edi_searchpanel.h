@@ -48,6 +48,44 @@ void edi_searchpanel_show();
  */
 void edi_searchpanel_find(const char *text);
 
+/**
+ * Search in project for text as it is being typed. The search starts once
+ * typing pauses, replacing the previous one without waiting for it to stop.
+ * When the text extends the previous search term only the lines that were
+ * already found are checked again.
+ *
+ * @param text The search string typed so far.
+ *
+ * @ingroup UI
+ */
+void edi_searchpanel_find_incremental(const char *text);
+
+/**
+ * Search in project for lines matching a regular expression and print results
+ * to the panel.
+ *
+ * @param pattern The regular expression to match against project files.
+ * @param error Set to a description of the problem if the pattern is invalid.
+ *
+ * @return EINA_FALSE if the pattern is invalid and no search was started.
+ *
+ * @ingroup UI
+ */
+Eina_Bool edi_searchpanel_find_regex(const char *pattern, const char **error);
+
+/**
+ * Replace text in the whole project and print each file changed, with the
+ * number of occurences, to the panel. Files open in an editor are changed
+ * there and left to be saved.
+ *
+ * @param search The text to be replaced.
+ * @param replace The text that will replace.
+ * @param dry_run Only print what would be replaced, as a preview.
+ *
+ * @ingroup UI
+ */
+void edi_searchpanel_replace(const char *search, const char *replace, Eina_Bool dry_run);
+
 /**
  * Initialise a new Edi taskspanel and add it to the parent pane.
  *
@@ -0,0 +1,1460 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sys/stat.h>
+
+#if HAVE_LIBCLANG
+#include <clang-c/Index.h>
+#endif
+
+#include <Eina.h>
+#include <Eet.h>
+#include <Ecore.h>
+#include <Ecore_File.h>
+
+#include "edi_symbol_index.h"
+#include "edi_search.h"
+#include "edi_index_file.h"
+#include "edi_config.h"
+#include "language/edi_language_provider.h"
+
+#include "edi_private.h"
+
+#if HAVE_LIBCLANG
+
+#define EDI_SYMBOL_INDEX_NAME "symbols.idx"
+#define EDI_SYMBOL_INDEX_VERSION 1
+
+// How many reindexed files are kept in memory before the table is rewritten.
+#define EDI_SYMBOL_INDEX_DELTA_MAX 256
+#define EDI_SYMBOL_INDEX_UPDATE_DELAY 0.5
+
+#define EDI_SYMBOL_INDEX_FILE_REMOVED 1
+#define EDI_SYMBOL_INDEX_FILE_INDEXED 2
+
+/*
+ * The table lists every symbol found in the project sorted by its USR, the
+ * places it occurs in are stored next to each other. The names order the
+ * same symbols by name. Each file is indexed through a unit of the
+ * compilation database that includes it, which is indexed again when the
+ * file changes.
+ */
+typedef struct
+{
+   unsigned int path;
+   unsigned int unit;
+   unsigned int flags;
+   long long mtime;
+} Edi_Symbol_Index_File;
+
+typedef struct
+{
+   unsigned int usr, name;
+   unsigned int kind;
+   unsigned int offset, count;
+} Edi_Symbol_Index_Symbol;
+
+typedef struct
+{
+   unsigned int file;
+   unsigned int line, column;
+   unsigned int flags;
+} Edi_Symbol_Index_Occurrence;
+
+typedef struct
+{
+   Edi_Symbol_Index_File *files;
+   unsigned int file_count;
+   char *paths;
+   unsigned int paths_size;
+   Edi_Symbol_Index_Symbol *symbols;
+   unsigned int symbol_count;
+   unsigned int *names;
+   char *strings;
+   unsigned int strings_size;
+   Edi_Symbol_Index_Occurrence *occurrences;
+   unsigned int occurrence_count;
+   long long database;
+} Edi_Symbol_Index_Table;
+
+// A symbol found in a file indexed again since the table was written.
+typedef struct
+{
+   const char *usr, *name;
+   unsigned int kind;
+   unsigned int line, column;
+   unsigned int flags;
+} Edi_Symbol_Index_Found;
+
+typedef struct
+{
+   const char *unit;
+   long long mtime;
+   Eina_Inarray *found;
+} Edi_Symbol_Index_Delta;
+
+typedef struct
+{
+   char *directory;
+   char *filename;
+   char *database;
+   char *working; /**< Where the units are compiled from, as the language provider does */
+
+   Eina_Hash *commands; /**< The units of the compilation database, by path */
+   long long database_mtime;
+
+   Edi_Symbol_Index_Table table;
+   Eina_Hash *ids;
+   Eina_Hash *delta;
+   unsigned int removed;
+   Eina_Bool ready;
+
+   Ecore_Thread *thread;
+   Ecore_Timer *timer;
+   Eina_List *pending;
+   Eina_List *handlers;
+} Edi_Symbol_Index;
+
+// What indexing one command of the compilation database found, by file.
+typedef struct
+{
+   Edi_Symbol_Index *index;
+   const char *path;
+   Ecore_Thread *thread;
+   Eina_Hash *cxfiles;
+   Eina_Hash *files;
+} Edi_Symbol_Index_Unit;
+
+typedef struct
+{
+   const char *name;
+   unsigned int kind;
+   Eina_Inarray *occurrences;
+} Edi_Symbol_Index_Builder_Symbol;
+
+typedef struct
+{
+   Eina_Lock lock;
+   Eina_Hash *symbols;
+   Eina_Inarray *files;
+   Eina_Binbuf *paths;
+   Eina_Hash *ids;
+} Edi_Symbol_Index_Builder;
+
+typedef struct
+{
+   Edi_Symbol_Index *index;
+   Edi_Symbol_Index_Builder *builder;
+   Ecore_Thread *thread;
+} Edi_Symbol_Index_Walk;
+
+typedef struct
+{
+   Edi_Symbol_Index *index;
+   Eina_List *paths;
+} Edi_Symbol_Index_Update;
+
+static Edi_Symbol_Index *_index = NULL;
+static Eina_Lock _index_lock;
+static Eina_Bool _index_lock_ready = EINA_FALSE;
+
+// Marks the files of a unit that are not part of the project.
+static Edi_Symbol_Index_Delta _edi_symbol_index_outside;
+
+static void
+_edi_symbol_index_delta_free(void *data)
+{
+   Edi_Symbol_Index_Delta *delta = data;
+   Edi_Symbol_Index_Found *found;
+
+   EINA_INARRAY_FOREACH(delta->found, found)
+     {
+        eina_stringshare_del(found->usr);
+        eina_stringshare_del(found->name);
+     }
+   eina_inarray_free(delta->found);
+   eina_stringshare_del(delta->unit);
+   free(delta);
+}
+
+static void
+_edi_symbol_index_table_free(Edi_Symbol_Index_Table *table)
+{
+   free(table->files);
+   free(table->paths);
+   free(table->symbols);
+   free(table->names);
+   free(table->strings);
+   free(table->occurrences);
+   memset(table, 0, sizeof(Edi_Symbol_Index_Table));
+}
+
+static char *
+_edi_symbol_index_path_get(const char *directory, const char *file)
+{
+   char *path, *sanitized;
+
+   if (!file || !*file)
+     return NULL;
+   if (file[0] == '/' || !directory)
+     return eina_file_path_sanitize(file);
+
+   path = edi_path_append(directory, file);
+   sanitized = eina_file_path_sanitize(path);
+   free(path);
+
+   return sanitized;
+}
+
+// The compilation database is looked for where the C language provider finds it, which loads it.
+static char *
+_edi_symbol_index_database_path_get(void)
+{
+   if (edi_project_file_exists("build/compile_commands.json"))
+     return edi_project_file_path_get("build/compile_commands.json");
+
+   return edi_project_file_path_get("compile_commands.json");
+}
+
+// Load the compilation database again if it changed since it was last loaded.
+static Eina_Bool
+_edi_symbol_index_commands_update(Edi_Symbol_Index *index)
+{
+   Eina_List *files;
+   long long mtime;
+   char *path;
+
+   mtime = ecore_file_mod_time(index->database);
+   if (index->commands && mtime == index->database_mtime)
+     return EINA_FALSE;
+
+   if (index->commands)
+     eina_hash_free(index->commands);
+
+   index->commands = eina_hash_string_superfast_new(NULL);
+   index->database_mtime = mtime;
+
+   files = edi_language_c_files_get();
+   if (!files)
+     INF("No compile_commands.json to index symbols with in %s", index->directory);
+   EINA_LIST_FREE(files, path)
+     {
+        if (!eina_hash_find(index->commands, path))
+          eina_hash_add(index->commands, path, (void *) 1);
+        free(path);
+     }
+
+   return EINA_TRUE;
+}
+
+// The symbols found in a file of the unit, or NULL if it is not part of the project.
+static Edi_Symbol_Index_Delta *
+_edi_symbol_index_unit_file_get(Edi_Symbol_Index_Unit *unit, CXFile file)
+{
+   Edi_Symbol_Index_Delta *delta;
+   struct stat st;
+   CXString name;
+   char *path;
+   size_t length;
+
+   if (!file)
+     return NULL;
+
+   delta = eina_hash_find(unit->cxfiles, &file);
+   if (delta)
+     return delta == &_edi_symbol_index_outside ? NULL : delta;
+
+   name = clang_getFileName(file);
+   path = _edi_symbol_index_path_get(unit->index->working, clang_getCString(name));
+   clang_disposeString(name);
+
+   length = strlen(unit->index->directory);
+   if (!path || strncmp(path, unit->index->directory, length) || path[length] != '/' ||
+       stat(path, &st))
+     {
+        eina_hash_add(unit->cxfiles, &file, &_edi_symbol_index_outside);
+        free(path);
+        return NULL;
+     }
+
+   delta = eina_hash_find(unit->files, path);
+   if (!delta)
+     {
+        delta = calloc(1, sizeof(Edi_Symbol_Index_Delta));
+        delta->unit = eina_stringshare_add(unit->path);
+        delta->mtime = st.st_mtime;
+        delta->found = eina_inarray_new(sizeof(Edi_Symbol_Index_Found), 64);
+        eina_hash_add(unit->files, path, delta);
+     }
+   eina_hash_add(unit->cxfiles, &file, delta);
+   free(path);
+
+   return delta;
+}
+
+static void
+_edi_symbol_index_unit_found_add(Edi_Symbol_Index_Unit *unit, CXIdxLoc loc,
+                                 const CXIdxEntityInfo *entity, unsigned int flags)
+{
+   Edi_Symbol_Index_Delta *delta;
+   Edi_Symbol_Index_Found found;
+   CXFile file;
+   unsigned int line, column;
+
+   if (!entity || !entity->USR || !entity->USR[0] || !entity->name)
+     return;
+
+   clang_indexLoc_getFileLocation(loc, NULL, &file, &line, &column, NULL);
+   delta = _edi_symbol_index_unit_file_get(unit, file);
+   if (!delta)
+     return;
+
+   found.usr = eina_stringshare_add(entity->USR);
+   found.name = eina_stringshare_add(entity->name);
+   found.kind = entity->kind;
+   found.line = line;
+   found.column = column;
+   found.flags = flags;
+   eina_inarray_push(delta->found, &found);
+}
+
+static int
+_edi_symbol_index_abort_cb(CXClientData data, void *reserved EINA_UNUSED)
+{
+   Edi_Symbol_Index_Unit *unit = data;
+
+   return ecore_thread_check(unit->thread);
+}
+
+static CXIdxClientFile
+_edi_symbol_index_main_file_cb(CXClientData data, CXFile file, void *reserved EINA_UNUSED)
+{
+   // Known even if it declares nothing, so it is not indexed again on every open.
+   _edi_symbol_index_unit_file_get(data, file);
+
+   return NULL;
+}
+
+static void
+_edi_symbol_index_declaration_cb(CXClientData data, const CXIdxDeclInfo *info)
+{
+   _edi_symbol_index_unit_found_add(data, info->loc, info->entityInfo,
+                                    info->isDefinition ? EDI_SYMBOL_DEFINITION : EDI_SYMBOL_DECLARATION);
+}
+
+static void
+_edi_symbol_index_reference_cb(CXClientData data, const CXIdxEntityRefInfo *info)
+{
+   _edi_symbol_index_unit_found_add(data, info->loc, info->referencedEntity, EDI_SYMBOL_REFERENCE);
+}
+
+static Edi_Symbol_Index_Unit *
+_edi_symbol_index_unit_run(Edi_Symbol_Index *index, const char *path, Ecore_Thread *thread)
+{
+   Edi_Symbol_Index_Unit *unit;
+   IndexerCallbacks callbacks;
+   CXIndexAction action;
+   char **args;
+   unsigned int argc;
+
+   unit = calloc(1, sizeof(Edi_Symbol_Index_Unit));
+   unit->index = index;
+   unit->path = path;
+   unit->thread = thread;
+   unit->cxfiles = eina_hash_pointer_new(NULL);
+   unit->files = eina_hash_string_superfast_new(_edi_symbol_index_delta_free);
+
+   memset(&callbacks, 0, sizeof(IndexerCallbacks));
+   callbacks.abortQuery = _edi_symbol_index_abort_cb;
+   callbacks.enteredMainFile = _edi_symbol_index_main_file_cb;
+   callbacks.indexDeclaration = _edi_symbol_index_declaration_cb;
+   callbacks.indexEntityReference = _edi_symbol_index_reference_cb;
+
+   // Parsed the way the editors parse it, with the index they share.
+   args = edi_language_c_args_get(path, &argc);
+   action = clang_IndexAction_create(edi_language_c_index_get());
+   if (clang_indexSourceFile(action, unit, &callbacks, sizeof(IndexerCallbacks),
+                             CXIndexOpt_SuppressWarnings | CXIndexOpt_SuppressRedundantRefs,
+                             path, (const char * const *) args, argc,
+                             NULL, 0, NULL, CXTranslationUnit_None))
+     INF("Could not index symbols of %s", path);
+   clang_IndexAction_dispose(action);
+   edi_language_c_args_free(args);
+
+   return unit;
+}
+
+static void
+_edi_symbol_index_unit_free(Edi_Symbol_Index_Unit *unit)
+{
+   eina_hash_free(unit->cxfiles);
+   eina_hash_free(unit->files);
+   free(unit);
+}
+
+static void
+_edi_symbol_index_builder_symbol_free(void *data)
+{
+   Edi_Symbol_Index_Builder_Symbol *symbol = data;
+
+   eina_stringshare_del(symbol->name);
+   eina_inarray_free(symbol->occurrences);
+   free(symbol);
+}
+
+static void
+_edi_symbol_index_builder_init(Edi_Symbol_Index_Builder *builder)
+{
+   eina_lock_new(&builder->lock);
+   builder->symbols = eina_hash_string_superfast_new(_edi_symbol_index_builder_symbol_free);
+   builder->files = eina_inarray_new(sizeof(Edi_Symbol_Index_File), 256);
+   builder->paths = eina_binbuf_new();
+   builder->ids = eina_hash_string_superfast_new(NULL);
+}
+
+static void
+_edi_symbol_index_builder_shutdown(Edi_Symbol_Index_Builder *builder)
+{
+   eina_hash_free(builder->symbols);
+   eina_inarray_free(builder->files);
+   eina_binbuf_free(builder->paths);
+   eina_hash_free(builder->ids);
+   eina_lock_free(&builder->lock);
+}
+
+static unsigned int
+_edi_symbol_index_builder_file_get(Edi_Symbol_Index_Builder *builder, const char *path)
+{
+   Edi_Symbol_Index_File file;
+   unsigned int id;
+
+   id = (uintptr_t) eina_hash_find(builder->ids, path);
+   if (id)
+     return id - 1;
+
+   id = eina_inarray_count(builder->files);
+
+   memset(&file, 0, sizeof(Edi_Symbol_Index_File));
+   file.path = eina_binbuf_length_get(builder->paths);
+   file.unit = id;
+   eina_inarray_push(builder->files, &file);
+   eina_binbuf_append_length(builder->paths, (const unsigned char *) path, strlen(path) + 1);
+   eina_hash_add(builder->ids, path, (void *) (uintptr_t) (id + 1));
+
+   return id;
+}
+
+// The id to add the symbols of a file with, or UINT_MAX if another unit added them already.
+static unsigned int
+_edi_symbol_index_builder_file_add(Edi_Symbol_Index_Builder *builder, const char *path,
+                                   const char *unit, long long mtime)
+{
+   Edi_Symbol_Index_File *file;
+   unsigned int id, unit_id;
+
+   id = _edi_symbol_index_builder_file_get(builder, path);
+   file = eina_inarray_nth(builder->files, id);
+   if (file->flags & EDI_SYMBOL_INDEX_FILE_INDEXED)
+     return UINT_MAX;
+
+   unit_id = _edi_symbol_index_builder_file_get(builder, unit);
+   file = eina_inarray_nth(builder->files, id);
+   file->unit = unit_id;
+   file->mtime = mtime;
+   file->flags = EDI_SYMBOL_INDEX_FILE_INDEXED;
+
+   return id;
+}
+
+static void
+_edi_symbol_index_builder_occurrence_add(Edi_Symbol_Index_Builder *builder, const char *usr,
+                                         const char *name, unsigned int kind, unsigned int file,
+                                         unsigned int line, unsigned int column, unsigned int flags)
+{
+   Edi_Symbol_Index_Builder_Symbol *symbol;
+   Edi_Symbol_Index_Occurrence occurrence;
+
+   symbol = eina_hash_find(builder->symbols, usr);
+   if (!symbol)
+     {
+        symbol = calloc(1, sizeof(Edi_Symbol_Index_Builder_Symbol));
+        symbol->name = eina_stringshare_add(name);
+        symbol->kind = kind;
+        symbol->occurrences = eina_inarray_new(sizeof(Edi_Symbol_Index_Occurrence), 4);
+        eina_hash_add(builder->symbols, usr, symbol);
+     }
+
+   occurrence.file = file;
+   occurrence.line = line;
+   occurrence.column = column;
+   occurrence.flags = flags;
+   eina_inarray_push(symbol->occurrences, &occurrence);
+}
+
+static void
+_edi_symbol_index_builder_unit_add(Edi_Symbol_Index_Builder *builder, Edi_Symbol_Index_Unit *unit)
+{
+   Edi_Symbol_Index_Found *found;
+   Eina_Hash_Tuple *tuple;
+   Eina_Iterator *it;
+   unsigned int id;
+
+   it = eina_hash_iterator_tuple_new(unit->files);
+   EINA_ITERATOR_FOREACH(it, tuple)
+     {
+        Edi_Symbol_Index_Delta *delta = tuple->data;
+
+        id = _edi_symbol_index_builder_file_add(builder, tuple->key, delta->unit, delta->mtime);
+        if (id == UINT_MAX)
+          continue;
+
+        EINA_INARRAY_FOREACH(delta->found, found)
+          _edi_symbol_index_builder_occurrence_add(builder, found->usr, found->name, found->kind,
+                                                   id, found->line, found->column, found->flags);
+     }
+   eina_iterator_free(it);
+}
+
+typedef struct
+{
+   const char *key;
+   Edi_Symbol_Index_Builder_Symbol *symbol;
+   unsigned int id;
+} Edi_Symbol_Index_Builder_Entry;
+
+static Eina_Bool
+_edi_symbol_index_builder_entry_collect(const Eina_Hash *hash EINA_UNUSED, const void *key,
+                                        void *data, void *fdata)
+{
+   Edi_Symbol_Index_Builder_Entry **entry = fdata;
+
+   (*entry)->key = key;
+   (*entry)->symbol = data;
+   (*entry)++;
+
+   return EINA_TRUE;
+}
+
+static int
+_edi_symbol_index_builder_entry_cmp(const void *a, const void *b)
+{
+   const Edi_Symbol_Index_Builder_Entry *e1 = a, *e2 = b;
+
+   return strcmp(e1->key, e2->key);
+}
+
+static void
+_edi_symbol_index_builder_finish(Edi_Symbol_Index_Builder *builder, Edi_Symbol_Index_Table *table)
+{
+   Edi_Symbol_Index_Builder_Entry *entries, *entry, *names;
+   Eina_Binbuf *strings;
+   unsigned int i, count, offset = 0;
+
+   memset(table, 0, sizeof(Edi_Symbol_Index_Table));
+
+   table->file_count = eina_inarray_count(builder->files);
+   if (table->file_count)
+     {
+        table->files = malloc(table->file_count * sizeof(Edi_Symbol_Index_File));
+        memcpy(table->files, eina_inarray_nth(builder->files, 0),
+               table->file_count * sizeof(Edi_Symbol_Index_File));
+     }
+
+   table->paths_size = eina_binbuf_length_get(builder->paths);
+   table->paths = (char *) eina_binbuf_string_steal(builder->paths);
+
+   table->symbol_count = eina_hash_population(builder->symbols);
+   if (!table->symbol_count) return;
+
+   entries = entry = malloc(table->symbol_count * sizeof(Edi_Symbol_Index_Builder_Entry));
+   eina_hash_foreach(builder->symbols, _edi_symbol_index_builder_entry_collect, &entry);
+   qsort(entries, table->symbol_count, sizeof(Edi_Symbol_Index_Builder_Entry),
+         _edi_symbol_index_builder_entry_cmp);
+
+   for (i = 0; i < table->symbol_count; i++)
+     table->occurrence_count += eina_inarray_count(entries[i].symbol->occurrences);
+
+   strings = eina_binbuf_new();
+   names = malloc(table->symbol_count * sizeof(Edi_Symbol_Index_Builder_Entry));
+   table->symbols = malloc(table->symbol_count * sizeof(Edi_Symbol_Index_Symbol));
+   table->names = malloc(table->symbol_count * sizeof(unsigned int));
+   table->occurrences = malloc((table->occurrence_count + 1) * sizeof(Edi_Symbol_Index_Occurrence));
+   for (i = 0; i < table->symbol_count; i++)
+     {
+        Edi_Symbol_Index_Builder_Symbol *symbol = entries[i].symbol;
+        Edi_Symbol_Index_Symbol *indexed = &table->symbols[i];
+
+        indexed->usr = eina_binbuf_length_get(strings);
+        eina_binbuf_append_length(strings, (const unsigned char *) entries[i].key,
+                                  strlen(entries[i].key) + 1);
+        indexed->name = eina_binbuf_length_get(strings);
+        eina_binbuf_append_length(strings, (const unsigned char *) symbol->name,
+                                  strlen(symbol->name) + 1);
+        indexed->kind = symbol->kind;
+
+        count = eina_inarray_count(symbol->occurrences);
+        indexed->offset = offset;
+        indexed->count = count;
+        if (count)
+          memcpy(table->occurrences + offset, eina_inarray_nth(symbol->occurrences, 0),
+                 count * sizeof(Edi_Symbol_Index_Occurrence));
+        offset += count;
+
+        names[i].key = symbol->name;
+        names[i].id = i;
+     }
+
+   qsort(names, table->symbol_count, sizeof(Edi_Symbol_Index_Builder_Entry),
+         _edi_symbol_index_builder_entry_cmp);
+   for (i = 0; i < table->symbol_count; i++)
+     table->names[i] = names[i].id;
+
+   table->strings_size = eina_binbuf_length_get(strings);
+   table->strings = (char *) eina_binbuf_string_steal(strings);
+   eina_binbuf_free(strings);
+
+   free(names);
+   free(entries);
+}
+
+static Eina_Bool
+_edi_symbol_index_table_write(Edi_Symbol_Index_Table *table, const char *filename,
+                              const char *directory)
+{
+   Eet_File *ef;
+   Eina_Bool ok;
+
+   ef = edi_index_file_write_begin(filename, EDI_SYMBOL_INDEX_VERSION, directory);
+   if (!ef)
+     return EINA_FALSE;
+
+   ok = eet_write(ef, "database", &table->database, sizeof(long long), EET_COMPRESSION_NONE) &&
+        (!table->file_count ||
+         (eet_write(ef, "files", table->files, table->file_count * sizeof(Edi_Symbol_Index_File),
+                    EET_COMPRESSION_VERYFAST) &&
+          eet_write(ef, "paths", table->paths, table->paths_size, EET_COMPRESSION_VERYFAST))) &&
+        (!table->symbol_count ||
+         (eet_write(ef, "symbols", table->symbols, table->symbol_count * sizeof(Edi_Symbol_Index_Symbol),
+                    EET_COMPRESSION_VERYFAST) &&
+          eet_write(ef, "names", table->names, table->symbol_count * sizeof(unsigned int),
+                    EET_COMPRESSION_VERYFAST) &&
+          eet_write(ef, "strings", table->strings, table->strings_size, EET_COMPRESSION_VERYFAST))) &&
+        (!table->occurrence_count ||
+         eet_write(ef, "occurrences", table->occurrences,
+                   table->occurrence_count * sizeof(Edi_Symbol_Index_Occurrence), EET_COMPRESSION_VERYFAST));
+
+   return edi_index_file_write_end(ef, filename, ok);
+}
+
+static Eina_Bool
+_edi_symbol_index_table_read(Edi_Symbol_Index_Table *table, const char *filename,
+                             const char *directory)
+{
+   Eet_File *ef;
+   int size, names_size = 0;
+   long long *database;
+   unsigned int i;
+   Eina_Bool ok = EINA_TRUE;
+
+   memset(table, 0, sizeof(Edi_Symbol_Index_Table));
+
+   ef = edi_index_file_open(filename, EDI_SYMBOL_INDEX_VERSION, directory);
+   if (!ef) return EINA_FALSE;
+
+   database = eet_read(ef, "database", &size);
+   if (database && size == sizeof(long long))
+     table->database = *database;
+   else
+     ok = EINA_FALSE;
+   free(database);
+
+   if (ok)
+     {
+        table->files = eet_read(ef, "files", &size);
+        table->file_count = size / sizeof(Edi_Symbol_Index_File);
+        table->paths = eet_read(ef, "paths", &size);
+        table->paths_size = size;
+        table->symbols = eet_read(ef, "symbols", &size);
+        table->symbol_count = size / sizeof(Edi_Symbol_Index_Symbol);
+        table->names = eet_read(ef, "names", &names_size);
+        table->strings = eet_read(ef, "strings", &size);
+        table->strings_size = size;
+        table->occurrences = eet_read(ef, "occurrences", &size);
+        table->occurrence_count = size / sizeof(Edi_Symbol_Index_Occurrence);
+     }
+   eet_close(ef);
+
+   if (!ok) return EINA_FALSE;
+
+   // Validate every offset so a damaged file is rebuilt rather than trusted.
+   if (table->file_count && (!table->paths || table->paths[table->paths_size - 1]))
+     ok = EINA_FALSE;
+   if (table->symbol_count && (!table->strings || table->strings[table->strings_size - 1] ||
+                               names_size != (int) (table->symbol_count * sizeof(unsigned int))))
+     ok = EINA_FALSE;
+   for (i = 0; ok && i < table->file_count; i++)
+     if (table->files[i].path >= table->paths_size || table->files[i].unit >= table->file_count)
+       ok = EINA_FALSE;
+   for (i = 0; ok && i < table->symbol_count; i++)
+     if (table->symbols[i].usr >= table->strings_size || table->symbols[i].name >= table->strings_size ||
+         table->symbols[i].offset > table->occurrence_count ||
+         table->symbols[i].count > table->occurrence_count - table->symbols[i].offset ||
+         table->names[i] >= table->symbol_count ||
+         (i && strcmp(table->strings + table->symbols[i - 1].usr, table->strings + table->symbols[i].usr) >= 0))
+       ok = EINA_FALSE;
+   for (i = 0; ok && i < table->occurrence_count; i++)
+     if (table->occurrences[i].file >= table->file_count)
+       ok = EINA_FALSE;
+
+   if (!ok)
+     {
+        WRN("Ignoring damaged symbol index %s", filename);
+        _edi_symbol_index_table_free(table);
+     }
+
+   return ok;
+}
+
+// Replace the table, dropping the changes it now includes. Called with the lock held.
+static void
+_edi_symbol_index_table_set(Edi_Symbol_Index *index, Edi_Symbol_Index_Table *table)
+{
+   unsigned int i;
+
+   eina_hash_free_buckets(index->ids);
+   eina_hash_free_buckets(index->delta);
+   _edi_symbol_index_table_free(&index->table);
+
+   index->table = *table;
+   index->removed = 0;
+
+   for (i = 0; i < table->file_count; i++)
+     eina_hash_direct_add(index->ids, table->paths + table->files[i].path,
+                          (void *) (uintptr_t) (i + 1));
+}
+
+// Write the table again with the files indexed since merged in. Only the index thread changes
+// the table, so it is read here without the lock, which is only held while the new one is set.
+static void
+_edi_symbol_index_compact(Edi_Symbol_Index *index)
+{
+   Edi_Symbol_Index_Builder builder;
+   Edi_Symbol_Index_Table *current = &index->table, table;
+   Edi_Symbol_Index_Found *found;
+   Eina_Hash_Tuple *tuple;
+   Eina_Iterator *it;
+   unsigned int *map, i, j, id;
+
+   _edi_symbol_index_builder_init(&builder);
+
+   map = malloc((current->file_count + 1) * sizeof(unsigned int));
+   for (i = 0; i < current->file_count; i++)
+     {
+        Edi_Symbol_Index_File *file = &current->files[i];
+
+        if (file->flags & EDI_SYMBOL_INDEX_FILE_REMOVED || !(file->flags & EDI_SYMBOL_INDEX_FILE_INDEXED))
+          map[i] = UINT_MAX;
+        else
+          map[i] = _edi_symbol_index_builder_file_add(&builder, current->paths + file->path,
+                                                      current->paths + current->files[file->unit].path,
+                                                      file->mtime);
+     }
+
+   for (i = 0; i < current->symbol_count; i++)
+     {
+        Edi_Symbol_Index_Symbol *symbol = &current->symbols[i];
+
+        for (j = symbol->offset; j < symbol->offset + symbol->count; j++)
+          {
+             Edi_Symbol_Index_Occurrence *occurrence = &current->occurrences[j];
+
+             if (map[occurrence->file] == UINT_MAX)
+               continue;
+
+             _edi_symbol_index_builder_occurrence_add(&builder, current->strings + symbol->usr,
+                                                      current->strings + symbol->name, symbol->kind,
+                                                      map[occurrence->file], occurrence->line,
+                                                      occurrence->column, occurrence->flags);
+          }
+     }
+   free(map);
+
+   it = eina_hash_iterator_tuple_new(index->delta);
+   EINA_ITERATOR_FOREACH(it, tuple)
+     {
+        Edi_Symbol_Index_Delta *delta = tuple->data;
+
+        id = _edi_symbol_index_builder_file_add(&builder, tuple->key, delta->unit, delta->mtime);
+        if (id == UINT_MAX)
+          continue;
+
+        EINA_INARRAY_FOREACH(delta->found, found)
+          _edi_symbol_index_builder_occurrence_add(&builder, found->usr, found->name, found->kind,
+                                                   id, found->line, found->column, found->flags);
+     }
+   eina_iterator_free(it);
+
+   _edi_symbol_index_builder_finish(&builder, &table);
+   _edi_symbol_index_builder_shutdown(&builder);
+
+   table.database = current->database;
+
+   eina_lock_take(&_index_lock);
+   _edi_symbol_index_table_set(index, &table);
+   eina_lock_release(&_index_lock);
+
+   _edi_symbol_index_table_write(&index->table, index->filename, index->directory);
+}
+
+// Replace what was found through a unit by what indexing it again found. Called with the lock held.
+static void
+_edi_symbol_index_unit_apply(Edi_Symbol_Index *index, Edi_Symbol_Index_Unit *unit)
+{
+   Edi_Symbol_Index_Table *table = &index->table;
+   Edi_Symbol_Index_Delta *delta;
+   Eina_Hash_Tuple *tuple;
+   Eina_Iterator *it;
+   Eina_List *stale = NULL;
+   const char *path;
+   unsigned int i, id;
+
+   // Files the unit does not include any more are dropped, unless another one does.
+   id = (uintptr_t) eina_hash_find(index->ids, unit->path);
+   for (i = 0; id && i < table->file_count; i++)
+     {
+        Edi_Symbol_Index_File *file = &table->files[i];
+
+        if (file->unit != id - 1 || file->flags & EDI_SYMBOL_INDEX_FILE_REMOVED ||
+            eina_hash_find(unit->files, table->paths + file->path))
+          continue;
+
+        file->flags |= EDI_SYMBOL_INDEX_FILE_REMOVED;
+        index->removed++;
+     }
+
+   it = eina_hash_iterator_tuple_new(index->delta);
+   EINA_ITERATOR_FOREACH(it, tuple)
+     {
+        delta = tuple->data;
+
+        if (!strcmp(delta->unit, unit->path) && !eina_hash_find(unit->files, tuple->key))
+          stale = eina_list_append(stale, tuple->key);
+     }
+   eina_iterator_free(it);
+   EINA_LIST_FREE(stale, path)
+     eina_hash_del_by_key(index->delta, path);
+
+   it = eina_hash_iterator_tuple_new(unit->files);
+   EINA_ITERATOR_FOREACH(it, tuple)
+     {
+        id = (uintptr_t) eina_hash_find(index->ids, tuple->key);
+        if (id && !(table->files[id - 1].flags & EDI_SYMBOL_INDEX_FILE_REMOVED))
+          {
+             table->files[id - 1].flags |= EDI_SYMBOL_INDEX_FILE_REMOVED;
+             index->removed++;
+          }
+
+        delta = eina_hash_set(index->delta, tuple->key, tuple->data);
+        if (delta)
+          _edi_symbol_index_delta_free(delta);
+     }
+   eina_iterator_free(it);
+
+   // The index owns what was found now.
+   eina_hash_free_cb_set(unit->files, NULL);
+}
+
+// Runs on the pool of scanner threads, once for each unit to index.
+static void
+_edi_symbol_index_unit_cb(void *data, const char *path)
+{
+   Edi_Symbol_Index_Walk *walk = data;
+   Edi_Symbol_Index_Unit *unit;
+
+   if (!eina_hash_find(walk->index->commands, path)) return;
+
+   unit = _edi_symbol_index_unit_run(walk->index, path, walk->thread);
+   if (walk->builder)
+     {
+        eina_lock_take(&walk->builder->lock);
+        _edi_symbol_index_builder_unit_add(walk->builder, unit);
+        eina_lock_release(&walk->builder->lock);
+     }
+   else if (!ecore_thread_check(walk->thread))
+     {
+        eina_lock_take(&_index_lock);
+        _edi_symbol_index_unit_apply(walk->index, unit);
+        eina_lock_release(&_index_lock);
+     }
+
+   _edi_symbol_index_unit_free(unit);
+}
+
+// The units to index again for the files that changed, to be freed with the stringshares.
+static Eina_List *
+_edi_symbol_index_units_get(Edi_Symbol_Index *index, Eina_List *paths)
+{
+   Edi_Symbol_Index_Delta *delta;
+   Eina_List *l, *units = NULL;
+   Eina_Hash *seen;
+   const char *path, *unit;
+   unsigned int id;
+
+   seen = eina_hash_string_superfast_new(NULL);
+
+   eina_lock_take(&_index_lock);
+   EINA_LIST_FOREACH(paths, l, path)
+     {
+        unit = NULL;
+        if (eina_hash_find(index->commands, path))
+          unit = path;
+        else if ((delta = eina_hash_find(index->delta, path)))
+          unit = delta->unit;
+        else if ((id = (uintptr_t) eina_hash_find(index->ids, path)))
+          unit = index->table.paths + index->table.files[index->table.files[id - 1].unit].path;
+
+        // Headers no unit was found to include are picked up once one does.
+        if (!unit || eina_hash_find(seen, unit))
+          continue;
+
+        eina_hash_add(seen, unit, (void *) 1);
+        units = eina_list_append(units, eina_stringshare_add(unit));
+     }
+   eina_lock_release(&_index_lock);
+
+   eina_hash_free(seen);
+   return units;
+}
+
+static void
+_edi_symbol_index_units_run(Edi_Symbol_Index *index, Eina_List *units, Ecore_Thread *thread)
+{
+   Edi_Symbol_Index_Walk walk = { index, NULL, thread };
+   const char *unit;
+
+   edi_search_files_run(units, thread, _edi_symbol_index_unit_cb, &walk);
+
+   EINA_LIST_FREE(units, unit)
+     eina_stringshare_del(unit);
+}
+
+static void
+_edi_symbol_index_build(Edi_Symbol_Index *index, Ecore_Thread *thread)
+{
+   Edi_Symbol_Index_Builder builder;
+   Edi_Symbol_Index_Table table;
+   Edi_Symbol_Index_Walk walk = { index, &builder, thread };
+   Eina_Iterator *it;
+   Eina_List *paths = NULL;
+   const char *path;
+
+   INF("Building symbol index for %s", index->directory);
+
+   it = eina_hash_iterator_key_new(index->commands);
+   EINA_ITERATOR_FOREACH(it, path)
+     paths = eina_list_append(paths, path);
+   eina_iterator_free(it);
+
+   _edi_symbol_index_builder_init(&builder);
+   edi_search_files_run(paths, thread, _edi_symbol_index_unit_cb, &walk);
+   eina_list_free(paths);
+
+   if (!ecore_thread_check(thread))
+     {
+        _edi_symbol_index_builder_finish(&builder, &table);
+        table.database = index->database_mtime;
+
+        eina_lock_take(&_index_lock);
+        _edi_symbol_index_table_set(index, &table);
+        eina_lock_release(&_index_lock);
+
+        _edi_symbol_index_table_write(&index->table, index->filename, index->directory);
+     }
+
+   _edi_symbol_index_builder_shutdown(&builder);
+}
+
+static void
+_edi_symbol_index_refresh(Edi_Symbol_Index *index, Ecore_Thread *thread)
+{
+   Edi_Symbol_Index_Table *table = &index->table;
+   Eina_Iterator *it;
+   Eina_List *paths = NULL;
+   struct stat st;
+   const char *path;
+   unsigned int i;
+
+   // Files changed while we were not looking, and units that were never indexed.
+   for (i = 0; i < table->file_count; i++)
+     {
+        if (!(table->files[i].flags & EDI_SYMBOL_INDEX_FILE_INDEXED))
+          continue;
+
+        path = table->paths + table->files[i].path;
+        if (stat(path, &st) || st.st_mtime != table->files[i].mtime)
+          paths = eina_list_append(paths, path);
+     }
+
+   it = eina_hash_iterator_key_new(index->commands);
+   EINA_ITERATOR_FOREACH(it, path)
+     {
+        if (!eina_hash_find(index->ids, path))
+          paths = eina_list_append(paths, path);
+     }
+   eina_iterator_free(it);
+
+   _edi_symbol_index_units_run(index, _edi_symbol_index_units_get(index, paths), thread);
+   eina_list_free(paths);
+}
+
+static void
+_edi_symbol_index_open_cb(void *data, Ecore_Thread *thread)
+{
+   Edi_Symbol_Index *index = data;
+   Edi_Symbol_Index_Table table;
+
+   _edi_symbol_index_commands_update(index);
+
+   // Every unit may be compiled differently with another compilation database.
+   if (_edi_symbol_index_table_read(&table, index->filename, index->directory) &&
+       table.database == index->database_mtime)
+     {
+        eina_lock_take(&_index_lock);
+        _edi_symbol_index_table_set(index, &table);
+        eina_lock_release(&_index_lock);
+
+        _edi_symbol_index_refresh(index, thread);
+     }
+   else
+     {
+        _edi_symbol_index_table_free(&table);
+        _edi_symbol_index_build(index, thread);
+     }
+
+   if (ecore_thread_check(thread)) return;
+
+   if (index->removed || eina_hash_population(index->delta))
+     _edi_symbol_index_compact(index);
+
+   eina_lock_take(&_index_lock);
+   index->ready = EINA_TRUE;
+   eina_lock_release(&_index_lock);
+
+   INF("Symbol index ready with %d symbols", index->table.symbol_count);
+}
+
+static Eina_Bool _edi_symbol_index_update_timer_cb(void *data);
+
+static void
+_edi_symbol_index_thread_end(Edi_Symbol_Index *index)
+{
+   index->thread = NULL;
+
+   if (index->pending && !index->timer)
+     index->timer = ecore_timer_add(EDI_SYMBOL_INDEX_UPDATE_DELAY,
+                                    _edi_symbol_index_update_timer_cb, index);
+}
+
+static void
+_edi_symbol_index_open_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   _edi_symbol_index_thread_end(data);
+}
+
+static void
+_edi_symbol_index_update_cb(void *data, Ecore_Thread *thread)
+{
+   Edi_Symbol_Index_Update *update = data;
+   Edi_Symbol_Index *index = update->index;
+
+   if (_edi_symbol_index_commands_update(index))
+     {
+        _edi_symbol_index_build(index, thread);
+        return;
+     }
+
+   _edi_symbol_index_units_run(index, _edi_symbol_index_units_get(index, update->paths), thread);
+   if (ecore_thread_check(thread)) return;
+
+   if (eina_hash_population(index->delta) > EDI_SYMBOL_INDEX_DELTA_MAX ||
+       index->removed > index->table.file_count / 4 + EDI_SYMBOL_INDEX_DELTA_MAX)
+     _edi_symbol_index_compact(index);
+}
+
+static void
+_edi_symbol_index_update_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Symbol_Index_Update *update = data;
+   const char *path;
+
+   _edi_symbol_index_thread_end(update->index);
+
+   EINA_LIST_FREE(update->paths, path)
+     eina_stringshare_del(path);
+   free(update);
+}
+
+static Eina_Bool
+_edi_symbol_index_update_timer_cb(void *data)
+{
+   Edi_Symbol_Index *index = data;
+   Edi_Symbol_Index_Update *update;
+
+   // Files saved while the index is busy are picked up once it is done.
+   if (index->thread)
+     return ECORE_CALLBACK_RENEW;
+
+   index->timer = NULL;
+
+   update = malloc(sizeof(Edi_Symbol_Index_Update));
+   update->index = index;
+   update->paths = index->pending;
+   index->pending = NULL;
+
+   index->thread = ecore_thread_run(_edi_symbol_index_update_cb, _edi_symbol_index_update_end_cb,
+                                    _edi_symbol_index_update_end_cb, update);
+
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static Eina_Bool
+_edi_symbol_index_file_saved_cb(void *data EINA_UNUSED, int type EINA_UNUSED, void *event)
+{
+   const char *path = event;
+
+   if (!_index || !path) return ECORE_CALLBACK_PASS_ON;
+
+   // The file saved, not the one shown, which may be another by now.
+   _index->pending = eina_list_append(_index->pending, eina_stringshare_ref(path));
+   if (!_index->timer)
+     _index->timer = ecore_timer_add(EDI_SYMBOL_INDEX_UPDATE_DELAY,
+                                     _edi_symbol_index_update_timer_cb, _index);
+
+   return ECORE_CALLBACK_PASS_ON;
+}
+
+void
+edi_symbol_index_init(void)
+{
+   Edi_Symbol_Index *index;
+
+   if (_index || !_edi_config->symbol_index || !edi_project_get())
+     return;
+
+   if (!_index_lock_ready)
+     {
+        eina_lock_new(&_index_lock);
+        _index_lock_ready = EINA_TRUE;
+     }
+
+   index = calloc(1, sizeof(Edi_Symbol_Index));
+   index->directory = strdup(edi_project_get());
+   index->filename = edi_path_append(_edi_project_config_dir_get(), EDI_SYMBOL_INDEX_NAME);
+   index->database = _edi_symbol_index_database_path_get();
+   index->working = ecore_file_dir_get(index->database);
+   // Created on the main loop, the scanner threads then share it.
+   edi_language_c_index_get();
+   index->ids = eina_hash_string_superfast_new(NULL);
+   index->delta = eina_hash_string_superfast_new(_edi_symbol_index_delta_free);
+
+   index->handlers = eina_list_append(index->handlers,
+      ecore_event_handler_add(EDI_EVENT_FILE_SAVED, _edi_symbol_index_file_saved_cb, NULL));
+
+   eina_lock_take(&_index_lock);
+   _index = index;
+   eina_lock_release(&_index_lock);
+
+   index->thread = ecore_thread_run(_edi_symbol_index_open_cb, _edi_symbol_index_open_end_cb,
+                                    _edi_symbol_index_open_end_cb, index);
+}
+
+void
+edi_symbol_index_shutdown(void)
+{
+   Edi_Symbol_Index *index = _index;
+   Ecore_Event_Handler *handler;
+   const char *path;
+
+   if (!index) return;
+
+   EINA_LIST_FREE(index->handlers, handler)
+     ecore_event_handler_del(handler);
+   if (index->timer)
+     ecore_timer_del(index->timer);
+   index->timer = NULL;
+   EINA_LIST_FREE(index->pending, path)
+     eina_stringshare_del(path);
+
+   if (index->thread)
+     {
+        ecore_thread_cancel(index->thread);
+        while ((ecore_thread_wait(index->thread, 0.1)) != EINA_TRUE);
+     }
+
+   // Files saved since the table was written are found again by the refresh on next open.
+   eina_lock_take(&_index_lock);
+   _index = NULL;
+   eina_lock_release(&_index_lock);
+
+   if (index->commands)
+     eina_hash_free(index->commands);
+   eina_hash_free(index->ids);
+   eina_hash_free(index->delta);
+   _edi_symbol_index_table_free(&index->table);
+   free(index->working);
+   free(index->database);
+   free(index->directory);
+   free(index->filename);
+   free(index);
+}
+
+static Edi_Symbol_Location *
+_edi_symbol_location_new(const char *path, const char *name, unsigned int line,
+                         unsigned int column, unsigned int flags)
+{
+   Edi_Symbol_Location *location;
+
+   location = malloc(sizeof(Edi_Symbol_Location));
+   location->path = eina_stringshare_add(path);
+   location->name = eina_stringshare_add(name);
+   location->line = line;
+   location->column = column;
+   location->flags = flags;
+
+   return location;
+}
+
+static Edi_Symbol_Index_Symbol *
+_edi_symbol_index_table_symbol_find(Edi_Symbol_Index_Table *table, const char *usr)
+{
+   unsigned int low = 0, high = table->symbol_count, middle;
+   int cmp;
+
+   while (low < high)
+     {
+        middle = (low + high) / 2;
+        cmp = strcmp(table->strings + table->symbols[middle].usr, usr);
+        if (!cmp)
+          return &table->symbols[middle];
+
+        if (cmp < 0)
+          low = middle + 1;
+        else
+          high = middle;
+     }
+
+   return NULL;
+}
+
+Eina_List *
+edi_symbol_index_locations_get(const char *usr, unsigned int flags)
+{
+   Edi_Symbol_Index *index;
+   Edi_Symbol_Index_Table *table;
+   Edi_Symbol_Index_Symbol *symbol;
+   Edi_Symbol_Index_Found *found;
+   Eina_Hash_Tuple *tuple;
+   Eina_Iterator *it;
+   Eina_List *locations = NULL;
+   unsigned int i;
+
+   if (!_index_lock_ready || !usr)
+     return NULL;
+
+   eina_lock_take(&_index_lock);
+   index = _index;
+   if (!index || !index->ready)
+     {
+        eina_lock_release(&_index_lock);
+        return NULL;
+     }
+
+   table = &index->table;
+   symbol = _edi_symbol_index_table_symbol_find(table, usr);
+   for (i = 0; symbol && i < symbol->count; i++)
+     {
+        Edi_Symbol_Index_Occurrence *occurrence = &table->occurrences[symbol->offset + i];
+        Edi_Symbol_Index_File *file = &table->files[occurrence->file];
+
+        if (!(occurrence->flags & flags) || file->flags & EDI_SYMBOL_INDEX_FILE_REMOVED)
+          continue;
+
+        locations = eina_list_append(locations,
+           _edi_symbol_location_new(table->paths + file->path, table->strings + symbol->name,
+                                    occurrence->line, occurrence->column, occurrence->flags));
+     }
+
+   it = eina_hash_iterator_tuple_new(index->delta);
+   EINA_ITERATOR_FOREACH(it, tuple)
+     {
+        Edi_Symbol_Index_Delta *delta = tuple->data;
+
+        EINA_INARRAY_FOREACH(delta->found, found)
+          {
+             if (!(found->flags & flags) || strcmp(found->usr, usr))
+               continue;
+
+             locations = eina_list_append(locations,
+                _edi_symbol_location_new(tuple->key, found->name, found->line, found->column, found->flags));
+          }
+     }
+   eina_iterator_free(it);
+
+   eina_lock_release(&_index_lock);
+
+   return locations;
+}
+
+// Keep the location that tells most about a symbol, its definition rather than a declaration.
+static void
+_edi_symbol_index_symbol_set(Eina_Hash *symbols, const char *usr, Edi_Symbol_Location *location)
+{
+   Edi_Symbol_Location *current;
+
+   current = eina_hash_find(symbols, usr);
+   if (current && (current->flags & EDI_SYMBOL_DEFINITION || !(location->flags & EDI_SYMBOL_DEFINITION)))
+     {
+        edi_symbol_location_free(location);
+        return;
+     }
+
+   current = eina_hash_set(symbols, usr, location);
+   if (current)
+     edi_symbol_location_free(current);
+}
+
+static int
+_edi_symbol_index_location_cmp(const void *a, const void *b)
+{
+   const Edi_Symbol_Location *l1 = a, *l2 = b;
+
+   return strcmp(l1->name, l2->name);
+}
+
+Eina_List *
+edi_symbol_index_symbols_find(const char *prefix, unsigned int max)
+{
+   Edi_Symbol_Index *index;
+   Edi_Symbol_Index_Table *table;
+   Edi_Symbol_Index_Found *found;
+   Edi_Symbol_Location *location;
+   Eina_Hash_Tuple *tuple;
+   Eina_Hash *symbols;
+   Eina_Iterator *it;
+   Eina_List *list = NULL;
+   unsigned int low, high, middle, i, j;
+   size_t length;
+
+   if (!_index_lock_ready || !prefix)
+     return NULL;
+
+   eina_lock_take(&_index_lock);
+   index = _index;
+   if (!index || !index->ready)
+     {
+        eina_lock_release(&_index_lock);
+        return NULL;
+     }
+
+   symbols = eina_hash_string_superfast_new(NULL);
+   table = &index->table;
+   length = strlen(prefix);
+
+   low = 0;
+   high = table->symbol_count;
+   while (low < high)
+     {
+        middle = (low + high) / 2;
+        if (strncmp(table->strings + table->symbols[table->names[middle]].name, prefix, length) < 0)
+          low = middle + 1;
+        else
+          high = middle;
+     }
+
+   for (i = low; i < table->symbol_count && eina_hash_population(symbols) < max; i++)
+     {
+        Edi_Symbol_Index_Symbol *symbol = &table->symbols[table->names[i]];
+
+        if (strncmp(table->strings + symbol->name, prefix, length))
+          break;
+
+        for (j = symbol->offset; j < symbol->offset + symbol->count; j++)
+          {
+             Edi_Symbol_Index_Occurrence *occurrence = &table->occurrences[j];
+             Edi_Symbol_Index_File *file = &table->files[occurrence->file];
+
+             if (!(occurrence->flags & (EDI_SYMBOL_DEFINITION | EDI_SYMBOL_DECLARATION)) ||
+                 file->flags & EDI_SYMBOL_INDEX_FILE_REMOVED)
+               continue;
+
+             location = _edi_symbol_location_new(table->paths + file->path, table->strings + symbol->name,
+                                                 occurrence->line, occurrence->column, occurrence->flags);
+             _edi_symbol_index_symbol_set(symbols, table->strings + symbol->usr, location);
+          }
+     }
+
+   it = eina_hash_iterator_tuple_new(index->delta);
+   EINA_ITERATOR_FOREACH(it, tuple)
+     {
+        Edi_Symbol_Index_Delta *delta = tuple->data;
+
+        EINA_INARRAY_FOREACH(delta->found, found)
+          {
+             if (!(found->flags & (EDI_SYMBOL_DEFINITION | EDI_SYMBOL_DECLARATION)) ||
+                 strncmp(found->name, prefix, length))
+               continue;
+             if (eina_hash_population(symbols) >= max && !eina_hash_find(symbols, found->usr))
+               continue;
+
+             location = _edi_symbol_location_new(tuple->key, found->name, found->line,
+                                                 found->column, found->flags);
+             _edi_symbol_index_symbol_set(symbols, found->usr, location);
+          }
+     }
+   eina_iterator_free(it);
+
+   eina_lock_release(&_index_lock);
+
+   it = eina_hash_iterator_data_new(symbols);
+   EINA_ITERATOR_FOREACH(it, location)
+     list = eina_list_append(list, location);
+   eina_iterator_free(it);
+   eina_hash_free(symbols);
+
+   return eina_list_sort(list, 0, _edi_symbol_index_location_cmp);
+}
+
+#else
+
+void
+edi_symbol_index_init(void)
+{
+}
+
+void
+edi_symbol_index_shutdown(void)
+{
+}
+
+Eina_List *
+edi_symbol_index_locations_get(const char *usr EINA_UNUSED, unsigned int flags EINA_UNUSED)
+{
+   return NULL;
+}
+
+Eina_List *
+edi_symbol_index_symbols_find(const char *prefix EINA_UNUSED, unsigned int max EINA_UNUSED)
+{
+   return NULL;
+}
+
+#endif
+
+void
+edi_symbol_location_free(Edi_Symbol_Location *location)
+{
+   eina_stringshare_del(location->path);
+   eina_stringshare_del(location->name);
+   free(location);
+}
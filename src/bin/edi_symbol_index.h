@@ -0,0 +1,105 @@
+#ifndef EDI_SYMBOL_INDEX_H_
+# define EDI_SYMBOL_INDEX_H_
+
+#include <Elementary.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief These routines manage the index of symbols defined and used across the project.
+ */
+
+/**
+ * @brief Symbol index functions.
+ * @defgroup Symbol_Index
+ *
+ * @{
+ *
+ * An index of every symbol found by clang in the files of the compilation
+ * database, stored in the project config directory and kept current as
+ * files are saved.
+ *
+ */
+
+#define EDI_SYMBOL_DEFINITION  1 /**< The symbol is defined there */
+#define EDI_SYMBOL_DECLARATION 2 /**< The symbol is declared there */
+#define EDI_SYMBOL_REFERENCE   4 /**< The symbol is used there */
+
+/**
+ * @typedef Edi_Symbol_Location
+ * Where a symbol occurs in the project.
+ */
+typedef struct _Edi_Symbol_Location
+{
+   const char *path; /**< The absolute path of the file */
+   const char *name; /**< The name of the symbol */
+   unsigned int line, column;
+   unsigned int flags; /**< How the symbol occurs there, a combination of EDI_SYMBOL_* */
+} Edi_Symbol_Location;
+
+/**
+ * Load the symbol index of the current project, building or refreshing it
+ * in the background. Does nothing if edi was built without clang or the
+ * index is disabled in the settings.
+ *
+ * @ingroup Symbol_Index
+ */
+void edi_symbol_index_init(void);
+
+/**
+ * Stop maintaining the symbol index and release it.
+ *
+ * @ingroup Symbol_Index
+ */
+void edi_symbol_index_shutdown(void);
+
+/**
+ * Get the places a symbol occurs in. This can be called from any thread.
+ *
+ * @param usr The unified symbol resolution of the symbol, as given by clang.
+ * @param flags Which occurrences to return, a combination of EDI_SYMBOL_*.
+ *
+ * @return a list of Edi_Symbol_Location to be freed with
+ *         edi_symbol_location_free(), or NULL if there is none or the index
+ *         is not ready yet.
+ *
+ * @ingroup Symbol_Index
+ */
+Eina_List *edi_symbol_index_locations_get(const char *usr, unsigned int flags);
+
+/**
+ * Find the symbols of the project whose name starts with a prefix, where
+ * each is defined or else declared. This can be called from any thread.
+ *
+ * @param prefix The start of the names to find.
+ * @param max The most symbols to return.
+ *
+ * @return a list of Edi_Symbol_Location to be freed with
+ *         edi_symbol_location_free(), or NULL if there is none or the index
+ *         is not ready yet.
+ *
+ * @ingroup Symbol_Index
+ */
+Eina_List *edi_symbol_index_symbols_find(const char *prefix, unsigned int max);
+
+/**
+ * Free a symbol location.
+ *
+ * @param location the location to free.
+ *
+ * @ingroup Symbol_Index
+ */
+void edi_symbol_location_free(Edi_Symbol_Location *location);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDI_SYMBOL_INDEX_H_ */
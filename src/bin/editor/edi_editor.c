@@ -2,12 +2,14 @@
 # include "config.h"
 #endif
 
+#include <ctype.h>
 #include <libgen.h>
 
 #include <Eina.h>
 #include <Elementary.h>
 
 #include "edi_editor.h"
+#include "edi_editor_edits.h"
 
 #include "mainview/edi_mainview.h"
 #include "edi_content.h"
@@ -35,6 +37,36 @@ typedef struct
    Edi_Location end;
 } Edi_Range;
 
+#if HAVE_LIBCLANG
+// Lines highlighted at once, after those that are visible.
+#define EDI_EDITOR_HIGHLIGHT_LINES 2000
+
+typedef struct
+{
+   Edi_Range range;
+   Elm_Code_Token_Type type;
+} Edi_Highlight;
+
+// Highlights of a block of lines, or the diagnostics of the whole file.
+typedef struct
+{
+   unsigned int first, last;
+   Eina_Bool visible;
+   Eina_Inarray *highlights;
+   Eina_Inarray *diagnostics;
+} Edi_Highlight_Block;
+
+// The lines a highlight thread looks at, what is visible goes first.
+typedef struct
+{
+   Edi_Editor *editor;
+   char *path;
+   unsigned int first, last, top, bottom, lines;
+   unsigned int size;
+   Eina_Bool errors;
+} Edi_Highlight_Pass;
+#endif
+
 static void
 _edi_editor_file_change_reload_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event EINA_UNUSED)
 {
@@ -120,6 +152,12 @@ _edi_editor_file_change_popup(Evas_Object *parent, Edi_Editor *editor)
    evas_object_show(editor->popup);
 }
 
+static void
+_edi_editor_file_saved_free(void *data EINA_UNUSED, void *event)
+{
+   eina_stringshare_del(event);
+}
+
 void
 edi_editor_save(Edi_Editor *editor)
 {
@@ -148,7 +186,8 @@ edi_editor_save(Edi_Editor *editor)
    if (edi_language_provider_has(editor))
      edi_language_provider_get(editor)->refresh(editor);
 
-   ecore_event_add(EDI_EVENT_FILE_SAVED, NULL, NULL, NULL);
+   ecore_event_add(EDI_EVENT_FILE_SAVED, (void *) eina_stringshare_add(filename),
+                   _edi_editor_file_saved_free, NULL);
 }
 
 static Eina_Bool
@@ -165,12 +204,72 @@ _edi_editor_autosave_cb(void *data)
    return ECORE_CALLBACK_CANCEL;
 }
 
+// Forget the edits, the file was loaded again or they are not known.
+static void
+_edi_editor_edits_reset(Edi_Editor *editor)
+{
+   Elm_Code *code;
+   unsigned int lines;
+
+   code = elm_code_widget_code_get(editor->entry);
+   lines = elm_code_file_lines_get(code->file);
+   if (!editor->edits)
+     editor->edits = edi_editor_edits_new(lines);
+   else
+     edi_editor_edits_reset(editor->edits, lines);
+}
+
+static void
+_edi_editor_edits_free(Edi_Editor *editor)
+{
+   edi_editor_edits_free(editor->edits);
+   editor->edits = NULL;
+}
+
+static void
+_edi_editor_edits_line_changed(Edi_Editor *editor, Elm_Code_Line *line)
+{
+   if (!editor->edits)
+     return;
+
+   edi_editor_edits_line_changed(editor->edits, line->number, elm_code_file_lines_get(line->file));
+}
+
+// Log the lines changed since the last edit as one edit.
+static void
+_edi_editor_edits_log(Edi_Editor *editor)
+{
+   Elm_Code *code;
+
+   if (!editor->edits)
+     return;
+
+   code = elm_code_widget_code_get(editor->entry);
+   edi_editor_edits_log(editor->edits, elm_code_file_lines_get(code->file));
+}
+
+Eina_Bool
+edi_editor_edits_get(Edi_Editor *editor, unsigned int *serial, Edi_Editor_Edit *edit)
+{
+   if (!editor->edits)
+     {
+        memset(edit, 0, sizeof(Edi_Editor_Edit));
+        *serial = 0;
+        return EINA_FALSE;
+     }
+
+   _edi_editor_edits_log(editor);
+
+   return edi_editor_edits_since_get(editor->edits, serial, edit);
+}
+
 static void
 _changed_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
 {
    Edi_Editor *editor = data;
 
-   editor->modified = EINA_TRUE;
+   edi_editor_modified_set(editor);
+   _edi_editor_edits_log(editor);
 
    if (editor->save_timer)
      ecore_timer_reset(editor->save_timer);
@@ -267,34 +366,264 @@ _suggest_list_cb_selected(void *data, Evas_Object *obj EINA_UNUSED, void *event_
    elm_object_text_set(label, suggest_it->detail);
 }
 
+/*
+ * The suggestions sorted by name, so those starting with a word are found
+ * by a binary search, and those shown in the list with their score. Typing
+ * more of the same word only narrows down what is shown, and the list is
+ * changed only where it differs.
+ */
+typedef struct
+{
+   Edi_Language_Suggest_Item *item;
+   Elm_Object_Item *genlist_item;
+   int score;
+   unsigned int stamp;
+} Edi_Editor_Suggestion;
+
+struct _Edi_Editor_Suggest_Index
+{
+   Edi_Editor_Suggestion *suggestions;
+   unsigned int count;
+
+   Edi_Editor_Suggestion **shown;
+   unsigned int shown_count;
+   char *word;
+   unsigned int stamp;
+};
+
+// Sorted ignoring case, as words match suggestions whatever their case.
+static int
+_suggest_index_cmp(const void *a, const void *b)
+{
+   const Edi_Editor_Suggestion *sa = a, *sb = b;
+   int cmp;
+
+   cmp = strcasecmp(sa->item->summary, sb->item->summary);
+   if (cmp)
+     return cmp;
+
+   return strcmp(sa->item->summary, sb->item->summary);
+}
+
 static void
-_suggest_list_update(Edi_Editor *editor, char *word)
+_suggest_index_free(Edi_Editor_Suggest_Index *index)
 {
+   if (!index)
+     return;
+
+   free(index->suggestions);
+   free(index->shown);
+   free(index->word);
+   free(index);
+}
+
+static Edi_Editor_Suggest_Index *
+_suggest_index_new(Eina_List *list)
+{
+   Edi_Editor_Suggest_Index *index;
    Edi_Language_Suggest_Item *suggest_it;
    Eina_List *l;
+   unsigned int i = 0;
+
+   index = calloc(1, sizeof(Edi_Editor_Suggest_Index));
+   index->count = eina_list_count(list);
+   index->suggestions = calloc(index->count + 1, sizeof(Edi_Editor_Suggestion));
+   index->shown = malloc((index->count + 1) * sizeof(Edi_Editor_Suggestion *));
+
+   EINA_LIST_FOREACH(list, l, suggest_it)
+     index->suggestions[i++].item = suggest_it;
+   qsort(index->suggestions, index->count, sizeof(Edi_Editor_Suggestion), _suggest_index_cmp);
+
+   return index;
+}
+
+// The suggestions starting with prefix in any case, they follow each other in the index.
+static Edi_Editor_Suggestion *
+_suggest_index_range_get(Edi_Editor_Suggest_Index *index, const char *prefix, unsigned int length,
+                         unsigned int *count)
+{
+   unsigned int low = 0, high = index->count, middle, first;
+
+   while (low < high)
+     {
+        middle = (low + high) / 2;
+        if (strncasecmp(index->suggestions[middle].item->summary, prefix, length) < 0)
+          low = middle + 1;
+        else
+          high = middle;
+     }
+
+   first = low;
+   high = index->count;
+   while (low < high)
+     {
+        middle = (low + high) / 2;
+        if (strncasecmp(index->suggestions[middle].item->summary, prefix, length) <= 0)
+          low = middle + 1;
+        else
+          high = middle;
+     }
+
+   *count = low - first;
+   return index->suggestions + first;
+}
+
+/*
+ * How well a summary matches the letters of word in order, in any case, or
+ * -1 if it does not. Starting with the word counts most, then letters that
+ * follow each other or start a part of the name, and those in the same case.
+ */
+static int
+_suggest_score(const char *summary, const char *word)
+{
+   const char *s, *previous = NULL;
+   int score = 0;
+
+   if (!*word)
+     return 0;
+   if (!strncasecmp(summary, word, strlen(word)))
+     score += 100;
+
+   for (s = summary; *word; word++, s++)
+     {
+        while (*s && tolower(*s) != tolower(*word))
+          s++;
+        if (!*s)
+          return -1;
+
+        if (previous && s == previous + 1)
+          score += 5;
+        else if (s == summary || s[-1] == '_' || (isupper(*s) && islower(s[-1])))
+          score += 3;
+        else
+          score += 1;
+
+        if (*s == *word)
+          score++;
+        previous = s;
+     }
+
+   return score;
+}
+
+static int
+_suggest_shown_cmp(const void *a, const void *b)
+{
+   const Edi_Editor_Suggestion *sa = *(Edi_Editor_Suggestion * const *) a;
+   const Edi_Editor_Suggestion *sb = *(Edi_Editor_Suggestion * const *) b;
+
+   if (sa->score != sb->score)
+     return sb->score - sa->score;
+
+   return (sa > sb) - (sa < sb);
+}
+
+// Change the genlist to show what is shown now, keeping the items that stayed in place.
+static void
+_suggest_genlist_diff(Edi_Editor *editor, Edi_Editor_Suggest_Index *index,
+                      Edi_Editor_Suggestion **shown, unsigned int count)
+{
+   Edi_Editor_Suggestion *suggestion;
    Elm_Genlist_Item_Class *ic;
    Elm_Object_Item *item;
+   unsigned int i;
 
-   elm_genlist_clear(editor->suggest_genlist);
+   index->stamp++;
+   for (i = 0; i < count; i++)
+     shown[i]->stamp = index->stamp;
+
+   for (i = 0; i < index->shown_count; i++)
+     {
+        suggestion = index->shown[i];
+        if (suggestion->stamp == index->stamp || !suggestion->genlist_item)
+          continue;
+
+        elm_object_item_del(suggestion->genlist_item);
+        suggestion->genlist_item = NULL;
+     }
 
    ic = elm_genlist_item_class_new();
    ic->item_style = "full";
    ic->func.content_get = _suggest_list_content_get;
 
-   EINA_LIST_FOREACH(editor->suggest_list, l, suggest_it)
+   item = elm_genlist_first_item_get(editor->suggest_genlist);
+   for (i = 0; i < count; i++)
      {
-        if (eina_str_has_prefix(suggest_it->summary, word))
+        suggestion = shown[i];
+        if (suggestion->genlist_item && suggestion->genlist_item == item)
           {
-             elm_genlist_item_append(editor->suggest_genlist,
-                                     ic,
-                                     suggest_it,
-                                     NULL,
-                                     ELM_GENLIST_ITEM_NONE,
-                                     NULL,
-                                     NULL);
+             item = elm_genlist_item_next_get(item);
+             continue;
           }
+
+        if (suggestion->genlist_item)
+          elm_object_item_del(suggestion->genlist_item);
+
+        if (item)
+          suggestion->genlist_item = elm_genlist_item_insert_before(editor->suggest_genlist, ic,
+                                                                   suggestion->item, NULL, item,
+                                                                   ELM_GENLIST_ITEM_NONE, NULL, NULL);
+        else
+          suggestion->genlist_item = elm_genlist_item_append(editor->suggest_genlist, ic,
+                                                             suggestion->item, NULL,
+                                                             ELM_GENLIST_ITEM_NONE, NULL, NULL);
      }
+
    elm_genlist_item_class_free(ic);
+}
+
+static void
+_suggest_list_update(Edi_Editor *editor, char *word)
+{
+   Edi_Editor_Suggest_Index *index = editor->suggest_index;
+   Edi_Editor_Suggestion *candidates = NULL, **narrowed = NULL, **shown;
+   Elm_Object_Item *item;
+   unsigned int i, count = 0, shown_count = 0;
+   int score;
+
+   if (!editor->suggest_genlist)
+     return;
+   if (!index)
+     {
+        evas_object_hide(editor->suggest_bg);
+        return;
+     }
+
+   // More of the same word can only match what matched already.
+   if (index->word && eina_str_has_prefix(word, index->word))
+     {
+        narrowed = index->shown;
+        count = index->shown_count;
+     }
+   else if (*word)
+     candidates = _suggest_index_range_get(index, word, 1, &count);
+   else
+     {
+        candidates = index->suggestions;
+        count = index->count;
+     }
+
+   shown = malloc((count + 1) * sizeof(Edi_Editor_Suggestion *));
+   for (i = 0; i < count; i++)
+     {
+        Edi_Editor_Suggestion *suggestion = narrowed ? narrowed[i] : &candidates[i];
+
+        score = _suggest_score(suggestion->item->summary, word);
+        if (score < 0)
+          continue;
+
+        suggestion->score = score;
+        shown[shown_count++] = suggestion;
+     }
+   qsort(shown, shown_count, sizeof(Edi_Editor_Suggestion *), _suggest_shown_cmp);
+
+   _suggest_genlist_diff(editor, index, shown, shown_count);
+
+   free(index->shown);
+   free(index->word);
+   index->shown = shown;
+   index->shown_count = shown_count;
+   index->word = strdup(word);
 
    item = elm_genlist_first_item_get(editor->suggest_genlist);
    if (item)
@@ -308,7 +637,35 @@ _suggest_list_update(Edi_Editor *editor, char *word)
 }
 
 static void
-_suggest_list_load(Edi_Editor *editor)
+_suggest_list_set(Edi_Editor *editor, Eina_List *list)
+{
+   Edi_Language_Suggest_Item *suggest_it;
+   char *curword;
+
+   // The items shown refer to the suggestions that are freed.
+   if (editor->suggest_genlist)
+     elm_genlist_clear(editor->suggest_genlist);
+   _suggest_index_free(editor->suggest_index);
+   editor->suggest_index = NULL;
+
+   EINA_LIST_FREE(editor->suggest_list, suggest_it)
+     edi_language_suggest_item_free(suggest_it);
+
+   editor->suggest_list = list;
+   if (list)
+     editor->suggest_index = _suggest_index_new(list);
+   if (!editor->suggest_show)
+     return;
+
+   editor->suggest_show = EINA_FALSE;
+   curword = _edi_editor_current_word_get(editor);
+   _suggest_list_update(editor, curword);
+   free(curword);
+}
+
+// Find the suggestions at the cursor, those of a slow provider arrive later.
+static void
+_suggest_list_load(Edi_Editor *editor, Eina_Bool show)
 {
    Edi_Language_Provider *provider;
    char *curword;
@@ -318,24 +675,23 @@ _suggest_list_load(Edi_Editor *editor)
      return;
 
    provider = edi_language_provider_get(editor);
-   if (!provider || !provider->lookup)
+   if (!provider || (!provider->lookup && !provider->lookup_async))
      return;
 
-   if (editor->suggest_list)
-     {
-        Edi_Language_Suggest_Item *suggest_it;
-
-        EINA_LIST_FREE(editor->suggest_list, suggest_it)
-          edi_language_suggest_item_free(suggest_it);
-
-        editor->suggest_list = NULL;
-     }
-
    elm_code_widget_cursor_position_get(editor->entry, &row, &col);
-
    curword = _edi_editor_word_at_position_get(editor, row, col);
-   editor->suggest_list = provider->lookup(editor, row, col - strlen(curword));
+   col -= strlen(curword);
    free(curword);
+
+   editor->suggest_show = show;
+   if (provider->lookup_async &&
+       provider->lookup_async(editor, row, col, _suggest_list_set))
+     return;
+
+   if (provider->lookup)
+     _suggest_list_set(editor, provider->lookup(editor, row, col));
+   else
+     _suggest_list_set(editor, NULL);
 }
 
 static void
@@ -702,24 +1058,34 @@ _suggest_hint_show_snippet(Edi_Editor *editor, const char *word)
    evas_object_show(_suggest_hint);
 }
 
+// The longer suggestion starting with word that scores best, the first in the index if they tie.
 Edi_Language_Suggest_Item *
 _suggest_match_get(Edi_Editor *editor, const char *word)
 {
-   Edi_Language_Suggest_Item *suggest_it;
-   unsigned int wordlen;
+   Edi_Editor_Suggestion *suggestions;
+   Edi_Language_Suggest_Item *match = NULL;
+   unsigned int i, count, wordlen;
+   int score, best = -1;
 
-   Eina_List *l, *list = editor->suggest_list;
+   if (!editor->suggest_index)
+     return NULL;
 
    wordlen = strlen(word);
-   EINA_LIST_FOREACH(list, l, suggest_it)
+   suggestions = _suggest_index_range_get(editor->suggest_index, word, wordlen, &count);
+   for (i = 0; i < count; i++)
      {
-        if (strlen(suggest_it->summary) <= wordlen)
+        if (strlen(suggestions[i].item->summary) <= wordlen)
           continue;
-        if (eina_str_has_prefix(suggest_it->summary, word))
-          return suggest_it;
+
+        score = _suggest_score(suggestions[i].item->summary, word);
+        if (score > best)
+          {
+             best = score;
+             match = suggestions[i].item;
+          }
      }
 
-   return NULL;
+   return match;
 }
 
 static void
@@ -802,8 +1168,7 @@ _smart_cb_key_down(void *data EINA_UNUSED, Evas *e EINA_UNUSED,
           }
         else if (edi_language_provider_has(editor) && !strcmp(ev->key, "space"))
           {
-             _suggest_list_load(editor);
-             _suggest_list_update(editor, _edi_editor_current_word_get(editor));
+             _suggest_list_load(editor, EINA_TRUE);
           }
      }
    else if ((!alt) && (ctrl) && (shift))
@@ -861,80 +1226,323 @@ _smart_cb_key_down(void *data EINA_UNUSED, Evas *e EINA_UNUSED,
      }
 }
 
-#if HAVE_LIBCLANG
 static void
-_edi_range_color_set(Edi_Editor *editor, Edi_Range range, Elm_Code_Token_Type type)
+_edi_diagnostics_free(Eina_Inarray *diagnostics)
 {
-   Elm_Code *code;
-   Elm_Code_Line *line, *extra_line;
-   unsigned int number;
+   Edi_Editor_Diagnostic *diagnostic;
 
-   ecore_thread_main_loop_begin();
+   if (!diagnostics)
+     return;
 
-   code = elm_code_widget_code_get(editor->entry);
-   line = elm_code_file_line_get(code->file, range.start.line);
+   EINA_INARRAY_FOREACH(diagnostics, diagnostic)
+     free(diagnostic->text);
+   eina_inarray_free(diagnostics);
+}
 
-   elm_code_line_token_add(line, range.start.col - 1, range.end.col - 2,
-                           range.end.line - range.start.line + 1, type);
+static int
+_edi_diagnostic_cmp(const void *a, const void *b)
+{
+   const Edi_Editor_Diagnostic *d1 = a, *d2 = b;
+
+   if (d1->line != d2->line)
+     return (d1->line > d2->line) - (d1->line < d2->line);
+
+   // The most severe first, it is the one shown.
+   if (d1->status != d2->status)
+     return (d1->status < d2->status) - (d1->status > d2->status);
+
+   if (!d1->text || !d2->text)
+     return !!d1->text - !!d2->text;
+   return strcmp(d1->text, d2->text);
+}
+
+// Keep only the most severe problem of each line, in the order of the lines.
+static void
+_edi_diagnostics_sort(Eina_Inarray *diagnostics)
+{
+   Edi_Editor_Diagnostic *current, *kept;
+   unsigned int i, count = 0;
+
+   eina_inarray_sort(diagnostics, _edi_diagnostic_cmp);
+
+   for (i = 0; i < eina_inarray_count(diagnostics); i++)
+     {
+        current = eina_inarray_nth(diagnostics, i);
+
+        kept = count ? eina_inarray_nth(diagnostics, count - 1) : NULL;
+        if (kept && kept->line == current->line)
+          {
+             free(current->text);
+             continue;
+          }
+
+        if (i != count)
+          *(Edi_Editor_Diagnostic *) eina_inarray_nth(diagnostics, count) = *current;
+        count++;
+     }
+   while (eina_inarray_count(diagnostics) > count)
+     eina_inarray_pop(diagnostics);
+}
+
+static void
+_edi_diagnostic_line_set(Edi_Editor *editor, Elm_Code *code, unsigned int number,
+                         Edi_Editor_Diagnostic *diagnostic)
+{
+   Elm_Code_Line *line;
+
+   line = elm_code_file_line_get(code->file, number);
+   if (!line)
+     return;
+
+   // Lines keep their status as they are edited, so compare with what is shown.
+   if (!diagnostic)
+     {
+        if (line->status == ELM_CODE_STATUS_TYPE_DEFAULT && !line->status_text)
+          return;
+
+        elm_code_line_status_clear(line);
+     }
+   else
+     {
+        if (line->status == diagnostic->status &&
+            (line->status_text == diagnostic->text ||
+             (line->status_text && diagnostic->text && !strcmp(line->status_text, diagnostic->text))))
+          return;
+
+        elm_code_line_status_set(line, diagnostic->status);
+        elm_code_line_status_text_set(line, diagnostic->text);
+     }
 
    elm_code_widget_line_refresh(editor->entry, line);
-   for (number = line->number + 1; number <= range.end.line; number++)
+}
+
+/*
+ * Show the diagnostics of a file, both sets are sorted by line so walking
+ * them together finds the lines that have a problem no more, and only the
+ * lines whose problem differs are refreshed.
+ */
+static void
+_edi_diagnostics_apply(Edi_Editor *editor, Eina_Inarray *diagnostics)
+{
+   Edi_Editor_Diagnostic *previous, *diagnostic;
+   Elm_Code *code;
+   unsigned int i = 0, j = 0, previous_count = 0, count;
+
+   code = elm_code_widget_code_get(editor->entry);
+   if (editor->diagnostics)
+     previous_count = eina_inarray_count(editor->diagnostics);
+   count = eina_inarray_count(diagnostics);
+
+   while (i < previous_count || j < count)
      {
-        extra_line = elm_code_file_line_get(code->file, number);
-        elm_code_widget_line_refresh(editor->entry, extra_line);
+        previous = i < previous_count ? eina_inarray_nth(editor->diagnostics, i) : NULL;
+        diagnostic = j < count ? eina_inarray_nth(diagnostics, j) : NULL;
+
+        if (previous && (!diagnostic || previous->line < diagnostic->line))
+          {
+             _edi_diagnostic_line_set(editor, code, previous->line, NULL);
+             i++;
+             continue;
+          }
+
+        _edi_diagnostic_line_set(editor, code, diagnostic->line, diagnostic);
+        if (previous && previous->line == diagnostic->line)
+          i++;
+        j++;
      }
 
-   ecore_thread_main_loop_end();
+   _edi_diagnostics_free(editor->diagnostics);
+   editor->diagnostics = diagnostics;
+   editor->diagnostics_lines = elm_code_file_lines_get(code->file);
 }
 
+void
+edi_editor_diagnostics_set(Edi_Editor *editor, Eina_Inarray *diagnostics)
+{
+   if (!diagnostics)
+     diagnostics = eina_inarray_new(sizeof(Edi_Editor_Diagnostic), 1);
+
+   _edi_diagnostics_sort(diagnostics);
+   _edi_diagnostics_apply(editor, diagnostics);
+}
+
+/*
+ * The lines keep their status as lines are added or removed above them, so
+ * move the problems they were given with them. Lines are added after the one
+ * reported, and removed below it.
+ */
 static void
-_edi_line_status_set(Edi_Editor *editor, unsigned int number, Elm_Code_Status_Type status,
-                     const char *text)
+_edi_diagnostics_line_changed(Edi_Editor *editor, Elm_Code_Line *line)
+{
+   Edi_Editor_Diagnostic *diagnostic;
+   unsigned int lines, i = 0;
+   int moved;
+
+   lines = elm_code_file_lines_get(line->file);
+   moved = (int) lines - (int) editor->diagnostics_lines;
+   editor->diagnostics_lines = lines;
+
+   if (!moved || !editor->diagnostics)
+     return;
+
+   while (i < eina_inarray_count(editor->diagnostics))
+     {
+        diagnostic = eina_inarray_nth(editor->diagnostics, i);
+
+        if (diagnostic->line < line->number || (moved < 0 && diagnostic->line == line->number))
+          {
+             i++;
+             continue;
+          }
+
+        // The lines removed took their problems with them.
+        if (moved < 0 && diagnostic->line <= line->number - moved)
+          {
+             free(diagnostic->text);
+             eina_inarray_remove_at(editor->diagnostics, i);
+             continue;
+          }
+
+        diagnostic->line += moved;
+        i++;
+     }
+}
+
+#if HAVE_LIBCLANG
+/*
+ * Add a block of highlights found by the clang thread in one pass of the
+ * main loop, they are sorted by position so each line they cover is
+ * refreshed once.
+ */
+static void
+_edi_highlights_apply(Edi_Editor *editor, Eina_Inarray *highlights)
 {
    Elm_Code *code;
    Elm_Code_Line *line;
-
-   ecore_thread_main_loop_begin();
+   Edi_Highlight *highlight;
+   unsigned int number, refreshed = 0;
 
    code = elm_code_widget_code_get(editor->entry);
-   line = elm_code_file_line_get(code->file, number);
-   if (!line)
+   EINA_INARRAY_FOREACH(highlights, highlight)
      {
-        if (text)
-          ERR("Status on invalid line %d (\"%s\")", number, text);
+        line = elm_code_file_line_get(code->file, highlight->range.start.line);
+        if (!line)
+          continue;
 
-        ecore_thread_main_loop_end();
-        return;
+        elm_code_line_token_add(line, highlight->range.start.col - 1, highlight->range.end.col - 2,
+                                highlight->range.end.line - highlight->range.start.line + 1,
+                                highlight->type);
+
+        number = highlight->range.start.line;
+        if (number <= refreshed)
+          number = refreshed + 1;
+        for (; number <= highlight->range.end.line; number++)
+          {
+             line = elm_code_file_line_get(code->file, number);
+             if (!line)
+               break;
+             elm_code_widget_line_refresh(editor->entry, line);
+             refreshed = number;
+          }
      }
+}
 
-   elm_code_line_status_set(line, status);
-   if (text)
-     elm_code_line_status_text_set(line, text);
+static void
+_edi_highlight_block_free(Edi_Highlight_Block *block)
+{
+   if (block->highlights)
+     eina_inarray_free(block->highlights);
+   _edi_diagnostics_free(block->diagnostics);
+   free(block);
+}
 
-   elm_code_widget_line_refresh(editor->entry, line);
+// Lines to highlight again once the translation unit has been parsed again.
+static void
+_edi_highlight_dirty_add(Edi_Editor *editor, unsigned int first, unsigned int last)
+{
+   if (first > last)
+     return;
 
-   ecore_thread_main_loop_end();
+   if (!editor->highlight_dirty_first || first < editor->highlight_dirty_first)
+     editor->highlight_dirty_first = first;
+   if (last > editor->highlight_dirty_last)
+     editor->highlight_dirty_last = last;
 }
 
+// Drop the blocks waiting to be shown, the text they were found in changed.
 static void
-_clang_load_highlighting(const char *path, Edi_Editor *editor)
+_edi_highlights_cancel(Edi_Editor *editor)
 {
-        CXFile cfile = clang_getFile(editor->clang_unit, path);
+   Edi_Highlight_Block *block;
 
-        CXSourceRange range = clang_getRange(
-              clang_getLocationForOffset(editor->clang_unit, cfile, 0),
-              clang_getLocationForOffset(editor->clang_unit, cfile, ecore_file_size(path)));
+   EINA_LIST_FREE(editor->highlight_blocks, block)
+     {
+        _edi_highlight_dirty_add(editor, block->first, block->last);
+        _edi_highlight_block_free(block);
+     }
 
-        clang_tokenize(editor->clang_unit, range, &editor->tokens, &editor->token_count);
-        editor->cursors = (CXCursor *) malloc(editor->token_count * sizeof(CXCursor));
-        clang_annotateTokens(editor->clang_unit, editor->tokens, editor->token_count, editor->cursors);
+   if (editor->highlight_idler)
+     ecore_idler_del(editor->highlight_idler);
+   editor->highlight_idler = NULL;
+}
+
+static Eina_Bool
+_edi_highlights_idler_cb(void *data)
+{
+   Edi_Editor *editor = (Edi_Editor *)data;
+   Edi_Highlight_Block *block;
+
+   block = eina_list_data_get(editor->highlight_blocks);
+   editor->highlight_blocks = eina_list_remove_list(editor->highlight_blocks, editor->highlight_blocks);
+
+   _edi_highlights_apply(editor, block->highlights);
+   _edi_highlight_block_free(block);
+
+   if (editor->highlight_blocks)
+     return ECORE_CALLBACK_RENEW;
+
+   editor->highlight_idler = NULL;
+   return ECORE_CALLBACK_CANCEL;
 }
 
 static void
-_clang_show_highlighting(Edi_Editor *editor)
+_edi_highlight_line_changed(Edi_Editor *editor, Elm_Code_Line *line)
 {
+   unsigned int lines;
+   int moved;
+
+   lines = elm_code_file_lines_get(line->file);
+   moved = (int) lines - (int) editor->highlight_dirty_lines;
+   editor->highlight_dirty_lines = lines;
+
+   // Lines added or removed above the last changed line move it.
+   if (editor->highlight_dirty_first && line->number <= editor->highlight_dirty_last)
+     {
+        if (moved < 0 && editor->highlight_dirty_last < editor->highlight_dirty_first - moved)
+          editor->highlight_dirty_last = editor->highlight_dirty_first;
+        else
+          editor->highlight_dirty_last += moved;
+     }
+
+   _edi_highlight_dirty_add(editor, line->number, line->number);
+   _edi_highlights_cancel(editor);
+}
+
+static void
+_clang_load_highlighting(Edi_Editor *editor, CXSourceRange range)
+{
+   clang_tokenize(editor->clang_unit, range, &editor->tokens, &editor->token_count);
+   editor->cursors = (CXCursor *) malloc(editor->token_count * sizeof(CXCursor));
+   clang_annotateTokens(editor->clang_unit, editor->tokens, editor->token_count, editor->cursors);
+}
+
+static Eina_Inarray *
+_clang_show_highlighting(Edi_Editor *editor, unsigned int first, unsigned int last)
+{
+   Eina_Inarray *highlights;
    unsigned int i = 0;
 
+   highlights = eina_inarray_new(sizeof(Edi_Highlight), 1024);
    for (i = 0 ; i < editor->token_count ; i++)
      {
         Edi_Range range;
@@ -984,9 +1592,17 @@ _clang_show_highlighting(Edi_Editor *editor)
 
         if (editor->highlight_cancel)
           break;
+        if (range.start.line < first || range.start.line > last)
+          continue;
         if (type != ELM_CODE_TOKEN_TYPE_DEFAULT)
-          _edi_range_color_set(editor, range, type);
+          {
+             Edi_Highlight highlight = { range, type };
+
+             eina_inarray_push(highlights, &highlight);
+          }
      }
+
+   return highlights;
 }
 
 static void
@@ -994,96 +1610,357 @@ _clang_free_highlighting(Edi_Editor *editor)
 {
    free(editor->cursors);
    clang_disposeTokens(editor->clang_unit, editor->tokens, editor->token_count);
+
+   editor->cursors = NULL;
+   editor->tokens = NULL;
+   editor->token_count = 0;
 }
 
+// Only the lines first to last are tokenized and sent to the main loop.
 static void
-_clang_load_errors(Edi_Editor *editor)
+_clang_highlight_lines(Edi_Highlight_Pass *pass, Ecore_Thread *thread, CXFile cfile,
+                       unsigned int first, unsigned int last, Eina_Bool visible)
 {
-   Elm_Code *code;
-   const char *filename;
-   unsigned n = clang_getNumDiagnostics(editor->clang_unit);
-   unsigned i = 0;
+   Edi_Editor *editor = pass->editor;
+   Edi_Highlight_Block *block;
+   CXSourceLocation start, end;
 
-   ecore_thread_main_loop_begin();
-   code = elm_code_widget_code_get(editor->entry);
-   filename = elm_code_file_path_get(code->file);
-   ecore_thread_main_loop_end();
+   if (first > last || editor->highlight_cancel)
+     return;
+
+   eina_lock_take(&editor->clang_lock);
+
+   start = clang_getLocation(editor->clang_unit, cfile, first, 1);
+   if (last < pass->lines)
+     end = clang_getLocation(editor->clang_unit, cfile, last + 1, 1);
+   else
+     end = clang_getLocationForOffset(editor->clang_unit, cfile, pass->size);
+
+   _clang_load_highlighting(editor, clang_getRange(start, end));
+
+   block = malloc(sizeof(Edi_Highlight_Block));
+   block->first = first;
+   block->last = last;
+   block->visible = visible;
+   block->highlights = _clang_show_highlighting(editor, first, last);
+
+   _clang_free_highlighting(editor);
+
+   eina_lock_release(&editor->clang_lock);
 
-   for(i = 0, n = clang_getNumDiagnostics(editor->clang_unit); i != n; ++i)
+   if (!ecore_thread_feedback(thread, block))
+     _edi_highlight_block_free(block);
+}
+
+// The problems reported in the file, sorted by line with only one for each.
+static Eina_Inarray *
+_clang_load_errors(Edi_Editor *editor, const char *filename)
+{
+   Eina_Inarray *diagnostics;
+   Edi_Editor_Diagnostic diagnostic;
+   unsigned int i, n;
+
+   diagnostics = eina_inarray_new(sizeof(Edi_Editor_Diagnostic), 16);
+
+   eina_lock_take(&editor->clang_lock);
+   n = clang_getNumDiagnostics(editor->clang_unit);
+   for (i = 0; i < n && !editor->highlight_cancel; i++)
      {
-        CXDiagnostic diag = clang_getDiagnostic(editor->clang_unit, i);
+        CXDiagnostic diag;
         CXFile file;
+        CXString str;
         unsigned int line;
-        CXString path;
+
+        diag = clang_getDiagnostic(editor->clang_unit, i);
 
         // the parameter after line would be a caret position but we're just highlighting for now
         clang_getSpellingLocation(clang_getDiagnosticLocation(diag), &file, &line, NULL, NULL);
 
-        path = clang_getFileName(file);
-        if (!clang_getCString(path) || strcmp(filename, clang_getCString(path)))
-          continue;
+        str = clang_getFileName(file);
+        if (!clang_getCString(str) || strcmp(filename, clang_getCString(str)))
+          {
+             clang_disposeString(str);
+             clang_disposeDiagnostic(diag);
+             continue;
+          }
+        clang_disposeString(str);
 
         /* FIXME: Also handle ranges and fix suggestions. */
-        Elm_Code_Status_Type status = ELM_CODE_STATUS_TYPE_DEFAULT;
+        diagnostic.status = ELM_CODE_STATUS_TYPE_DEFAULT;
 
         switch (clang_getDiagnosticSeverity(diag))
           {
            case CXDiagnostic_Ignored:
-              status = ELM_CODE_STATUS_TYPE_IGNORED;
+              diagnostic.status = ELM_CODE_STATUS_TYPE_IGNORED;
               break;
            case CXDiagnostic_Note:
-              status = ELM_CODE_STATUS_TYPE_NOTE;
+              diagnostic.status = ELM_CODE_STATUS_TYPE_NOTE;
               break;
            case CXDiagnostic_Warning:
-              status = ELM_CODE_STATUS_TYPE_WARNING;
+              diagnostic.status = ELM_CODE_STATUS_TYPE_WARNING;
               break;
            case CXDiagnostic_Error:
-              status = ELM_CODE_STATUS_TYPE_ERROR;
+              diagnostic.status = ELM_CODE_STATUS_TYPE_ERROR;
               break;
            case CXDiagnostic_Fatal:
-              status = ELM_CODE_STATUS_TYPE_FATAL;
+              diagnostic.status = ELM_CODE_STATUS_TYPE_FATAL;
               break;
           }
-        CXString str = clang_getDiagnosticSpelling(diag);
-        if (status != ELM_CODE_STATUS_TYPE_DEFAULT)
-          _edi_line_status_set(editor, line, status, clang_getCString(str));
-        clang_disposeString(str);
+
+        if (diagnostic.status != ELM_CODE_STATUS_TYPE_DEFAULT)
+          {
+             str = clang_getDiagnosticSpelling(diag);
+             diagnostic.line = line;
+             diagnostic.text = clang_getCString(str) ? strdup(clang_getCString(str)) : NULL;
+             eina_inarray_push(diagnostics, &diagnostic);
+             clang_disposeString(str);
+          }
 
         clang_disposeDiagnostic(diag);
-        if (editor->highlight_cancel)
-          break;
      }
+   eina_lock_release(&editor->clang_lock);
+
+   _edi_diagnostics_sort(diagnostics);
+
+   return diagnostics;
 }
 
 static void
-_edi_clang_setup(void *data, Ecore_Thread *thread EINA_UNUSED)
+_edi_clang_setup(void *data, Ecore_Thread *thread)
 {
+   Edi_Highlight_Pass *pass;
    Edi_Editor *editor;
    Elm_Code *code;
-   const char *path;
+   Evas_Coord x, y;
+   unsigned int line, last, col;
+   int visible_col;
+   CXFile cfile;
+
+   pass = (Edi_Highlight_Pass *)data;
+   editor = pass->editor;
 
    ecore_thread_main_loop_begin();
 
-   editor = (Edi_Editor *)data;
    code = elm_code_widget_code_get(editor->entry);
-   path = elm_code_file_path_get(code->file);
+   if (elm_code_file_path_get(code->file))
+     pass->path = strdup(elm_code_file_path_get(code->file));
+   pass->lines = elm_code_file_lines_get(code->file);
+   if (pass->last > pass->lines)
+     pass->last = pass->lines;
+
+   evas_object_geometry_get(editor->entry, &x, &y, NULL, NULL);
+   if (!elm_code_widget_position_at_coordinates_get(editor->entry, x, y, &pass->top, &visible_col))
+     elm_code_widget_cursor_position_get(editor->entry, &pass->top, &col);
+   pass->bottom = pass->top + elm_code_widget_lines_visible_get(editor->entry);
 
    ecore_thread_main_loop_end();
 
-   _clang_load_errors(editor);
-   _clang_load_highlighting(path, editor);
-   _clang_show_highlighting(editor);
+   if (!pass->path || !editor->clang_unit)
+     return;
+
+   eina_lock_take(&editor->clang_lock);
+   cfile = clang_getFile(editor->clang_unit, pass->path);
+   eina_lock_release(&editor->clang_lock);
+   pass->size = ecore_file_size(pass->path);
+
+   // Show what is on screen first, then the rest of the lines a block at a time.
+   if (pass->top < pass->first)
+     pass->top = pass->first;
+   if (pass->bottom > pass->last)
+     pass->bottom = pass->last;
+   _clang_highlight_lines(pass, thread, cfile, pass->top, pass->bottom, EINA_TRUE);
+
+   // Diagnostics are shown all at once, as soon as the visible lines are highlighted.
+   if (pass->errors)
+     {
+        Edi_Highlight_Block *block;
+
+        block = calloc(1, sizeof(Edi_Highlight_Block));
+        block->diagnostics = _clang_load_errors(editor, pass->path);
+        if (!ecore_thread_feedback(thread, block))
+          _edi_highlight_block_free(block);
+     }
+
+   for (line = pass->first; line <= pass->last; line = last + 1)
+     {
+        if (line >= pass->top && line <= pass->bottom)
+          {
+             last = pass->bottom;
+             continue;
+          }
+
+        last = line + EDI_EDITOR_HIGHLIGHT_LINES - 1;
+        if (line < pass->top && last >= pass->top)
+          last = pass->top - 1;
+        if (last > pass->last)
+          last = pass->last;
+
+        _clang_highlight_lines(pass, thread, cfile, line, last, EINA_FALSE);
+     }
+}
+
+static void
+_edi_clang_notify(void *data, Ecore_Thread *thread EINA_UNUSED, void *msg)
+{
+   Edi_Highlight_Pass *pass = (Edi_Highlight_Pass *)data;
+   Edi_Highlight_Block *block = (Edi_Highlight_Block *)msg;
+   Edi_Editor *editor = pass->editor;
+
+   if (editor->highlight_cancel)
+     {
+        _edi_highlight_block_free(block);
+        return;
+     }
+
+   if (block->diagnostics)
+     {
+        _edi_diagnostics_apply(editor, block->diagnostics);
+        block->diagnostics = NULL;
+        _edi_highlight_block_free(block);
+        return;
+     }
+
+   // Visible lines are coloured straight away, the others when the main loop is idle.
+   if (block->visible)
+     {
+        _edi_highlights_apply(editor, block->highlights);
+        _edi_highlight_block_free(block);
+        return;
+     }
+
+   editor->highlight_blocks = eina_list_append(editor->highlight_blocks, block);
+   if (!editor->highlight_idler)
+     editor->highlight_idler = ecore_idler_add(_edi_highlights_idler_cb, editor);
 }
 
 static void
 _edi_clang_dispose(void *data, Ecore_Thread *thread EINA_UNUSED)
 {
-   Edi_Editor *editor = (Edi_Editor *)data;
+   Edi_Highlight_Pass *pass = (Edi_Highlight_Pass *)data;
+   Edi_Editor *editor = pass->editor;
 
-   _clang_free_highlighting(editor);
+   if (editor->highlight_cancel)
+     {
+        _edi_highlight_dirty_add(editor, pass->first, pass->last);
+        if (pass->errors)
+          editor->highlight_errors = EINA_TRUE;
+     }
+
+   free(pass->path);
+   free(pass);
 
    editor->highlight_thread = NULL;
    editor->highlight_cancel = EINA_FALSE;
+
+   // A translation unit given while highlighting can be used now.
+   if (editor->clang_swap)
+     edi_editor_clang_unit_swap(editor);
+   else if (editor->clang_refresh && edi_language_provider_has(editor))
+     edi_language_provider_get(editor)->refresh(editor);
+}
+
+static void
+_edi_clang_highlight(Edi_Editor *editor, unsigned int first, unsigned int last, Eina_Bool errors)
+{
+   Edi_Highlight_Pass *pass;
+
+   pass = calloc(1, sizeof(Edi_Highlight_Pass));
+   pass->editor = editor;
+   pass->first = first;
+   pass->last = last;
+   pass->errors = errors;
+
+   if (errors)
+     editor->highlight_errors = EINA_FALSE;
+   editor->highlight_cancel = EINA_FALSE;
+   editor->highlight_thread = ecore_thread_feedback_run(_edi_clang_setup, _edi_clang_notify,
+                                                        _edi_clang_dispose, _edi_clang_dispose,
+                                                        pass, EINA_FALSE);
+}
+
+/*
+ * Highlight again only the lines that changed, once the translation unit
+ * knows about them.
+ */
+static void
+_edi_clang_highlight_changed(Edi_Editor *editor, Eina_Bool errors)
+{
+   unsigned int first, last;
+
+   if (!editor->clang_unit)
+     return;
+
+   // The problems a cancelled pass did not load are loaded with this one.
+   errors = errors || editor->highlight_errors;
+
+   // No line to highlight, only the diagnostics to load.
+   if (!editor->highlight_dirty_first)
+     {
+        if (errors)
+          _edi_clang_highlight(editor, 1, 0, EINA_TRUE);
+        return;
+     }
+
+   first = editor->highlight_dirty_first;
+   last = editor->highlight_dirty_last;
+   editor->highlight_dirty_first = editor->highlight_dirty_last = 0;
+
+   _edi_clang_highlight(editor, first, last, errors);
+}
+
+void
+edi_editor_clang_unit_set(Edi_Editor *editor, CXTranslationUnit unit)
+{
+   Eina_Bool first;
+
+   // The highlight thread, or a lookup, may be using the current one, swap them once it stopped.
+   if (editor->highlight_thread || eina_lock_take_try(&editor->clang_lock) != EINA_LOCK_SUCCEED)
+     {
+        if (editor->clang_swap && editor->clang_unit_next &&
+            editor->clang_unit_next != unit && editor->clang_unit_next != editor->clang_unit)
+          clang_disposeTranslationUnit(editor->clang_unit_next);
+
+        editor->clang_unit_next = unit;
+        editor->clang_swap = EINA_TRUE;
+        editor->highlight_cancel = EINA_TRUE;
+        return;
+     }
+
+   // A unit parsed again is the same one.
+   first = !editor->clang_unit;
+   if (editor->clang_unit && editor->clang_unit != unit)
+     clang_disposeTranslationUnit(editor->clang_unit);
+
+   editor->clang_unit = unit;
+   eina_lock_release(&editor->clang_lock);
+   editor->clang_unit_next = NULL;
+   if (!unit)
+     return;
+
+   // Problems may come or go on lines that did not change as well.
+   if (!first)
+     {
+        _edi_clang_highlight_changed(editor, EINA_TRUE);
+        return;
+     }
+
+   // Until now there was nothing to highlight, or suggest, with.
+   _edi_highlights_cancel(editor);
+   editor->highlight_dirty_first = editor->highlight_dirty_last = 0;
+   _edi_clang_highlight(editor, 1, UINT_MAX, EINA_TRUE);
+
+   if (edi_language_provider_has(editor))
+     _suggest_list_load(editor, EINA_FALSE);
+}
+
+void
+edi_editor_clang_unit_swap(Edi_Editor *editor)
+{
+   if (!editor->clang_swap)
+     return;
+
+   editor->clang_swap = EINA_FALSE;
+   edi_editor_clang_unit_set(editor, editor->clang_unit_next);
 }
 #endif
 
@@ -1136,11 +2013,19 @@ _unfocused_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UN
      evas_object_del(editor->doc_popup);
 }
 
+static void
+_edi_editor_definition_open(Edi_Editor *editor EINA_UNUSED, Edi_Path_Options *options)
+{
+   if (options)
+     edi_mainview_open(options);
+}
+
 static void
 _mouse_up_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED,
              void *event_info)
 {
    Edi_Editor *editor;
+   Edi_Language_Provider *provider;
    Evas_Event_Mouse_Up *event;
    Eina_Bool ctrl;
    unsigned int row;
@@ -1155,10 +2040,29 @@ _mouse_up_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED,
      evas_object_hide(editor->suggest_bg);
 
    ctrl = evas_key_modifier_is_set(event->modifiers, "Control");
-   if (event->button != 3 || !ctrl || !edi_language_provider_has(editor))
+   if (!ctrl || !edi_language_provider_has(editor))
      return;
 
    elm_code_widget_position_at_coordinates_get(editor->entry, event->canvas.x, event->canvas.y, &row, &col);
+
+   // Go to the definition of what was clicked on.
+   if (event->button == 1)
+     {
+        provider = edi_language_provider_get(editor);
+
+        // The file opens once the definition is found.
+        if (provider->lookup_definition_async &&
+            provider->lookup_definition_async(editor, row, col, _edi_editor_definition_open))
+          return;
+        if (!provider->lookup_definition)
+          return;
+
+        _edi_editor_definition_open(editor, provider->lookup_definition(editor, row, col));
+        return;
+     }
+
+   if (event->button != 3)
+     return;
    elm_code_widget_selection_select_word(editor->entry, row, col);
    word = elm_code_widget_selection_text_get(editor->entry);
    if (!word || !strlen(word))
@@ -1168,10 +2072,92 @@ _mouse_up_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj EINA_UNUSED,
 }
 
 static void
-_edi_editor_parse_line_cb(Elm_Code_Line *line EINA_UNUSED, void *data)
+_edi_lexer_token_cb(void *data, unsigned int start, unsigned int end, Elm_Code_Token_Type type)
+{
+   Elm_Code_Line *line = data;
+
+   elm_code_line_token_add(line, start, end, 1, type);
+}
+
+/*
+ * Lex a line again, starting in the state the line above ended in. The
+ * state it ends in is kept in its data, offset by one so lines not lexed
+ * yet have none. The matches of a search stay on top of the tokens.
+ */
+static Edi_Lexer_State
+_edi_lexer_line_lex(Edi_Editor *editor, Elm_Code_Line *line, Edi_Lexer_State state)
+{
+   Elm_Code_Token *token;
+   Eina_List *matches = NULL;
+   const char *text;
+   unsigned int length;
+
+   EINA_LIST_FREE(line->tokens, token)
+     {
+        if (token->type == ELM_CODE_TOKEN_TYPE_MATCH)
+          matches = eina_list_append(matches, token);
+        else
+          free(token);
+     }
+
+   text = elm_code_line_text_get(line, &length);
+   state = edi_lexer_line_lex(editor->lexer, state, text, length, _edi_lexer_token_cb, line);
+   line->tokens = eina_list_merge(line->tokens, matches);
+
+   line->data = (void *) ((uintptr_t) state + 1);
+   return state;
+}
+
+/*
+ * Lex a line that changed, then the lines after it for as long as the state
+ * they start in is not the one they were lexed in. Any lines above not lexed
+ * yet, split off by a newline, are lexed first.
+ */
+static void
+_edi_lexer_line_changed(Edi_Editor *editor, Elm_Code_Line *line)
+{
+   Elm_Code_Line *current;
+   Edi_Lexer_State state = 0;
+   unsigned int number, lines;
+   uintptr_t before;
+
+   for (number = line->number; number > 1; number--)
+     {
+        current = elm_code_file_line_get(line->file, number - 1);
+        if (current->data)
+          {
+             state = (uintptr_t) current->data - 1;
+             break;
+          }
+     }
+
+   lines = elm_code_file_lines_get(line->file);
+   for (; number <= lines; number++)
+     {
+        current = elm_code_file_line_get(line->file, number);
+        before = (uintptr_t) current->data;
+        state = _edi_lexer_line_lex(editor, current, state);
+        if (current != line)
+          elm_code_widget_line_refresh(editor->entry, current);
+
+        if (number >= line->number && before == (uintptr_t) state + 1)
+          break;
+     }
+}
+
+static void
+_edi_editor_parse_line_cb(Elm_Code_Line *line, void *data)
 {
    Edi_Editor *editor = (Edi_Editor *)data;
 
+   _edi_editor_edits_line_changed(editor, line);
+   _edi_diagnostics_line_changed(editor, line);
+   if (editor->lexer)
+     _edi_lexer_line_changed(editor, line);
+#if HAVE_LIBCLANG
+   _edi_highlight_line_changed(editor, line);
+#endif
+
    // We have caused a reset in the file parser, if it is active
    if (!editor->highlight_thread)
      return;
@@ -1189,12 +2175,16 @@ _edi_editor_parse_file_cb(Elm_Code_File *file EINA_UNUSED, void *data)
      return;
 
 #if HAVE_LIBCLANG
-   editor->highlight_cancel = EINA_FALSE;
-   editor->highlight_thread = ecore_thread_run(_edi_clang_setup, _edi_clang_dispose, NULL, editor);
+   // The whole file is highlighted, nothing is left to do for the lines changed while loading.
+   // Until its translation unit is parsed, there is nothing to highlight with.
+   _edi_highlights_cancel(editor);
+   editor->highlight_dirty_first = editor->highlight_dirty_last = 0;
+   if (editor->clang_unit && !editor->clang_thread)
+     _edi_clang_highlight(editor, 1, UINT_MAX, EINA_TRUE);
 #endif
 
    if (edi_language_provider_has(editor))
-     _suggest_list_load(editor);
+     _suggest_list_load(editor, EINA_FALSE);
 }
 
 static Eina_Bool
@@ -1233,8 +2223,25 @@ _editor_del_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *o, void *event_info
 
    ecore_event_handler_del(ev_handler);
 
+#if HAVE_LIBCLANG
+   _edi_highlights_cancel(editor);
+#endif
+   _edi_diagnostics_free(editor->diagnostics);
+   editor->diagnostics = NULL;
+
    if (edi_language_provider_has(editor))
      edi_language_provider_get(editor)->del(editor);
+   _edi_editor_edits_free(editor);
+}
+
+void
+edi_editor_modified_set(Edi_Editor *editor)
+{
+   // Serials are never reused, so text copied from a closed editor is not taken for another's.
+   static unsigned int serial = 0;
+
+   editor->modified = EINA_TRUE;
+   editor->edit_serial = ++serial;
 }
 
 void
@@ -1249,6 +2256,8 @@ edi_editor_reload(Edi_Editor *editor)
    path = strdup(elm_code_file_path_get(code->file));
    elm_code_file_clear(code->file);
    code->file = elm_code_file_open(code, path);
+   if (editor->edits)
+     _edi_editor_edits_reset(editor);
    editor->modified = EINA_FALSE;
    editor->save_time = ecore_file_mod_time(path);
 
@@ -1336,6 +2345,7 @@ edi_editor_add(Evas_Object *parent, Edi_Mainview_Item *item)
    Elm_Code *code;
    Elm_Code_Widget *widget;
    Edi_Editor *editor;
+   Eina_Bool parsed;
 
    vbox = elm_box_add(parent);
    evas_object_size_hint_weight_set(vbox, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
@@ -1381,14 +2391,27 @@ edi_editor_add(Evas_Object *parent, Edi_Mainview_Item *item)
    evas_object_smart_callback_add(widget, "focused", _focused_cb, item);
    evas_object_smart_callback_add(widget, "unfocused", _unfocused_cb, editor);
 
+   // Languages without a parser of their own are highlighted by a lexer,
+   // the others by the generic syntax of the code widget.
+   editor->lexer = edi_lexer_get(item->mimetype, item->path);
+#if HAVE_LIBCLANG
+   if (editor->lexer && !strcmp(edi_lexer_name_get(editor->lexer), "c"))
+     editor->lexer = NULL;
+#endif
+
    elm_code_parser_standard_add(code, ELM_CODE_PARSER_STANDARD_TODO);
-   if (!strcmp(item->editortype, "code"))
+   parsed = editor->lexer || !strcmp(item->editortype, "code");
+   if (parsed)
      {
         elm_code_parser_add(code, _edi_editor_parse_line_cb,
                             _edi_editor_parse_file_cb, editor);
-        elm_code_widget_syntax_enabled_set(widget, EINA_TRUE);
+        if (!editor->lexer)
+          elm_code_widget_syntax_enabled_set(widget, EINA_TRUE);
      }
    elm_code_file_open(code, item->path);
+   // Edits are only seen by the parser.
+   if (parsed)
+     _edi_editor_edits_reset(editor);
    if (eina_str_has_extension(item->path, ".eo"))
      {
         code->file->mime = "text/x-eolian";
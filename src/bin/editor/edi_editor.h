@@ -10,6 +10,7 @@
 #include <Evas.h>
 
 #include "mainview/edi_mainview_item.h"
+#include "edi_lexer.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,6 +27,40 @@ extern "C" {
  */
 typedef struct _Edi_Editor_Search Edi_Editor_Search;
 
+/**
+ * @typedef Edi_Editor_Suggest_Index
+ * The suggestions of an editor, indexed for filtering as the user types.
+ */
+typedef struct _Edi_Editor_Suggest_Index Edi_Editor_Suggest_Index;
+
+/**
+ * @typedef Edi_Editor_Edits
+ * The edits made to the file of an editor, kept for the backends that take changes.
+ */
+typedef struct _Edi_Editor_Edits Edi_Editor_Edits;
+
+/**
+ * @typedef Edi_Editor_Edit
+ * Lines of the file replaced by others, first is 0 when nothing changed.
+ */
+typedef struct _Edi_Editor_Edit
+{
+   unsigned int first; /**< The first line replaced */
+   unsigned int removed; /**< How many lines were there, from the first */
+   unsigned int added; /**< How many lines are there now, from the first */
+} Edi_Editor_Edit;
+
+/**
+ * @typedef Edi_Editor_Diagnostic
+ * A problem a language provider found on a line of the file.
+ */
+typedef struct _Edi_Editor_Diagnostic
+{
+   unsigned int line;
+   Elm_Code_Status_Type status; /**< How severe the problem is */
+   char *text; /**< The message shown, freed by the editor */
+} Edi_Editor_Diagnostic;
+
 /**
  * @typedef Edi_Editor
  * An instance of an editor view.
@@ -45,22 +80,43 @@ struct _Edi_Editor
    Evas_Object *popup;
    Eina_List *undo_stack; /**< The list of operations that can be undone */
    Eina_List *suggest_list; /**< The list of all possible suggestions for the file */
+   Edi_Editor_Suggest_Index *suggest_index; /**< The suggestions sorted, and those shown */
 
    /* Private */
    Edi_Editor_Search *search;
    Eina_Bool modified;
+   unsigned int edit_serial; /**< Changes whenever the text is edited, unique to the editor */
    Ecore_Timer *save_timer;
    Eina_List *split_views;
+   Eina_Inarray *diagnostics; /**< The problems shown on lines, sorted by line */
+   unsigned int diagnostics_lines; /**< The lines of the file when the problems were last moved */
+   Edi_Editor_Edits *edits; /**< The lines each edit changed, NULL if they are not followed */
+   const Edi_Lexer *lexer; /**< Highlights the lines, if the language has no parser of its own */
 
 #if HAVE_LIBCLANG
    /* Clang */
-   CXIndex clang_idx;
    CXTranslationUnit clang_unit;
    CXToken *tokens;
    CXCursor *cursors;
    unsigned int token_count;
+   Eina_List *highlight_blocks; /**< Highlights found by the clang thread, waiting for the main loop to be idle */
+   Ecore_Idler *highlight_idler;
+   unsigned int highlight_dirty_first, highlight_dirty_last; /**< Lines changed since they were last highlighted */
+   unsigned int highlight_dirty_lines;
+   Eina_Bool highlight_errors; /**< The problems are to be loaded with the next highlight, the last pass was cancelled */
+
+   Ecore_Thread *clang_thread; /**< The thread parsing the translation unit, it has it until done */
+   Eina_Bool clang_refresh; /**< Parse again once the translation unit is not in use */
+   CXTranslationUnit clang_unit_next; /**< A translation unit to use once the current one is not in use */
+   Eina_Bool clang_swap;
+   Ecore_Thread *lookup_thread; /**< The documentation or definition lookup running */
+   Eina_Lock clang_lock; /**< Held by whoever uses the translation unit */
 #endif
 
+   Ecore_Thread *suggest_thread; /**< The lookup running for the suggestions */
+   unsigned int suggest_generation; /**< Changes once a lookup is superseded */
+   Eina_Bool suggest_show;
+
    Ecore_Thread *highlight_thread;
    Eina_Bool highlight_cancel;
    time_t save_time;
@@ -89,6 +145,15 @@ struct _Edi_Editor
  */
 Evas_Object *edi_editor_add(Evas_Object *parent, Edi_Mainview_Item *item);
 
+/**
+ * Mark the content of an editor as changed since it was saved.
+ *
+ * @param editor the editor instance whose text was changed.
+ *
+ * @ingroup Editor
+ */
+void edi_editor_modified_set(Edi_Editor *editor);
+
 /**
  * Reload existing editor's content from disk.
  *
@@ -98,6 +163,58 @@ Evas_Object *edi_editor_add(Evas_Object *parent, Edi_Mainview_Item *item);
  */
 void edi_editor_reload(Edi_Editor *editor);
 
+/**
+ * Show the problems found in the file of an editor, replacing those shown.
+ * Only the lines whose problem changes are refreshed.
+ *
+ * @param editor the editor instance the problems were found for.
+ * @param diagnostics an array of Edi_Editor_Diagnostic in any order, with
+ *        one or more for each line, which the editor then owns. NULL clears
+ *        all the problems shown.
+ *
+ * @ingroup Editor
+ */
+void edi_editor_diagnostics_set(Edi_Editor *editor, Eina_Inarray *diagnostics);
+
+/**
+ * Get the lines changed in the file of an editor since a version of it, as
+ * one edit, so that a backend can be given only those lines.
+ *
+ * @param editor the editor instance of the file.
+ * @param serial the version the backend has, 0 if it has none. It is set to
+ *        the current version.
+ * @param edit set to the lines changed since that version.
+ * @return EINA_FALSE if the edits since that version are not known any more,
+ *         the whole file then has to be given again.
+ *
+ * @ingroup Editor
+ */
+Eina_Bool edi_editor_edits_get(Edi_Editor *editor, unsigned int *serial, Edi_Editor_Edit *edit);
+
+#if HAVE_LIBCLANG
+/**
+ * Give the editor a newly parsed translation unit, replacing its current
+ * one. The file is highlighted with it as soon as it is not in use by the
+ * highlight thread, or any lookup running, any more.
+ *
+ * @param editor the editor instance the translation unit was parsed for.
+ * @param unit the translation unit, or NULL to only dispose the current one.
+ *
+ * @ingroup Editor
+ */
+void edi_editor_clang_unit_set(Edi_Editor *editor, CXTranslationUnit unit);
+
+/**
+ * Use the translation unit given while the current one was in use, if any.
+ * Called on the main loop once a thread using the unit stopped.
+ *
+ * @param editor the editor instance the translation unit was parsed for.
+ *
+ * @ingroup Editor
+ */
+void edi_editor_clang_unit_swap(Edi_Editor *editor);
+#endif
+
 /**
  * @}
  *
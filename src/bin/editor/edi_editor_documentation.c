@@ -102,11 +102,9 @@ _edi_doc_popup_cb_del(void *data, Evas *e EINA_UNUSED,
    edi_language_doc_free(doc);
 }
 
-void
-edi_editor_doc_open(Edi_Editor *editor)
+static void
+_edi_doc_popup_open(Edi_Editor *editor, Edi_Language_Document *doc)
 {
-   Edi_Language_Document *doc = NULL;
-   Edi_Language_Provider *provider;
    Evas_Object *label;
    const char *detail, *param, *ret, *see;
    char *display;
@@ -115,15 +113,6 @@ edi_editor_doc_open(Edi_Editor *editor)
    const char *font;
    int font_size;
 
-   provider = edi_language_provider_get(editor);
-   if (provider && provider->lookup_doc)
-     {
-        unsigned int row, col;
-
-        elm_code_widget_cursor_position_get(editor->entry, &row, &col);
-        doc = edi_language_provider_get(editor)->lookup_doc(editor, row, col);
-     }
-
    //Popup
    editor->doc_popup = elm_popup_add(editor->entry);
    evas_object_smart_callback_add(editor->doc_popup, "block,clicked",
@@ -212,3 +201,27 @@ edi_editor_doc_open(Edi_Editor *editor)
 
    free(display);
 }
+
+void
+edi_editor_doc_open(Edi_Editor *editor)
+{
+   Edi_Language_Document *doc = NULL;
+   Edi_Language_Provider *provider;
+   unsigned int row, col;
+
+   provider = edi_language_provider_get(editor);
+   if (provider && (provider->lookup_doc_async || provider->lookup_doc))
+     {
+        elm_code_widget_cursor_position_get(editor->entry, &row, &col);
+
+        // The popup opens once the document arrives.
+        if (provider->lookup_doc_async &&
+            provider->lookup_doc_async(editor, row, col, _edi_doc_popup_open))
+          return;
+
+        if (provider->lookup_doc)
+          doc = provider->lookup_doc(editor, row, col);
+     }
+
+   _edi_doc_popup_open(editor, doc);
+}
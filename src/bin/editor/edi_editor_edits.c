@@ -0,0 +1,154 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <Eina.h>
+
+#include "edi_editor_edits.h"
+
+#include "edi_private.h"
+
+// Edits remembered for the backends catching up, older ones are forgotten.
+#define EDI_EDITOR_EDITS_MAX 1024
+
+struct _Edi_Editor_Edits
+{
+   Eina_Inarray *log; /**< The Edi_Editor_Edit turning each version into the next */
+   unsigned int base, serial; /**< The oldest version the log goes back to, and the current one */
+   unsigned int first, last; /**< The lines changed since the last edit was logged, or 0 */
+   unsigned int lines_before, lines;
+};
+
+Edi_Editor_Edits *
+edi_editor_edits_new(unsigned int lines)
+{
+   Edi_Editor_Edits *edits;
+
+   edits = calloc(1, sizeof(Edi_Editor_Edits));
+   edits->log = eina_inarray_new(sizeof(Edi_Editor_Edit), 64);
+   edi_editor_edits_reset(edits, lines);
+
+   return edits;
+}
+
+void
+edi_editor_edits_free(Edi_Editor_Edits *edits)
+{
+   if (!edits)
+     return;
+
+   eina_inarray_free(edits->log);
+   free(edits);
+}
+
+void
+edi_editor_edits_reset(Edi_Editor_Edits *edits, unsigned int lines)
+{
+   eina_inarray_flush(edits->log);
+
+   edits->serial++;
+   edits->base = edits->serial;
+   edits->first = edits->last = 0;
+   edits->lines = lines;
+}
+
+void
+edi_editor_edits_line_changed(Edi_Editor_Edits *edits, unsigned int number, unsigned int lines)
+{
+   int moved;
+
+   moved = (int) lines - (int) edits->lines;
+
+   if (!edits->first)
+     {
+        edits->first = edits->last = number;
+        edits->lines_before = edits->lines;
+     }
+   else
+     {
+        // Lines added or removed above the last changed line move it.
+        if (number <= edits->last)
+          {
+             if (moved < 0 && edits->last < edits->first - moved)
+               edits->last = edits->first;
+             else
+               edits->last += moved;
+          }
+        if (number < edits->first)
+          edits->first = number;
+        if (number > edits->last)
+          edits->last = number;
+     }
+
+   edits->lines = lines;
+}
+
+void
+edi_editor_edits_log(Edi_Editor_Edits *edits, unsigned int lines)
+{
+   Edi_Editor_Edit edit;
+   int removed;
+
+   if (!edits->first)
+     {
+        // Lines were removed without any other changing, where is not known.
+        if (lines != edits->lines)
+          edi_editor_edits_reset(edits, lines);
+        return;
+     }
+
+   edit.first = edits->first;
+   edit.added = edits->last - edits->first + 1;
+   removed = (int) edit.added - ((int) edits->lines - (int) edits->lines_before);
+   edits->first = edits->last = 0;
+   if (removed < 0)
+     {
+        edi_editor_edits_reset(edits, lines);
+        return;
+     }
+   edit.removed = removed;
+
+   if (eina_inarray_count(edits->log) >= EDI_EDITOR_EDITS_MAX)
+     {
+        eina_inarray_remove_at(edits->log, 0);
+        edits->base++;
+     }
+   eina_inarray_push(edits->log, &edit);
+   edits->serial++;
+}
+
+Eina_Bool
+edi_editor_edits_since_get(Edi_Editor_Edits *edits, unsigned int *serial, Edi_Editor_Edit *edit)
+{
+   Edi_Editor_Edit *next;
+   unsigned int i, end;
+   Eina_Bool known;
+
+   memset(edit, 0, sizeof(Edi_Editor_Edit));
+
+   known = *serial && *serial >= edits->base && *serial <= edits->serial;
+   for (i = *serial - edits->base; known && i < eina_inarray_count(edits->log); i++)
+     {
+        next = eina_inarray_nth(edits->log, i);
+        if (!edit->first)
+          {
+             *edit = *next;
+             continue;
+          }
+
+        // Both replace the lines from the first one changed up to the last
+        // one either changed, counted in the text between them.
+        end = edit->first + edit->added;
+        if (next->first + next->removed > end)
+          end = next->first + next->removed;
+        edit->removed = end - edit->added + edit->removed;
+        edit->added = end - next->removed + next->added;
+        if (next->first < edit->first)
+          edit->first = next->first;
+        edit->removed -= edit->first;
+        edit->added -= edit->first;
+     }
+
+   *serial = edits->serial;
+   return known;
+}
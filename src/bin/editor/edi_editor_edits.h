@@ -0,0 +1,103 @@
+#ifndef EDI_EDITOR_EDITS_H_
+# define EDI_EDITOR_EDITS_H_
+
+#include <Elementary.h>
+
+#include "edi_editor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief These routines log the lines each edit of an editor changed.
+ */
+
+/**
+ * @brief Editor edits functions.
+ * @defgroup Editor_Edits
+ *
+ * @{
+ *
+ * The lines changed are reported one at a time as the text is edited, with
+ * how many lines the file has then. Once an edit is done they are logged as
+ * the lines it replaced, so the edits since any version still remembered
+ * can be merged into one.
+ *
+ */
+
+/**
+ * Start logging the edits of a file.
+ *
+ * @param lines How many lines the file has.
+ *
+ * @return the log of edits, to free with edi_editor_edits_free().
+ *
+ * @ingroup Editor_Edits
+ */
+Edi_Editor_Edits *edi_editor_edits_new(unsigned int lines);
+
+/**
+ * Stop logging edits.
+ *
+ * @param edits The log of edits.
+ *
+ * @ingroup Editor_Edits
+ */
+void edi_editor_edits_free(Edi_Editor_Edits *edits);
+
+/**
+ * Forget the edits, the versions before are not known any more.
+ *
+ * @param edits The log of edits.
+ * @param lines How many lines the file has now.
+ *
+ * @ingroup Editor_Edits
+ */
+void edi_editor_edits_reset(Edi_Editor_Edits *edits, unsigned int lines);
+
+/**
+ * Note that a line changed, or was added, as part of the current edit.
+ *
+ * @param edits The log of edits.
+ * @param number The line changed.
+ * @param lines How many lines the file has now.
+ *
+ * @ingroup Editor_Edits
+ */
+void edi_editor_edits_line_changed(Edi_Editor_Edits *edits, unsigned int number, unsigned int lines);
+
+/**
+ * Log the lines changed since the last edit as one edit, a new version.
+ *
+ * @param edits The log of edits.
+ * @param lines How many lines the file has now.
+ *
+ * @ingroup Editor_Edits
+ */
+void edi_editor_edits_log(Edi_Editor_Edits *edits, unsigned int lines);
+
+/**
+ * Merge the edits logged since a version into one.
+ *
+ * @param edits The log of edits.
+ * @param serial The version to start from, 0 for none. It is set to the
+ *        current version.
+ * @param edit Set to the lines changed since that version.
+ *
+ * @return EINA_FALSE if the edits since that version are not known.
+ *
+ * @ingroup Editor_Edits
+ */
+Eina_Bool edi_editor_edits_since_get(Edi_Editor_Edits *edits, unsigned int *serial, Edi_Editor_Edit *edit);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDI_EDITOR_EDITS_H_ */
@@ -14,6 +14,7 @@
 #include <Evas.h>
 
 #include "edi_editor.h"
+#include "edi_regex.h"
 #include "edi_private.h"
 
 /**
@@ -50,8 +51,66 @@ struct _Edi_Editor_Search
    struct _Edi_Search_Result cache; /**< The first found search instance */
    /* Add new members here. */
    Eina_Bool wrapped;
+   Evas_Object *regex_checkbox; /**< The checkbox for regular expression search */
+   Edi_Regex *regex; /**< The compiled search term, if searching for a regular expression */
+   char *regex_pattern; /**< The search term the regex was compiled from */
+   unsigned int found_length; /**< The length of the match that will be selected */
 };
 
+static void
+_edi_search_regex_free(Edi_Editor_Search *search)
+{
+   edi_regex_free(search->regex);
+   free(search->regex_pattern);
+   search->regex = NULL;
+   search->regex_pattern = NULL;
+}
+
+// Compile the search term if it is a regular expression, keeping it while it is unchanged.
+static Eina_Bool
+_edi_search_regex_update(Edi_Editor_Search *search, const char *text)
+{
+   if (!elm_check_state_get(search->regex_checkbox))
+     {
+        _edi_search_regex_free(search);
+        return EINA_TRUE;
+     }
+
+   if (search->regex && !strcmp(search->regex_pattern, text))
+     return EINA_TRUE;
+
+   _edi_search_regex_free(search);
+   search->regex = edi_regex_new(text, NULL);
+   if (!search->regex)
+     return EINA_FALSE;
+
+   search->regex_pattern = strdup(text);
+   return EINA_TRUE;
+}
+
+// Find the next match in a line, as a byte position, and its length.
+static int
+_edi_search_line_find(Edi_Editor_Search *search, Elm_Code_Line *line, const char *text,
+                      unsigned int offset, unsigned int *length)
+{
+   const char *content;
+   unsigned int content_length;
+   size_t start, end;
+
+   if (!search->regex)
+     {
+        *length = strlen(text);
+        return elm_code_line_text_strpos(line, text, offset);
+     }
+
+   content = elm_code_line_text_get(line, &content_length);
+   if (!content || !edi_regex_match(search->regex, content, content_length, offset, &start, &end))
+     return ELM_CODE_TEXT_NOT_FOUND;
+
+   *length = end - start;
+   return start;
+}
+
 static void
 _edi_search_cache_reset(Edi_Editor_Search *search)
 {
@@ -119,16 +178,18 @@ _edi_search_clear_highlights(Eina_List *tokens)
 }
 
 static void
-_edi_search_show_highlights(Elm_Code_Line *line, const char *text)
+_edi_search_show_highlights(Edi_Editor_Search *search, Elm_Code_Line *line, const char *text)
 {
+   unsigned int length;
    int match;
 
-   match = elm_code_line_text_strpos(line, text, 0);
+   match = _edi_search_line_find(search, line, text, 0, &length);
    while (match != ELM_CODE_TEXT_NOT_FOUND)
      {
-        elm_code_line_token_add(line, match, match + strlen(text) - 1, 1, ELM_CODE_TOKEN_TYPE_MATCH);
+        elm_code_line_token_add(line, match, match + length - 1, 1, ELM_CODE_TOKEN_TYPE_MATCH);
 
-        match = elm_code_line_text_strpos(line, text, match + 1);
+        // Regular expression matches do not overlap.
+        match = _edi_search_line_find(search, line, text, match + (search->regex ? length : 1), &length);
      }
 }
 
@@ -141,7 +202,7 @@ _edi_search_in_entry(Evas_Object *entry, Edi_Editor_Search *search)
    Elm_Code_Line *line;
    const char *text_markup;
    char *text;
-   unsigned int offset, pos, pos_line, pos_col;
+   unsigned int offset, pos, pos_line, pos_col, length;
    int found, match;
    search->wrap = elm_check_state_get(search->checkbox);
 
@@ -153,6 +214,12 @@ _edi_search_in_entry(Evas_Object *entry, Edi_Editor_Search *search)
      }
 
    text = elm_entry_markup_to_utf8(text_markup);
+   if (!_edi_search_regex_update(search, text))
+     {
+        search->term_found = EINA_FALSE;
+        free(text);
+        return EINA_FALSE;
+     }
 
    code = elm_code_widget_code_get(entry);
    elm_code_widget_cursor_position_get(entry, &pos_line, &pos_col);
@@ -177,10 +244,10 @@ _edi_search_in_entry(Evas_Object *entry, Edi_Editor_Search *search)
    EINA_LIST_FOREACH(code->file->lines, item, line)
      {
         line->tokens = _edi_search_clear_highlights(line->tokens);
-        _edi_search_show_highlights(line, text);
+        _edi_search_show_highlights(search, line, text);
 
         offset = 0;
-        match = elm_code_line_text_strpos(line, text, offset);
+        match = _edi_search_line_find(search, line, text, offset, &length);
         if (match == ELM_CODE_TEXT_NOT_FOUND)
           continue;
 
@@ -195,7 +262,7 @@ _edi_search_in_entry(Evas_Object *entry, Edi_Editor_Search *search)
           {
              offset = elm_code_widget_line_text_position_for_column_get(entry, line, pos_col) + (try_next ? 1 : 0);
 
-             match = elm_code_line_text_strpos(line, text, offset);
+             match = _edi_search_line_find(search, line, text, offset, &length);
              if (match == ELM_CODE_TEXT_NOT_FOUND)
                continue;
 
@@ -207,6 +274,7 @@ _edi_search_in_entry(Evas_Object *entry, Edi_Editor_Search *search)
              // store first occurence of search from cursor position
              search->current_search_line = line->number;
              search->current_search_col = pos;
+             search->found_length = length;
 
              found = match;
           }
@@ -257,7 +325,7 @@ _edi_search_in_entry(Evas_Object *entry, Edi_Editor_Search *search)
    elm_code_widget_selection_start(entry, search->current_search_line,
                                         search->current_search_col);
    elm_code_widget_selection_end(entry, search->current_search_line,
-                                 elm_code_widget_line_text_column_width_to_position(entry, line, found + strlen(text)) - 1);
+                                 elm_code_widget_line_text_column_width_to_position(entry, line, found + search->found_length) - 1);
 
    free(text);
 
@@ -345,6 +413,7 @@ _edi_editor_search_hide(Edi_Editor *editor)
 
    search->current_search_line = 0;
    elm_code_widget_selection_clear(editor->entry);
+   _edi_search_regex_free(search);
 
    // Re-focus in the editor proper since we are closing the search bar here
    elm_object_focus_set(editor->entry, EINA_TRUE);
@@ -406,6 +475,19 @@ _edi_cancel_clicked(void *data, Evas_Object *obj EINA_UNUSED, void *event_info E
    _edi_editor_search_hide((Edi_Editor *)data);
 }
 
+static void
+_edi_search_regex_changed(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUSED)
+{
+   Edi_Editor_Search *search;
+
+   search = ((Edi_Editor *)data)->search;
+
+   // The same term now finds different matches, start over.
+   _edi_search_cache_reset(search);
+   search->current_search_line = 0;
+   search->term_found = EINA_FALSE;
+}
+
 static void
 _edi_search_key_up_cb(void *data, Evas *e EINA_UNUSED, Evas_Object *obj,
                   void *event_info)
@@ -436,7 +518,7 @@ edi_editor_search_add(Evas_Object *parent, Edi_Editor *editor)
 {
    Evas_Object *entry, *wrapped_text, *lbl, *btn, *box, *big_box, *table;
    Evas_Object *replace_entry, *replace_lbl, *replace_btn;
-   Evas_Object *checkbox;
+   Evas_Object *checkbox, *regex_checkbox;
    Edi_Editor_Search *search;
 
    big_box = elm_box_add(parent);
@@ -511,6 +593,12 @@ edi_editor_search_add(Evas_Object *parent, Edi_Editor *editor)
    evas_object_show(checkbox);
    elm_box_pack_end(box, checkbox);
 
+   regex_checkbox = elm_check_add(parent);
+   elm_object_text_set(regex_checkbox, _("Regex?"));
+   evas_object_show(regex_checkbox);
+   elm_box_pack_end(box, regex_checkbox);
+   evas_object_smart_callback_add(regex_checkbox, "changed", _edi_search_regex_changed, editor);
+
    btn = elm_button_add(parent);
    elm_object_text_set(btn, _("Search"));
    evas_object_size_hint_align_set(btn, 1.0, 0.0);
@@ -543,6 +631,7 @@ edi_editor_search_add(Evas_Object *parent, Edi_Editor *editor)
    search->parent = parent;
    search->widget = big_box;
    search->checkbox = checkbox;
+   search->regex_checkbox = regex_checkbox;
    editor->search = search;
    evas_object_show(parent);
 }
@@ -9,6 +9,7 @@
 #include "edi_private.h"
 
 #include "edi_language_provider_c.c"
+#include "edi_language_provider_lsp.c"
 #include "edi_language_provider_python.c"
 #include "edi_language_provider_rust.c"
 #include "edi_language_provider_go.c"
@@ -18,25 +19,27 @@ static Edi_Language_Provider _edi_language_provider_registry[] =
    {
       "c", _edi_language_c_add, _edi_language_c_refresh, _edi_language_c_del,
       _edi_language_c_mime_name, _edi_language_c_snippet_get,
-      _edi_language_c_lookup, _edi_language_c_lookup_doc
+      _edi_language_c_lookup, _edi_language_c_lookup_doc, _edi_language_c_lookup_async,
+      _edi_language_c_lookup_doc_async, _edi_language_c_lookup_definition,
+      _edi_language_c_lookup_definition_async
    },
    {
       "python", _edi_language_python_add, _edi_language_python_refresh, _edi_language_python_del,
       _edi_language_python_mime_name, _edi_language_python_snippet_get,
-      NULL, NULL
+      NULL, NULL, _edi_language_lsp_lookup_async, _edi_language_lsp_lookup_doc_async, NULL, NULL
    },
    {
       "rust", _edi_language_rust_add, _edi_language_rust_refresh, _edi_language_rust_del,
       _edi_language_rust_mime_name, _edi_language_rust_snippet_get,
-      NULL, NULL
+      NULL, NULL, _edi_language_lsp_lookup_async, _edi_language_lsp_lookup_doc_async, NULL, NULL
    },
    {
       "go", _edi_language_go_add, _edi_language_go_refresh, _edi_language_go_del,
       _edi_language_go_mime_name, _edi_language_go_snippet_get,
-      NULL, NULL
+      NULL, NULL, _edi_language_lsp_lookup_async, _edi_language_lsp_lookup_doc_async, NULL, NULL
    },
 
-   {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL}
+   {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL}
 };
 
 Edi_Language_Provider *edi_language_provider_get(Edi_Editor *editor)
@@ -84,6 +87,12 @@ edi_language_provider_has(Edi_Editor *editor)
    return !!edi_language_provider_get(editor);
 }
 
+void
+edi_language_provider_shutdown(void)
+{
+   _edi_language_lsp_shutdown();
+}
+
 void
 edi_language_suggest_item_free(Edi_Language_Suggest_Item *item)
 {
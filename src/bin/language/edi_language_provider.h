@@ -31,6 +31,29 @@ typedef struct _Edi_Language_Document
    Eina_Strbuf *ret;
    Eina_Strbuf *see;
 } Edi_Language_Document;
+
+/**
+ * @typedef Edi_Language_Lookup_Cb
+ * Called on the main loop with the suggestions found by a lookup that was
+ * started with lookup_async, the list is then owned by the callee.
+ */
+typedef void (*Edi_Language_Lookup_Cb)(Edi_Editor *editor, Eina_List *list);
+
+/**
+ * @typedef Edi_Language_Doc_Cb
+ * Called on the main loop with the document found by a lookup that was
+ * started with lookup_doc_async, or NULL if there is none. The document is
+ * then owned by the callee.
+ */
+typedef void (*Edi_Language_Doc_Cb)(Edi_Editor *editor, Edi_Language_Document *doc);
+
+/**
+ * @typedef Edi_Language_Definition_Cb
+ * Called on the main loop with where the symbol looked up with
+ * lookup_definition_async is defined, or NULL if it is not known. The
+ * options are then owned by the callee.
+ */
+typedef void (*Edi_Language_Definition_Cb)(Edi_Editor *editor, Edi_Path_Options *options);
 /**
  * @struct Edi_Editor_Suggest_Provider
  * A description of the requirements for a suggestion provider.
@@ -48,6 +71,10 @@ typedef struct _Edi_Language_Provider
    const char *(*snippet_get)(const char *key);
    Eina_List *(*lookup)(Edi_Editor *editor, unsigned int row, unsigned int col);
    Edi_Language_Document *(*lookup_doc)(Edi_Editor *editor, unsigned int row, unsigned int col);
+   Eina_Bool (*lookup_async)(Edi_Editor *editor, unsigned int row, unsigned int col, Edi_Language_Lookup_Cb cb);
+   Eina_Bool (*lookup_doc_async)(Edi_Editor *editor, unsigned int row, unsigned int col, Edi_Language_Doc_Cb cb);
+   Edi_Path_Options *(*lookup_definition)(Edi_Editor *editor, unsigned int row, unsigned int col);
+   Eina_Bool (*lookup_definition_async)(Edi_Editor *editor, unsigned int row, unsigned int col, Edi_Language_Definition_Cb cb);
 } Edi_Language_Provider;
 
 /**
@@ -86,6 +113,14 @@ Edi_Language_Provider *edi_language_provider_for_mime_get(const char *mime);
  */
 Eina_Bool edi_language_provider_has(Edi_Editor *editor);
 
+/**
+ * Stop the language servers the providers started, waiting a moment for
+ * them to shut down. Call it once before exiting.
+ *
+ * @ingroup Lookup
+ */
+void edi_language_provider_shutdown(void);
+
 /**
  * Free a suggest item.
  *
@@ -108,6 +143,60 @@ void edi_language_doc_free(Edi_Language_Document *doc);
  * @}
  */
 
+#if HAVE_LIBCLANG
+/**
+ * @brief Clang, shared by the C language provider and the symbol index.
+ * @defgroup Clang
+ *
+ * @{
+ *
+ * The clang index everything parsing C uses, created on first use.
+ * Call it on the main loop before the other functions of this group.
+ *
+ * @return the shared index.
+ *
+ * @ingroup Clang
+ */
+CXIndex edi_language_c_index_get(void);
+
+/**
+ * The arguments to parse a C file with, found in the compilation database
+ * of the project. The database is loaded again only once it changes. Can
+ * be called from any thread.
+ *
+ * @param path the absolute path of the file to parse.
+ * @param argc set to the number of arguments.
+ * @return the arguments, NULL terminated, to free with edi_language_c_args_free().
+ *
+ * @ingroup Clang
+ */
+char **edi_language_c_args_get(const char *path, unsigned int *argc);
+
+/**
+ * Free the arguments returned by edi_language_c_args_get().
+ *
+ * @param args the arguments to free.
+ *
+ * @ingroup Clang
+ */
+void edi_language_c_args_free(char **args);
+
+/**
+ * The files the compilation database of the project builds. Can be called
+ * from any thread.
+ *
+ * @return a list of absolute paths, to free along with the list, or NULL
+ *         if the project has no compilation database.
+ *
+ * @ingroup Clang
+ */
+Eina_List *edi_language_c_files_get(void);
+
+/**
+ * @}
+ */
+#endif
+
 
 
 #ifdef __cplusplus
@@ -13,44 +13,104 @@
 #include "edi_language_provider.h"
 
 #include "edi_config.h"
+#include "edi_symbol_index.h"
 
 #include "edi_private.h"
 
 #if HAVE_LIBCLANG
 
+/*
+ * One index is shared by all editors, and the symbol index. The compilation
+ * database of the project is loaded once, and again only when it changes,
+ * each file keeps the arguments found for it. Parse threads share them
+ * under the lock.
+ */
+typedef struct
+{
+   char **args;
+   unsigned int argc;
+} Edi_Language_C_Args;
+
+typedef struct
+{
+   char *working;
+   long long mtime;
+   CXCompilationDatabase database;
+   Eina_Hash *files;
+} Edi_Language_C_Database;
+
+static CXIndex _clang_index = NULL;
+static Edi_Language_C_Database _clang_database;
+static Eina_Lock _clang_database_lock;
+
+static void
+_clang_args_free(Edi_Language_C_Args *args)
+{
+   unsigned int i;
+
+   for (i = 0; i < args->argc; i++)
+     free(args->args[i]);
+   free(args->args);
+   free(args);
+}
+
 static void
-_clang_commands_fallback_get(const char ***args, unsigned int *argc)
+_clang_args_free_cb(void *data)
 {
+   _clang_args_free(data);
+}
+
+static Edi_Language_C_Args *
+_clang_args_dup(const Edi_Language_C_Args *args)
+{
+   Edi_Language_C_Args *copy;
+   unsigned int i;
+
+   copy = malloc(sizeof(Edi_Language_C_Args));
+   copy->argc = args->argc;
+   copy->args = malloc(sizeof(char *) * (args->argc + 1));
+   for (i = 0; i < args->argc; i++)
+     copy->args[i] = strdup(args->args[i]);
+   copy->args[i] = NULL;
+
+   return copy;
+}
+
+static Edi_Language_C_Args *
+_clang_commands_fallback_get(void)
+{
+   Edi_Language_C_Args *args;
    const char *argstr;
+   char **split;
+   unsigned int i;
 
    argstr = "-I/usr/include/ " EFL_CFLAGS " " CLANG_INCLUDES " -Wall -Wextra";
-   *args = (const char **) eina_str_split_full(argstr, " ", 0, argc);
+   split = eina_str_split_full(argstr, " ", 0, &i);
+
+   args = malloc(sizeof(Edi_Language_C_Args));
+   args->argc = i;
+   args->args = malloc(sizeof(char *) * (args->argc + 1));
+   for (i = 0; i < args->argc; i++)
+     args->args[i] = strdup(split[i]);
+   args->args[i] = NULL;
+
+   free(split[0]);
+   free(split);
+
+   return args;
 }
 
-static void
-_clang_commands_get(const char *path, const char ***args, unsigned int *argc)
+static Edi_Language_C_Args *
+_clang_commands_load(CXCompilationDatabase database, const char *working, const char *path)
 {
-   CXCompilationDatabase_Error error;
-   CXCompilationDatabase database = NULL;
+   Edi_Language_C_Args *args;
    CXCompileCommands commands;
    CXCompileCommand command;
-   char *working;
-   const char** arguments;
+   char argstr_working[PATH_MAX + 32];
    unsigned int i, numargs, ignored = 0;
 
-   if (edi_project_file_exists("build/compile_commands.json"))
-     working = edi_project_file_path_get("build");
-   else
-     working = strdup(edi_project_get());
-
-   database = clang_CompilationDatabase_fromDirectory(working, &error);
-   if (database == NULL || error == CXCompilationDatabase_CanNotLoadDatabase)
-     {
-        INF("Could not load compile_commands.json in %s", edi_project_get());
-        _clang_commands_fallback_get(args, argc);
-	free(working);
-        return;
-     }
+   if (!database)
+     return _clang_commands_fallback_get();
 
    commands = clang_CompilationDatabase_getCompileCommands(database, path);
    command = clang_CompileCommands_getCommand(commands, 0);
@@ -59,62 +119,299 @@ _clang_commands_get(const char *path, const char ***args, unsigned int *argc)
    if (numargs == 0)
      {
         INF("File %s not found in compile_commands.json", path);
-        _clang_commands_fallback_get(args, argc);
-        free(working);
-        return;
+        clang_CompileCommands_dispose(commands);
+        return _clang_commands_fallback_get();
      }
 
-   arguments = malloc(sizeof(char*) * (numargs + 2));
+   args = malloc(sizeof(Edi_Language_C_Args));
+   args->args = malloc(sizeof(char *) * (numargs + 2));
    INF("Loading clang parameters for %s", path);
 
-   arguments[0] = CLANG_INCLUDES;
+   args->args[0] = strdup(CLANG_INCLUDES);
    for(i = 1; i <= numargs; i++ )
      {
         const char *argstr;
         CXString argument = clang_CompileCommand_getArg(command, i + 1);
         argstr = clang_getCString(argument);
 
+        // Only the arguments that change what is declared are kept.
         if (argstr && strlen(argstr) > 2 && argstr[0] == '-' &&
-            (argstr[1] == 'I' || argstr[1] == 'D'))
-          arguments[i - ignored] = strdup(argstr);
+            (argstr[1] == 'I' || argstr[1] == 'D' || argstr[1] == 'U' ||
+             !strncmp(argstr, "-std=", 5)))
+          args->args[i - ignored] = strdup(argstr);
         else
           ignored++;
 
         clang_disposeString(argument);
      }
 
-   arguments[i - ignored] = eina_slstr_printf("-working-directory=%s", working);
-   *args = arguments;
-   *argc = numargs + 2 - ignored;
+   snprintf(argstr_working, sizeof(argstr_working), "-working-directory=%s", working);
+   args->args[i - ignored] = strdup(argstr_working);
+   args->argc = numargs + 2 - ignored;
+   args->args[args->argc] = NULL;
+
+   clang_CompileCommands_dispose(commands);
+
+   return args;
+}
+
+// Drop what was loaded from a database that changed, or of another project.
+static void
+_clang_database_reset(const char *working, long long mtime)
+{
+   CXCompilationDatabase_Error error;
+
+   if (_clang_database.database)
+     clang_CompilationDatabase_dispose(_clang_database.database);
+   if (_clang_database.files)
+     eina_hash_free(_clang_database.files);
+   free(_clang_database.working);
+
+   _clang_database.working = strdup(working);
+   _clang_database.mtime = mtime;
+   _clang_database.files = eina_hash_string_superfast_new(_clang_args_free_cb);
+   _clang_database.database = clang_CompilationDatabase_fromDirectory(working, &error);
+   if (_clang_database.database && error == CXCompilationDatabase_CanNotLoadDatabase)
+     {
+        clang_CompilationDatabase_dispose(_clang_database.database);
+        _clang_database.database = NULL;
+     }
+
+   if (!_clang_database.database)
+     INF("Could not load compile_commands.json in %s", edi_project_get());
+}
+
+// Load the database again if it changed, or the project did. Called with the lock held.
+static void
+_clang_database_update(void)
+{
+   char *working, *json;
+   long long mtime;
+
+   if (edi_project_file_exists("build/compile_commands.json"))
+     working = edi_project_file_path_get("build");
+   else
+     working = strdup(edi_project_get());
+
+   json = malloc(strlen(working) + strlen("/compile_commands.json") + 1);
+   sprintf(json, "%s/compile_commands.json", working);
+   mtime = ecore_file_mod_time(json);
+   free(json);
+
+   if (!_clang_database.working || strcmp(_clang_database.working, working) ||
+       _clang_database.mtime != mtime)
+     _clang_database_reset(working, mtime);
 
-   clang_CompilationDatabase_dispose(database);
    free(working);
 }
 
+// The arguments to parse path with, to be freed by the caller.
+static Edi_Language_C_Args *
+_clang_commands_get(const char *path)
+{
+   Edi_Language_C_Args *args;
+
+   eina_lock_take(&_clang_database_lock);
+   _clang_database_update();
+
+   args = eina_hash_find(_clang_database.files, path);
+   if (!args)
+     {
+        args = _clang_commands_load(_clang_database.database, _clang_database.working, path);
+        eina_hash_add(_clang_database.files, path, args);
+     }
+   args = _clang_args_dup(args);
+
+   eina_lock_release(&_clang_database_lock);
+
+   return args;
+}
+
+static void
+_clang_init(void)
+{
+   if (_clang_index)
+     return;
+
+   _clang_index = clang_createIndex(0, 0);
+   eina_lock_new(&_clang_database_lock);
+}
+
+/*
+ * Parsing a file and all it includes takes a while, it is done on a thread.
+ * The first parse keeps a preamble of the headers included, later ones only
+ * parse the text of the file again. The editor gets the unit back once
+ * done, unless it was closed meanwhile.
+ */
+typedef struct
+{
+   Edi_Editor *editor;
+   char *path;
+   char *contents;
+   unsigned long length;
+   CXTranslationUnit unit, old;
+} Edi_Language_C_Parse;
+
+static void
+_clang_parse_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Language_C_Parse *parse = data;
+   Edi_Language_C_Args *args;
+   struct CXUnsavedFile unsaved;
+
+   unsaved.Filename = parse->path;
+   unsaved.Contents = parse->contents;
+   unsaved.Length = parse->length;
+
+   if (parse->unit)
+     {
+        eina_lock_take(&parse->editor->clang_lock);
+        if (!clang_reparseTranslationUnit(parse->unit, 1, &unsaved,
+                                          clang_defaultReparseOptions(parse->unit)))
+          {
+             eina_lock_release(&parse->editor->clang_lock);
+             return;
+          }
+        eina_lock_release(&parse->editor->clang_lock);
+
+        // The unit is of no use after a failed reparse, the editor disposes of it.
+        INF("Could not reparse %s, parsing it again", parse->path);
+        parse->old = parse->unit;
+        parse->unit = NULL;
+     }
+
+   args = _clang_commands_get(parse->path);
+   parse->unit = clang_parseTranslationUnit(_clang_index, parse->path,
+                                  (const char *const *) args->args, args->argc,
+                                  parse->contents ? &unsaved : NULL, parse->contents ? 1 : 0,
+                                  clang_defaultEditingTranslationUnitOptions() | CXTranslationUnit_DetailedPreprocessingRecord | CXTranslationUnit_KeepGoing |
+                                  CXTranslationUnit_PrecompiledPreamble | CXTranslationUnit_CreatePreambleOnFirstParse);
+   _clang_args_free(args);
+}
+
+static void
+_clang_parse_free(Edi_Language_C_Parse *parse)
+{
+   free(parse->contents);
+   free(parse->path);
+   free(parse);
+}
+
+static void
+_clang_autosuggest_setup(Edi_Editor *editor);
+
+static void
+_clang_parse_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Language_C_Parse *parse = data;
+   Edi_Editor *editor = parse->editor;
+
+   editor->clang_thread = NULL;
+   edi_editor_clang_unit_set(editor, parse->unit);
+   _clang_parse_free(parse);
+
+   // Saved again while parsing, the text parsed is already out of date.
+   if (editor->clang_refresh)
+     _clang_autosuggest_setup(editor);
+}
+
+// The editor was closed, what the parse had is now left to it to dispose of.
+static void
+_clang_parse_cancel_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Language_C_Parse *parse = data;
+
+   if (parse->unit)
+     clang_disposeTranslationUnit(parse->unit);
+   if (parse->old)
+     clang_disposeTranslationUnit(parse->old);
+
+   _clang_parse_free(parse);
+}
+
+static char *
+_clang_contents_get(Edi_Editor *editor, unsigned long *length)
+{
+   Elm_Code_Line *line;
+   Eina_Strbuf *text;
+   Eina_List *l;
+   const char *content;
+   unsigned int line_length;
+   char *contents;
+
+   text = eina_strbuf_new();
+   EINA_LIST_FOREACH(elm_code_widget_code_get(editor->entry)->file->lines, l, line)
+     {
+        content = elm_code_line_text_get(line, &line_length);
+        if (line_length)
+          eina_strbuf_append_length(text, content, line_length);
+        eina_strbuf_append_char(text, '\n');
+     }
+
+   *length = eina_strbuf_length_get(text);
+   contents = eina_strbuf_string_steal(text);
+   eina_strbuf_free(text);
+
+   return contents;
+}
+
 static void
 _clang_autosuggest_setup(Edi_Editor *editor)
 {
+   Edi_Language_C_Parse *parse;
    Elm_Code *code;
    const char *path;
-   const char **args;
-   unsigned int argc;
 
    code = elm_code_widget_code_get(editor->entry);
    path = elm_code_file_path_get(code->file);
+   if (!path)
+     return;
+
+   _clang_init();
 
-   //Initialize Clang
-   _clang_commands_get(path, &args, &argc);
-   editor->clang_idx = clang_createIndex(0, 0);
-   editor->clang_unit = clang_parseTranslationUnit(editor->clang_idx, path,
-                                  args, argc, NULL, 0,
-                                  clang_defaultEditingTranslationUnitOptions() | CXTranslationUnit_DetailedPreprocessingRecord | CXTranslationUnit_KeepGoing);
+   // The unit can only be parsed again once nothing else uses it.
+   editor->clang_refresh = EINA_FALSE;
+   if (editor->clang_thread || editor->highlight_thread)
+     {
+        editor->clang_refresh = EINA_TRUE;
+        editor->highlight_cancel = EINA_TRUE;
+        return;
+     }
+
+   parse = calloc(1, sizeof(Edi_Language_C_Parse));
+   parse->editor = editor;
+   parse->path = strdup(path);
+   if (editor->clang_unit)
+     {
+        parse->unit = editor->clang_unit;
+        parse->contents = _clang_contents_get(editor, &parse->length);
+     }
+
+   editor->clang_thread = ecore_thread_run(_clang_parse_cb, _clang_parse_end_cb,
+                                           _clang_parse_cancel_cb, parse);
 }
 
 static void
 _clang_autosuggest_dispose(Edi_Editor *editor)
 {
-   clang_disposeTranslationUnit(editor->clang_unit);
-   clang_disposeIndex(editor->clang_idx);
+   editor->suggest_generation++;
+   if (editor->suggest_thread)
+     ecore_thread_cancel(editor->suggest_thread);
+   editor->suggest_thread = NULL;
+   if (editor->lookup_thread)
+     ecore_thread_cancel(editor->lookup_thread);
+   editor->lookup_thread = NULL;
+
+   // A parse running has the unit of the editor, if any.
+   if (editor->clang_thread)
+     {
+        ecore_thread_cancel(editor->clang_thread);
+        editor->clang_thread = NULL;
+        editor->clang_unit = NULL;
+     }
+   editor->clang_refresh = EINA_FALSE;
+
+   edi_editor_clang_unit_set(editor, NULL);
 }
 #endif
 
@@ -122,6 +419,8 @@ void
 _edi_language_c_add(Edi_Editor *editor)
 {
 #if HAVE_LIBCLANG
+   // Kept as long as the editor, threads may still hold it once it is closed.
+   eina_lock_new(&editor->clang_lock);
    _clang_autosuggest_setup(editor);
 #else
    (void) editor;
@@ -132,7 +431,6 @@ void
 _edi_language_c_refresh(Edi_Editor *editor)
 {
 #if HAVE_LIBCLANG
-   _clang_autosuggest_dispose(editor);
    _clang_autosuggest_setup(editor);
 #else
    (void) editor;
@@ -184,58 +482,119 @@ _edi_language_c_snippet_get(const char *key)
 
 
 #if HAVE_LIBCLANG
+/*
+ * What a completion needs from the editor, copied on the main loop so it
+ * can run on a thread. A newer request replaces it, once the generation of
+ * the editor moved on its result is thrown away.
+ */
+typedef struct
+{
+   Edi_Editor *editor;
+   Edi_Language_Lookup_Cb cb;
+   unsigned int generation;
+
+   char *path, *contents;
+   unsigned long length;
+   unsigned int row, col;
+
+   const char *font;
+   int font_size;
+   Evas_Coord width;
+
+   Eina_List *list;
+} Edi_Language_C_Complete;
+
 char *
-_edi_suggest_c_detail_get(Edi_Editor *editor, const char *term_str,
+_edi_suggest_c_detail_get(Edi_Language_C_Complete *complete, const char *term_str,
                                  const char *ret_str, const char *param_str)
 {
    char *format, *display;
-   const char *font;
-   int font_size, displen;
-   unsigned int row, col;
-   Evas_Coord w;
-
-   elm_code_widget_font_get(editor->entry, &font, &font_size);
-   elm_code_widget_cursor_position_get(editor->entry, &row, &col);
-   elm_code_widget_geometry_for_position_get(editor->entry, row, col,
-                                             NULL, NULL, &w, NULL);
+   int displen;
 
    format = "<left_margin=%d><align=left><font='%s'><font_size=%d>%s<br><b>%s</b><br>%s</font_size></font></align></left_margin>";
    displen = strlen(ret_str) + strlen(param_str) + strlen(term_str)
-             + strlen(format) + strlen(font);
+             + strlen(format) + strlen(complete->font);
    display = malloc(sizeof(char) * displen);
-   snprintf(display, displen, format, w, font, font_size, ret_str, term_str, param_str);
+   snprintf(display, displen, format, complete->width, complete->font, complete->font_size,
+            ret_str, term_str, param_str);
 
    return display;
 }
-#endif
 
-Eina_List *
-_edi_language_c_lookup(Edi_Editor *editor, unsigned int row, unsigned int col)
+static Edi_Language_C_Complete *
+_clang_complete_new(Edi_Editor *editor, unsigned int row, unsigned int col)
 {
-   Eina_List *list = NULL;
-
-#if HAVE_LIBCLANG
-   CXCodeCompleteResults *res;
-   struct CXUnsavedFile unsaved_file;
+   Edi_Language_C_Complete *complete;
    Elm_Code *code;
-   const char *path = NULL;
+   unsigned int cursor_row, cursor_col;
 
-   if (!editor->clang_unit)
-     return list;
+   complete = calloc(1, sizeof(Edi_Language_C_Complete));
+   complete->editor = editor;
+   complete->row = row;
+   complete->col = col;
 
    code = elm_code_widget_code_get(editor->entry);
    if (code->file->file)
-     path = elm_code_file_path_get(code->file);
+     complete->path = strdup(elm_code_file_path_get(code->file));
+   complete->contents = _clang_contents_get(editor, &complete->length);
+
+   elm_code_widget_font_get(editor->entry, &complete->font, &complete->font_size);
+   elm_code_widget_cursor_position_get(editor->entry, &cursor_row, &cursor_col);
+   elm_code_widget_geometry_for_position_get(editor->entry, cursor_row, cursor_col,
+                                             NULL, NULL, &complete->width, NULL);
+
+   return complete;
+}
+
+static void
+_clang_complete_free(Edi_Language_C_Complete *complete)
+{
+   Edi_Language_Suggest_Item *suggest_it;
+
+   EINA_LIST_FREE(complete->list, suggest_it)
+     edi_language_suggest_item_free(suggest_it);
+
+   free(complete->contents);
+   free(complete->path);
+   free(complete);
+}
+
+// Run the completion, stopping early if the thread, when there is one, is cancelled.
+static void
+_clang_complete(Edi_Language_C_Complete *complete, Ecore_Thread *thread)
+{
+   Edi_Editor *editor = complete->editor;
+   CXCodeCompleteResults *res;
+   struct CXUnsavedFile unsaved_file;
+
+   if (!complete->path)
+     return;
+
+   unsaved_file.Filename = complete->path;
+   unsaved_file.Contents = complete->contents;
+   unsaved_file.Length = complete->length;
+
+   // Without a thread, on the main loop, only if nothing else uses the unit.
+   if (thread)
+     eina_lock_take(&editor->clang_lock);
+   else if (eina_lock_take_try(&editor->clang_lock) != EINA_LOCK_SUCCEED)
+     return;
 
-   unsaved_file.Filename = path;
-   unsaved_file.Contents = elm_code_widget_text_between_positions_get(
-                                                 editor->entry, 1, 1, row, col);
-   unsaved_file.Length = strlen(unsaved_file.Contents);
+   if (!editor->clang_unit || (thread && ecore_thread_check(thread)))
+     {
+        eina_lock_release(&editor->clang_lock);
+        return;
+     }
 
-   res = clang_codeCompleteAt(editor->clang_unit, path, row, col,
+   res = clang_codeCompleteAt(editor->clang_unit, complete->path, complete->row, complete->col,
                               &unsaved_file, 1,
                               CXCodeComplete_IncludeMacros |
                               CXCodeComplete_IncludeCodePatterns);
+   if (!res)
+     {
+        eina_lock_release(&editor->clang_lock);
+        return;
+     }
 
    clang_sortCodeCompletionResults(res->Results, res->NumResults);
 
@@ -247,6 +606,9 @@ _edi_language_c_lookup(Edi_Editor *editor, unsigned int row, unsigned int col)
         Edi_Language_Suggest_Item *suggest_it;
         Eina_Strbuf *buf = NULL;
 
+        if (thread && ecore_thread_check(thread))
+          break;
+
         suggest_it = calloc(1, sizeof(Edi_Language_Suggest_Item));
 
         for (unsigned int j = 0; j < clang_getNumCompletionChunks(str); j++)
@@ -288,14 +650,77 @@ _edi_language_c_lookup(Edi_Editor *editor, unsigned int row, unsigned int col)
         if (name)
           {
              suggest_it->summary = strdup(name);
-             suggest_it->detail = _edi_suggest_c_detail_get(editor, name, ret?ret:"", param?param:"");
+             suggest_it->detail = _edi_suggest_c_detail_get(complete, name, ret?ret:"", param?param:"");
 
-             list = eina_list_append(list, suggest_it);
+             complete->list = eina_list_append(complete->list, suggest_it);
           }
+        else
+          free(suggest_it);
         if (param)
           free(param);
      }
    clang_disposeCodeCompleteResults(res);
+
+   eina_lock_release(&editor->clang_lock);
+}
+
+static void
+_clang_complete_cb(void *data, Ecore_Thread *thread)
+{
+   _clang_complete(data, thread);
+}
+
+static void
+_clang_complete_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Language_C_Complete *complete = data;
+   Edi_Editor *editor = complete->editor;
+   Edi_Language_Lookup_Cb cb = complete->cb;
+   Eina_List *list;
+
+   edi_editor_clang_unit_swap(editor);
+   if (complete->generation != editor->suggest_generation)
+     {
+        _clang_complete_free(complete);
+        return;
+     }
+
+   editor->suggest_thread = NULL;
+   list = complete->list;
+   complete->list = NULL;
+   _clang_complete_free(complete);
+
+   cb(editor, list);
+}
+
+static void
+_clang_complete_cancel_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Language_C_Complete *complete = data;
+
+   edi_editor_clang_unit_swap(complete->editor);
+   _clang_complete_free(complete);
+}
+#endif
+
+Eina_List *
+_edi_language_c_lookup(Edi_Editor *editor, unsigned int row, unsigned int col)
+{
+   Eina_List *list = NULL;
+
+#if HAVE_LIBCLANG
+   Edi_Language_C_Complete *complete;
+
+   // Not while it is being parsed again.
+   if (!editor->clang_unit || editor->clang_thread)
+     return list;
+
+   complete = _clang_complete_new(editor, row, col);
+   _clang_complete(complete, NULL);
+
+   list = complete->list;
+   complete->list = NULL;
+   _clang_complete_free(complete);
 #else
    (void) editor; (void) row; (void) col;
 #endif
@@ -303,6 +728,36 @@ _edi_language_c_lookup(Edi_Editor *editor, unsigned int row, unsigned int col)
    return list;
 }
 
+Eina_Bool
+_edi_language_c_lookup_async(Edi_Editor *editor, unsigned int row, unsigned int col,
+                             Edi_Language_Lookup_Cb cb)
+{
+#if HAVE_LIBCLANG
+   Edi_Language_C_Complete *complete;
+
+   // A newer request makes the previous one useless.
+   editor->suggest_generation++;
+   if (editor->suggest_thread)
+     ecore_thread_cancel(editor->suggest_thread);
+   editor->suggest_thread = NULL;
+
+   if (!editor->clang_unit)
+     return EINA_FALSE;
+
+   complete = _clang_complete_new(editor, row, col);
+   complete->cb = cb;
+   complete->generation = editor->suggest_generation;
+   editor->suggest_thread = ecore_thread_run(_clang_complete_cb, _clang_complete_end_cb,
+                                             _clang_complete_cancel_cb, complete);
+
+   return EINA_TRUE;
+#else
+   (void) editor; (void) row; (void) col; (void) cb;
+
+   return EINA_FALSE;
+#endif
+}
+
 #if HAVE_LIBCLANG
 static void
 _edi_doc_init(Edi_Language_Document *doc)
@@ -469,16 +924,11 @@ _edi_doc_dump(Edi_Language_Document *doc, CXComment comment, Eina_Strbuf *strbuf
 }
 
 static CXCursor
-_edi_doc_cursor_get(Edi_Editor *editor, unsigned int row, unsigned int col)
+_edi_doc_cursor_get(Edi_Editor *editor, const char *path, unsigned int row, unsigned int col)
 {
    CXFile cxfile;
    CXSourceLocation location;
    CXCursor cursor;
-   Elm_Code *code;
-   const char *path;
-
-   code = elm_code_widget_code_get(editor->entry);
-   path = elm_code_file_path_get(code->file);
 
    cxfile = clang_getFile(editor->clang_unit, path);
    location = clang_getLocation(editor->clang_unit, cxfile, row, col);
@@ -486,23 +936,20 @@ _edi_doc_cursor_get(Edi_Editor *editor, unsigned int row, unsigned int col)
 
    return clang_getCursorReferenced(cursor);
 }
-#endif
 
+// The documentation of the symbol at a position, the unit is held by the caller.
 static Edi_Language_Document *
-_edi_language_c_lookup_doc(Edi_Editor *editor, unsigned int row, unsigned int col)
+_edi_doc_get(Edi_Editor *editor, const char *path, unsigned int row, unsigned int col)
 {
-   Edi_Language_Document *doc = NULL;
-#if HAVE_LIBCLANG
+   Edi_Language_Document *doc;
    CXCursor cursor;
    CXComment comment;
 
-   cursor = _edi_doc_cursor_get(editor, row, col);
+   cursor = _edi_doc_cursor_get(editor, path, row, col);
    comment = clang_Cursor_getParsedComment(cursor);
 
    if (clang_Comment_getKind(comment) == CXComment_Null)
-     {
-        return NULL;
-     }
+     return NULL;
 
    doc = malloc(sizeof(Edi_Language_Document));
 
@@ -510,6 +957,29 @@ _edi_language_c_lookup_doc(Edi_Editor *editor, unsigned int row, unsigned int co
    _edi_doc_dump(doc, comment, doc->detail);
    _edi_doc_title_get(cursor, doc->title);
    _edi_doc_trim(doc->detail);
+
+   return doc;
+}
+#endif
+
+static Edi_Language_Document *
+_edi_language_c_lookup_doc(Edi_Editor *editor, unsigned int row, unsigned int col)
+{
+   Edi_Language_Document *doc = NULL;
+#if HAVE_LIBCLANG
+   Elm_Code *code;
+
+   if (!editor->clang_unit || editor->clang_thread)
+     return NULL;
+
+   // The main loop does not wait for whoever uses the unit.
+   if (eina_lock_take_try(&editor->clang_lock) != EINA_LOCK_SUCCEED)
+     return NULL;
+
+   code = elm_code_widget_code_get(editor->entry);
+   if (editor->clang_unit)
+     doc = _edi_doc_get(editor, elm_code_file_path_get(code->file), row, col);
+   eina_lock_release(&editor->clang_lock);
 #else
    (void) editor; (void) row; (void) col;
 #endif
@@ -517,3 +987,308 @@ _edi_language_c_lookup_doc(Edi_Editor *editor, unsigned int row, unsigned int co
    return doc;
 }
 
+#if HAVE_LIBCLANG
+static Edi_Path_Options *
+_edi_language_c_cursor_options_get(CXCursor cursor)
+{
+   Edi_Path_Options *options;
+   CXFile cxfile;
+   CXString path;
+   unsigned int line, col;
+
+   clang_getSpellingLocation(clang_getCursorLocation(cursor), &cxfile, &line, &col, NULL);
+   if (!cxfile)
+     return NULL;
+
+   path = clang_getFileName(cxfile);
+   options = calloc(1, sizeof(Edi_Path_Options));
+   options->path = eina_stringshare_add(clang_getCString(path));
+   options->line = line;
+   options->character = col;
+   clang_disposeString(path);
+
+   return options;
+}
+
+// Where the symbol at a position is defined, the unit is held by the caller.
+static Edi_Path_Options *
+_edi_language_c_definition_get(Edi_Editor *editor, const char *path, unsigned int row, unsigned int col)
+{
+   Edi_Path_Options *options = NULL;
+   Edi_Symbol_Location *location;
+   Eina_List *locations;
+   CXCursor cursor, definition;
+   CXString usr;
+
+   cursor = _edi_doc_cursor_get(editor, path, row, col);
+   if (clang_Cursor_isNull(cursor))
+     return NULL;
+
+   definition = clang_getCursorDefinition(cursor);
+   if (!clang_Cursor_isNull(definition))
+     options = _edi_language_c_cursor_options_get(definition);
+
+   // Defined in another file of the project, which the symbol index knows.
+   if (!options)
+     {
+        usr = clang_getCursorUSR(cursor);
+        locations = edi_symbol_index_locations_get(clang_getCString(usr), EDI_SYMBOL_DEFINITION);
+        clang_disposeString(usr);
+
+        location = eina_list_data_get(locations);
+        if (location)
+          {
+             options = calloc(1, sizeof(Edi_Path_Options));
+             options->path = eina_stringshare_ref(location->path);
+             options->line = location->line;
+             options->character = location->column;
+          }
+
+        EINA_LIST_FREE(locations, location)
+          edi_symbol_location_free(location);
+     }
+
+   if (!options)
+     options = _edi_language_c_cursor_options_get(cursor);
+
+   return options;
+}
+#endif
+
+static Edi_Path_Options *
+_edi_language_c_lookup_definition(Edi_Editor *editor, unsigned int row, unsigned int col)
+{
+   Edi_Path_Options *options = NULL;
+#if HAVE_LIBCLANG
+   Elm_Code *code;
+
+   if (!editor->clang_unit || editor->clang_thread)
+     return NULL;
+
+   // The main loop does not wait for whoever uses the unit.
+   if (eina_lock_take_try(&editor->clang_lock) != EINA_LOCK_SUCCEED)
+     return NULL;
+
+   code = elm_code_widget_code_get(editor->entry);
+   if (editor->clang_unit)
+     options = _edi_language_c_definition_get(editor, elm_code_file_path_get(code->file), row, col);
+   eina_lock_release(&editor->clang_lock);
+#else
+   (void) editor; (void) row; (void) col;
+#endif
+
+   return options;
+}
+
+#if HAVE_LIBCLANG
+/*
+ * A documentation or definition lookup, run on a thread as it waits for
+ * whoever uses the translation unit. A newer lookup cancels it.
+ */
+typedef struct
+{
+   Edi_Editor *editor;
+   char *path;
+   unsigned int row, col;
+
+   Edi_Language_Doc_Cb doc_cb;
+   Edi_Language_Definition_Cb definition_cb;
+   Edi_Language_Document *doc;
+   Edi_Path_Options *options;
+} Edi_Language_C_Lookup;
+
+static void
+_clang_lookup_cb(void *data, Ecore_Thread *thread)
+{
+   Edi_Language_C_Lookup *lookup = data;
+   Edi_Editor *editor = lookup->editor;
+
+   eina_lock_take(&editor->clang_lock);
+   if (editor->clang_unit && !ecore_thread_check(thread))
+     {
+        if (lookup->doc_cb)
+          lookup->doc = _edi_doc_get(editor, lookup->path, lookup->row, lookup->col);
+        else
+          lookup->options = _edi_language_c_definition_get(editor, lookup->path,
+                                                           lookup->row, lookup->col);
+     }
+   eina_lock_release(&editor->clang_lock);
+}
+
+static void
+_clang_lookup_end_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Language_C_Lookup *lookup = data;
+   Edi_Editor *editor = lookup->editor;
+
+   editor->lookup_thread = NULL;
+   edi_editor_clang_unit_swap(editor);
+
+   if (lookup->doc_cb)
+     lookup->doc_cb(editor, lookup->doc);
+   else
+     lookup->definition_cb(editor, lookup->options);
+
+   free(lookup->path);
+   free(lookup);
+}
+
+static void
+_clang_lookup_cancel_cb(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Edi_Language_C_Lookup *lookup = data;
+
+   edi_editor_clang_unit_swap(lookup->editor);
+
+   if (lookup->doc)
+     edi_language_doc_free(lookup->doc);
+   if (lookup->options)
+     {
+        eina_stringshare_del(lookup->options->path);
+        free(lookup->options);
+     }
+   free(lookup->path);
+   free(lookup);
+}
+
+static Eina_Bool
+_clang_lookup_start(Edi_Editor *editor, unsigned int row, unsigned int col,
+                    Edi_Language_Doc_Cb doc_cb, Edi_Language_Definition_Cb definition_cb)
+{
+   Edi_Language_C_Lookup *lookup;
+   Elm_Code *code;
+
+   if (editor->lookup_thread)
+     ecore_thread_cancel(editor->lookup_thread);
+   editor->lookup_thread = NULL;
+
+   code = elm_code_widget_code_get(editor->entry);
+   if (!editor->clang_unit || editor->clang_thread || !elm_code_file_path_get(code->file))
+     return EINA_FALSE;
+
+   lookup = calloc(1, sizeof(Edi_Language_C_Lookup));
+   lookup->editor = editor;
+   lookup->path = strdup(elm_code_file_path_get(code->file));
+   lookup->row = row;
+   lookup->col = col;
+   lookup->doc_cb = doc_cb;
+   lookup->definition_cb = definition_cb;
+
+   editor->lookup_thread = ecore_thread_run(_clang_lookup_cb, _clang_lookup_end_cb,
+                                            _clang_lookup_cancel_cb, lookup);
+
+   return EINA_TRUE;
+}
+#endif
+
+Eina_Bool
+_edi_language_c_lookup_doc_async(Edi_Editor *editor, unsigned int row, unsigned int col,
+                                 Edi_Language_Doc_Cb cb)
+{
+#if HAVE_LIBCLANG
+   return _clang_lookup_start(editor, row, col, cb, NULL);
+#else
+   (void) editor; (void) row; (void) col; (void) cb;
+
+   return EINA_FALSE;
+#endif
+}
+
+Eina_Bool
+_edi_language_c_lookup_definition_async(Edi_Editor *editor, unsigned int row, unsigned int col,
+                                        Edi_Language_Definition_Cb cb)
+{
+#if HAVE_LIBCLANG
+   return _clang_lookup_start(editor, row, col, NULL, cb);
+#else
+   (void) editor; (void) row; (void) col; (void) cb;
+
+   return EINA_FALSE;
+#endif
+}
+
+#if HAVE_LIBCLANG
+CXIndex
+edi_language_c_index_get(void)
+{
+   _clang_init();
+
+   return _clang_index;
+}
+
+char **
+edi_language_c_args_get(const char *path, unsigned int *argc)
+{
+   Edi_Language_C_Args *args;
+   char **list;
+
+   args = _clang_commands_get(path);
+   list = args->args;
+   *argc = args->argc;
+   free(args);
+
+   return list;
+}
+
+void
+edi_language_c_args_free(char **args)
+{
+   char **arg;
+
+   for (arg = args; *arg; arg++)
+     free(*arg);
+   free(args);
+}
+
+Eina_List *
+edi_language_c_files_get(void)
+{
+   CXCompileCommands commands;
+   CXCompileCommand command;
+   CXString directory, filename;
+   Eina_List *files = NULL;
+   const char *name;
+   char *path, *relative;
+   unsigned int i, count;
+
+   eina_lock_take(&_clang_database_lock);
+   _clang_database_update();
+
+   if (!_clang_database.database)
+     {
+        eina_lock_release(&_clang_database_lock);
+        return NULL;
+     }
+
+   commands = clang_CompilationDatabase_getAllCompileCommands(_clang_database.database);
+   count = clang_CompileCommands_getSize(commands);
+   for (i = 0; i < count; i++)
+     {
+        command = clang_CompileCommands_getCommand(commands, i);
+        directory = clang_CompileCommand_getDirectory(command);
+        filename = clang_CompileCommand_getFilename(command);
+
+        name = clang_getCString(filename);
+
+        path = NULL;
+        if (name && name[0] == '/')
+          path = eina_file_path_sanitize(name);
+        else if (name && *name && clang_getCString(directory))
+          {
+             relative = edi_path_append(clang_getCString(directory), name);
+             path = eina_file_path_sanitize(relative);
+             free(relative);
+          }
+        if (path)
+          files = eina_list_append(files, path);
+
+        clang_disposeString(directory);
+        clang_disposeString(filename);
+     }
+   clang_CompileCommands_dispose(commands);
+
+   eina_lock_release(&_clang_database_lock);
+
+   return files;
+}
+#endif
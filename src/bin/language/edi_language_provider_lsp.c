@@ -0,0 +1,656 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <Elementary.h>
+#include <Ecore_File.h>
+
+#include "edi_language_provider.h"
+#include "edi_lsp.h"
+
+#include "edi_private.h"
+
+/*
+ * The languages without a library to parse them are handled by a language
+ * server, one for each language started when a file of it is first opened.
+ * A server that exits is started again the next time it is needed.
+ */
+
+// How many times a server that exited is started again before giving up on it.
+#define EDI_LANGUAGE_LSP_RESTARTS_MAX 3
+
+typedef struct
+{
+   const char *language;
+   const char *command;
+   Edi_Lsp_Client *client;
+   Eina_Bool failed; /**< The server could not be started, it is not tried again */
+   unsigned int restarts;
+   Eina_List *documents;
+} Edi_Language_Lsp_Server;
+
+// A file open in an editor, as the server knows it.
+typedef struct
+{
+   Edi_Editor *editor;
+   Edi_Language_Lsp_Server *server;
+   char *path, *uri;
+   int version;
+   unsigned int serial; /**< The version of the editor the server was last given */
+
+   unsigned int complete_id, doc_id; /**< The requests waiting for an answer */
+   Edi_Language_Lookup_Cb complete_cb;
+   Edi_Language_Doc_Cb doc_cb;
+} Edi_Language_Lsp_Document;
+
+static Edi_Language_Lsp_Server _edi_language_lsp_servers[] =
+{
+   { "rust", "rust-analyzer", NULL, EINA_FALSE, 0, NULL },
+   { "go", "gopls", NULL, EINA_FALSE, 0, NULL },
+   { "python", "pylsp", NULL, EINA_FALSE, 0, NULL },
+   { NULL, NULL, NULL, EINA_FALSE, 0, NULL }
+};
+
+static Edi_Language_Lsp_Document *
+_edi_language_lsp_document_get(Edi_Editor *editor)
+{
+   Edi_Language_Lsp_Server *server;
+   Edi_Language_Lsp_Document *document;
+   Eina_List *l;
+
+   for (server = _edi_language_lsp_servers; server->language; server++)
+     {
+        EINA_LIST_FOREACH(server->documents, l, document)
+          {
+             if (document->editor == editor)
+               return document;
+          }
+     }
+
+   return NULL;
+}
+
+static void
+_edi_language_lsp_diagnostics_show(Edi_Language_Lsp_Server *server, const Edi_Lsp_Json *params)
+{
+   Edi_Language_Lsp_Document *document;
+   const Edi_Lsp_Json *diagnostics, *item;
+   Edi_Editor_Diagnostic diagnostic;
+   Eina_Inarray *shown;
+   Eina_List *l, *ll;
+   const char *uri, *message;
+   char *path;
+
+   uri = edi_lsp_json_string_get(params, "uri");
+   diagnostics = edi_lsp_json_get(params, "diagnostics");
+   if (!uri || !diagnostics || diagnostics->type != EDI_LSP_JSON_ARRAY)
+     return;
+
+   path = edi_lsp_uri_path_get(uri);
+   if (!path)
+     return;
+
+   EINA_LIST_FOREACH(server->documents, l, document)
+     {
+        if (strcmp(document->path, path))
+          continue;
+
+        shown = eina_inarray_new(sizeof(Edi_Editor_Diagnostic), 16);
+        EINA_LIST_FOREACH(diagnostics->value.children, ll, item)
+          {
+             switch ((int) edi_lsp_json_number_get(item, "severity", 1))
+               {
+                case 2:
+                   diagnostic.status = ELM_CODE_STATUS_TYPE_WARNING;
+                   break;
+                case 3:
+                case 4:
+                   diagnostic.status = ELM_CODE_STATUS_TYPE_NOTE;
+                   break;
+                default:
+                   diagnostic.status = ELM_CODE_STATUS_TYPE_ERROR;
+               }
+
+             message = edi_lsp_json_string_get(item, "message");
+             diagnostic.line = edi_lsp_json_number_get(item, "range.start.line", 0) + 1;
+             diagnostic.text = message ? strdup(message) : NULL;
+             eina_inarray_push(shown, &diagnostic);
+          }
+
+        edi_editor_diagnostics_set(document->editor, shown);
+     }
+
+   free(path);
+}
+
+static void
+_edi_language_lsp_notification_cb(void *data, Edi_Lsp_Client *client EINA_UNUSED,
+                                  const char *method, const Edi_Lsp_Json *params)
+{
+   Edi_Language_Lsp_Server *server = data;
+
+   if (!strcmp(method, "textDocument/publishDiagnostics"))
+     _edi_language_lsp_diagnostics_show(server, params);
+   else if (!strcmp(method, "window/showMessage"))
+     INF("%s: %s", server->command, edi_lsp_json_string_get(params, "message"));
+   else if (!strcmp(method, "window/logMessage"))
+     DBG("%s: %s", server->command, edi_lsp_json_string_get(params, "message"));
+}
+
+// Start the server unless it is running, the files open are then given to it again.
+static Eina_Bool
+_edi_language_lsp_server_start(Edi_Language_Lsp_Server *server)
+{
+   Edi_Language_Lsp_Document *document;
+   Eina_List *l;
+
+   if (server->client && edi_lsp_client_running_get(server->client))
+     return EINA_TRUE;
+   if (server->failed)
+     return EINA_FALSE;
+
+   if (server->client)
+     {
+        edi_lsp_client_free(server->client);
+        server->client = NULL;
+
+        if (++server->restarts > EDI_LANGUAGE_LSP_RESTARTS_MAX)
+          {
+             WRN("Language server %s keeps exiting, not starting it again", server->command);
+             server->failed = EINA_TRUE;
+             return EINA_FALSE;
+          }
+     }
+
+   if (ecore_file_app_installed(server->command))
+     server->client = edi_lsp_client_new(server->command, edi_project_get(),
+                                          _edi_language_lsp_notification_cb, server);
+   else
+     INF("Install %s for code completion of %s files", server->command, server->language);
+
+   server->failed = !server->client;
+   if (server->failed)
+     return EINA_FALSE;
+
+   // The requests of the server that exited were answered when it did.
+   EINA_LIST_FOREACH(server->documents, l, document)
+     {
+        document->version = 0;
+        document->complete_id = document->doc_id = 0;
+     }
+
+   return EINA_TRUE;
+}
+
+static Edi_Language_Lsp_Server *
+_edi_language_lsp_server_get(const char *language)
+{
+   Edi_Language_Lsp_Server *server;
+
+   for (server = _edi_language_lsp_servers; server->language; server++)
+     {
+        if (strcmp(server->language, language))
+          continue;
+
+        return _edi_language_lsp_server_start(server) ? server : NULL;
+     }
+
+   return NULL;
+}
+
+// Ask the servers to shut down, they are not started again.
+static void
+_edi_language_lsp_shutdown(void)
+{
+   Edi_Language_Lsp_Server *server;
+
+   for (server = _edi_language_lsp_servers; server->language; server++)
+     {
+        edi_lsp_client_free(server->client);
+        server->client = NULL;
+        server->failed = EINA_TRUE;
+     }
+
+   edi_lsp_shutdown();
+}
+
+// Lines of the file as they are in the editor, each followed by a newline.
+static void
+_edi_language_lsp_lines_append(Eina_Strbuf *buf, Edi_Editor *editor,
+                               unsigned int first, unsigned int count)
+{
+   Elm_Code *code;
+   Elm_Code_Line *line;
+   const char *content;
+   unsigned int number, size;
+
+   code = elm_code_widget_code_get(editor->entry);
+   for (number = first; number < first + count; number++)
+     {
+        line = elm_code_file_line_get(code->file, number);
+        if (!line)
+          break;
+
+        content = elm_code_line_text_get(line, &size);
+        if (content)
+          eina_strbuf_append_length(buf, content, size);
+        eina_strbuf_append_char(buf, '\n');
+     }
+}
+
+static void
+_edi_language_lsp_text_append(Eina_Strbuf *params, Edi_Editor *editor,
+                              unsigned int first, unsigned int count)
+{
+   Eina_Strbuf *text;
+
+   text = eina_strbuf_new();
+   _edi_language_lsp_lines_append(text, editor, first, count);
+   edi_lsp_json_string_append(params, eina_strbuf_string_get(text));
+   eina_strbuf_free(text);
+}
+
+// Give the server the changes made to the file since it was last given it,
+// only the lines changed if it takes those.
+static void
+_edi_language_lsp_sync(Edi_Language_Lsp_Document *document)
+{
+   Edi_Editor *editor = document->editor;
+   Edi_Editor_Edit edit;
+   Eina_Strbuf *params;
+   Elm_Code *code;
+   unsigned int lines;
+   Eina_Bool known;
+
+   known = edi_editor_edits_get(editor, &document->serial, &edit);
+   if (document->version && known && !edit.first)
+     return;
+
+   // Servers that take no changes are only given the file as it is opened.
+   if (document->version &&
+       edi_lsp_client_text_sync_get(document->server->client) == EDI_LSP_TEXT_SYNC_NONE)
+     return;
+
+   document->version++;
+   code = elm_code_widget_code_get(editor->entry);
+   lines = elm_code_file_lines_get(code->file);
+
+   params = eina_strbuf_new();
+   eina_strbuf_append(params, "{\"textDocument\":{\"uri\":");
+   edi_lsp_json_string_append(params, document->uri);
+   eina_strbuf_append_printf(params, ",\"version\":%d", document->version);
+   if (document->version == 1)
+     {
+        eina_strbuf_append(params, ",\"languageId\":");
+        edi_lsp_json_string_append(params, document->server->language);
+        eina_strbuf_append(params, ",\"text\":");
+        _edi_language_lsp_text_append(params, editor, 1, lines);
+        eina_strbuf_append(params, "}}");
+        edi_lsp_client_notify(document->server->client, "textDocument/didOpen",
+                              eina_strbuf_string_get(params));
+     }
+   else
+     {
+        eina_strbuf_append(params, "},\"contentChanges\":[{");
+        if (known && edi_lsp_client_text_sync_get(document->server->client) == EDI_LSP_TEXT_SYNC_INCREMENTAL)
+          {
+             // Whole lines are replaced, the range ends at the start of the line after them.
+             eina_strbuf_append_printf(params, "\"range\":{\"start\":{\"line\":%u,\"character\":0},"
+                                               "\"end\":{\"line\":%u,\"character\":0}},\"text\":",
+                                       edit.first - 1, edit.first - 1 + edit.removed);
+             _edi_language_lsp_text_append(params, editor, edit.first, edit.added);
+          }
+        else
+          {
+             eina_strbuf_append(params, "\"text\":");
+             _edi_language_lsp_text_append(params, editor, 1, lines);
+          }
+        eina_strbuf_append(params, "}]}");
+        edi_lsp_client_notify(document->server->client, "textDocument/didChange",
+                              eina_strbuf_string_get(params));
+     }
+
+   eina_strbuf_free(params);
+}
+
+// Positions are counted in UTF-16 code units by the servers, not columns.
+static Eina_Strbuf *
+_edi_language_lsp_position_params_get(Edi_Language_Lsp_Document *document,
+                                      unsigned int row, unsigned int col)
+{
+   Elm_Code *code;
+   Elm_Code_Line *line;
+   Eina_Strbuf *params;
+   const char *text;
+   unsigned int i, length, offset, character = 0;
+
+   code = elm_code_widget_code_get(document->editor->entry);
+   line = elm_code_file_line_get(code->file, row);
+   if (line)
+     {
+        text = elm_code_line_text_get(line, &length);
+        offset = elm_code_widget_line_text_position_for_column_get(document->editor->entry, line, col);
+        if (!text || offset > length)
+          offset = text ? length : 0;
+
+        for (i = 0; i < offset; i++)
+          {
+             if ((text[i] & 0xC0) != 0x80)
+               character++;
+             // Beyond the first plane it takes two.
+             if ((text[i] & 0xF8) == 0xF0)
+               character++;
+          }
+     }
+
+   params = eina_strbuf_new();
+   eina_strbuf_append(params, "{\"textDocument\":{\"uri\":");
+   edi_lsp_json_string_append(params, document->uri);
+   eina_strbuf_append_printf(params, "},\"position\":{\"line\":%u,\"character\":%u}}",
+                             row ? row - 1 : 0, character);
+
+   return params;
+}
+
+static char *
+_edi_language_lsp_complete_detail_get(Edi_Editor *editor, const char *label, const char *detail)
+{
+   Eina_Strbuf *buf;
+   const char *font;
+   char *markup;
+   int font_size;
+
+   elm_code_widget_font_get(editor->entry, &font, &font_size);
+
+   buf = eina_strbuf_new();
+   eina_strbuf_append_printf(buf, "<align=left><font='%s'><font_size=%d>", font, font_size);
+   if (detail)
+     {
+        markup = evas_textblock_text_utf8_to_markup(NULL, detail);
+        eina_strbuf_append(buf, markup);
+        free(markup);
+     }
+   markup = evas_textblock_text_utf8_to_markup(NULL, label);
+   eina_strbuf_append_printf(buf, "<br><b>%s</b></font_size></font></align>", markup);
+   free(markup);
+
+   return eina_strbuf_string_steal(buf);
+}
+
+static void
+_edi_language_lsp_complete_cb(void *data, Edi_Lsp_Client *client EINA_UNUSED,
+                              const Edi_Lsp_Json *result, const Edi_Lsp_Json *error EINA_UNUSED)
+{
+   Edi_Language_Lsp_Document *document = data;
+   Edi_Language_Suggest_Item *suggest_it;
+   const Edi_Lsp_Json *items, *item;
+   const char *label;
+   Eina_List *l, *list = NULL;
+
+   document->complete_id = 0;
+
+   // The result is the items or a list of them.
+   items = result;
+   if (items && items->type == EDI_LSP_JSON_OBJECT)
+     items = edi_lsp_json_get(items, "items");
+
+   if (items && items->type == EDI_LSP_JSON_ARRAY)
+     {
+        EINA_LIST_FOREACH(items->value.children, l, item)
+          {
+             label = edi_lsp_json_string_get(item, "insertText");
+             if (!label)
+               label = edi_lsp_json_string_get(item, "label");
+             if (!label)
+               continue;
+
+             suggest_it = calloc(1, sizeof(Edi_Language_Suggest_Item));
+             suggest_it->summary = strdup(label);
+             suggest_it->detail = _edi_language_lsp_complete_detail_get(document->editor,
+                edi_lsp_json_string_get(item, "label"), edi_lsp_json_string_get(item, "detail"));
+             list = eina_list_append(list, suggest_it);
+          }
+     }
+
+   document->complete_cb(document->editor, list);
+}
+
+Eina_Bool
+_edi_language_lsp_lookup_async(Edi_Editor *editor, unsigned int row, unsigned int col,
+                               Edi_Language_Lookup_Cb cb)
+{
+   Edi_Language_Lsp_Document *document;
+   Eina_Strbuf *params;
+
+   document = _edi_language_lsp_document_get(editor);
+   if (!document || !_edi_language_lsp_server_start(document->server))
+     return EINA_FALSE;
+
+   // A newer request makes the previous one useless.
+   if (document->complete_id)
+     edi_lsp_client_cancel(document->server->client, document->complete_id);
+
+   _edi_language_lsp_sync(document);
+
+   params = _edi_language_lsp_position_params_get(document, row, col);
+   document->complete_cb = cb;
+   document->complete_id = edi_lsp_client_request(document->server->client, "textDocument/completion",
+                                                  eina_strbuf_string_get(params),
+                                                  _edi_language_lsp_complete_cb, document);
+   eina_strbuf_free(params);
+
+   return !!document->complete_id;
+}
+
+// Hover contents are a string, a marked string, markup content or a list of them.
+static void
+_edi_language_lsp_hover_text_append(Eina_Strbuf *text, const Edi_Lsp_Json *contents)
+{
+   const Edi_Lsp_Json *item;
+   const char *value;
+   Eina_List *l;
+
+   if (!contents)
+     return;
+
+   if (contents->type == EDI_LSP_JSON_ARRAY)
+     {
+        EINA_LIST_FOREACH(contents->value.children, l, item)
+          _edi_language_lsp_hover_text_append(text, item);
+        return;
+     }
+
+   if (contents->type == EDI_LSP_JSON_STRING)
+     value = contents->value.string;
+   else
+     value = edi_lsp_json_string_get(contents, "value");
+   if (!value || !*value)
+     return;
+
+   if (eina_strbuf_length_get(text))
+     eina_strbuf_append(text, "\n\n");
+
+   // Code given with its language is shown as the title, like markdown code blocks.
+   if (edi_lsp_json_string_get(contents, "language"))
+     eina_strbuf_append_printf(text, "```\n%s\n```", value);
+   else
+     eina_strbuf_append(text, value);
+}
+
+static void
+_edi_language_lsp_doc_markup_append(Eina_Strbuf *buf, const char *text, size_t length)
+{
+   char *plain, *markup;
+
+   plain = strndup(text, length);
+   markup = evas_textblock_text_utf8_to_markup(NULL, plain);
+   eina_strbuf_append(buf, markup);
+   free(markup);
+   free(plain);
+}
+
+static Edi_Language_Document *
+_edi_language_lsp_doc_get(const char *text)
+{
+   Edi_Language_Document *doc;
+   const char *line, *end;
+   Eina_Bool code = EINA_FALSE, titled = EINA_FALSE;
+   Eina_Strbuf *buf;
+
+   doc = calloc(1, sizeof(Edi_Language_Document));
+   doc->title = eina_strbuf_new();
+   doc->detail = eina_strbuf_new();
+   doc->param = eina_strbuf_new();
+   doc->ret = eina_strbuf_new();
+   doc->see = eina_strbuf_new();
+
+   // The first block of code is the title, the rest without the fences is the detail.
+   for (line = text; *line; line = *end ? end + 1 : end)
+     {
+        end = strchr(line, '\n');
+        if (!end)
+          end = line + strlen(line);
+
+        if (!strncmp(line, "```", 3))
+          {
+             if (code)
+               titled = EINA_TRUE;
+             code = !code;
+             continue;
+          }
+
+        buf = code && !titled ? doc->title : doc->detail;
+        if (eina_strbuf_length_get(buf))
+          eina_strbuf_append(buf, "<br>");
+        _edi_language_lsp_doc_markup_append(buf, line, end - line);
+     }
+
+   return doc;
+}
+
+static void
+_edi_language_lsp_doc_cb(void *data, Edi_Lsp_Client *client EINA_UNUSED,
+                         const Edi_Lsp_Json *result, const Edi_Lsp_Json *error EINA_UNUSED)
+{
+   Edi_Language_Lsp_Document *document = data;
+   Edi_Language_Document *doc = NULL;
+   Eina_Strbuf *text;
+
+   document->doc_id = 0;
+
+   text = eina_strbuf_new();
+   _edi_language_lsp_hover_text_append(text, edi_lsp_json_get(result, "contents"));
+   if (eina_strbuf_length_get(text))
+     doc = _edi_language_lsp_doc_get(eina_strbuf_string_get(text));
+   eina_strbuf_free(text);
+
+   document->doc_cb(document->editor, doc);
+}
+
+Eina_Bool
+_edi_language_lsp_lookup_doc_async(Edi_Editor *editor, unsigned int row, unsigned int col,
+                                   Edi_Language_Doc_Cb cb)
+{
+   Edi_Language_Lsp_Document *document;
+   Eina_Strbuf *params;
+
+   document = _edi_language_lsp_document_get(editor);
+   if (!document || !_edi_language_lsp_server_start(document->server))
+     return EINA_FALSE;
+
+   if (document->doc_id)
+     edi_lsp_client_cancel(document->server->client, document->doc_id);
+
+   _edi_language_lsp_sync(document);
+
+   params = _edi_language_lsp_position_params_get(document, row, col);
+   document->doc_cb = cb;
+   document->doc_id = edi_lsp_client_request(document->server->client, "textDocument/hover",
+                                             eina_strbuf_string_get(params),
+                                             _edi_language_lsp_doc_cb, document);
+   eina_strbuf_free(params);
+
+   return !!document->doc_id;
+}
+
+static void
+_edi_language_lsp_add(Edi_Editor *editor, const char *language)
+{
+   Edi_Language_Lsp_Server *server;
+   Edi_Language_Lsp_Document *document;
+   Elm_Code *code;
+
+   // Files not saved yet have no URI.
+   code = elm_code_widget_code_get(editor->entry);
+   if (!code->file->file)
+     return;
+
+   server = _edi_language_lsp_server_get(language);
+   if (!server)
+     return;
+
+   document = calloc(1, sizeof(Edi_Language_Lsp_Document));
+   document->editor = editor;
+   document->server = server;
+   document->path = strdup(elm_code_file_path_get(code->file));
+   document->uri = edi_lsp_uri_from_path(document->path);
+   server->documents = eina_list_append(server->documents, document);
+
+   _edi_language_lsp_sync(document);
+}
+
+static void
+_edi_language_lsp_refresh(Edi_Editor *editor)
+{
+   Edi_Language_Lsp_Document *document;
+   Eina_Strbuf *params;
+
+   document = _edi_language_lsp_document_get(editor);
+   if (!document || !_edi_language_lsp_server_start(document->server))
+     return;
+
+   // Servers check the files again once they are saved.
+   _edi_language_lsp_sync(document);
+
+   params = eina_strbuf_new();
+   eina_strbuf_append(params, "{\"textDocument\":{\"uri\":");
+   edi_lsp_json_string_append(params, document->uri);
+   eina_strbuf_append(params, "}}");
+   edi_lsp_client_notify(document->server->client, "textDocument/didSave",
+                         eina_strbuf_string_get(params));
+   eina_strbuf_free(params);
+}
+
+static void
+_edi_language_lsp_del(Edi_Editor *editor)
+{
+   Edi_Language_Lsp_Document *document;
+   Edi_Language_Lsp_Server *server;
+   Eina_Strbuf *params;
+
+   document = _edi_language_lsp_document_get(editor);
+   if (!document)
+     return;
+
+   // The server may have exited, or been shut down already.
+   server = document->server;
+   if (server->client && edi_lsp_client_running_get(server->client))
+     {
+        if (document->complete_id)
+          edi_lsp_client_cancel(server->client, document->complete_id);
+        if (document->doc_id)
+          edi_lsp_client_cancel(server->client, document->doc_id);
+
+        params = eina_strbuf_new();
+        eina_strbuf_append(params, "{\"textDocument\":{\"uri\":");
+        edi_lsp_json_string_append(params, document->uri);
+        eina_strbuf_append(params, "}}");
+        edi_lsp_client_notify(server->client, "textDocument/didClose", eina_strbuf_string_get(params));
+        eina_strbuf_free(params);
+     }
+
+   server->documents = eina_list_remove(server->documents, document);
+   free(document->path);
+   free(document->uri);
+   free(document);
+}
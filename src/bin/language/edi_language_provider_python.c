@@ -11,18 +11,21 @@
 #include "edi_private.h"
 
 void
-_edi_language_python_add(Edi_Editor *editor EINA_UNUSED)
+_edi_language_python_add(Edi_Editor *editor)
 {
+   _edi_language_lsp_add(editor, "python");
 }
 
 void
-_edi_language_python_refresh(Edi_Editor *editor EINA_UNUSED)
+_edi_language_python_refresh(Edi_Editor *editor)
 {
+   _edi_language_lsp_refresh(editor);
 }
 
 void
-_edi_language_python_del(Edi_Editor *editor EINA_UNUSED)
+_edi_language_python_del(Edi_Editor *editor)
 {
+   _edi_language_lsp_del(editor);
 }
 
 const char *
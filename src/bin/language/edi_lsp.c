@@ -0,0 +1,1286 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <unistd.h>
+
+#include <Eina.h>
+#include <Ecore.h>
+
+#include "edi_lsp.h"
+
+#include "edi_private.h"
+
+// Deeper values are not valid, it keeps the parser off the end of the stack.
+#define EDI_LSP_JSON_DEPTH_MAX 256
+// How long a server asked to shut down has to exit before it is stopped.
+#define EDI_LSP_SHUTDOWN_TIMEOUT 2.0
+
+struct _Edi_Lsp_Parser
+{
+   Eina_Binbuf *buffer;
+   size_t length; /**< The length of the content of the message read, 0 while its header is */
+};
+
+typedef struct
+{
+   unsigned int id;
+   const char *method;
+   Edi_Lsp_Response_Cb cb;
+   void *data;
+   double start;
+} Edi_Lsp_Request;
+
+// A message waiting for the server to be initialized, id is 0 for notifications.
+typedef struct
+{
+   unsigned int id;
+   char *text;
+} Edi_Lsp_Message;
+
+struct _Edi_Lsp_Client
+{
+   Ecore_Exe *exe;
+   Edi_Lsp_Parser *parser;
+   char *command;
+
+   Eina_Bool initialized;
+   Edi_Lsp_Text_Sync text_sync;
+   Eina_List *queue;
+   Eina_Hash *requests;
+   Eina_Hash *latencies;
+   unsigned int next_id;
+
+   Edi_Lsp_Notification_Cb cb;
+   void *data;
+
+   int walking;
+   Eina_Bool closing; /**< Shutting down, or could not initialize: nothing more is sent */
+   Eina_Bool deleted; /**< Freed, it goes once the server exited */
+   Ecore_Timer *shutdown_timer;
+};
+
+typedef struct
+{
+   const char *text, *end;
+   int depth;
+} Edi_Lsp_Json_Reader;
+
+static Eina_List *_edi_lsp_clients = NULL;
+static Ecore_Event_Handler *_edi_lsp_data_handler = NULL;
+static Ecore_Event_Handler *_edi_lsp_error_handler = NULL;
+static Ecore_Event_Handler *_edi_lsp_del_handler = NULL;
+
+static Edi_Lsp_Json *_edi_lsp_json_value_read(Edi_Lsp_Json_Reader *reader);
+static Eina_Bool _edi_lsp_client_data_cb(void *data, int type, void *event);
+static Eina_Bool _edi_lsp_client_error_cb(void *data, int type, void *event);
+static Eina_Bool _edi_lsp_client_del_cb(void *data, int type, void *event);
+
+static void
+_edi_lsp_json_space_skip(Edi_Lsp_Json_Reader *reader)
+{
+   while (reader->text < reader->end &&
+          (*reader->text == ' ' || *reader->text == '\t' ||
+           *reader->text == '\n' || *reader->text == '\r'))
+     reader->text++;
+}
+
+static Eina_Bool
+_edi_lsp_json_literal_read(Edi_Lsp_Json_Reader *reader, const char *literal)
+{
+   size_t length = strlen(literal);
+
+   if ((size_t) (reader->end - reader->text) < length ||
+       strncmp(reader->text, literal, length))
+     return EINA_FALSE;
+
+   reader->text += length;
+   return EINA_TRUE;
+}
+
+static int
+_edi_lsp_json_hex_read(Edi_Lsp_Json_Reader *reader)
+{
+   int i, digit, value = 0;
+
+   if (reader->end - reader->text < 4)
+     return -1;
+
+   for (i = 0; i < 4; i++)
+     {
+        char c = *reader->text++;
+
+        if (c >= '0' && c <= '9')
+          digit = c - '0';
+        else if (c >= 'a' && c <= 'f')
+          digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+          digit = c - 'A' + 10;
+        else
+          return -1;
+
+        value = value * 16 + digit;
+     }
+
+   return value;
+}
+
+static void
+_edi_lsp_utf8_append(Eina_Strbuf *buf, unsigned int code)
+{
+   char utf8[4];
+
+   if (code < 0x80)
+     {
+        eina_strbuf_append_char(buf, code);
+        return;
+     }
+
+   if (code < 0x800)
+     {
+        utf8[0] = 0xC0 | (code >> 6);
+        utf8[1] = 0x80 | (code & 0x3F);
+        eina_strbuf_append_length(buf, utf8, 2);
+     }
+   else if (code < 0x10000)
+     {
+        utf8[0] = 0xE0 | (code >> 12);
+        utf8[1] = 0x80 | ((code >> 6) & 0x3F);
+        utf8[2] = 0x80 | (code & 0x3F);
+        eina_strbuf_append_length(buf, utf8, 3);
+     }
+   else
+     {
+        utf8[0] = 0xF0 | (code >> 18);
+        utf8[1] = 0x80 | ((code >> 12) & 0x3F);
+        utf8[2] = 0x80 | ((code >> 6) & 0x3F);
+        utf8[3] = 0x80 | (code & 0x3F);
+        eina_strbuf_append_length(buf, utf8, 4);
+     }
+}
+
+static char *
+_edi_lsp_json_string_read(Edi_Lsp_Json_Reader *reader)
+{
+   Eina_Strbuf *buf;
+   const char *start;
+   int code, low;
+
+   if (reader->text >= reader->end || *reader->text != '"')
+     return NULL;
+   reader->text++;
+
+   buf = eina_strbuf_new();
+   while (reader->text < reader->end && *reader->text != '"')
+     {
+        // Copy the runs without escapes at once.
+        start = reader->text;
+        while (reader->text < reader->end && *reader->text != '"' && *reader->text != '\\')
+          reader->text++;
+        eina_strbuf_append_length(buf, start, reader->text - start);
+
+        if (reader->text >= reader->end || *reader->text == '"')
+          break;
+
+        reader->text++;
+        if (reader->text >= reader->end)
+          break;
+
+        switch (*reader->text++)
+          {
+           case '"': eina_strbuf_append_char(buf, '"'); break;
+           case '\\': eina_strbuf_append_char(buf, '\\'); break;
+           case '/': eina_strbuf_append_char(buf, '/'); break;
+           case 'b': eina_strbuf_append_char(buf, '\b'); break;
+           case 'f': eina_strbuf_append_char(buf, '\f'); break;
+           case 'n': eina_strbuf_append_char(buf, '\n'); break;
+           case 'r': eina_strbuf_append_char(buf, '\r'); break;
+           case 't': eina_strbuf_append_char(buf, '\t'); break;
+           case 'u':
+              code = _edi_lsp_json_hex_read(reader);
+              if (code < 0)
+                goto error;
+
+              // Characters beyond the first plane come as a pair of surrogates.
+              if (code >= 0xD800 && code <= 0xDBFF &&
+                  _edi_lsp_json_literal_read(reader, "\\u"))
+                {
+                   low = _edi_lsp_json_hex_read(reader);
+                   if (low < 0xDC00 || low > 0xDFFF)
+                     goto error;
+                   code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+              _edi_lsp_utf8_append(buf, code);
+              break;
+           default:
+              goto error;
+          }
+     }
+
+   if (reader->text >= reader->end)
+     goto error;
+   reader->text++;
+
+   return eina_strbuf_string_steal(buf);
+
+error:
+   eina_strbuf_free(buf);
+   return NULL;
+}
+
+// Numbers are read by hand, strtod() would follow the locale of the user.
+static Eina_Bool
+_edi_lsp_json_number_read(Edi_Lsp_Json_Reader *reader, double *number)
+{
+   double value = 0, scale = 1;
+   int exponent = 0, exponent_sign = 1;
+   Eina_Bool negative = EINA_FALSE, digits = EINA_FALSE;
+
+   if (reader->text < reader->end && *reader->text == '-')
+     {
+        negative = EINA_TRUE;
+        reader->text++;
+     }
+
+   while (reader->text < reader->end && *reader->text >= '0' && *reader->text <= '9')
+     {
+        value = value * 10 + (*reader->text++ - '0');
+        digits = EINA_TRUE;
+     }
+
+   if (reader->text < reader->end && *reader->text == '.')
+     {
+        reader->text++;
+        while (reader->text < reader->end && *reader->text >= '0' && *reader->text <= '9')
+          {
+             scale /= 10;
+             value += (*reader->text++ - '0') * scale;
+             digits = EINA_TRUE;
+          }
+     }
+
+   if (!digits)
+     return EINA_FALSE;
+
+   if (reader->text < reader->end && (*reader->text == 'e' || *reader->text == 'E'))
+     {
+        reader->text++;
+        if (reader->text < reader->end && (*reader->text == '-' || *reader->text == '+'))
+          exponent_sign = *reader->text++ == '-' ? -1 : 1;
+
+        while (reader->text < reader->end && *reader->text >= '0' && *reader->text <= '9')
+          {
+             if (exponent < 1000)
+               exponent = exponent * 10 + (*reader->text - '0');
+             reader->text++;
+          }
+
+        for (; exponent > 0; exponent--)
+          value = exponent_sign > 0 ? value * 10 : value / 10;
+     }
+
+   *number = negative ? -value : value;
+   return EINA_TRUE;
+}
+
+static Eina_Bool
+_edi_lsp_json_children_read(Edi_Lsp_Json_Reader *reader, Edi_Lsp_Json *json, char close)
+{
+   Edi_Lsp_Json *child;
+   char *key = NULL;
+
+   reader->text++;
+   _edi_lsp_json_space_skip(reader);
+   if (reader->text < reader->end && *reader->text == close)
+     {
+        reader->text++;
+        return EINA_TRUE;
+     }
+
+   while (reader->text < reader->end)
+     {
+        if (json->type == EDI_LSP_JSON_OBJECT)
+          {
+             key = _edi_lsp_json_string_read(reader);
+             if (!key)
+               return EINA_FALSE;
+
+             _edi_lsp_json_space_skip(reader);
+             if (reader->text >= reader->end || *reader->text != ':')
+               {
+                  free(key);
+                  return EINA_FALSE;
+               }
+             reader->text++;
+          }
+
+        child = _edi_lsp_json_value_read(reader);
+        if (!child)
+          {
+             free(key);
+             return EINA_FALSE;
+          }
+        child->key = key;
+        key = NULL;
+        json->value.children = eina_list_append(json->value.children, child);
+
+        _edi_lsp_json_space_skip(reader);
+        if (reader->text >= reader->end)
+          return EINA_FALSE;
+
+        if (*reader->text == close)
+          {
+             reader->text++;
+             return EINA_TRUE;
+          }
+        if (*reader->text != ',')
+          return EINA_FALSE;
+
+        reader->text++;
+        _edi_lsp_json_space_skip(reader);
+     }
+
+   return EINA_FALSE;
+}
+
+static Edi_Lsp_Json *
+_edi_lsp_json_value_read(Edi_Lsp_Json_Reader *reader)
+{
+   Edi_Lsp_Json *json;
+   Eina_Bool valid;
+
+   _edi_lsp_json_space_skip(reader);
+   if (reader->text >= reader->end || reader->depth >= EDI_LSP_JSON_DEPTH_MAX)
+     return NULL;
+
+   json = calloc(1, sizeof(Edi_Lsp_Json));
+   switch (*reader->text)
+     {
+      case '{':
+      case '[':
+         json->type = *reader->text == '{' ? EDI_LSP_JSON_OBJECT : EDI_LSP_JSON_ARRAY;
+         reader->depth++;
+         valid = _edi_lsp_json_children_read(reader, json, *reader->text == '{' ? '}' : ']');
+         reader->depth--;
+         break;
+      case '"':
+         json->type = EDI_LSP_JSON_STRING;
+         json->value.string = _edi_lsp_json_string_read(reader);
+         valid = !!json->value.string;
+         break;
+      case 't':
+         json->type = EDI_LSP_JSON_BOOLEAN;
+         json->value.boolean = EINA_TRUE;
+         valid = _edi_lsp_json_literal_read(reader, "true");
+         break;
+      case 'f':
+         json->type = EDI_LSP_JSON_BOOLEAN;
+         valid = _edi_lsp_json_literal_read(reader, "false");
+         break;
+      case 'n':
+         valid = _edi_lsp_json_literal_read(reader, "null");
+         break;
+      default:
+         json->type = EDI_LSP_JSON_NUMBER;
+         valid = _edi_lsp_json_number_read(reader, &json->value.number);
+     }
+
+   if (!valid)
+     {
+        edi_lsp_json_free(json);
+        return NULL;
+     }
+
+   return json;
+}
+
+Edi_Lsp_Json *
+edi_lsp_json_parse(const char *text, size_t length)
+{
+   Edi_Lsp_Json_Reader reader;
+   Edi_Lsp_Json *json;
+
+   reader.text = text;
+   reader.end = text + length;
+   reader.depth = 0;
+
+   json = _edi_lsp_json_value_read(&reader);
+   if (!json)
+     return NULL;
+
+   _edi_lsp_json_space_skip(&reader);
+   if (reader.text != reader.end)
+     {
+        edi_lsp_json_free(json);
+        return NULL;
+     }
+
+   return json;
+}
+
+void
+edi_lsp_json_free(Edi_Lsp_Json *json)
+{
+   Edi_Lsp_Json *child;
+
+   if (!json)
+     return;
+
+   if (json->type == EDI_LSP_JSON_STRING)
+     free(json->value.string);
+   else if (json->type == EDI_LSP_JSON_ARRAY || json->type == EDI_LSP_JSON_OBJECT)
+     {
+        EINA_LIST_FREE(json->value.children, child)
+          edi_lsp_json_free(child);
+     }
+
+   free(json->key);
+   free(json);
+}
+
+const Edi_Lsp_Json *
+edi_lsp_json_get(const Edi_Lsp_Json *json, const char *path)
+{
+   const Edi_Lsp_Json *child;
+   const char *end;
+   Eina_List *l;
+   size_t length;
+
+   while (json && path && *path)
+     {
+        if (json->type != EDI_LSP_JSON_OBJECT)
+          return NULL;
+
+        end = strchr(path, '.');
+        length = end ? (size_t) (end - path) : strlen(path);
+
+        child = NULL;
+        EINA_LIST_FOREACH(json->value.children, l, child)
+          {
+             if (!strncmp(child->key, path, length) && !child->key[length])
+               break;
+          }
+        json = l ? child : NULL;
+
+        path = end ? end + 1 : NULL;
+     }
+
+   return json;
+}
+
+const char *
+edi_lsp_json_string_get(const Edi_Lsp_Json *json, const char *path)
+{
+   json = edi_lsp_json_get(json, path);
+   if (!json || json->type != EDI_LSP_JSON_STRING)
+     return NULL;
+
+   return json->value.string;
+}
+
+double
+edi_lsp_json_number_get(const Edi_Lsp_Json *json, const char *path, double fallback)
+{
+   json = edi_lsp_json_get(json, path);
+   if (!json || json->type != EDI_LSP_JSON_NUMBER)
+     return fallback;
+
+   return json->value.number;
+}
+
+void
+edi_lsp_json_string_append(Eina_Strbuf *buf, const char *string)
+{
+   const char *start;
+
+   if (!string)
+     {
+        eina_strbuf_append(buf, "null");
+        return;
+     }
+
+   eina_strbuf_append_char(buf, '"');
+   while (*string)
+     {
+        start = string;
+        while (*string && *string != '"' && *string != '\\' && (unsigned char) *string >= 0x20)
+          string++;
+        eina_strbuf_append_length(buf, start, string - start);
+
+        if (!*string)
+          break;
+
+        switch (*string)
+          {
+           case '"': eina_strbuf_append(buf, "\\\""); break;
+           case '\\': eina_strbuf_append(buf, "\\\\"); break;
+           case '\n': eina_strbuf_append(buf, "\\n"); break;
+           case '\r': eina_strbuf_append(buf, "\\r"); break;
+           case '\t': eina_strbuf_append(buf, "\\t"); break;
+           default: eina_strbuf_append_printf(buf, "\\u%04x", (unsigned char) *string);
+          }
+        string++;
+     }
+   eina_strbuf_append_char(buf, '"');
+}
+
+char *
+edi_lsp_uri_from_path(const char *path)
+{
+   Eina_Strbuf *buf;
+   unsigned char c;
+
+   buf = eina_strbuf_new();
+   eina_strbuf_append(buf, "file://");
+   for (; *path; path++)
+     {
+        c = *path;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+            c == '/' || c == '-' || c == '.' || c == '_' || c == '~')
+          eina_strbuf_append_char(buf, c);
+        else
+          eina_strbuf_append_printf(buf, "%%%02X", c);
+     }
+
+   return eina_strbuf_string_steal(buf);
+}
+
+char *
+edi_lsp_uri_path_get(const char *uri)
+{
+   Edi_Lsp_Json_Reader reader;
+   Eina_Strbuf *buf;
+   int code;
+
+   if (strncmp(uri, "file://", 7))
+     return NULL;
+
+   buf = eina_strbuf_new();
+   for (uri += 7; *uri; uri++)
+     {
+        if (*uri == '%' && uri[1] && uri[2])
+          {
+             // Two hex digits, read as the end of a \u escape would be.
+             char hex[4] = { '0', '0', uri[1], uri[2] };
+
+             reader.text = hex;
+             reader.end = hex + 4;
+             code = _edi_lsp_json_hex_read(&reader);
+             if (code >= 0)
+               {
+                  eina_strbuf_append_char(buf, code);
+                  uri += 2;
+                  continue;
+               }
+          }
+        eina_strbuf_append_char(buf, *uri);
+     }
+
+   return eina_strbuf_string_steal(buf);
+}
+
+Edi_Lsp_Parser *
+edi_lsp_parser_new(void)
+{
+   Edi_Lsp_Parser *parser;
+
+   parser = calloc(1, sizeof(Edi_Lsp_Parser));
+   parser->buffer = eina_binbuf_new();
+
+   return parser;
+}
+
+void
+edi_lsp_parser_free(Edi_Lsp_Parser *parser)
+{
+   if (!parser)
+     return;
+
+   eina_binbuf_free(parser->buffer);
+   free(parser);
+}
+
+void
+edi_lsp_parser_feed(Edi_Lsp_Parser *parser, const void *data, size_t size)
+{
+   eina_binbuf_append_length(parser->buffer, data, size);
+}
+
+// The length of the content a header announces, 0 if it has none.
+static size_t
+_edi_lsp_parser_header_read(const char *header, size_t size)
+{
+   const char *line, *end, *value;
+   size_t length = 0;
+
+   for (line = header; line < header + size; line = end + 2)
+     {
+        end = line;
+        while (end + 1 < header + size && (end[0] != '\r' || end[1] != '\n'))
+          end++;
+        if (end + 1 >= header + size)
+          break;
+
+        if (end - line > 15 && !strncasecmp(line, "Content-Length:", 15))
+          {
+             length = 0;
+             for (value = line + 15; value < end && *value == ' '; value++);
+             for (; value < end && *value >= '0' && *value <= '9'; value++)
+               length = length * 10 + (*value - '0');
+          }
+     }
+
+   return length;
+}
+
+Edi_Lsp_Json *
+edi_lsp_parser_next(Edi_Lsp_Parser *parser)
+{
+   const char *data, *end;
+   Edi_Lsp_Json *message;
+   size_t size, header;
+
+   while (1)
+     {
+        data = (const char *) eina_binbuf_string_get(parser->buffer);
+        size = eina_binbuf_length_get(parser->buffer);
+
+        if (!parser->length)
+          {
+             end = NULL;
+             for (header = 0; header + 4 <= size; header++)
+               {
+                  if (!memcmp(data + header, "\r\n\r\n", 4))
+                    {
+                       end = data + header;
+                       break;
+                    }
+               }
+             if (!end)
+               return NULL;
+
+             // The header line ends are needed to read it, the empty line is not.
+             parser->length = _edi_lsp_parser_header_read(data, header + 2);
+             eina_binbuf_remove(parser->buffer, 0, header + 4);
+             if (!parser->length)
+               WRN("Skipping a language server message without a length");
+             continue;
+          }
+
+        if (size < parser->length)
+          return NULL;
+
+        message = edi_lsp_json_parse(data, parser->length);
+        if (!message)
+          WRN("Skipping a language server message that is not valid JSON");
+
+        eina_binbuf_remove(parser->buffer, 0, parser->length);
+        parser->length = 0;
+
+        if (message)
+          return message;
+     }
+}
+
+static void
+_edi_lsp_message_free(Edi_Lsp_Message *message)
+{
+   free(message->text);
+   free(message);
+}
+
+static void
+_edi_lsp_request_free(Edi_Lsp_Request *request)
+{
+   eina_stringshare_del(request->method);
+   free(request);
+}
+
+static void
+_edi_lsp_client_write(Edi_Lsp_Client *client, const char *text)
+{
+   char header[64];
+   size_t length;
+
+   if (!client->exe)
+     return;
+
+   length = strlen(text);
+   snprintf(header, sizeof(header), "Content-Length: %zu\r\n\r\n", length);
+
+   ecore_exe_send(client->exe, header, strlen(header));
+   ecore_exe_send(client->exe, text, length);
+}
+
+static char *
+_edi_lsp_message_text_get(unsigned int id, const char *method, const char *params)
+{
+   Eina_Strbuf *buf;
+
+   buf = eina_strbuf_new();
+   eina_strbuf_append(buf, "{\"jsonrpc\":\"2.0\"");
+   if (id)
+     eina_strbuf_append_printf(buf, ",\"id\":%u", id);
+   eina_strbuf_append(buf, ",\"method\":");
+   edi_lsp_json_string_append(buf, method);
+   if (params)
+     eina_strbuf_append_printf(buf, ",\"params\":%s", params);
+   eina_strbuf_append_char(buf, '}');
+
+   return eina_strbuf_string_steal(buf);
+}
+
+// Messages have to wait for the server to be initialized, only the first request does not.
+static void
+_edi_lsp_client_send(Edi_Lsp_Client *client, unsigned int id, const char *method, const char *params)
+{
+   Edi_Lsp_Message *message;
+
+   message = malloc(sizeof(Edi_Lsp_Message));
+   message->id = id;
+   message->text = _edi_lsp_message_text_get(id, method, params);
+
+   if (!client->initialized && strcmp(method, "initialize"))
+     {
+        client->queue = eina_list_append(client->queue, message);
+        return;
+     }
+
+   _edi_lsp_client_write(client, message->text);
+   _edi_lsp_message_free(message);
+}
+
+static Edi_Lsp_Latency *
+_edi_lsp_client_latency_add(Edi_Lsp_Client *client, const char *method)
+{
+   Edi_Lsp_Latency *latency;
+
+   latency = eina_hash_find(client->latencies, method);
+   if (!latency)
+     {
+        latency = calloc(1, sizeof(Edi_Lsp_Latency));
+        eina_hash_add(client->latencies, method, latency);
+     }
+
+   return latency;
+}
+
+// Nothing will be sent to the server, answer what waits for it with the error and stop it.
+static void
+_edi_lsp_client_fail(Edi_Lsp_Client *client, const Edi_Lsp_Json *error)
+{
+   Edi_Lsp_Message *message;
+   Edi_Lsp_Request *request;
+   Eina_List *queue;
+
+   client->closing = EINA_TRUE;
+
+   // The callbacks may free the client, and its queue with it.
+   queue = client->queue;
+   client->queue = NULL;
+
+   client->walking++;
+   EINA_LIST_FREE(queue, message)
+     {
+        request = message->id ? eina_hash_find(client->requests, &message->id) : NULL;
+        if (request)
+          {
+             eina_hash_del_by_key(client->requests, &message->id);
+             if (request->cb && !client->deleted)
+               request->cb(request->data, client, NULL, error);
+             _edi_lsp_request_free(request);
+          }
+        _edi_lsp_message_free(message);
+     }
+   client->walking--;
+
+   if (client->exe)
+     ecore_exe_terminate(client->exe);
+}
+
+static void
+_edi_lsp_client_initialize_cb(void *data EINA_UNUSED, Edi_Lsp_Client *client,
+                              const Edi_Lsp_Json *result, const Edi_Lsp_Json *error)
+{
+   Edi_Lsp_Message *message;
+   const Edi_Lsp_Json *sync;
+
+   if (!client->exe)
+     return;
+
+   if (error)
+     {
+        ERR("Language server %s could not initialize: %s", client->command,
+            edi_lsp_json_string_get(error, "message"));
+        _edi_lsp_client_fail(client, error);
+        return;
+     }
+
+   // Either the kind of sync or the options of it.
+   sync = edi_lsp_json_get(result, "capabilities.textDocumentSync");
+   if (sync && sync->type == EDI_LSP_JSON_NUMBER)
+     client->text_sync = sync->value.number;
+   else
+     client->text_sync = edi_lsp_json_number_get(sync, "change", EDI_LSP_TEXT_SYNC_NONE);
+
+   client->initialized = EINA_TRUE;
+   _edi_lsp_client_send(client, 0, "initialized", "{}");
+
+   EINA_LIST_FREE(client->queue, message)
+     {
+        _edi_lsp_client_write(client, message->text);
+        _edi_lsp_message_free(message);
+     }
+}
+
+Edi_Lsp_Client *
+edi_lsp_client_new(const char *command, const char *root,
+                   Edi_Lsp_Notification_Cb cb, const void *data)
+{
+   Edi_Lsp_Client *client;
+   Eina_Strbuf *params;
+   char *uri;
+
+   client = calloc(1, sizeof(Edi_Lsp_Client));
+   client->exe = ecore_exe_pipe_run(command, ECORE_EXE_PIPE_READ | ECORE_EXE_PIPE_WRITE |
+                                             ECORE_EXE_PIPE_ERROR | ECORE_EXE_TERM_WITH_PARENT,
+                                    client);
+   if (!client->exe)
+     {
+        ERR("Could not run the language server %s", command);
+        free(client);
+        return NULL;
+     }
+
+   client->command = strdup(command);
+   client->parser = edi_lsp_parser_new();
+   client->requests = eina_hash_int32_new(NULL);
+   client->latencies = eina_hash_string_superfast_new(free);
+   client->next_id = 1;
+   client->cb = cb;
+   client->data = (void *) data;
+
+   if (!_edi_lsp_clients)
+     {
+        _edi_lsp_data_handler = ecore_event_handler_add(ECORE_EXE_EVENT_DATA, _edi_lsp_client_data_cb, NULL);
+        _edi_lsp_error_handler = ecore_event_handler_add(ECORE_EXE_EVENT_ERROR, _edi_lsp_client_error_cb, NULL);
+        _edi_lsp_del_handler = ecore_event_handler_add(ECORE_EXE_EVENT_DEL, _edi_lsp_client_del_cb, NULL);
+     }
+   _edi_lsp_clients = eina_list_append(_edi_lsp_clients, client);
+
+   uri = edi_lsp_uri_from_path(root);
+
+   params = eina_strbuf_new();
+   eina_strbuf_append_printf(params, "{\"processId\":%d,\"rootUri\":", (int) getpid());
+   edi_lsp_json_string_append(params, uri);
+   eina_strbuf_append(params, ",\"capabilities\":{\"textDocument\":{"
+                              "\"synchronization\":{\"didSave\":true},"
+                              "\"completion\":{\"completionItem\":{\"snippetSupport\":false}},"
+                              "\"hover\":{\"contentFormat\":[\"plaintext\",\"markdown\"]},"
+                              "\"publishDiagnostics\":{}}}}");
+   edi_lsp_client_request(client, "initialize", eina_strbuf_string_get(params),
+                          _edi_lsp_client_initialize_cb, NULL);
+   eina_strbuf_free(params);
+   free(uri);
+
+   return client;
+}
+
+static Eina_Bool
+_edi_lsp_client_request_collect(const Eina_Hash *hash EINA_UNUSED, const void *key EINA_UNUSED,
+                                void *data, void *fdata)
+{
+   Eina_List **requests = fdata;
+
+   *requests = eina_list_append(*requests, data);
+
+   return EINA_TRUE;
+}
+
+// Take the pending requests, they are then owned by the caller.
+static Eina_List *
+_edi_lsp_client_requests_steal(Edi_Lsp_Client *client)
+{
+   Eina_List *requests = NULL;
+
+   eina_hash_foreach(client->requests, _edi_lsp_client_request_collect, &requests);
+   eina_hash_free_buckets(client->requests);
+
+   return requests;
+}
+
+static void
+_edi_lsp_client_finish(Edi_Lsp_Client *client)
+{
+   Edi_Lsp_Message *message;
+   Edi_Lsp_Request *request;
+   Eina_List *requests;
+
+   _edi_lsp_clients = eina_list_remove(_edi_lsp_clients, client);
+   if (!_edi_lsp_clients)
+     {
+        ecore_event_handler_del(_edi_lsp_data_handler);
+        ecore_event_handler_del(_edi_lsp_error_handler);
+        ecore_event_handler_del(_edi_lsp_del_handler);
+        _edi_lsp_data_handler = _edi_lsp_error_handler = _edi_lsp_del_handler = NULL;
+     }
+
+   if (client->shutdown_timer)
+     ecore_timer_del(client->shutdown_timer);
+   if (client->exe)
+     {
+        ecore_exe_kill(client->exe);
+        ecore_exe_free(client->exe);
+     }
+
+   EINA_LIST_FREE(client->queue, message)
+     _edi_lsp_message_free(message);
+
+   requests = _edi_lsp_client_requests_steal(client);
+   EINA_LIST_FREE(requests, request)
+     _edi_lsp_request_free(request);
+
+   eina_hash_free(client->requests);
+   eina_hash_free(client->latencies);
+   edi_lsp_parser_free(client->parser);
+   free(client->command);
+   free(client);
+}
+
+static void
+_edi_lsp_client_shutdown_cb(void *data EINA_UNUSED, Edi_Lsp_Client *client,
+                            const Edi_Lsp_Json *result EINA_UNUSED, const Edi_Lsp_Json *error EINA_UNUSED)
+{
+   _edi_lsp_client_write(client, "{\"jsonrpc\":\"2.0\",\"method\":\"exit\"}");
+}
+
+static Eina_Bool
+_edi_lsp_client_shutdown_timer_cb(void *data)
+{
+   Edi_Lsp_Client *client = data;
+
+   WRN("Language server %s did not shut down, stopping it", client->command);
+   client->shutdown_timer = NULL;
+   if (client->exe)
+     ecore_exe_terminate(client->exe);
+
+   return ECORE_CALLBACK_CANCEL;
+}
+
+void
+edi_lsp_client_free(Edi_Lsp_Client *client)
+{
+   Edi_Lsp_Message *message;
+   Edi_Lsp_Request *request;
+   Eina_List *requests;
+
+   if (!client || client->deleted)
+     return;
+
+   client->deleted = EINA_TRUE;
+   client->cb = NULL;
+
+   EINA_LIST_FREE(client->queue, message)
+     _edi_lsp_message_free(message);
+   requests = _edi_lsp_client_requests_steal(client);
+   EINA_LIST_FREE(requests, request)
+     _edi_lsp_request_free(request);
+
+   // The server is asked to shut down, it is told to exit once it did.
+   if (client->exe && client->initialized && !client->closing)
+     {
+        edi_lsp_client_request(client, "shutdown", NULL, _edi_lsp_client_shutdown_cb, NULL);
+        client->closing = EINA_TRUE;
+        client->shutdown_timer = ecore_timer_add(EDI_LSP_SHUTDOWN_TIMEOUT,
+                                                 _edi_lsp_client_shutdown_timer_cb, client);
+        return;
+     }
+
+   if (client->exe)
+     {
+        ecore_exe_terminate(client->exe);
+        ecore_exe_free(client->exe);
+        client->exe = NULL;
+     }
+
+   // Called back while messages are handled, the client is still in use.
+   if (!client->walking)
+     _edi_lsp_client_finish(client);
+}
+
+void
+edi_lsp_shutdown(void)
+{
+   Edi_Lsp_Client *client;
+   double end;
+
+   // The servers shutting down are given a moment to exit, the others are stopped.
+   end = ecore_time_get() + EDI_LSP_SHUTDOWN_TIMEOUT;
+   while (_edi_lsp_clients && ecore_time_get() < end)
+     {
+        ecore_main_loop_iterate();
+        usleep(10000);
+     }
+
+   while (_edi_lsp_clients)
+     {
+        client = eina_list_data_get(_edi_lsp_clients);
+        client->walking = 0;
+        _edi_lsp_client_finish(client);
+     }
+}
+
+unsigned int
+edi_lsp_client_request(Edi_Lsp_Client *client, const char *method, const char *params,
+                       Edi_Lsp_Response_Cb cb, const void *data)
+{
+   Edi_Lsp_Request *request;
+
+   if (!client->exe || client->closing)
+     return 0;
+
+   request = calloc(1, sizeof(Edi_Lsp_Request));
+   request->id = client->next_id++;
+   request->method = eina_stringshare_add(method);
+   request->cb = cb;
+   request->data = (void *) data;
+   request->start = ecore_time_get();
+   eina_hash_add(client->requests, &request->id, request);
+
+   _edi_lsp_client_send(client, request->id, method, params);
+
+   return request->id;
+}
+
+void
+edi_lsp_client_notify(Edi_Lsp_Client *client, const char *method, const char *params)
+{
+   if (!client->exe || client->closing)
+     return;
+
+   _edi_lsp_client_send(client, 0, method, params);
+}
+
+void
+edi_lsp_client_cancel(Edi_Lsp_Client *client, unsigned int id)
+{
+   Edi_Lsp_Request *request;
+   Edi_Lsp_Message *message;
+   Eina_List *l;
+   char params[32];
+
+   request = eina_hash_find(client->requests, &id);
+   if (!request)
+     return;
+
+   _edi_lsp_client_latency_add(client, request->method)->cancelled++;
+   eina_hash_del_by_key(client->requests, &id);
+   _edi_lsp_request_free(request);
+
+   // Not sent yet, it never will be.
+   EINA_LIST_FOREACH(client->queue, l, message)
+     {
+        if (message->id == id)
+          {
+             client->queue = eina_list_remove_list(client->queue, l);
+             _edi_lsp_message_free(message);
+             return;
+          }
+     }
+
+   if (!client->exe || client->closing)
+     return;
+
+   snprintf(params, sizeof(params), "{\"id\":%u}", id);
+   _edi_lsp_client_send(client, 0, "$/cancelRequest", params);
+}
+
+Eina_Bool
+edi_lsp_client_running_get(const Edi_Lsp_Client *client)
+{
+   return client->exe && !client->closing;
+}
+
+Edi_Lsp_Text_Sync
+edi_lsp_client_text_sync_get(const Edi_Lsp_Client *client)
+{
+   if (!client->initialized)
+     return EDI_LSP_TEXT_SYNC_FULL;
+
+   return client->text_sync;
+}
+
+const Edi_Lsp_Latency *
+edi_lsp_client_latency_get(const Edi_Lsp_Client *client, const char *method)
+{
+   return eina_hash_find(client->latencies, method);
+}
+
+static void
+_edi_lsp_client_response_handle(Edi_Lsp_Client *client, const Edi_Lsp_Json *message)
+{
+   Edi_Lsp_Request *request;
+   Edi_Lsp_Latency *latency;
+   unsigned int id;
+   double elapsed;
+
+   id = edi_lsp_json_number_get(message, "id", 0);
+   request = eina_hash_find(client->requests, &id);
+
+   // Answers to cancelled requests can still arrive.
+   if (!request)
+     return;
+   eina_hash_del_by_key(client->requests, &id);
+
+   elapsed = ecore_time_get() - request->start;
+   latency = _edi_lsp_client_latency_add(client, request->method);
+   latency->count++;
+   latency->total += elapsed;
+   if (elapsed > latency->max)
+     latency->max = elapsed;
+   DBG("Language server %s answered %s in %.3fs", client->command, request->method, elapsed);
+
+   if (request->cb)
+     request->cb(request->data, client, edi_lsp_json_get(message, "result"),
+                 edi_lsp_json_get(message, "error"));
+   _edi_lsp_request_free(request);
+}
+
+// The server asks for things too, configuration is given as the default.
+static void
+_edi_lsp_client_request_handle(Edi_Lsp_Client *client, const Edi_Lsp_Json *message, const char *method)
+{
+   const Edi_Lsp_Json *id, *items;
+   Eina_Strbuf *buf;
+   unsigned int i, count = 0;
+
+   id = edi_lsp_json_get(message, "id");
+   buf = eina_strbuf_new();
+   eina_strbuf_append(buf, "{\"jsonrpc\":\"2.0\",\"id\":");
+   if (id->type == EDI_LSP_JSON_STRING)
+     edi_lsp_json_string_append(buf, id->value.string);
+   else
+     eina_strbuf_append_printf(buf, "%.0f", id->value.number);
+
+   if (!strcmp(method, "workspace/configuration"))
+     {
+        items = edi_lsp_json_get(message, "params.items");
+        if (items && items->type == EDI_LSP_JSON_ARRAY)
+          count = eina_list_count(items->value.children);
+
+        eina_strbuf_append(buf, ",\"result\":[");
+        for (i = 0; i < count; i++)
+          eina_strbuf_append(buf, i ? ",null" : "null");
+        eina_strbuf_append(buf, "]}");
+     }
+   else
+     eina_strbuf_append(buf, ",\"result\":null}");
+
+   _edi_lsp_client_write(client, eina_strbuf_string_get(buf));
+   eina_strbuf_free(buf);
+}
+
+static void
+_edi_lsp_client_message_handle(Edi_Lsp_Client *client, const Edi_Lsp_Json *message)
+{
+   const char *method;
+
+   method = edi_lsp_json_string_get(message, "method");
+   if (!method)
+     _edi_lsp_client_response_handle(client, message);
+   else if (edi_lsp_json_get(message, "id"))
+     _edi_lsp_client_request_handle(client, message, method);
+   else if (client->cb)
+     client->cb(client->data, client, method, edi_lsp_json_get(message, "params"));
+}
+
+static Edi_Lsp_Client *
+_edi_lsp_client_find(Ecore_Exe *exe)
+{
+   Edi_Lsp_Client *client;
+   Eina_List *l;
+
+   EINA_LIST_FOREACH(_edi_lsp_clients, l, client)
+     {
+        if (client->exe == exe)
+          return client;
+     }
+
+   return NULL;
+}
+
+static Eina_Bool
+_edi_lsp_client_data_cb(void *data EINA_UNUSED, int type EINA_UNUSED, void *event)
+{
+   Ecore_Exe_Event_Data *ev = event;
+   Edi_Lsp_Client *client;
+   Edi_Lsp_Json *message;
+
+   client = _edi_lsp_client_find(ev->exe);
+   if (!client)
+     return ECORE_CALLBACK_PASS_ON;
+
+   edi_lsp_parser_feed(client->parser, ev->data, ev->size);
+
+   // A client freed meanwhile still reads the answer to its shutdown.
+   client->walking++;
+   while ((!client->deleted || client->closing) && (message = edi_lsp_parser_next(client->parser)))
+     {
+        _edi_lsp_client_message_handle(client, message);
+        edi_lsp_json_free(message);
+     }
+   client->walking--;
+
+   if (client->deleted && !client->walking && !client->exe)
+     _edi_lsp_client_finish(client);
+
+   return ECORE_CALLBACK_PASS_ON;
+}
+
+static Eina_Bool
+_edi_lsp_client_error_cb(void *data EINA_UNUSED, int type EINA_UNUSED, void *event)
+{
+   Ecore_Exe_Event_Data *ev = event;
+   Edi_Lsp_Client *client;
+
+   client = _edi_lsp_client_find(ev->exe);
+   if (client)
+     DBG("Language server %s: %.*s", client->command, ev->size, (char *) ev->data);
+
+   return ECORE_CALLBACK_PASS_ON;
+}
+
+static Eina_Bool
+_edi_lsp_client_del_cb(void *data EINA_UNUSED, int type EINA_UNUSED, void *event)
+{
+   Ecore_Exe_Event_Del *ev = event;
+   Edi_Lsp_Client *client;
+   Edi_Lsp_Request *request;
+   Eina_List *requests;
+
+   client = _edi_lsp_client_find(ev->exe);
+   if (!client)
+     return ECORE_CALLBACK_PASS_ON;
+
+   if (client->deleted)
+     DBG("Language server %s exited with code %d", client->command, ev->exit_code);
+   else
+     WRN("Language server %s exited with code %d", client->command, ev->exit_code);
+   client->exe = NULL;
+
+   // Nothing will answer the requests left.
+   requests = _edi_lsp_client_requests_steal(client);
+   client->walking++;
+   EINA_LIST_FREE(requests, request)
+     {
+        if (request->cb && !client->deleted)
+          request->cb(request->data, client, NULL, NULL);
+        _edi_lsp_request_free(request);
+     }
+   client->walking--;
+
+   if (client->deleted && !client->walking)
+     _edi_lsp_client_finish(client);
+
+   return ECORE_CALLBACK_PASS_ON;
+}
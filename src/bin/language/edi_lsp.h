@@ -0,0 +1,356 @@
+#ifndef EDI_LSP_H_
+# define EDI_LSP_H_
+
+#include <Eina.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief These routines talk to language servers over the language server protocol.
+ */
+
+/**
+ * @brief Language server client functions.
+ * @defgroup Lsp
+ *
+ * @{
+ *
+ * A client for a language server started as a child process, exchanging
+ * JSON-RPC messages over its standard input and output. Everything runs on
+ * the main loop, the answers arrive through callbacks.
+ *
+ */
+
+/**
+ * @typedef Edi_Lsp_Json_Type
+ * The types of JSON value.
+ */
+typedef enum
+{
+   EDI_LSP_JSON_NULL = 0,
+   EDI_LSP_JSON_BOOLEAN,
+   EDI_LSP_JSON_NUMBER,
+   EDI_LSP_JSON_STRING,
+   EDI_LSP_JSON_ARRAY,
+   EDI_LSP_JSON_OBJECT
+} Edi_Lsp_Json_Type;
+
+/**
+ * @typedef Edi_Lsp_Json
+ * A JSON value, the members of an object have a key.
+ */
+typedef struct _Edi_Lsp_Json Edi_Lsp_Json;
+
+struct _Edi_Lsp_Json
+{
+   Edi_Lsp_Json_Type type;
+   char *key; /**< The name of the value in its object, or NULL */
+   union
+   {
+      Eina_Bool boolean;
+      double number;
+      char *string;
+      Eina_List *children; /**< The Edi_Lsp_Json of an array or object, in order */
+   } value;
+};
+
+/**
+ * @typedef Edi_Lsp_Text_Sync
+ * How a language server wants to be told about the changes to a file.
+ */
+typedef enum
+{
+   EDI_LSP_TEXT_SYNC_NONE = 0,
+   EDI_LSP_TEXT_SYNC_FULL, /**< The whole text of the file */
+   EDI_LSP_TEXT_SYNC_INCREMENTAL /**< Only the ranges of text that changed */
+} Edi_Lsp_Text_Sync;
+
+/**
+ * @typedef Edi_Lsp_Parser
+ * Splits the stream a language server writes into messages.
+ */
+typedef struct _Edi_Lsp_Parser Edi_Lsp_Parser;
+
+/**
+ * @typedef Edi_Lsp_Client
+ * A connection to a running language server.
+ */
+typedef struct _Edi_Lsp_Client Edi_Lsp_Client;
+
+/**
+ * @typedef Edi_Lsp_Latency
+ * How long the server took to answer the requests of a method.
+ */
+typedef struct _Edi_Lsp_Latency
+{
+   unsigned int count; /**< The requests answered */
+   unsigned int cancelled; /**< The requests cancelled before they were answered */
+   double total, max; /**< In seconds, from the request to its answer */
+} Edi_Lsp_Latency;
+
+/**
+ * @typedef Edi_Lsp_Response_Cb
+ * Called with the result or the error the server answered a request with.
+ * Both are NULL if the server exited before it answered.
+ */
+typedef void (*Edi_Lsp_Response_Cb)(void *data, Edi_Lsp_Client *client,
+                                    const Edi_Lsp_Json *result, const Edi_Lsp_Json *error);
+
+/**
+ * @typedef Edi_Lsp_Notification_Cb
+ * Called with the notifications the server sends.
+ */
+typedef void (*Edi_Lsp_Notification_Cb)(void *data, Edi_Lsp_Client *client,
+                                        const char *method, const Edi_Lsp_Json *params);
+
+/**
+ * Parse a JSON text.
+ *
+ * @param text The text to parse, it does not need to be nul terminated.
+ * @param length The length of the text.
+ *
+ * @return the value to be freed with edi_lsp_json_free(), or NULL if the text is not valid.
+ *
+ * @ingroup Lsp
+ */
+Edi_Lsp_Json *edi_lsp_json_parse(const char *text, size_t length);
+
+/**
+ * Free a JSON value and all it contains.
+ *
+ * @param json The value to free.
+ *
+ * @ingroup Lsp
+ */
+void edi_lsp_json_free(Edi_Lsp_Json *json);
+
+/**
+ * Get a value in nested objects.
+ *
+ * @param json The object to look in.
+ * @param path The keys of the value in each object, separated by dots like "range.start.line".
+ *
+ * @return the value, or NULL if there is none.
+ *
+ * @ingroup Lsp
+ */
+const Edi_Lsp_Json *edi_lsp_json_get(const Edi_Lsp_Json *json, const char *path);
+
+/**
+ * Get a string in nested objects.
+ *
+ * @param json The object to look in.
+ * @param path The keys of the value, as for edi_lsp_json_get().
+ *
+ * @return the string, or NULL if there is none or the value is not a string.
+ *
+ * @ingroup Lsp
+ */
+const char *edi_lsp_json_string_get(const Edi_Lsp_Json *json, const char *path);
+
+/**
+ * Get a number in nested objects.
+ *
+ * @param json The object to look in.
+ * @param path The keys of the value, as for edi_lsp_json_get().
+ * @param fallback What to return if there is no such number.
+ *
+ * @return the number or the fallback.
+ *
+ * @ingroup Lsp
+ */
+double edi_lsp_json_number_get(const Edi_Lsp_Json *json, const char *path, double fallback);
+
+/**
+ * Append a string to a buffer as a quoted and escaped JSON string.
+ *
+ * @param buf The buffer to append to.
+ * @param string The string to append, NULL is appended as null.
+ *
+ * @ingroup Lsp
+ */
+void edi_lsp_json_string_append(Eina_Strbuf *buf, const char *string);
+
+/**
+ * Get the URI the language servers know a file by.
+ *
+ * @param path The absolute path of the file.
+ *
+ * @return the URI to be freed.
+ *
+ * @ingroup Lsp
+ */
+char *edi_lsp_uri_from_path(const char *path);
+
+/**
+ * Get the file a URI given by a language server is for.
+ *
+ * @param uri The URI of the file.
+ *
+ * @return the path to be freed, or NULL if the URI is not of a local file.
+ *
+ * @ingroup Lsp
+ */
+char *edi_lsp_uri_path_get(const char *uri);
+
+/**
+ * Create a parser for the stream of a language server.
+ *
+ * @return the parser to be freed with edi_lsp_parser_free().
+ *
+ * @ingroup Lsp
+ */
+Edi_Lsp_Parser *edi_lsp_parser_new(void);
+
+/**
+ * Free a parser and the data it has not parsed yet.
+ *
+ * @param parser The parser to free.
+ *
+ * @ingroup Lsp
+ */
+void edi_lsp_parser_free(Edi_Lsp_Parser *parser);
+
+/**
+ * Give a parser what was read from the stream, in chunks of any size.
+ *
+ * @param parser The parser of the stream.
+ * @param data The data read.
+ * @param size The size of the data.
+ *
+ * @ingroup Lsp
+ */
+void edi_lsp_parser_feed(Edi_Lsp_Parser *parser, const void *data, size_t size);
+
+/**
+ * Get the next message whole in the data fed to a parser, messages that are
+ * not valid are skipped.
+ *
+ * @param parser The parser of the stream.
+ *
+ * @return the message to be freed with edi_lsp_json_free(), or NULL if more data is needed.
+ *
+ * @ingroup Lsp
+ */
+Edi_Lsp_Json *edi_lsp_parser_next(Edi_Lsp_Parser *parser);
+
+/**
+ * Start a language server and initialize it, requests made meanwhile are
+ * sent once it is initialized.
+ *
+ * @param command The command that runs the server, talking on its standard input and output.
+ * @param root The directory of the project the server works on.
+ * @param cb Called with the notifications of the server, may be NULL.
+ * @param data Passed to the notification callback.
+ *
+ * @return the client, or NULL if the server could not be started.
+ *
+ * @ingroup Lsp
+ */
+Edi_Lsp_Client *edi_lsp_client_new(const char *command, const char *root,
+                                   Edi_Lsp_Notification_Cb cb, const void *data);
+
+/**
+ * Stop a language server and free its client. Pending requests are
+ * forgotten without their callbacks being called. An initialized server is
+ * asked to shut down and exit, it is stopped if it does not in time.
+ *
+ * @param client The client of the server.
+ *
+ * @ingroup Lsp
+ */
+void edi_lsp_client_free(Edi_Lsp_Client *client);
+
+/**
+ * Wait for the language servers asked to shut down to exit, and stop those
+ * left. Call it once the clients were freed, before exiting.
+ *
+ * @ingroup Lsp
+ */
+void edi_lsp_shutdown(void);
+
+/**
+ * Send a request to a language server.
+ *
+ * @param client The client of the server.
+ * @param method The method to call.
+ * @param params The parameters of the call as JSON text, or NULL.
+ * @param cb Called once with the answer.
+ * @param data Passed to the callback.
+ *
+ * @return the id of the request, or 0 if the server is not running.
+ *
+ * @ingroup Lsp
+ */
+unsigned int edi_lsp_client_request(Edi_Lsp_Client *client, const char *method, const char *params,
+                                    Edi_Lsp_Response_Cb cb, const void *data);
+
+/**
+ * Send a notification to a language server.
+ *
+ * @param client The client of the server.
+ * @param method The method to notify.
+ * @param params The parameters of the notification as JSON text, or NULL.
+ *
+ * @ingroup Lsp
+ */
+void edi_lsp_client_notify(Edi_Lsp_Client *client, const char *method, const char *params);
+
+/**
+ * Cancel a request, its callback will not be called. The server is told to
+ * stop working on it if it was sent already.
+ *
+ * @param client The client of the server.
+ * @param id The id of the request, those already answered are ignored.
+ *
+ * @ingroup Lsp
+ */
+void edi_lsp_client_cancel(Edi_Lsp_Client *client, unsigned int id);
+
+/**
+ * Get how a language server wants to be told about the changes to files.
+ *
+ * @param client The client of the server.
+ *
+ * @return how the server syncs text, always full until it is initialized.
+ *
+ * @ingroup Lsp
+ */
+Edi_Lsp_Text_Sync edi_lsp_client_text_sync_get(const Edi_Lsp_Client *client);
+
+/**
+ * Get whether a language server is still running, it is not once it
+ * exited or could not be initialized.
+ *
+ * @param client The client of the server.
+ *
+ * @return EINA_TRUE if requests can still be sent to the server.
+ *
+ * @ingroup Lsp
+ */
+Eina_Bool edi_lsp_client_running_get(const Edi_Lsp_Client *client);
+
+/**
+ * Get how long a language server takes to answer the requests of a method.
+ *
+ * @param client The client of the server.
+ * @param method The method of the requests.
+ *
+ * @return the latency, or NULL if no request of the method was made.
+ *
+ * @ingroup Lsp
+ */
+const Edi_Lsp_Latency *edi_lsp_client_latency_get(const Edi_Lsp_Client *client, const char *method);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDI_LSP_H_ */
@@ -23,6 +23,7 @@
 
 static Evas_Object *_main_win, *_mainview_panel;
 static Evas_Object *_edi_mainview_search_project_popup;
+static Evas_Object *_edi_mainview_search_project_regex;
 
 static Edi_Mainview_Panel *_current_panel;
 static Eina_List *_edi_mainview_panels = NULL, *_edi_mainview_wins = NULL;
@@ -258,7 +259,7 @@ _edi_mainview_win_stat_done(void *data, Eio_File *handler EINA_UNUSED, const Ein
      return;
 
    mime = edi_mime_type_get(options->path);
-   provider = edi_content_provider_for_mime_get(mime);
+   provider = edi_content_provider_for_file_get(mime, stat->size);
    if (!provider)
      {
 //TODO        _edi_mainview_mime_content_safe_popup();
@@ -280,7 +281,7 @@ _changed_cb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info EINA_UNUS
 {
    Edi_Editor *editor = data;
 
-   editor->modified = EINA_TRUE;
+   edi_editor_modified_set(editor);
 
    ecore_event_add(EDI_EVENT_FILE_CHANGED, NULL, NULL, NULL);
 }
@@ -365,7 +366,10 @@ edi_mainview_open_window(Edi_Path_Options *options)
    else if (!edi_content_provider_for_id_get(options->type))
      {
         const char *mime = options->type;
-        Edi_Content_Provider *provider = edi_content_provider_for_mime_get(mime);
+        Edi_Content_Provider *provider;
+
+        // Restored tabs open in order, so their size is looked at right away.
+        provider = edi_content_provider_for_file_get(mime, ecore_file_size(options->path));
 
         if (provider)
           options->type = provider->id;
@@ -578,6 +582,8 @@ _edi_mainview_project_search_popup_cancel_cb(void *data EINA_UNUSED,
                                    Evas_Object *obj EINA_UNUSED,
                                    void *event_info EINA_UNUSED)
 {
+   // Drop a search still waiting for typing to pause.
+   edi_searchpanel_find_incremental(NULL);
    evas_object_del(_edi_mainview_search_project_popup);
 }
 
@@ -586,7 +592,8 @@ _edi_mainview_project_search_cb(void *data,
                              Evas_Object *obj EINA_UNUSED,
                              void *event_info EINA_UNUSED)
 {
-   const char *text_markup;
+   const char *text_markup, *error = NULL;
+   char message[1024];
    char *text;
 
    text_markup = elm_object_text_get((Evas_Object *) data);
@@ -598,13 +605,47 @@ _edi_mainview_project_search_cb(void *data,
 
    text = elm_entry_markup_to_utf8(text_markup);
 
-   edi_searchpanel_show();
-   edi_searchpanel_find(text);
+   if (elm_check_state_get(_edi_mainview_search_project_regex))
+     {
+        if (!edi_searchpanel_find_regex(text, &error))
+          {
+             snprintf(message, sizeof(message), _("Invalid regular expression: %s"), error);
+             _edi_mainview_popup_message_open(message);
+             elm_object_focus_set((Evas_Object *)data, EINA_TRUE);
+
+             free(text);
+             return;
+          }
+        edi_searchpanel_show();
+     }
+   else
+     {
+        edi_searchpanel_show();
+        edi_searchpanel_find(text);
+     }
 
    free(text);
    evas_object_del(_edi_mainview_search_project_popup);
 }
 
+static void
+_edi_mainview_project_search_changed_cb(void *data EINA_UNUSED, Evas_Object *obj,
+                                        void *event_info EINA_UNUSED)
+{
+   char *text;
+
+   // Expressions are rarely valid while they are typed, only search them on request.
+   if (elm_check_state_get(_edi_mainview_search_project_regex))
+     return;
+
+   text = elm_entry_markup_to_utf8(elm_object_text_get(obj));
+   if (text && text[0])
+     edi_searchpanel_show();
+
+   edi_searchpanel_find_incremental(text);
+   free(text);
+}
+
 static void
 _edi_mainview_project_search_popup_key_up_cb(void *data EINA_UNUSED, Evas *e EINA_UNUSED,
                                    Evas_Object *obj, void *event_info)
@@ -621,7 +662,7 @@ _edi_mainview_project_search_popup_key_up_cb(void *data EINA_UNUSED, Evas *e EIN
 void
 edi_mainview_project_search_popup_show(void)
 {
-   Evas_Object *popup, *frame, *box, *input, *button, *label;
+   Evas_Object *popup, *frame, *box, *input, *button, *label, *check;
 
    popup = elm_popup_add(_main_win);
    _edi_mainview_search_project_popup = popup;
@@ -643,8 +684,16 @@ edi_mainview_project_search_popup_show(void)
    evas_object_size_hint_weight_set(input, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
    evas_object_size_hint_align_set(input, EVAS_HINT_FILL, EVAS_HINT_FILL);
    evas_object_event_callback_add(input, EVAS_CALLBACK_KEY_UP, _edi_mainview_project_search_popup_key_up_cb, NULL);
+   evas_object_smart_callback_add(input, "changed,user", _edi_mainview_project_search_changed_cb, NULL);
    evas_object_show(input);
    elm_box_pack_end(box, input);
+
+   check = elm_check_add(box);
+   elm_object_text_set(check, _("Regular expression"));
+   evas_object_size_hint_align_set(check, 0.0, 0.5);
+   evas_object_show(check);
+   elm_box_pack_end(box, check);
+   _edi_mainview_search_project_regex = check;
    evas_object_show(box);
 
    frame = elm_frame_add(popup);
@@ -667,41 +716,70 @@ edi_mainview_project_search_popup_show(void)
    elm_object_focus_set(input, EINA_TRUE);
 }
 
-static void
-_edi_mainview_project_replace_cb(void *data,
-                             Evas_Object *obj,
-                             void *event_info EINA_UNUSED)
+// Read the terms of the replace popup, or point the user at what is missing.
+static Eina_Bool
+_edi_mainview_project_replace_terms_get(Evas_Object *button, char **search, char **replace)
 {
    Evas_Object *search_obj, *replace_obj;
    const char *search_markup, *replace_markup;
-   char *search, *replace;
 
-   search_obj = evas_object_data_get(obj, "search");
+   search_obj = evas_object_data_get(button, "search");
    search_markup = elm_object_text_get(search_obj);
    if (!search_markup || !search_markup[0])
      {
         elm_object_focus_set(search_obj, EINA_TRUE);
-        return;
+        return EINA_FALSE;
      }
 
-   replace_obj = (Evas_Object *) data;
+   replace_obj = evas_object_data_get(button, "replace");
    replace_markup = elm_object_text_get(replace_obj);
    if (!replace_markup || !replace_markup[0])
      {
         elm_object_focus_set(replace_obj, EINA_TRUE);
-        return;
+        return EINA_FALSE;
      }
 
    if (!strcmp(replace_markup, search_markup))
      {
         _edi_mainview_popup_message_open(_("Strings cannot match."));
-        return;
+        return EINA_FALSE;
      }
 
-   search = elm_entry_markup_to_utf8(search_markup);
-   replace = elm_entry_markup_to_utf8(replace_markup);
+   *search = elm_entry_markup_to_utf8(search_markup);
+   *replace = elm_entry_markup_to_utf8(replace_markup);
 
-   edi_file_text_replace_all(search, replace);
+   return EINA_TRUE;
+}
+
+static void
+_edi_mainview_project_replace_preview_cb(void *data EINA_UNUSED,
+                                         Evas_Object *obj,
+                                         void *event_info EINA_UNUSED)
+{
+   char *search, *replace;
+
+   if (!_edi_mainview_project_replace_terms_get(obj, &search, &replace))
+     return;
+
+   edi_searchpanel_show();
+   edi_searchpanel_replace(search, replace, EINA_TRUE);
+
+   free(search);
+   free(replace);
+}
+
+static void
+_edi_mainview_project_replace_cb(void *data EINA_UNUSED,
+                             Evas_Object *obj,
+                             void *event_info EINA_UNUSED)
+{
+   char *search, *replace;
+
+   if (!_edi_mainview_project_replace_terms_get(obj, &search, &replace))
+     return;
+
+   edi_searchpanel_show();
+   edi_searchpanel_replace(search, replace, EINA_FALSE);
 
    free(search);
    free(replace);
@@ -771,10 +849,19 @@ edi_mainview_project_replace_popup_show(void)
 
    button = elm_button_add(popup);
    evas_object_data_set(button, "search", search);
-   elm_object_text_set(button, _("Replace"));
+   evas_object_data_set(button, "replace", replace);
+   elm_object_text_set(button, _("Preview"));
    elm_object_part_content_set(popup, "button2", button);
    evas_object_smart_callback_add(button, "clicked",
-                                  _edi_mainview_project_replace_cb, replace);
+                                  _edi_mainview_project_replace_preview_cb, NULL);
+
+   button = elm_button_add(popup);
+   evas_object_data_set(button, "search", search);
+   evas_object_data_set(button, "replace", replace);
+   elm_object_text_set(button, _("Replace"));
+   elm_object_part_content_set(popup, "button3", button);
+   evas_object_smart_callback_add(button, "clicked",
+                                  _edi_mainview_project_replace_cb, NULL);
 
    evas_object_show(popup);
 }
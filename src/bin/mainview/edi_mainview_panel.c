@@ -15,6 +15,7 @@
 #include "edi_filepanel.h"
 #include "editor/edi_editor.h"
 #include "edi_content_provider.h"
+#include "edi_content.h"
 
 #include "edi_private.h"
 #include "edi_config.h"
@@ -774,6 +775,7 @@ void
 edi_mainview_panel_search(Edi_Mainview_Panel *panel)
 {
    Edi_Editor *editor;
+   Edi_Content_Large *large;
 
    if (edi_mainview_is_empty()) return;
 
@@ -781,9 +783,12 @@ edi_mainview_panel_search(Edi_Mainview_Panel *panel)
      return;
 
    editor = (Edi_Editor *)evas_object_data_get(panel->current->view, "editor");
+   large = evas_object_data_get(panel->current->view, "large");
 
    if (editor)
      edi_editor_search(editor);
+   else if (large)
+     edi_content_large_search(large);
 }
 
 void
@@ -801,10 +806,18 @@ void
 edi_mainview_panel_goto_position(Edi_Mainview_Panel *panel, unsigned int row, unsigned int col)
 {
    Edi_Editor *editor;
+   Edi_Content_Large *large;
 
    if (!panel || !panel->current)
      return;
 
+   large = evas_object_data_get(panel->current->view, "large");
+   if (large && row > 0)
+     {
+        edi_content_large_goto(large, row);
+        return;
+     }
+
    editor = (Edi_Editor *)evas_object_data_get(panel->current->view, "editor");
    if (!editor || row <= 0 || col <= 0)
      return;
@@ -852,11 +865,13 @@ edi_mainview_panel_goto_popup_show(Edi_Mainview_Panel *panel)
      return;
 
    editor = evas_object_data_get(panel->current->view, "editor");
-   if (!editor)
+   if (editor)
+     popup = elm_popup_add(editor->entry);
+   else if (evas_object_data_get(panel->current->view, "large"))
+     popup = elm_popup_add(panel->current->container);
+   else
      return;
 
-   popup = elm_popup_add(editor->entry);
-
    _edi_mainview_goto_popup = popup;
    elm_object_part_text_set(popup, "title,text",
                             _("Enter line number"));
@@ -913,7 +928,7 @@ _edi_mainview_panel_tab_stat_done(void *data, Eio_File *handler EINA_UNUSED, con
      return;
 
    mime = edi_mime_type_get(options->path);
-   provider = edi_content_provider_for_mime_get(mime);
+   provider = edi_content_provider_for_file_get(mime, stat->size);
    if (!provider)
      {
         _edi_mainview_panel_mime_content_safe_popup();
@@ -983,7 +998,10 @@ edi_mainview_panel_open(Edi_Mainview_Panel *panel, Edi_Path_Options *options)
    else if (!edi_content_provider_for_id_get(options->type))
      {
         const char *mime = options->type;
-        Edi_Content_Provider *provider = edi_content_provider_for_mime_get(mime);
+        Edi_Content_Provider *provider;
+
+        // Restored tabs open in order, so their size is looked at right away.
+        provider = edi_content_provider_for_file_get(mime, ecore_file_size(options->path));
 
         if (provider)
           options->type = provider->id;
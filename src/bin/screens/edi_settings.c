@@ -10,6 +10,8 @@
 #include "edi_config.h"
 #include "edi_debug.h"
 #include "edi_filepanel.h"
+#include "edi_search_index.h"
+#include "edi_symbol_index.h"
 #include "edi_theme.h"
 
 #include "edi_private.h"
@@ -715,11 +717,27 @@ _edi_settings_project_name_cb(void *data EINA_UNUSED, Evas_Object *obj,
    _edi_settings_scm_credentials_set(_edi_project_config->user_fullname, _edi_project_config->user_email);
 }
 
+static void
+_edi_settings_project_task_tags_cb(void *data EINA_UNUSED, Evas_Object *obj,
+                                   void *event EINA_UNUSED)
+{
+   Evas_Object *entry;
+
+   entry = (Evas_Object *)obj;
+
+   if (_edi_project_config->task_tags)
+     eina_stringshare_del(_edi_project_config->task_tags);
+
+   _edi_project_config->task_tags = eina_stringshare_add(elm_object_text_get(entry));
+   _edi_project_config_save();
+}
+
 static Evas_Object *
 _edi_settings_project_create(Evas_Object *parent)
 {
    Edi_Scm_Engine *engine = NULL;
    Evas_Object *box, *frames, *frame, *table, *label, *entry_name, *entry_email;
+   Evas_Object *entry_tags;
    Evas_Object *entry_remote;
    Eina_Strbuf *text;
    const char *remote_name, *remote_email;
@@ -783,6 +801,24 @@ _edi_settings_project_create(Evas_Object *parent)
    evas_object_smart_callback_add(entry_email, "changed",
                                   _edi_settings_project_email_cb, NULL);
 
+   label = elm_label_add(table);
+   elm_object_text_set(label, _("Task Tags"));
+   evas_object_size_hint_weight_set(label, 0.0, 0.0);
+   evas_object_size_hint_align_set(label, 0.0, EVAS_HINT_FILL);
+   elm_table_pack(table, label, 0, 2, 1, 1);
+   evas_object_show(label);
+
+   entry_tags = elm_entry_add(table);
+   elm_object_text_set(entry_tags, _edi_project_config->task_tags);
+   elm_entry_single_line_set(entry_tags, EINA_TRUE);
+   elm_entry_scrollable_set(entry_tags, EINA_TRUE);
+   evas_object_size_hint_weight_set(entry_tags, 0.75, 0.0);
+   evas_object_size_hint_align_set(entry_tags, EVAS_HINT_FILL, EVAS_HINT_FILL);
+   elm_table_pack(table, entry_tags, 1, 2, 1, 1);
+   evas_object_show(entry_tags);
+   evas_object_smart_callback_add(entry_tags, "changed",
+                                  _edi_settings_project_task_tags_cb, NULL);
+
    if (!edi_scm_enabled())
      return frames;
 
@@ -859,10 +895,55 @@ _edi_settings_behaviour_trim_whitespace_cb(void *data EINA_UNUSED, Evas_Object *
    _edi_config_save();
 }
 
+static void
+_edi_settings_behaviour_search_index_cb(void *data EINA_UNUSED, Evas_Object *obj,
+                                        void *event EINA_UNUSED)
+{
+   Evas_Object *check;
+
+   check = (Evas_Object *)obj;
+   _edi_config->search_index = elm_check_state_get(check);
+   _edi_config_save();
+
+   if (_edi_config->search_index)
+     edi_search_index_init();
+   else
+     edi_search_index_shutdown();
+}
+
+#if HAVE_LIBCLANG
+static void
+_edi_settings_behaviour_symbol_index_cb(void *data EINA_UNUSED, Evas_Object *obj,
+                                        void *event EINA_UNUSED)
+{
+   Evas_Object *check;
+
+   check = (Evas_Object *)obj;
+   _edi_config->symbol_index = elm_check_state_get(check);
+   _edi_config_save();
+
+   if (_edi_config->symbol_index)
+     edi_symbol_index_init();
+   else
+     edi_symbol_index_shutdown();
+}
+#endif
+
+static void
+_edi_settings_behaviour_search_results_max_cb(void *data EINA_UNUSED, Evas_Object *obj,
+                                              void *event EINA_UNUSED)
+{
+   Evas_Object *spinner;
+
+   spinner = (Evas_Object *)obj;
+   _edi_config->search_results_max = (int) elm_spinner_value_get(spinner);
+   _edi_config_save();
+}
+
 static Evas_Object *
 _edi_settings_behaviour_create(Evas_Object *parent)
 {
-   Evas_Object *box, *frame, *check;
+   Evas_Object *box, *frame, *check, *hbox, *label, *spinner;
 
    frame = _edi_settings_panel_create(parent, _("Behaviour"));
    box = elm_object_part_content_get(frame, "default");
@@ -896,6 +977,51 @@ _edi_settings_behaviour_create(Evas_Object *parent)
                                   _edi_settings_behaviour_show_hidden_cb, NULL);
    evas_object_show(check);
 
+   check = elm_check_add(box);
+   elm_object_text_set(check, _("Index project for faster search"));
+   elm_check_state_set(check, _edi_config->search_index);
+   elm_box_pack_end(box, check);
+   evas_object_size_hint_align_set(check, EVAS_HINT_FILL, 0.5);
+   evas_object_smart_callback_add(check, "changed",
+                                  _edi_settings_behaviour_search_index_cb, NULL);
+   evas_object_show(check);
+
+#if HAVE_LIBCLANG
+   check = elm_check_add(box);
+   elm_object_text_set(check, _("Index symbols for code navigation"));
+   elm_check_state_set(check, _edi_config->symbol_index);
+   elm_box_pack_end(box, check);
+   evas_object_size_hint_align_set(check, EVAS_HINT_FILL, 0.5);
+   evas_object_smart_callback_add(check, "changed",
+                                  _edi_settings_behaviour_symbol_index_cb, NULL);
+   evas_object_show(check);
+#endif
+
+   hbox = elm_box_add(box);
+   elm_box_horizontal_set(hbox, EINA_TRUE);
+   elm_box_padding_set(hbox, 5, 0);
+   evas_object_size_hint_align_set(hbox, EVAS_HINT_FILL, 0.5);
+   elm_box_pack_end(box, hbox);
+   evas_object_show(hbox);
+
+   label = elm_label_add(hbox);
+   elm_object_text_set(label, _("Stop searching after (results)"));
+   elm_box_pack_end(hbox, label);
+   evas_object_show(label);
+
+   spinner = elm_spinner_add(hbox);
+   elm_spinner_value_set(spinner, _edi_config->search_results_max);
+   elm_spinner_editable_set(spinner, EINA_TRUE);
+   elm_spinner_step_set(spinner, 1000);
+   elm_spinner_wrap_set(spinner, EINA_FALSE);
+   elm_spinner_min_max_set(spinner, 100, 1000000);
+   evas_object_size_hint_weight_set(spinner, EVAS_HINT_EXPAND, 0.0);
+   evas_object_size_hint_align_set(spinner, EVAS_HINT_FILL, 0.5);
+   evas_object_smart_callback_add(spinner, "changed",
+                                  _edi_settings_behaviour_search_results_max_cb, NULL);
+   elm_box_pack_end(hbox, spinner);
+   evas_object_show(spinner);
+
    return frame;
 }
 
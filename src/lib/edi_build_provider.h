@@ -15,6 +15,7 @@ typedef struct _Edi_Build_Provider
    const char *id;
 
    Eina_Bool (*path_supported_is)(const char *path);
+   /* asked about directories, for build output ignore_patterns cannot match, may be NULL */
    Eina_Bool (*file_hidden_is)(const char *path);
    Eina_Bool (*project_runnable_is)(const char *path);
 
@@ -22,6 +23,9 @@ typedef struct _Edi_Build_Provider
    void (*test)(void);
    void (*run)(const char *path, const char *args);
    void (*clean)(void);
+
+   /* gitignore style patterns for build output, NULL terminated */
+   const char * const *ignore_patterns;
 } Edi_Build_Provider;
 
 /**
@@ -38,18 +38,6 @@ _cargo_project_supported(const char *path)
    return _relative_path_exists(path, "Cargo.toml");
 }
 
-static Eina_Bool
-_cargo_file_hidden_is(const char *file)
-{
-   if (!file || strlen(file) == 0)
-     return EINA_FALSE;
-
-   if (eina_str_has_extension(file, ".o") || !strcmp(ecore_file_file_get(file), "target"))
-     return EINA_TRUE;
-
-   return EINA_FALSE;
-}
-
 static Eina_Bool
 _cargo_project_runnable_is(const char *file EINA_UNUSED)
 {
@@ -84,14 +72,20 @@ _cargo_clean(void)
      edi_exe_notify("edi_clean", "cargo clean");
 }
 
+static const char *_cargo_ignore_patterns[] = {
+   "target/", "*.o",
+   NULL
+};
+
 Edi_Build_Provider _edi_build_provider_cargo =
    {
       "cargo",
       _cargo_project_supported,
-      _cargo_file_hidden_is,
+      NULL,
       _cargo_project_runnable_is,
       _cargo_build,
       _cargo_test,
       _cargo_run,
-      _cargo_clean
+      _cargo_clean,
+      _cargo_ignore_patterns
    };
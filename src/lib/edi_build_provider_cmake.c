@@ -16,27 +16,6 @@ _cmake_project_supported(const char *path)
    return edi_path_relative_exists(path, "CMakeLists.txt");
 }
 
-static Eina_Bool
-_cmake_file_hidden_is(const char *file)
-{
-   if (!file || strlen(file) == 0)
-     return EINA_FALSE;
-
-   if (!strcmp("build", ecore_file_file_get(file)))
-     return EINA_TRUE;
-
-   if (eina_str_has_extension(file, ".o") || eina_str_has_extension(file, ".so") ||
-       eina_str_has_extension(file, ".lo"))
-     return EINA_TRUE;
-   if (eina_str_has_extension(file, ".a") || eina_str_has_extension(file, ".la"))
-     return EINA_TRUE;
-
-   if (!strcmp(ecore_file_file_get(file), "autom4te.cache"))
-     return EINA_TRUE;
-
-   return EINA_FALSE;
-}
-
 static Eina_Bool
 _cmake_project_runnable_is(const char *path)
 {
@@ -103,6 +82,11 @@ _cmake_clean(void)
    edi_exe_notify("edi_clean", "make clean");
 }
 
+static const char *_cmake_ignore_patterns[] = {
+   "build/", "*.o", "*.so", "*.lo", "*.a", "*.la", "autom4te.cache/",
+   NULL
+};
+
 Edi_Build_Provider _edi_build_provider_cmake =
-   {"cmake", _cmake_project_supported, _cmake_file_hidden_is, _cmake_project_runnable_is,
-     _cmake_build, _cmake_test, _cmake_run, _cmake_clean};
+   {"cmake", _cmake_project_supported, NULL, _cmake_project_runnable_is,
+     _cmake_build, _cmake_test, _cmake_run, _cmake_clean, _cmake_ignore_patterns};
@@ -30,19 +30,6 @@ _go_project_supported(const char *path)
    return EINA_FALSE;
 }
 
-static Eina_Bool
-_go_file_hidden_is(const char *file)
-{
-   if (!file || strlen(file) == 0)
-     return EINA_FALSE;
-
-   if (!strcmp(ecore_file_file_get(file), "_obj") || !strcmp(ecore_file_file_get(file), "target") ||
-        eina_str_has_extension(file, ".so"))
-     return EINA_TRUE;
-
-   return EINA_FALSE;
-}
-
 static Eina_Bool
 _go_project_runnable_is(const char *path EINA_UNUSED)
 {
@@ -114,14 +101,20 @@ _go_clean(void)
      edi_exe_notify("edi_clean", "go clean");
 }
 
+static const char *_go_ignore_patterns[] = {
+   "_obj/", "target/", "*.so",
+   NULL
+};
+
 Edi_Build_Provider _edi_build_provider_go =
    {
       "go",
       _go_project_supported,
-      _go_file_hidden_is,
+      NULL,
       _go_project_runnable_is,
       _go_build,
       _go_test,
       _go_run,
-      _go_clean
+      _go_clean,
+      _go_ignore_patterns
    };
@@ -27,24 +27,6 @@ _make_project_supported(const char *path)
           edi_path_relative_exists(path, "autogen.sh");
 }
 
-static Eina_Bool
-_make_file_hidden_is(const char *file)
-{
-   if (!file || strlen(file) == 0)
-     return EINA_FALSE;
-
-   if (eina_str_has_extension(file, ".o") || eina_str_has_extension(file, ".so") ||
-       eina_str_has_extension(file, ".lo"))
-     return EINA_TRUE;
-   if (eina_str_has_extension(file, ".a") || eina_str_has_extension(file, ".la"))
-     return EINA_TRUE;
-
-   if (!strcmp(ecore_file_file_get(file), "autom4te.cache"))
-     return EINA_TRUE;
-
-   return EINA_FALSE;
-}
-
 static Eina_Bool
 _make_project_runnable_is(const char *path)
 {
@@ -174,6 +156,11 @@ _make_clean(void)
    edi_exe_notify("edi_clean", cmd);
 }
 
+static const char *_make_ignore_patterns[] = {
+   "*.o", "*.so", "*.lo", "*.a", "*.la", "autom4te.cache/",
+   NULL
+};
+
 Edi_Build_Provider _edi_build_provider_make =
-   {"make", _make_project_supported, _make_file_hidden_is, _make_project_runnable_is,
-     _make_build, _make_test, _make_run, _make_clean};
+   {"make", _make_project_supported, NULL, _make_project_runnable_is,
+     _make_build, _make_test, _make_run, _make_clean, _make_ignore_patterns};
@@ -51,28 +51,14 @@ _meson_configured_check(const char *dir)
    return EINA_FALSE;
 }
 
+// Build directories can have any name, they are found by their build.ninja.
 static Eina_Bool
 _meson_file_hidden_is(const char *file)
 {
-   size_t k;
-
    if (!file || strlen(file) == 0)
      return EINA_FALSE;
 
-   static const char *hidden_exts[] = {
-      ".o", ".so", ".lo",
-      ".ninja", ".ninja", ".ninja_deps", ".ninja_log",
-      "compile_commands.json", "meson-logs", "meson-private", "@exe"
-   };
-
-   if (ecore_file_is_dir(file) && _meson_configured_check(file))
-     return EINA_TRUE;
-
-   for (k = 0; k < EINA_C_ARRAY_LENGTH(hidden_exts); k++)
-     if (eina_str_has_extension(file, hidden_exts[k]))
-       return EINA_TRUE;
-
-   return EINA_FALSE;
+   return ecore_file_is_dir(file) && _meson_configured_check(file);
 }
 
 static Eina_Bool
@@ -163,7 +149,13 @@ _meson_clean(void)
    _meson_ninja_do(md, "clean");
 }
 
+static const char *_meson_ignore_patterns[] = {
+   "*.o", "*.so", "*.lo", "*.ninja", ".ninja_deps", ".ninja_log",
+   "compile_commands.json", "meson-logs/", "meson-private/", "*@exe/",
+   NULL
+};
+
 Edi_Build_Provider _edi_build_provider_meson =
    {"meson", _meson_project_supported, _meson_file_hidden_is,
     _meson_project_runnable_is, _meson_build, _meson_test,
-    _meson_run, _meson_clean};
+    _meson_run, _meson_clean, _meson_ignore_patterns};
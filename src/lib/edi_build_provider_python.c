@@ -38,18 +38,6 @@ _python_project_supported(const char *path)
    return _relative_path_exists(path, "setup.py");
 }
 
-static Eina_Bool
-_python_file_hidden_is(const char *file)
-{
-   if (!file || strlen(file) == 0)
-     return EINA_FALSE;
-
-   if (eina_str_has_extension(file, ".pyc") || eina_str_has_extension(file, ".pyo"))
-     return EINA_TRUE;
-
-   return EINA_FALSE;
-}
-
 static Eina_Bool
 _python_project_runnable_is(const char *file EINA_UNUSED)
 {
@@ -84,14 +72,20 @@ _python_clean(void)
      edi_exe_notify("edi_clean", "./setup.py clean --all");
 }
 
+static const char *_python_ignore_patterns[] = {
+   "*.pyc", "*.pyo", "__pycache__/",
+   NULL
+};
+
 Edi_Build_Provider _edi_build_provider_python =
    {
       "python",
       _python_project_supported,
-      _python_file_hidden_is,
+      NULL,
       _python_project_runnable_is,
       _python_build,
       _python_test,
       _python_run,
-      _python_clean
+      _python_clean,
+      _python_ignore_patterns
    };
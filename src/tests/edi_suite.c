@@ -18,10 +18,18 @@ static const struct {
   { "basic", edi_test_basic },
   { "path", edi_test_path },
   { "create", edi_test_create },
+  { "editor_edits", edi_test_editor_edits },
   { "exe", edi_test_exe },
   { "content_provider", edi_test_content_provider },
   { "language_provider", edi_test_language_provider },
-  { "language_provider_c", edi_test_language_provider_c }
+  { "language_provider_c", edi_test_language_provider_c },
+  { "ignore", edi_test_ignore },
+  { "lexer", edi_test_lexer },
+  { "line_index", edi_test_line_index },
+  { "lsp", edi_test_lsp },
+  { "regex", edi_test_regex },
+  { "search", edi_test_search },
+  { "symbol_index", edi_test_symbol_index }
 };
 
 START_TEST(edi_initialization)
@@ -9,9 +9,17 @@ void edi_test_basic(TCase *tc);
 void edi_test_console(TCase *tc);
 void edi_test_path(TCase *tc);
 void edi_test_create(TCase *tc);
+void edi_test_editor_edits(TCase *tc);
 void edi_test_exe(TCase *tc);
 void edi_test_content_provider(TCase *tc);
 void edi_test_language_provider(TCase *tc);
 void edi_test_language_provider_c(TCase *tc);
+void edi_test_ignore(TCase *tc);
+void edi_test_lexer(TCase *tc);
+void edi_test_line_index(TCase *tc);
+void edi_test_lsp(TCase *tc);
+void edi_test_regex(TCase *tc);
+void edi_test_search(TCase *tc);
+void edi_test_symbol_index(TCase *tc);
 
 #endif /* _EDI_SUITE_H */
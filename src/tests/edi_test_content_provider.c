@@ -14,6 +14,30 @@ edi_editor_add(Evas_Object *parent EINA_UNUSED, Edi_Mainview_Item *item EINA_UNU
    return NULL;
 }
 
+void
+edi_editor_diagnostics_set(Edi_Editor *editor EINA_UNUSED, Eina_Inarray *diagnostics EINA_UNUSED)
+{
+}
+
+Eina_Bool
+edi_editor_edits_get(Edi_Editor *editor EINA_UNUSED, unsigned int *serial EINA_UNUSED,
+                     Edi_Editor_Edit *edit EINA_UNUSED)
+{
+   return EINA_FALSE;
+}
+
+#if HAVE_LIBCLANG
+void
+edi_editor_clang_unit_set(Edi_Editor *editor EINA_UNUSED, CXTranslationUnit unit EINA_UNUSED)
+{
+}
+
+void
+edi_editor_clang_unit_swap(Edi_Editor *editor EINA_UNUSED)
+{
+}
+#endif
+
 EAPI Evas_Object *
 edi_content_image_add(Evas_Object *parent EINA_UNUSED, Edi_Mainview_Item *item EINA_UNUSED)
 {
@@ -26,6 +50,12 @@ edi_content_diff_add(Evas_Object *parent EINA_UNUSED, Edi_Mainview_Item *item EI
    return NULL;
 }
 
+EAPI Evas_Object *
+edi_content_large_add(Evas_Object *parent EINA_UNUSED, Edi_Mainview_Item *item EINA_UNUSED)
+{
+   return NULL;
+}
+
 Edi_Config *_edi_config = NULL;
 Edi_Project_Config *_edi_project_config = NULL;
 int EDI_EVENT_CONFIG_CHANGED;
@@ -83,6 +113,26 @@ START_TEST (edi_test_content_provider_c_files)
    _edi_test_content_provider_type_assert("text/x-chdr", "code");
 }
 END_TEST
+
+START_TEST (edi_test_content_provider_large_files)
+{
+   Edi_Content_Provider *provider;
+
+   provider = edi_content_provider_for_file_get("text/plain", 4096);
+   ck_assert(provider);
+   ck_assert_str_eq(provider->id, "text");
+
+   provider = edi_content_provider_for_file_get("text/x-csrc", 1ULL << 32);
+   ck_assert(provider);
+   ck_assert_str_eq(provider->id, "large");
+   ck_assert(!provider->is_editable);
+
+   provider = edi_content_provider_for_file_get("image/png", 1ULL << 32);
+   ck_assert(provider);
+   ck_assert_str_eq(provider->id, "image");
+}
+END_TEST
+
 /*
 START_TEST (edi_test_content_provider_cpp_files)
 {
@@ -97,6 +147,7 @@ void edi_test_content_provider(TCase *tc)
    tcase_add_test(tc, edi_test_content_provider_mime_lookup);
    tcase_add_test(tc, edi_test_content_provider_text_files);
    tcase_add_test(tc, edi_test_content_provider_c_files);
+   tcase_add_test(tc, edi_test_content_provider_large_files);
 //   tcase_add_test(tc, edi_test_content_provider_cpp_files);
 }
 
@@ -0,0 +1,176 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "editor/edi_editor_edits.c"
+
+#include "edi_suite.h"
+
+static void
+_edi_test_editor_edit_check(const Edi_Editor_Edit *edit, unsigned int first,
+                            unsigned int removed, unsigned int added)
+{
+   ck_assert_int_eq(edit->first, first);
+   ck_assert_int_eq(edit->removed, removed);
+   ck_assert_int_eq(edit->added, added);
+}
+
+START_TEST (edi_test_editor_edits_insert)
+{
+   Edi_Editor_Edits *edits;
+   Edi_Editor_Edit edit;
+   unsigned int serial = 0;
+
+   edits = edi_editor_edits_new(10);
+   ck_assert(!edi_editor_edits_since_get(edits, &serial, &edit));
+
+   // Breaking line 3 adds the line after it, then changes it.
+   edi_editor_edits_line_changed(edits, 4, 11);
+   edi_editor_edits_line_changed(edits, 3, 11);
+   edi_editor_edits_log(edits, 11);
+
+   ck_assert(edi_editor_edits_since_get(edits, &serial, &edit));
+   _edi_test_editor_edit_check(&edit, 3, 1, 2);
+
+   edi_editor_edits_line_changed(edits, 6, 11);
+   edi_editor_edits_line_changed(edits, 7, 12);
+   edi_editor_edits_log(edits, 12);
+
+   ck_assert(edi_editor_edits_since_get(edits, &serial, &edit));
+   _edi_test_editor_edit_check(&edit, 6, 1, 2);
+
+   // Nothing changed since.
+   ck_assert(edi_editor_edits_since_get(edits, &serial, &edit));
+   _edi_test_editor_edit_check(&edit, 0, 0, 0);
+
+   edi_editor_edits_free(edits);
+}
+END_TEST
+
+START_TEST (edi_test_editor_edits_delete)
+{
+   Edi_Editor_Edits *edits;
+   Edi_Editor_Edit edit;
+   unsigned int serial = 0;
+
+   edits = edi_editor_edits_new(10);
+   ck_assert(!edi_editor_edits_since_get(edits, &serial, &edit));
+
+   // Joining line 7 to line 6 changes it and removes the other.
+   edi_editor_edits_line_changed(edits, 6, 9);
+   edi_editor_edits_log(edits, 9);
+
+   ck_assert(edi_editor_edits_since_get(edits, &serial, &edit));
+   _edi_test_editor_edit_check(&edit, 6, 2, 1);
+
+   // Lines removed without any changing are not known, the whole file is.
+   edi_editor_edits_log(edits, 8);
+   ck_assert(!edi_editor_edits_since_get(edits, &serial, &edit));
+
+   edi_editor_edits_free(edits);
+}
+END_TEST
+
+START_TEST (edi_test_editor_edits_merge)
+{
+   Edi_Editor_Edits *edits;
+   Edi_Editor_Edit edit;
+   unsigned int serial = 0, start, middle;
+
+   edits = edi_editor_edits_new(10);
+   edi_editor_edits_since_get(edits, &serial, &edit);
+   start = serial;
+
+   edi_editor_edits_line_changed(edits, 2, 10);
+   edi_editor_edits_log(edits, 10);
+   middle = start + 1;
+   edi_editor_edits_line_changed(edits, 5, 10);
+   edi_editor_edits_log(edits, 10);
+
+   // The lines between both edits are given again.
+   serial = start;
+   ck_assert(edi_editor_edits_since_get(edits, &serial, &edit));
+   _edi_test_editor_edit_check(&edit, 2, 4, 4);
+
+   serial = middle;
+   ck_assert(edi_editor_edits_since_get(edits, &serial, &edit));
+   _edi_test_editor_edit_check(&edit, 5, 1, 1);
+
+   edi_editor_edits_free(edits);
+}
+END_TEST
+
+START_TEST (edi_test_editor_edits_merge_above)
+{
+   Edi_Editor_Edits *edits;
+   Edi_Editor_Edit edit;
+   unsigned int serial = 0, start;
+
+   edits = edi_editor_edits_new(10);
+   edi_editor_edits_since_get(edits, &serial, &edit);
+   start = serial;
+
+   // A line is added after line 8, then line 3 is joined to line 2.
+   edi_editor_edits_line_changed(edits, 9, 11);
+   edi_editor_edits_line_changed(edits, 8, 11);
+   edi_editor_edits_log(edits, 11);
+   edi_editor_edits_line_changed(edits, 2, 10);
+   edi_editor_edits_log(edits, 10);
+
+   // Lines 2 to 8 became lines 2 to 8 again, whatever moved between.
+   ck_assert(edi_editor_edits_since_get(edits, &serial, &edit));
+   _edi_test_editor_edit_check(&edit, 2, 7, 7);
+
+   // Once reset the edits before are not known.
+   edi_editor_edits_reset(edits, 10);
+   serial = start;
+   ck_assert(!edi_editor_edits_since_get(edits, &serial, &edit));
+
+   // A line is added after line 2, then the line below is joined to line 7.
+   edi_editor_edits_line_changed(edits, 3, 11);
+   edi_editor_edits_line_changed(edits, 2, 11);
+   edi_editor_edits_log(edits, 11);
+   edi_editor_edits_line_changed(edits, 7, 10);
+   edi_editor_edits_log(edits, 10);
+
+   ck_assert(edi_editor_edits_since_get(edits, &serial, &edit));
+   _edi_test_editor_edit_check(&edit, 2, 6, 6);
+
+   edi_editor_edits_free(edits);
+}
+END_TEST
+
+START_TEST (edi_test_editor_edits_forgotten)
+{
+   Edi_Editor_Edits *edits;
+   Edi_Editor_Edit edit;
+   unsigned int serial = 0, start, i;
+
+   edits = edi_editor_edits_new(10);
+   edi_editor_edits_since_get(edits, &serial, &edit);
+   start = serial;
+
+   for (i = 0; i <= EDI_EDITOR_EDITS_MAX; i++)
+     {
+        edi_editor_edits_line_changed(edits, 1, 10);
+        edi_editor_edits_log(edits, 10);
+     }
+
+   serial = start;
+   ck_assert(!edi_editor_edits_since_get(edits, &serial, &edit));
+   serial = start + 1;
+   ck_assert(edi_editor_edits_since_get(edits, &serial, &edit));
+   _edi_test_editor_edit_check(&edit, 1, 1, 1);
+
+   edi_editor_edits_free(edits);
+}
+END_TEST
+
+void edi_test_editor_edits(TCase *tc)
+{
+   tcase_add_test(tc, edi_test_editor_edits_insert);
+   tcase_add_test(tc, edi_test_editor_edits_delete);
+   tcase_add_test(tc, edi_test_editor_edits_merge);
+   tcase_add_test(tc, edi_test_editor_edits_merge_above);
+   tcase_add_test(tc, edi_test_editor_edits_forgotten);
+}
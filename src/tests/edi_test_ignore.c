@@ -0,0 +1,142 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "edi_ignore.c"
+
+#include "edi_suite.h"
+
+static void
+_edi_test_ignore_write(const char *directory, const char *name, const char *content)
+{
+   char *path;
+   FILE *f;
+
+   path = edi_path_append(directory, name);
+   if (content)
+     {
+        f = fopen(path, "w");
+        ck_assert(f);
+        fputs(content, f);
+        fclose(f);
+     }
+   else
+     ck_assert(ecore_file_mkpath(path));
+   free(path);
+}
+
+static Eina_Bool
+_edi_test_ignore_path(const char *directory, const char *name)
+{
+   char *path;
+   Eina_Bool ignored;
+
+   path = edi_path_append(directory, name);
+   ignored = edi_ignore_path_ignored(path, EINA_FILE_UNKNOWN);
+   free(path);
+
+   return ignored;
+}
+
+static void
+_edi_test_ignore_walk_cb(void *data, const char *path)
+{
+   int *count = data;
+
+   ck_assert(!strstr(path, "/build/"));
+   ck_assert(!strstr(path, ".o"));
+   (*count)++;
+}
+
+START_TEST (edi_test_ignore_glob)
+{
+   ck_assert(_edi_ignore_glob("*.o", "main.o"));
+   ck_assert(!_edi_ignore_glob("*.o", "main.c"));
+   ck_assert(!_edi_ignore_glob("*.o", "src/main.o"));
+   ck_assert(_edi_ignore_glob("src/*.o", "src/main.o"));
+   ck_assert(_edi_ignore_glob("ma?n.[co]", "main.c"));
+   ck_assert(!_edi_ignore_glob("main.[!co]", "main.c"));
+   ck_assert(_edi_ignore_glob("[a-c]x", "bx"));
+   ck_assert(_edi_ignore_glob("**/build", "build"));
+   ck_assert(_edi_ignore_glob("**/build", "a/b/build"));
+   ck_assert(_edi_ignore_glob("doc/**", "doc/html/index.html"));
+   ck_assert(!_edi_ignore_glob("doc/**", "doc"));
+   ck_assert(_edi_ignore_glob("a/**/z", "a/z"));
+   ck_assert(_edi_ignore_glob("a/**/z", "a/b/c/z"));
+   ck_assert(_edi_ignore_glob("\\*", "*"));
+   ck_assert(!_edi_ignore_glob("\\*", "a"));
+}
+END_TEST
+
+START_TEST (edi_test_ignore_rules)
+{
+   Edi_Ignore_Rules rules;
+
+   memset(&rules, 0, sizeof(Edi_Ignore_Rules));
+   _edi_ignore_rules_add(&rules, "# comment", 9);
+   _edi_ignore_rules_add(&rules, "", 0);
+   _edi_ignore_rules_add(&rules, "*.log", 5);
+   _edi_ignore_rules_add(&rules, "!keep.log", 9);
+   _edi_ignore_rules_add(&rules, "out/", 4);
+   _edi_ignore_rules_add(&rules, "/root.txt  ", 11);
+   ck_assert_int_eq(rules.count, 4);
+
+   ck_assert_int_eq(_edi_ignore_rules_match(&rules, "a/x.log", "x.log", EINA_FALSE), 1);
+   ck_assert_int_eq(_edi_ignore_rules_match(&rules, "a/keep.log", "keep.log", EINA_FALSE), 0);
+   ck_assert_int_eq(_edi_ignore_rules_match(&rules, "a/out", "out", EINA_TRUE), 1);
+   ck_assert_int_eq(_edi_ignore_rules_match(&rules, "a/out", "out", EINA_FALSE), -1);
+   ck_assert_int_eq(_edi_ignore_rules_match(&rules, "root.txt", "root.txt", EINA_FALSE), 1);
+   ck_assert_int_eq(_edi_ignore_rules_match(&rules, "a/root.txt", "root.txt", EINA_FALSE), -1);
+
+   _edi_ignore_rules_clear(&rules);
+}
+END_TEST
+
+START_TEST (edi_test_ignore_project)
+{
+   char template[] = "/tmp/edi_test_ignore_XXXXXX";
+   const char *directory;
+   int count = 0;
+
+   ck_assert(mkdtemp(template));
+   ck_assert(edi_project_set(template));
+   directory = edi_project_get();
+   edi_ignore_init();
+
+   _edi_test_ignore_write(directory, ".gitignore", "*.o\nbuild/\n!src/keep.o\n");
+   _edi_test_ignore_write(directory, "src/lib", NULL);
+   _edi_test_ignore_write(directory, "build/sub", NULL);
+   _edi_test_ignore_write(directory, "src/main.c", "");
+   _edi_test_ignore_write(directory, "src/main.o", "");
+   _edi_test_ignore_write(directory, "src/lib/.ignore", "generated.c\n");
+   _edi_test_ignore_write(directory, "src/lib/generated.c", "");
+   _edi_test_ignore_write(directory, "src/lib/lib.c", "");
+   _edi_test_ignore_write(directory, "build/sub/file.c", "");
+
+   ck_assert(!_edi_test_ignore_path(directory, "src/main.c"));
+   ck_assert(_edi_test_ignore_path(directory, "src/main.o"));
+   ck_assert(!_edi_test_ignore_path(directory, "src/keep.o"));
+   ck_assert(_edi_test_ignore_path(directory, "build/sub/file.c"));
+   ck_assert(_edi_test_ignore_path(directory, "src/lib/generated.c"));
+   ck_assert(!_edi_test_ignore_path(directory, "src/lib/lib.c"));
+   ck_assert(_edi_test_ignore_path(directory, ".gitignore"));
+
+   edi_ignore_walk(directory, NULL, _edi_test_ignore_walk_cb, &count);
+   ck_assert_int_eq(count, 2);
+
+   // The project itself, src and src/lib.
+   count = 0;
+   edi_ignore_directories_walk(directory, NULL, _edi_test_ignore_walk_cb, &count);
+   ck_assert_int_eq(count, 3);
+
+   edi_ignore_shutdown();
+   ecore_file_recursive_rm(directory);
+}
+END_TEST
+
+void edi_test_ignore(TCase *tc)
+{
+   tcase_add_test(tc, edi_test_ignore_glob);
+   tcase_add_test(tc, edi_test_ignore_rules);
+   tcase_add_test(tc, edi_test_ignore_project);
+}
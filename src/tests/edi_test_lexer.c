@@ -0,0 +1,147 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "edi_lexer.c"
+
+#include "edi_suite.h"
+
+#define EDI_TEST_LEXER_LINES 100000
+
+typedef struct
+{
+   char tokens[256];
+} Edi_Test_Lexer_Run;
+
+static const char *_edi_test_lexer_c[] =
+{
+   "static int",
+   "handler(int request) /* handle",
+   "   the request */",
+   "{",
+   "   return request + 42; // fast path",
+   "}"
+};
+
+static void
+_edi_test_lexer_token_cb(void *data, unsigned int start, unsigned int end, Elm_Code_Token_Type type)
+{
+   Edi_Test_Lexer_Run *run = data;
+   size_t length = strlen(run->tokens);
+   char kind;
+
+   switch (type)
+     {
+      case ELM_CODE_TOKEN_TYPE_COMMENT: kind = 'c'; break;
+      case ELM_CODE_TOKEN_TYPE_STRING: kind = 's'; break;
+      case ELM_CODE_TOKEN_TYPE_NUMBER: kind = 'n'; break;
+      case ELM_CODE_TOKEN_TYPE_KEYWORD: kind = 'k'; break;
+      case ELM_CODE_TOKEN_TYPE_TYPE: kind = 't'; break;
+      case ELM_CODE_TOKEN_TYPE_FUNCTION: kind = 'f'; break;
+      case ELM_CODE_TOKEN_TYPE_PREPROCESSOR: kind = 'p'; break;
+      default: kind = '?'; break;
+     }
+
+   snprintf(run->tokens + length, sizeof(run->tokens) - length, "%u-%u%c ", start, end, kind);
+}
+
+static Edi_Lexer_State
+_edi_test_lexer_line_lex(const Edi_Lexer *lexer, Edi_Lexer_State state, const char *text,
+                         Edi_Test_Lexer_Run *run)
+{
+   run->tokens[0] = '\0';
+
+   return edi_lexer_line_lex(lexer, state, text, strlen(text), _edi_test_lexer_token_cb, run);
+}
+
+START_TEST (edi_test_lexer_tables)
+{
+   Edi_Lexer *lexer;
+   unsigned int i;
+
+   // Keywords are looked up by bisection.
+   for (lexer = _edi_lexers; lexer->name; lexer++)
+     {
+        for (i = 0; lexer->keywords && lexer->keywords[i] && lexer->keywords[i + 1]; i++)
+          ck_assert(strcmp(lexer->keywords[i], lexer->keywords[i + 1]) < 0);
+        for (i = 0; lexer->types && lexer->types[i] && lexer->types[i + 1]; i++)
+          ck_assert(strcmp(lexer->types[i], lexer->types[i + 1]) < 0);
+     }
+
+   ck_assert_str_eq(edi_lexer_name_get(edi_lexer_get("text/x-python", NULL)), "python");
+   ck_assert_str_eq(edi_lexer_name_get(edi_lexer_get("text/plain", "/src/meson.build")), "meson");
+   ck_assert_str_eq(edi_lexer_name_get(edi_lexer_get(NULL, "/src/main.rs")), "rust");
+   ck_assert(!edi_lexer_get("text/plain", "/src/README"));
+}
+END_TEST
+
+START_TEST (edi_test_lexer_lines)
+{
+   const Edi_Lexer *lexer;
+   Edi_Test_Lexer_Run run;
+   Edi_Lexer_State state;
+
+   lexer = edi_lexer_get("text/x-python", NULL);
+   state = _edi_test_lexer_line_lex(lexer, 0, "def f(x): return 'a\\'b' # c", &run);
+   ck_assert_int_eq(state, 0);
+   ck_assert_str_eq(run.tokens, "0-2k 4-4f 10-15k 17-22s 24-26c ");
+
+   // A string going on over lines.
+   state = _edi_test_lexer_line_lex(lexer, 0, "x = \"\"\"a", &run);
+   ck_assert_int_ne(state, 0);
+   state = _edi_test_lexer_line_lex(lexer, state, "if 'b'", &run);
+   ck_assert_int_ne(state, 0);
+   ck_assert_str_eq(run.tokens, "0-5s ");
+   state = _edi_test_lexer_line_lex(lexer, state, "c\"\"\" + 1.5", &run);
+   ck_assert_int_eq(state, 0);
+   ck_assert_str_eq(run.tokens, "0-3s 7-9n ");
+
+   // Shell comments have to start a word.
+   lexer = edi_lexer_get("application/x-shellscript", NULL);
+   _edi_test_lexer_line_lex(lexer, 0, "echo ${#x} # c", &run);
+   ck_assert_str_eq(run.tokens, "11-13c ");
+}
+END_TEST
+
+START_TEST (edi_test_lexer_large)
+{
+   const Edi_Lexer *lexer;
+   Edi_Test_Lexer_Run run;
+   Edi_Lexer_State *states, state = 0;
+   const char *text;
+   unsigned int i, lexed;
+
+   lexer = edi_lexer_get("text/x-csrc", NULL);
+   states = malloc(EDI_TEST_LEXER_LINES * sizeof(Edi_Lexer_State));
+   for (i = 0; i < EDI_TEST_LEXER_LINES; i++)
+     {
+        text = _edi_test_lexer_c[i % EINA_C_ARRAY_LENGTH(_edi_test_lexer_c)];
+        state = states[i] = _edi_test_lexer_line_lex(lexer, state, text, &run);
+     }
+   ck_assert_int_eq(state, 0);
+   ck_assert_int_ne(states[7], 0);
+
+   // Editing the code of a line leaves the state of the lines after it.
+   state = _edi_test_lexer_line_lex(lexer, states[9], "   return 0;", &run);
+   ck_assert_int_eq(state, states[10]);
+
+   // Opening a comment changes the state of the lines after it, up to the
+   // next line that was in a comment already.
+   state = _edi_test_lexer_line_lex(lexer, states[8], "{ /* opened", &run);
+   for (i = 10, lexed = 1; i < EDI_TEST_LEXER_LINES && state != states[i - 1]; i++, lexed++)
+     {
+        text = _edi_test_lexer_c[i % EINA_C_ARRAY_LENGTH(_edi_test_lexer_c)];
+        state = _edi_test_lexer_line_lex(lexer, state, text, &run);
+     }
+   ck_assert_int_eq(lexed, 5);
+
+   free(states);
+}
+END_TEST
+
+void edi_test_lexer(TCase *tc)
+{
+   tcase_add_test(tc, edi_test_lexer_tables);
+   tcase_add_test(tc, edi_test_lexer_lines);
+   tcase_add_test(tc, edi_test_lexer_large);
+}
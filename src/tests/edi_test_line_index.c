@@ -0,0 +1,144 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "edi_line_index.c"
+
+#include "edi_suite.h"
+
+// More than the starts found in a batch, so the index grows while it is read.
+#define EDI_TEST_LINE_INDEX_LINES 300000
+
+static void
+_edi_test_line_index_cb(void *data, Edi_Line_Index *index)
+{
+   Eina_Bool *done = data;
+
+   if (!edi_line_index_done_get(index))
+     return;
+
+   *done = EINA_TRUE;
+   ecore_main_loop_quit();
+}
+
+static Eina_Bool
+_edi_test_line_index_timeout_cb(void *data EINA_UNUSED)
+{
+   ecore_main_loop_quit();
+
+   return ECORE_CALLBACK_CANCEL;
+}
+
+typedef struct
+{
+   Eina_Bool found;
+   unsigned int line, col;
+} Edi_Test_Line_Index_Found;
+
+static void
+_edi_test_line_index_found_cb(void *data, Edi_Line_Index *index EINA_UNUSED, Eina_Bool found,
+                              unsigned int line, unsigned int col)
+{
+   Edi_Test_Line_Index_Found *result = data;
+
+   result->found = found;
+   result->line = line;
+   result->col = col;
+   ecore_main_loop_quit();
+}
+
+static void
+_edi_test_line_index_line_check(Edi_Line_Index *index, unsigned int number, const char *expected)
+{
+   const char *text;
+   unsigned int length;
+
+   text = edi_line_index_line_get(index, number, &length);
+   ck_assert(text);
+   ck_assert_int_eq(length, strlen(expected));
+   ck_assert(!strncmp(text, expected, length));
+}
+
+START_TEST (edi_test_line_index_file)
+{
+   Edi_Line_Index *index;
+   Ecore_Timer *timeout;
+   Eina_Tmpstr *path;
+   Edi_Test_Line_Index_Found result;
+   Eina_Bool done = EINA_FALSE;
+   unsigned int i, line, col, length;
+   FILE *file;
+   int fd;
+
+   ecore_init();
+
+   // Every seventh line ends in CRLF, the last has no newline.
+   fd = eina_file_mkstemp("edi_test_line_index_XXXXXX", &path);
+   ck_assert(fd >= 0);
+   file = fdopen(fd, "w");
+   for (i = 1; i < EDI_TEST_LINE_INDEX_LINES; i++)
+     fprintf(file, "line %u%s", i, i % 7 ? "\n" : "\r\n");
+   fprintf(file, "end");
+   fclose(file);
+
+   index = edi_line_index_new(path, _edi_test_line_index_cb, &done);
+   ck_assert(index);
+
+   timeout = ecore_timer_add(10.0, _edi_test_line_index_timeout_cb, NULL);
+   ecore_main_loop_begin();
+   ecore_timer_del(timeout);
+
+   ck_assert(done);
+   ck_assert_int_eq(edi_line_index_lines_get(index), EDI_TEST_LINE_INDEX_LINES);
+
+   _edi_test_line_index_line_check(index, 1, "line 1");
+   _edi_test_line_index_line_check(index, 7, "line 7");
+   _edi_test_line_index_line_check(index, 64, "line 64");
+   _edi_test_line_index_line_check(index, 65, "line 65");
+   _edi_test_line_index_line_check(index, 262145, "line 262145");
+   _edi_test_line_index_line_check(index, EDI_TEST_LINE_INDEX_LINES, "end");
+   ck_assert(!edi_line_index_line_get(index, 0, &length));
+   ck_assert(!edi_line_index_line_get(index, EDI_TEST_LINE_INDEX_LINES + 1, &length));
+
+   // Matches are found from the position given, and after it.
+   line = 1;
+   col = 1;
+   ck_assert(edi_line_index_find(index, "line 77", &line, &col));
+   ck_assert_int_eq(line, 77);
+   ck_assert_int_eq(col, 1);
+   col++;
+   ck_assert(edi_line_index_find(index, "line 77", &line, &col));
+   ck_assert_int_eq(line, 770);
+   ck_assert_int_eq(col, 1);
+
+   ck_assert(edi_line_index_find(index, "end", &line, &col));
+   ck_assert_int_eq(line, EDI_TEST_LINE_INDEX_LINES);
+   ck_assert_int_eq(col, 1);
+   col = 2;
+   ck_assert(!edi_line_index_find(index, "end", &line, &col));
+
+   // On a thread the find starts again from the top when nothing is found after.
+   memset(&result, 0, sizeof(Edi_Test_Line_Index_Found));
+   ck_assert(edi_line_index_find_async(index, "line 77", line, col,
+                                       _edi_test_line_index_found_cb, &result));
+   ck_assert(!edi_line_index_find_async(index, "line 77", 1, 1,
+                                        _edi_test_line_index_found_cb, &result));
+   timeout = ecore_timer_add(10.0, _edi_test_line_index_timeout_cb, NULL);
+   ecore_main_loop_begin();
+   ecore_timer_del(timeout);
+
+   ck_assert(result.found);
+   ck_assert_int_eq(result.line, 77);
+   ck_assert_int_eq(result.col, 1);
+
+   edi_line_index_free(index);
+   unlink(path);
+   eina_tmpstr_del(path);
+   ecore_shutdown();
+}
+END_TEST
+
+void edi_test_line_index(TCase *tc)
+{
+   tcase_add_test(tc, edi_test_line_index_file);
+}
@@ -0,0 +1,219 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "language/edi_lsp.c"
+
+#include "edi_suite.h"
+
+typedef struct
+{
+   unsigned int completions;
+   Eina_Bool slow_answered;
+   Eina_Bool notified;
+} Edi_Test_Lsp_Run;
+
+START_TEST (edi_test_lsp_json_parse)
+{
+   const char *text = "{\"a\": [1, -2.5e1, true, null, \"x\\u00e9\\ud83d\\ude00\\n\"], \"b\": {\"c\": {\"d\": 42}}}";
+   Edi_Lsp_Json *json;
+   const Edi_Lsp_Json *array;
+
+   json = edi_lsp_json_parse(text, strlen(text));
+   ck_assert(json);
+
+   ck_assert(edi_lsp_json_number_get(json, "b.c.d", 0) == 42);
+   ck_assert(!edi_lsp_json_get(json, "b.c.e"));
+   ck_assert(!edi_lsp_json_get(json, "b.cc"));
+
+   array = edi_lsp_json_get(json, "a");
+   ck_assert(array && array->type == EDI_LSP_JSON_ARRAY);
+   ck_assert_int_eq(eina_list_count(array->value.children), 5);
+   ck_assert(((Edi_Lsp_Json *) eina_list_nth(array->value.children, 1))->value.number == -25);
+   ck_assert(((Edi_Lsp_Json *) eina_list_nth(array->value.children, 3))->type == EDI_LSP_JSON_NULL);
+   ck_assert_str_eq(((Edi_Lsp_Json *) eina_list_nth(array->value.children, 4))->value.string,
+                    "x\xc3\xa9\xf0\x9f\x98\x80\n");
+   edi_lsp_json_free(json);
+
+   ck_assert(!edi_lsp_json_parse("{\"a\":}", 6));
+   ck_assert(!edi_lsp_json_parse("[1,]", 4));
+   ck_assert(!edi_lsp_json_parse("[1] x", 5));
+   ck_assert(!edi_lsp_json_parse("\"abc", 4));
+}
+END_TEST
+
+START_TEST (edi_test_lsp_parser_stream)
+{
+   const char *stream = "Content-Length: 14\r\n\r\n{\"id\":1,\"a\":2}"
+                        "content-length: 8\r\nContent-Type: x\r\n\r\n{\"id\":2}"
+                        "Content-Length: 3\r\n\r\nbad"
+                        "Content-Length: 8\r\n\r\n{\"id\":3}";
+   Edi_Lsp_Parser *parser;
+   Edi_Lsp_Json *message;
+   unsigned int i, count = 0;
+
+   // Messages arrive cut anywhere, here one byte at a time.
+   parser = edi_lsp_parser_new();
+   for (i = 0; i < strlen(stream); i++)
+     {
+        edi_lsp_parser_feed(parser, stream + i, 1);
+        while ((message = edi_lsp_parser_next(parser)))
+          {
+             count++;
+             ck_assert_int_eq(edi_lsp_json_number_get(message, "id", 0), count);
+             edi_lsp_json_free(message);
+          }
+     }
+   ck_assert_int_eq(count, 3);
+
+   // Or several at once.
+   edi_lsp_parser_feed(parser, stream, strlen(stream));
+   for (count = 0; (message = edi_lsp_parser_next(parser)); count++)
+     edi_lsp_json_free(message);
+   ck_assert_int_eq(count, 3);
+
+   edi_lsp_parser_free(parser);
+}
+END_TEST
+
+static void
+_edi_test_lsp_notification_cb(void *data, Edi_Lsp_Client *client EINA_UNUSED,
+                              const char *method, const Edi_Lsp_Json *params)
+{
+   Edi_Test_Lsp_Run *run = data;
+
+   if (!strcmp(method, "window/logMessage"))
+     run->notified = !strcmp(edi_lsp_json_string_get(params, "message"), "ready");
+}
+
+static void
+_edi_test_lsp_slow_cb(void *data, Edi_Lsp_Client *client EINA_UNUSED,
+                      const Edi_Lsp_Json *result EINA_UNUSED, const Edi_Lsp_Json *error EINA_UNUSED)
+{
+   Edi_Test_Lsp_Run *run = data;
+
+   run->slow_answered = EINA_TRUE;
+}
+
+static void
+_edi_test_lsp_completion_cb(void *data, Edi_Lsp_Client *client EINA_UNUSED,
+                            const Edi_Lsp_Json *result, const Edi_Lsp_Json *error)
+{
+   Edi_Test_Lsp_Run *run = data;
+   const Edi_Lsp_Json *items;
+
+   ck_assert(!error);
+   items = edi_lsp_json_get(result, "items");
+   ck_assert(items && items->type == EDI_LSP_JSON_ARRAY);
+   run->completions = eina_list_count(items->value.children);
+
+   ecore_main_loop_quit();
+}
+
+static Eina_Bool
+_edi_test_lsp_timeout_cb(void *data EINA_UNUSED)
+{
+   ecore_main_loop_quit();
+
+   return ECORE_CALLBACK_CANCEL;
+}
+
+START_TEST (edi_test_lsp_client_request)
+{
+   Edi_Test_Lsp_Run run = { 0, EINA_FALSE, EINA_FALSE };
+   Edi_Lsp_Client *client;
+   const Edi_Lsp_Latency *latency;
+   Ecore_Timer *timeout;
+   unsigned int slow;
+   double start;
+
+   ecore_init();
+
+   client = edi_lsp_client_new("sh " PACKAGE_TESTS_DIR "edi_test_lsp_server.sh",
+                               eina_environment_tmp_get(), _edi_test_lsp_notification_cb, &run);
+   ck_assert(client);
+   ck_assert_int_eq(edi_lsp_client_text_sync_get(client), EDI_LSP_TEXT_SYNC_FULL);
+
+   slow = edi_lsp_client_request(client, "test/slow", "{}", _edi_test_lsp_slow_cb, &run);
+   ck_assert(slow);
+   edi_lsp_client_cancel(client, slow);
+
+   ck_assert(edi_lsp_client_request(client, "textDocument/completion", "{}",
+                                    _edi_test_lsp_completion_cb, &run));
+
+   timeout = ecore_timer_add(10.0, _edi_test_lsp_timeout_cb, NULL);
+   ecore_main_loop_begin();
+   ecore_timer_del(timeout);
+
+   ck_assert_int_eq(run.completions, 2);
+   ck_assert(run.notified);
+   ck_assert(!run.slow_answered);
+   ck_assert_int_eq(edi_lsp_client_text_sync_get(client), EDI_LSP_TEXT_SYNC_INCREMENTAL);
+
+   latency = edi_lsp_client_latency_get(client, "textDocument/completion");
+   ck_assert(latency && latency->count == 1 && latency->total >= 0);
+   latency = edi_lsp_client_latency_get(client, "test/slow");
+   ck_assert(latency && latency->count == 0 && latency->cancelled == 1);
+
+   // Asked to shut down, the server exits without having to be stopped.
+   start = ecore_time_get();
+   edi_lsp_client_free(client);
+   edi_lsp_shutdown();
+   ck_assert(!_edi_lsp_clients);
+   ck_assert(ecore_time_get() - start < EDI_LSP_SHUTDOWN_TIMEOUT);
+
+   ecore_shutdown();
+}
+END_TEST
+
+static void
+_edi_test_lsp_failed_cb(void *data, Edi_Lsp_Client *client EINA_UNUSED,
+                        const Edi_Lsp_Json *result, const Edi_Lsp_Json *error)
+{
+   Eina_Bool *failed = data;
+
+   ck_assert(!result);
+   *failed = error && !strcmp(edi_lsp_json_string_get(error, "message"), "broken");
+
+   ecore_main_loop_quit();
+}
+
+START_TEST (edi_test_lsp_client_initialize_error)
+{
+   Edi_Lsp_Client *client;
+   Ecore_Timer *timeout;
+   Eina_Bool failed = EINA_FALSE;
+
+   ecore_init();
+
+   client = edi_lsp_client_new("sh " PACKAGE_TESTS_DIR "edi_test_lsp_server.sh fail",
+                               eina_environment_tmp_get(), NULL, NULL);
+   ck_assert(client);
+
+   // Requests waiting for the server to be initialized fail with it.
+   ck_assert(edi_lsp_client_request(client, "textDocument/completion", "{}",
+                                    _edi_test_lsp_failed_cb, &failed));
+
+   timeout = ecore_timer_add(10.0, _edi_test_lsp_timeout_cb, NULL);
+   ecore_main_loop_begin();
+   ecore_timer_del(timeout);
+
+   ck_assert(failed);
+   ck_assert(!edi_lsp_client_running_get(client));
+   ck_assert(!edi_lsp_client_request(client, "textDocument/completion", "{}", NULL, NULL));
+
+   edi_lsp_client_free(client);
+   edi_lsp_shutdown();
+   ck_assert(!_edi_lsp_clients);
+
+   ecore_shutdown();
+}
+END_TEST
+
+void edi_test_lsp(TCase *tc)
+{
+   tcase_add_test(tc, edi_test_lsp_json_parse);
+   tcase_add_test(tc, edi_test_lsp_parser_stream);
+   tcase_add_test(tc, edi_test_lsp_client_request);
+   tcase_add_test(tc, edi_test_lsp_client_initialize_error);
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+# A language server answering the requests of the LSP tests with canned results.
+# "test/slow" requests are never answered, so they can be cancelled.
+# Run with "fail" it does not initialize.
+
+reply()
+{
+   printf 'Content-Length: %d\r\n\r\n%s' "${#1}" "$1"
+}
+
+length=0
+while IFS= read -r header; do
+   header=$(printf '%s' "$header" | tr -d '\r')
+   case "$header" in
+      [Cc]ontent-[Ll]ength:*)
+         length=${header#*:}
+         length=$(echo $length)
+         ;;
+      "")
+         body=$(dd bs=1 count="$length" 2>/dev/null)
+         method=$(printf '%s' "$body" | sed -n 's/.*"method":"\([^"]*\)".*/\1/p')
+         id=$(printf '%s' "$body" | sed -n 's/^{"jsonrpc":"2.0","id":\([0-9]*\),.*/\1/p')
+         case "$method" in
+            initialize)
+               if [ "$1" = fail ]; then
+                  reply "{\"jsonrpc\":\"2.0\",\"id\":$id,\"error\":{\"code\":-32603,\"message\":\"broken\"}}"
+                  continue
+               fi
+               reply "{\"jsonrpc\":\"2.0\",\"id\":$id,\"result\":{\"capabilities\":{\"textDocumentSync\":{\"openClose\":true,\"change\":2}}}}"
+               ;;
+            initialized)
+               reply '{"jsonrpc":"2.0","method":"window/logMessage","params":{"type":3,"message":"ready"}}'
+               ;;
+            textDocument/completion)
+               reply "{\"jsonrpc\":\"2.0\",\"id\":$id,\"result\":{\"isIncomplete\":false,\"items\":[{\"label\":\"edi_one\",\"detail\":\"int\"},{\"label\":\"edi_two\"}]}}"
+               ;;
+            shutdown)
+               reply "{\"jsonrpc\":\"2.0\",\"id\":$id,\"result\":null}"
+               ;;
+            exit)
+               exit 0
+               ;;
+         esac
+         ;;
+   esac
+done
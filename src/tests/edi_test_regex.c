@@ -0,0 +1,109 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "edi_regex.c"
+
+#include "edi_suite.h"
+
+static Eina_Bool
+_edi_test_regex_match(const char *pattern, const char *text, int start, int end)
+{
+   Edi_Regex *regex;
+   size_t match_start, match_end;
+   Eina_Bool found;
+
+   regex = edi_regex_new(pattern, NULL);
+   ck_assert(regex);
+
+   found = edi_regex_match(regex, text, strlen(text), 0, &match_start, &match_end);
+   edi_regex_free(regex);
+
+   if (start < 0)
+     return !found;
+
+   return found && (int) match_start == start && (int) match_end == end;
+}
+
+START_TEST (edi_test_regex_match)
+{
+   ck_assert(_edi_test_regex_match("void", "static void _edi(void);", 7, 11));
+   ck_assert(_edi_test_regex_match("_[a-z]+\\(", "static void _edi(void);", 12, 17));
+   ck_assert(_edi_test_regex_match("\\d+", "line 1234;", 5, 9));
+   ck_assert(_edi_test_regex_match("a|ab|abc", "xabcd", 1, 4));
+   ck_assert(_edi_test_regex_match("(ab){2,3}", "abababab", 0, 6));
+   ck_assert(_edi_test_regex_match("x*", "aaa", -1, -1));
+   ck_assert(_edi_test_regex_match("^static", "int static", -1, -1));
+   ck_assert(_edi_test_regex_match("void\\);$", "static void _edi(void);", 17, 23));
+   // "." and negated classes match a whole UTF-8 character.
+   ck_assert(_edi_test_regex_match("h.llo", "h\xc3\xa9llo", 0, 6));
+   ck_assert(_edi_test_regex_match("[^ ]+", "\xe2\x82\xac\xe2\x82\xac x", 0, 6));
+   ck_assert(_edi_test_regex_match("[^\\S]+", "a\xc3\xa9  b", 3, 5));
+   ck_assert(_edi_test_regex_match("\\x4A", "\xc3\xa9J", 2, 3));
+   // The leftmost match is found, not the one ending first, and never an empty one.
+   ck_assert(_edi_test_regex_match("b+|abc", "xabcbb", 1, 4));
+   ck_assert(_edi_test_regex_match("a*", "bba", 2, 3));
+   ck_assert(_edi_test_regex_match("^a|b$", "aab", 0, 1));
+   ck_assert(_edi_test_regex_match("x?$", "ab", -1, -1));
+}
+END_TEST
+
+START_TEST (edi_test_regex_lines)
+{
+   const char *text = "int a;\nint b;\r\nchar c;\n";
+   Edi_Regex *regex;
+
+   regex = edi_regex_new("^char", NULL);
+   ck_assert(edi_regex_search(regex, text, strlen(text)) == strstr(text, "char") + 4);
+   edi_regex_free(regex);
+
+   // Matches never span lines.
+   regex = edi_regex_new("b;\\s*char", NULL);
+   ck_assert(!edi_regex_search(regex, text, strlen(text)));
+   edi_regex_free(regex);
+
+   regex = edi_regex_new("b;$", NULL);
+   ck_assert(edi_regex_search(regex, text, strlen(text)) == strstr(text, "b;") + 2);
+   edi_regex_free(regex);
+}
+END_TEST
+
+START_TEST (edi_test_regex_literal)
+{
+   Edi_Regex *regex;
+
+   regex = edi_regex_new("h.llo world", NULL);
+   ck_assert_str_eq(edi_regex_literal_get(regex), "llo world");
+   edi_regex_free(regex);
+
+   regex = edi_regex_new("x(ab)+cd", NULL);
+   ck_assert_str_eq(edi_regex_literal_get(regex), "abcd");
+   edi_regex_free(regex);
+
+   regex = edi_regex_new("foo|bar", NULL);
+   ck_assert_str_eq(edi_regex_literal_get(regex), "");
+   edi_regex_free(regex);
+}
+END_TEST
+
+START_TEST (edi_test_regex_error)
+{
+   const char *error = NULL;
+
+   ck_assert(!edi_regex_new("(ab", &error));
+   ck_assert(error);
+   ck_assert(!edi_regex_new("*a", &error));
+   ck_assert(!edi_regex_new("[a-", &error));
+   ck_assert(!edi_regex_new("(a)\\1", &error));
+   ck_assert(!edi_regex_new("a{2000}", &error));
+   ck_assert(!edi_regex_new("[^\xc3\xa9]", &error));
+}
+END_TEST
+
+void edi_test_regex(TCase *tc)
+{
+   tcase_add_test(tc, edi_test_regex_match);
+   tcase_add_test(tc, edi_test_regex_lines);
+   tcase_add_test(tc, edi_test_regex_literal);
+   tcase_add_test(tc, edi_test_regex_error);
+}
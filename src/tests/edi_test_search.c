@@ -0,0 +1,390 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "edi_search.c"
+#include "edi_searchpanel.c"
+
+#include "edi_suite.h"
+
+// Add some no-op methods here so linking works without having to import the whole UI!
+int EDI_EVENT_FILE_CHANGED;
+
+void
+edi_editor_modified_set(Edi_Editor *editor EINA_UNUSED)
+{
+}
+
+Edi_File_Replace *
+edi_file_text_replace_all(const char *search EINA_UNUSED, const char *replace EINA_UNUSED,
+                          Eina_Bool dry_run EINA_UNUSED, Eina_Hash *skip EINA_UNUSED,
+                          Edi_File_Replace_Cb file_cb EINA_UNUSED,
+                          Edi_File_Replace_Done_Cb done_cb EINA_UNUSED, const void *data EINA_UNUSED)
+{
+   return NULL;
+}
+
+void
+edi_file_text_replace_cancel(Edi_File_Replace *replace EINA_UNUSED)
+{
+}
+
+void
+edi_mainview_open_path(const char *path EINA_UNUSED)
+{
+}
+
+void
+edi_mainview_goto_position(unsigned int row EINA_UNUSED, unsigned int col EINA_UNUSED)
+{
+}
+
+Edi_Mainview_Panel *
+edi_mainview_panel_by_index(int index EINA_UNUSED)
+{
+   return NULL;
+}
+
+int
+edi_mainview_panel_count(void)
+{
+   return 0;
+}
+
+void
+edi_search_index_init(void)
+{
+}
+
+Eina_Bool
+edi_search_index_candidates_get(const char *term EINA_UNUSED, Eina_List **paths EINA_UNUSED)
+{
+   return EINA_FALSE;
+}
+
+void
+edi_theme_elm_code_set(Evas_Object *obj EINA_UNUSED, const char *name EINA_UNUSED)
+{
+}
+
+void
+edi_theme_elm_code_alpha_set(Evas_Object *obj EINA_UNUSED)
+{
+}
+// end no-ops
+
+START_TEST (edi_test_search_find_simple)
+{
+   const char *text = "static void _edi_search_find(void);";
+
+   ck_assert(edi_search_find(text, strlen(text), "_edi", 4) == text + 12);
+   ck_assert(edi_search_find(text, strlen(text), "void", 4) == text + 7);
+   ck_assert(edi_search_find(text, strlen(text), ";", 1) == text + strlen(text) - 1);
+   ck_assert(!edi_search_find(text, strlen(text), "_edx", 4));
+}
+END_TEST
+
+START_TEST (edi_test_search_find_bounds)
+{
+   const char *text = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab";
+   size_t length = strlen(text);
+
+   ck_assert(edi_search_find(text, length, "ab", 2) == text + length - 2);
+   // A match must not be reported beyond the given length.
+   ck_assert(!edi_search_find(text, length - 1, "ab", 2));
+   ck_assert(!edi_search_find(text, 1, "ab", 2));
+}
+END_TEST
+
+START_TEST (edi_test_search_find_memmem)
+{
+   const char *alphabet = "_e \n";
+   char haystack[200], needle[6];
+   size_t length, needle_length, i;
+   int iteration;
+
+   srand(42);
+   for (iteration = 0; iteration < 10000; iteration++)
+     {
+        const char *found, *expected = NULL;
+
+        length = rand() % sizeof(haystack);
+        for (i = 0; i < length; i++)
+          haystack[i] = alphabet[rand() % 4];
+        needle_length = 1 + rand() % sizeof(needle);
+        for (i = 0; i < needle_length; i++)
+          needle[i] = alphabet[rand() % 4];
+
+        for (i = 0; i + needle_length <= length; i++)
+          if (!memcmp(haystack + i, needle, needle_length))
+            {
+               expected = haystack + i;
+               break;
+            }
+
+        found = edi_search_find(haystack, length, needle, needle_length);
+        ck_assert(found == expected);
+     }
+}
+END_TEST
+
+START_TEST (edi_test_search_patterns)
+{
+   const char *text = "int x; // FIXME: TODO later";
+   Edi_Search_Patterns *patterns;
+   Eina_List *tags = NULL;
+
+   tags = eina_list_append(tags, "TODO");
+   tags = eina_list_append(tags, "FIXME");
+   tags = eina_list_append(tags, "XXX");
+   patterns = edi_search_patterns_new(tags);
+
+   ck_assert(edi_search_patterns_length_max(patterns) == 5);
+   ck_assert(edi_search_patterns_find(patterns, text, strlen(text)) == text + 10);
+   ck_assert(edi_search_patterns_find(patterns, text + 11, strlen(text) - 11) == text + 17);
+   // A pattern cut by the end of the text does not match.
+   ck_assert(!edi_search_patterns_find(patterns, text, 13));
+   ck_assert(!edi_search_patterns_find(patterns, "XX TOD", 6));
+
+   edi_search_patterns_free(patterns);
+   eina_list_free(tags);
+
+   ck_assert(!edi_search_patterns_new(NULL));
+}
+END_TEST
+
+START_TEST (edi_test_search_patterns_overlap)
+{
+   const char *text = "ushers";
+   Edi_Search_Patterns *patterns;
+   Eina_List *words = NULL;
+
+   words = eina_list_append(words, "he");
+   words = eina_list_append(words, "she");
+   words = eina_list_append(words, "his");
+   words = eina_list_append(words, "hers");
+   patterns = edi_search_patterns_new(words);
+
+   // "she" and "he" both end at the same byte, the first to end is reported.
+   ck_assert(edi_search_patterns_find(patterns, text, strlen(text)) == text + 1);
+   ck_assert(edi_search_patterns_find(patterns, text + 2, strlen(text) - 2) == text + 2);
+
+   edi_search_patterns_free(patterns);
+   eina_list_free(words);
+}
+END_TEST
+
+// Lines ending in \n, \r\n or a lone \r, some of them with "hit" in them.
+static char *
+_edi_test_search_text(size_t size, size_t *length)
+{
+   static const char *breaks[] = { "\n", "\r\n", "\r" };
+   Eina_Strbuf *buf;
+   unsigned int i, count;
+   char *text;
+
+   buf = eina_strbuf_new();
+   while (eina_strbuf_length_get(buf) < size)
+     {
+        for (count = rand() % 60, i = 0; i < count; i++)
+          eina_strbuf_append_char(buf, 'a' + rand() % 3);
+        if (!(rand() % 20))
+          eina_strbuf_append(buf, "hit");
+        for (count = rand() % 60, i = 0; i < count; i++)
+          eina_strbuf_append_char(buf, 'a' + rand() % 3);
+        eina_strbuf_append(buf, breaks[rand() % 3]);
+     }
+
+   *length = eina_strbuf_length_get(buf);
+   text = eina_strbuf_string_steal(buf);
+   eina_strbuf_free(buf);
+
+   return text;
+}
+
+// The line breaks in a block, a \r\n counted once.
+static unsigned int
+_edi_test_search_breaks(const char *start, const char *end)
+{
+   unsigned int count = 0;
+
+   for (; start < end; start++)
+     if (*start == '\n' || (*start == '\r' && (start + 1 == end || start[1] != '\n')))
+       count++;
+
+   return count;
+}
+
+START_TEST (edi_test_search_lines)
+{
+   const char *match, *line, *end;
+   Eina_Iterator *it;
+   Eina_File_Line *l;
+   unsigned long long offset;
+   unsigned int count = 0;
+   size_t length, match_length;
+   char *text;
+
+   // Many lines cross the 4096 byte blocks the text is counted in, some on a \r\n.
+   srand(3);
+   text = _edi_test_search_text(256 * 1024, &length);
+
+   edi_count_line(text, length, text, &count);
+   ck_assert_int_eq(count, _edi_test_search_breaks(text, text + length));
+
+   it = edi_search_text(text, text + length, "hit", NULL, NULL);
+   EINA_ITERATOR_FOREACH(it, l)
+     {
+        match = edi_search_match_get(it, &match_length, &offset);
+
+        // The line found is the one the match is in, numbered from 1.
+        for (line = match; line > text && line[-1] != '\n' && line[-1] != '\r'; line--);
+        for (end = match; end < text + length && *end != '\n' && *end != '\r'; end++);
+        ck_assert(l->start == line);
+        ck_assert(offset == (unsigned long long) (line - text));
+        ck_assert_int_eq(l->index, _edi_test_search_breaks(text, line) + 1);
+        ck_assert(edi_search_find(line, end - line, "hit", 3) == match);
+        ck_assert_int_eq(match_length, 3);
+     }
+   eina_iterator_free(it);
+
+   free(text);
+}
+END_TEST
+
+START_TEST (edi_test_search_blocks)
+{
+   const char *start, *end, *lf;
+   Eina_Iterator *serial, *block;
+   Eina_File_Line *l, *expected;
+   unsigned int base = 0;
+   size_t length, size;
+   char *text;
+
+   srand(5);
+   text = _edi_test_search_text(256 * 1024, &length);
+
+   // Blocks are cut after a \n, as large files are, and numbered on from the breaks before them.
+   serial = edi_search_text(text, text + length, "hit", NULL, NULL);
+   for (start = text; start < text + length; start = end)
+     {
+        size = 1 + rand() % 8192;
+        if ((size_t) (text + length - start) <= size)
+          end = text + length;
+        else
+          {
+             lf = memchr(start + size - 1, '\n', text + length - (start + size - 1));
+             end = lf ? lf + 1 : text + length;
+          }
+
+        block = edi_search_text(start, end, "hit", NULL, NULL);
+        if (block)
+          {
+             EINA_ITERATOR_FOREACH(block, l)
+               {
+                  ck_assert(eina_iterator_next(serial, (void **) &expected));
+                  ck_assert(l->start == expected->start);
+                  ck_assert_int_eq(l->index + base, expected->index);
+               }
+             eina_iterator_free(block);
+          }
+
+        edi_count_line(start, end - start, start, &base);
+     }
+   ck_assert(!eina_iterator_next(serial, (void **) &expected));
+   eina_iterator_free(serial);
+
+   free(text);
+}
+END_TEST
+
+START_TEST (edi_test_search_chunks)
+{
+   Search_Run *run;
+   Search_Result result;
+   Eina_Stringshare *path;
+   Eina_Iterator *it;
+   Eina_File_Line *l;
+   const char *match;
+   unsigned long long offset;
+   unsigned int i, hits = 0;
+   size_t length, match_length;
+   char *text;
+
+   eina_init();
+   _edi_searchpanel_results_init();
+
+   srand(7);
+   text = _edi_test_search_text(EDI_SEARCHPANEL_CHUNK_SIZE * 3, &length);
+
+   run = _edi_searchpanel_run_new(NULL, 0);
+   run->text = strdup("hit");
+   path = eina_stringshare_add("chunks");
+   _edi_searchpanel_search_chunks(run, path, text, length);
+
+   // The blocks give the hits in file order, numbered as a search of the whole file does.
+   it = edi_search_text(text, text + length, "hit", NULL, NULL);
+   while (_edi_searchpanel_results_pop(&result))
+     {
+        for (i = 0; i < result.count; i++)
+          {
+             ck_assert(eina_iterator_next(it, (void **) &l));
+             match = edi_search_match_get(it, &match_length, &offset);
+
+             ck_assert_int_eq(result.hits[i].line, l->index);
+             ck_assert(result.hits[i].offset == offset);
+             ck_assert_int_eq(result.hits[i].column, _edi_searchpanel_column_get(l->start, match));
+             hits++;
+          }
+        _edi_searchpanel_result_free(&result);
+     }
+   ck_assert(!eina_iterator_next(it, (void **) &l));
+   ck_assert(hits > EDI_SEARCHPANEL_BATCH_SIZE);
+   eina_iterator_free(it);
+
+   eina_stringshare_del(path);
+   _edi_searchpanel_run_unref(run);
+   free(text);
+   eina_shutdown();
+}
+END_TEST
+
+START_TEST (edi_test_search_snippet)
+{
+   char line[512];
+   char *match;
+   const char *snippet;
+   unsigned int i, length;
+
+   // Short lines are kept whole, without their indent.
+   snippet = _edi_searchpanel_snippet_get("\t  int hit;", "\t  int hit;" + 11, "\t  int hit;" + 7, &length);
+   ck_assert_int_eq(length, 8);
+   ck_assert(!strncmp(snippet, "int hit;", length));
+
+   // Long lines are cut around the match, between the bytes of a character.
+   memset(line, 'x', sizeof(line));
+   for (i = 0; i + 1 < sizeof(line); i += 3)
+     memcpy(line + i, "\xc3\xa9", 2);
+   match = line + 302;
+   memcpy(match, "hit", 3);
+   snippet = _edi_searchpanel_snippet_get(line, line + sizeof(line), match, &length);
+   ck_assert(snippet <= match && match - snippet <= EDI_SEARCHPANEL_SNIPPET_BEFORE);
+   ck_assert(length <= EDI_SEARCHPANEL_SNIPPET_LENGTH);
+   ck_assert(snippet + length >= match + 3);
+   ck_assert((snippet[0] & 0xC0) != 0x80);
+   ck_assert((snippet[length] & 0xC0) != 0x80);
+}
+END_TEST
+
+void edi_test_search(TCase *tc)
+{
+   tcase_add_test(tc, edi_test_search_find_simple);
+   tcase_add_test(tc, edi_test_search_find_bounds);
+   tcase_add_test(tc, edi_test_search_find_memmem);
+   tcase_add_test(tc, edi_test_search_patterns);
+   tcase_add_test(tc, edi_test_search_patterns_overlap);
+   tcase_add_test(tc, edi_test_search_lines);
+   tcase_add_test(tc, edi_test_search_blocks);
+   tcase_add_test(tc, edi_test_search_chunks);
+   tcase_add_test(tc, edi_test_search_snippet);
+}
@@ -0,0 +1,237 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "edi_index_file.c"
+#include "edi_symbol_index.c"
+
+#include "edi_suite.h"
+
+// Add some no-op methods here so linking works without having to import the whole UI!
+int EDI_EVENT_FILE_SAVED;
+
+const char *
+_edi_project_config_dir_get(void)
+{
+   return NULL;
+}
+
+#if HAVE_LIBCLANG
+
+#define EDI_TEST_SYMBOL_INDEX_DIR "/project"
+
+static void
+_edi_test_symbol_index_found_add(Edi_Symbol_Index_Delta *delta, const char *usr, const char *name,
+                                 unsigned int line, unsigned int flags)
+{
+   Edi_Symbol_Index_Found found;
+
+   found.usr = eina_stringshare_add(usr);
+   found.name = eina_stringshare_add(name);
+   found.kind = CXIdxEntity_Function;
+   found.line = line;
+   found.column = 1;
+   found.flags = flags;
+   eina_inarray_push(delta->found, &found);
+}
+
+static Edi_Symbol_Index_Delta *
+_edi_test_symbol_index_delta_new(const char *unit)
+{
+   Edi_Symbol_Index_Delta *delta;
+
+   delta = calloc(1, sizeof(Edi_Symbol_Index_Delta));
+   delta->unit = eina_stringshare_add(unit);
+   delta->mtime = 42;
+   delta->found = eina_inarray_new(sizeof(Edi_Symbol_Index_Found), 4);
+
+   return delta;
+}
+
+// main.c includes main.h, util.c is a unit of its own.
+static void
+_edi_test_symbol_index_table_build(Edi_Symbol_Index_Table *table)
+{
+   Edi_Symbol_Index_Builder builder;
+   unsigned int id;
+
+   _edi_symbol_index_builder_init(&builder);
+
+   id = _edi_symbol_index_builder_file_add(&builder, EDI_TEST_SYMBOL_INDEX_DIR "/main.c",
+                                           EDI_TEST_SYMBOL_INDEX_DIR "/main.c", 1);
+   _edi_symbol_index_builder_occurrence_add(&builder, "c:@F@main", "main", CXIdxEntity_Function,
+                                            id, 3, 1, EDI_SYMBOL_DEFINITION);
+   _edi_symbol_index_builder_occurrence_add(&builder, "c:@F@util", "util", CXIdxEntity_Function,
+                                            id, 5, 4, EDI_SYMBOL_REFERENCE);
+   id = _edi_symbol_index_builder_file_add(&builder, EDI_TEST_SYMBOL_INDEX_DIR "/main.h",
+                                           EDI_TEST_SYMBOL_INDEX_DIR "/main.c", 1);
+   _edi_symbol_index_builder_occurrence_add(&builder, "c:@F@util", "util", CXIdxEntity_Function,
+                                            id, 1, 5, EDI_SYMBOL_DECLARATION);
+   id = _edi_symbol_index_builder_file_add(&builder, EDI_TEST_SYMBOL_INDEX_DIR "/util.c",
+                                           EDI_TEST_SYMBOL_INDEX_DIR "/util.c", 1);
+   _edi_symbol_index_builder_occurrence_add(&builder, "c:@F@util", "util", CXIdxEntity_Function,
+                                            id, 2, 5, EDI_SYMBOL_DEFINITION);
+
+   _edi_symbol_index_builder_finish(&builder, table);
+   _edi_symbol_index_builder_shutdown(&builder);
+   table->database = 7;
+}
+
+static unsigned int
+_edi_test_symbol_index_count(const char *usr, unsigned int flags, const char *path)
+{
+   Edi_Symbol_Location *location;
+   Eina_List *locations;
+   unsigned int count = 0;
+
+   locations = edi_symbol_index_locations_get(usr, flags);
+   EINA_LIST_FREE(locations, location)
+     {
+        if (!path || !strcmp(location->path, path))
+          count++;
+        edi_symbol_location_free(location);
+     }
+
+   return count;
+}
+
+START_TEST (edi_test_symbol_index_table)
+{
+   Edi_Symbol_Index_Table table, read;
+   Eina_Tmpstr *dir;
+   Eet_File *ef;
+   char *filename;
+
+   eet_init();
+   ecore_file_init();
+
+   ck_assert(eina_file_mkdtemp("edi_test_symbol_index_XXXXXX", &dir));
+   filename = edi_path_append(dir, EDI_SYMBOL_INDEX_NAME);
+
+   _edi_test_symbol_index_table_build(&table);
+   ck_assert_int_eq(table.file_count, 3);
+   ck_assert_int_eq(table.symbol_count, 2);
+   ck_assert_int_eq(table.occurrence_count, 4);
+
+   ck_assert(_edi_symbol_index_table_write(&table, filename, EDI_TEST_SYMBOL_INDEX_DIR));
+   ck_assert(_edi_symbol_index_table_read(&read, filename, EDI_TEST_SYMBOL_INDEX_DIR));
+   ck_assert_int_eq(read.database, 7);
+   ck_assert_int_eq(read.file_count, table.file_count);
+   ck_assert_int_eq(read.symbol_count, table.symbol_count);
+   ck_assert_int_eq(read.occurrence_count, table.occurrence_count);
+   ck_assert(!memcmp(read.paths, table.paths, table.paths_size));
+   ck_assert(!memcmp(read.strings, table.strings, table.strings_size));
+   ck_assert(!memcmp(read.occurrences, table.occurrences,
+                     table.occurrence_count * sizeof(Edi_Symbol_Index_Occurrence)));
+   _edi_symbol_index_table_free(&read);
+
+   // The index of another project, or one written by another version, is built again.
+   ck_assert(!_edi_symbol_index_table_read(&read, filename, "/other"));
+   ef = edi_index_file_write_begin(filename, EDI_SYMBOL_INDEX_VERSION + 1, EDI_TEST_SYMBOL_INDEX_DIR);
+   ck_assert(ef);
+   ck_assert(edi_index_file_write_end(ef, filename, EINA_TRUE));
+   ck_assert(!_edi_symbol_index_table_read(&read, filename, EDI_TEST_SYMBOL_INDEX_DIR));
+
+   _edi_symbol_index_table_free(&table);
+   ecore_file_recursive_rm(dir);
+   free(filename);
+   eina_tmpstr_del(dir);
+   ecore_file_shutdown();
+   eet_shutdown();
+}
+END_TEST
+
+START_TEST (edi_test_symbol_index_compact)
+{
+   Edi_Symbol_Index index;
+   Edi_Symbol_Index_Table table, read;
+   Edi_Symbol_Index_Unit unit;
+   Edi_Symbol_Index_Delta *delta;
+   Eina_Tmpstr *dir;
+
+   eet_init();
+   ecore_file_init();
+
+   if (!_index_lock_ready)
+     {
+        eina_lock_new(&_index_lock);
+        _index_lock_ready = EINA_TRUE;
+     }
+
+   ck_assert(eina_file_mkdtemp("edi_test_symbol_index_XXXXXX", &dir));
+
+   memset(&index, 0, sizeof(Edi_Symbol_Index));
+   index.directory = strdup(EDI_TEST_SYMBOL_INDEX_DIR);
+   index.filename = edi_path_append(dir, EDI_SYMBOL_INDEX_NAME);
+   index.ids = eina_hash_string_superfast_new(NULL);
+   index.delta = eina_hash_string_superfast_new(_edi_symbol_index_delta_free);
+   index.ready = EINA_TRUE;
+
+   _edi_test_symbol_index_table_build(&table);
+   _edi_symbol_index_table_set(&index, &table);
+   _index = &index;
+
+   // main.c was indexed again, it does not include main.h any more and calls util twice.
+   memset(&unit, 0, sizeof(Edi_Symbol_Index_Unit));
+   unit.index = &index;
+   unit.path = EDI_TEST_SYMBOL_INDEX_DIR "/main.c";
+   unit.files = eina_hash_string_superfast_new(_edi_symbol_index_delta_free);
+   delta = _edi_test_symbol_index_delta_new(unit.path);
+   _edi_test_symbol_index_found_add(delta, "c:@F@main", "main", 4, EDI_SYMBOL_DEFINITION);
+   _edi_test_symbol_index_found_add(delta, "c:@F@util", "util", 6, EDI_SYMBOL_REFERENCE);
+   _edi_test_symbol_index_found_add(delta, "c:@F@util", "util", 7, EDI_SYMBOL_REFERENCE);
+   eina_hash_add(unit.files, unit.path, delta);
+
+   eina_lock_take(&_index_lock);
+   _edi_symbol_index_unit_apply(&index, &unit);
+   eina_lock_release(&_index_lock);
+   eina_hash_free(unit.files);
+
+   ck_assert_int_eq(index.removed, 2);
+   ck_assert_int_eq(eina_hash_population(index.delta), 1);
+   ck_assert_int_eq(_edi_test_symbol_index_count("c:@F@util", EDI_SYMBOL_REFERENCE, NULL), 2);
+   ck_assert_int_eq(_edi_test_symbol_index_count("c:@F@util", EDI_SYMBOL_DECLARATION, NULL), 0);
+
+   // The changes are merged into the table, which is written again.
+   _edi_symbol_index_compact(&index);
+   ck_assert_int_eq(index.removed, 0);
+   ck_assert_int_eq(eina_hash_population(index.delta), 0);
+   ck_assert_int_eq(index.table.file_count, 2);
+   ck_assert_int_eq(index.table.database, 7);
+   ck_assert(!eina_hash_find(index.ids, EDI_TEST_SYMBOL_INDEX_DIR "/main.h"));
+
+   ck_assert_int_eq(_edi_test_symbol_index_count("c:@F@main", EDI_SYMBOL_DEFINITION,
+                                                 EDI_TEST_SYMBOL_INDEX_DIR "/main.c"), 1);
+   ck_assert_int_eq(_edi_test_symbol_index_count("c:@F@util", EDI_SYMBOL_REFERENCE,
+                                                 EDI_TEST_SYMBOL_INDEX_DIR "/main.c"), 2);
+   ck_assert_int_eq(_edi_test_symbol_index_count("c:@F@util", EDI_SYMBOL_DEFINITION,
+                                                 EDI_TEST_SYMBOL_INDEX_DIR "/util.c"), 1);
+   ck_assert_int_eq(_edi_test_symbol_index_count("c:@F@util", EDI_SYMBOL_DECLARATION, NULL), 0);
+
+   ck_assert(_edi_symbol_index_table_read(&read, index.filename, EDI_TEST_SYMBOL_INDEX_DIR));
+   ck_assert_int_eq(read.file_count, 2);
+   ck_assert_int_eq(read.occurrence_count, 4);
+   _edi_symbol_index_table_free(&read);
+
+   _index = NULL;
+   eina_hash_free(index.ids);
+   eina_hash_free(index.delta);
+   _edi_symbol_index_table_free(&index.table);
+   ecore_file_recursive_rm(dir);
+   free(index.filename);
+   free(index.directory);
+   eina_tmpstr_del(dir);
+   ecore_file_shutdown();
+   eet_shutdown();
+}
+END_TEST
+
+#endif
+
+void edi_test_symbol_index(TCase *tc EINA_UNUSED)
+{
+#if HAVE_LIBCLANG
+   tcase_add_test(tc, edi_test_symbol_index_table);
+   tcase_add_test(tc, edi_test_symbol_index_compact);
+#endif
+}